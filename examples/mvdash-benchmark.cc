@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash_client.h"
+#include "ns3/mvdash-event-recorder.h"
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-benchmark");
+
+/*
+ * Scalability benchmark of the mvdash-v2 dumbbell.
+ *
+ * Every combination of client count, viewpoint count and session length
+ * (in segments) is run in a forked child process, so that the peak RSS
+ * reported by wait4 () belongs to that configuration only.  One CSV row per
+ * configuration is written to stdout (and to the output file, if given):
+ *
+ *   nClients,nViewpoints,nSegments,simSeconds,wallSeconds,events,
+ *   eventsPerSecond,peakRssKB,simSecondsPerWallSecond
+ *
+ * With record=1 every client trace source, packets included, is recorded by
+ * mvdashEventRecorder, so comparing wallSeconds with record=0 gives the
+ * tracing overhead.
+ */
+
+struct st_benchConfig {
+    int      nClients;
+    int      nViewpoints;
+    int      nSegments;
+    uint64_t bwPerClient;               // bottleneck bandwidth share per client in bps
+    double   startWindow;               // clients start uniformly within this window (seconds)
+    std::string path;
+    std::string mvTemplate;
+    bool     record;                    // record every client trace event to events_<nClients>.bin
+};
+
+struct st_benchResult {
+    double   simSeconds;
+    double   wallSeconds;
+    uint64_t events;
+};
+
+std::vector<int> ParseList(std::string str);
+std::string WriteManifest(const st_benchConfig &cfg);
+std::string WriteViewpointInfo(const st_benchConfig &cfg);
+st_benchResult RunConfig(const st_benchConfig &cfg);
+void SetConfig();
+
+int main(int argc, char *argv[]) {
+    std::string clientList = "1,10,100,1000,5000";
+    std::string viewpointList = "5";
+    std::string segmentList = "30";
+    std::string bwPerClient = "5Mbps";
+    std::string output = "";
+    st_benchConfig cfg = {1, 5, 30, 0, 10.0, "./contrib/etri_mvdash/", "multiviewvideo.csv", false};
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH scalability benchmark.\n");
+    cmd.AddValue ("nClients", "Comma separated list of client counts", clientList);
+    cmd.AddValue ("nViewpoints", "Comma separated list of viewpoint counts", viewpointList);
+    cmd.AddValue ("nSegments", "Comma separated list of session lengths in segments", segmentList);
+    cmd.AddValue ("bwPerClient", "Bottleneck bandwidth per client", bwPerClient);
+    cmd.AddValue ("startWindow", "Clients start uniformly within this window (seconds)", cfg.startWindow);
+    cmd.AddValue ("mvTemplate", "Multi-View video source info used to synthesize the manifests", cfg.mvTemplate);
+    cmd.AddValue ("record", "Record every client trace event with mvdashEventRecorder", cfg.record);
+    cmd.AddValue ("output", "The name of a CSV file receiving the results (appended)", output);
+    cmd.Parse (argc, argv);
+
+    cfg.bwPerClient = DataRate (bwPerClient).GetBitRate ();
+
+    std::ofstream outFile;
+    if (!output.empty ())
+        outFile.open ((cfg.path + output).c_str (), std::ios::app);
+
+    std::string header = "nClients,nViewpoints,nSegments,simSeconds,wallSeconds,events,"
+                         "eventsPerSecond,peakRssKB,simSecondsPerWallSecond";
+    std::cout << header << std::endl;
+    if (outFile.is_open ())
+        outFile << header << std::endl;
+
+    for (int nViewpoints : ParseList (viewpointList)) {
+        for (int nSegments : ParseList (segmentList)) {
+            for (int nClients : ParseList (clientList)) {
+                cfg.nClients = nClients;
+                cfg.nViewpoints = nViewpoints;
+                cfg.nSegments = nSegments;
+
+                int fd[2];
+                if (pipe (fd) != 0) {
+                    NS_FATAL_ERROR ("pipe() failed");
+                }
+                pid_t pid = fork ();
+                if (pid == 0) {
+                    close (fd[0]);
+                    st_benchResult result = RunConfig (cfg);
+                    if (write (fd[1], &result, sizeof (result)) != sizeof (result))
+                        _exit (1);
+                    close (fd[1]);
+                    _exit (0);
+                }
+                close (fd[1]);
+                st_benchResult result = {0.0, 0.0, 0};
+                bool valid = (read (fd[0], &result, sizeof (result)) == sizeof (result));
+                close (fd[0]);
+
+                int status;
+                struct rusage usage;
+                wait4 (pid, &status, 0, &usage);
+                if (!valid || !WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+                    NS_LOG_UNCOND ("Configuration " << nClients << "/" << nViewpoints << "/"
+                        << nSegments << " failed");
+                    continue;
+                }
+
+                std::ostringstream row;
+                row << nClients << "," << nViewpoints << "," << nSegments
+                    << "," << result.simSeconds
+                    << "," << result.wallSeconds
+                    << "," << result.events
+                    << "," << result.events / result.wallSeconds
+                    << "," << usage.ru_maxrss
+                    << "," << result.simSeconds / result.wallSeconds;
+                std::cout << row.str () << std::endl;
+                if (outFile.is_open ())
+                    outFile << row.str () << std::endl;
+            }
+        }
+    }
+    return 0;
+}
+
+std::vector<int> ParseList(std::string str) {
+    std::vector<int> values;
+    std::replace (str.begin (), str.end (), ',', ' ');
+    std::istringstream buffer (str);
+    int value;
+    while (buffer >> value)
+        values.push_back (value);
+    return values;
+}
+
+/*
+ * Synthesize a manifest with the requested viewpoint and segment counts by
+ * cycling through the viewpoints and segments of the template manifest.
+ */
+std::string WriteManifest(const st_benchConfig &cfg) {
+    std::ifstream templ ((cfg.path + cfg.mvTemplate).c_str ());
+    if (!templ) {
+        NS_FATAL_ERROR ("Cannot open the template manifest " << cfg.path + cfg.mvTemplate);
+    }
+    std::string temp;
+    std::getline (templ, temp);
+    std::istringstream buffer (temp);
+    std::vector<int64_t> first_line ((std::istream_iterator<int64_t> (buffer)),
+                 std::istream_iterator<int64_t>());
+    int nTemplViews = first_line[0];
+    int64_t duration = first_line[2];
+    std::vector<int> offsets;           // column of the first rate of each template viewpoint
+    int column = 0;
+    for (int vp = 0; vp < nTemplViews; vp++) {
+        offsets.push_back (column);
+        column += first_line[vp + 3];
+    }
+
+    std::vector<std::vector<int64_t>> rows;
+    while (std::getline (templ, temp)) {
+        if (temp.empty ()) break;
+        std::istringstream line (temp);
+        rows.push_back (std::vector<int64_t> ((std::istream_iterator<int64_t> (line)),
+                        std::istream_iterator<int64_t>()));
+    }
+
+    std::string fileName = cfg.path + "bench_mv_v" + std::to_string (cfg.nViewpoints)
+        + "_s" + std::to_string (cfg.nSegments) + ".csv";
+    std::ofstream mv (fileName.c_str ());
+    mv << cfg.nViewpoints << " " << cfg.nSegments << " " << duration;
+    for (int vp = 0; vp < cfg.nViewpoints; vp++)
+        mv << " " << first_line[vp % nTemplViews + 3];
+    mv << "\n";
+    for (int t = 0; t < cfg.nSegments; t++) {
+        const std::vector<int64_t> &row = rows[t % rows.size ()];
+        for (int vp = 0; vp < cfg.nViewpoints; vp++) {
+            int tv = vp % nTemplViews;
+            for (int r = 0; r < first_line[tv + 3]; r++)
+                mv << (vp + r ? "\t" : "") << row[offsets[tv] + r];
+        }
+        mv << "\n";
+    }
+    return fileName;
+}
+
+/*
+ * Markovian switching model with a sticky diagonal and uniform exits.
+ */
+std::string WriteViewpointInfo(const st_benchConfig &cfg) {
+    std::string fileName = cfg.path + "bench_vp_v" + std::to_string (cfg.nViewpoints) + ".csv";
+    std::ofstream vp (fileName.c_str ());
+    int n = cfg.nViewpoints;
+    double stay = (n > 1) ? 0.4 : 1.0;
+    double leave = (n > 1) ? (1.0 - stay) / (n - 1) : 0.0;
+
+    vp << "0 " << n << " 2 10 2\n";
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++)
+            vp << (j ? " " : "") << (i == j ? stay : leave);
+        vp << "\n";
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++)
+            vp << (j ? " " : "") << (i == j ? 4 : 2);
+        vp << "\n";
+    }
+    return fileName;
+}
+
+st_benchResult RunConfig(const st_benchConfig &cfg) {
+    SetConfig();
+    std::string mvInfo = WriteManifest (cfg);
+    std::string vpInfo = WriteViewpointInfo (cfg);
+    double simTime = 1.0 + cfg.startWindow + 1.5 * cfg.nSegments * 2.0;
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now ();
+
+// ===========================================================================================
+    /* Build Simulation Topology, the dumbbell of mvdash-v2; its setup time counts in wallSeconds */
+    uint64_t bottleneckRate = cfg.bwPerClient * cfg.nClients;
+    mvdashTopologyHelper topology;
+    topology.SetBottleneck (std::to_string (bottleneckRate) + "bps", "40ms");
+    topology.SetServerLink (std::to_string (std::max (bottleneckRate, (uint64_t) 100000000)) + "bps", "5ms");
+    topology.Build (cfg.nClients);
+
+    NodeContainer serverNodes (topology.GetServer ());
+    NodeContainer clientNodes = topology.GetClients ();
+
+// ===========================================================================================
+    uint16_t serverPort = 9;
+    Address serverAddress = InetSocketAddress(topology.GetServerAddress (), serverPort);
+    mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), 0);
+    ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+    serverApp.Start (Seconds (0.0));
+
+    mvdashClientHelper clientHelper (serverAddress, 0);
+    clientHelper.SetAttribute("VPInfo", StringValue(vpInfo));
+    clientHelper.SetAttribute("VPModel", StringValue("markovian"));
+    clientHelper.SetAttribute("MVInfo", StringValue(mvInfo));
+    clientHelper.SetAttribute("EnableLogs", BooleanValue(false));
+    ApplicationContainer clientApps = clientHelper.Install (clientNodes);
+
+    for (int i=0; i < cfg.nClients; i++) {
+        clientApps.Get(i)->SetStartTime(Seconds(0.1 + cfg.startWindow * i / cfg.nClients));
+    }
+    clientApps.Stop(Seconds(simTime));
+
+    std::unique_ptr<mvdashEventRecorder> recorder;
+    if (cfg.record) {
+        recorder.reset (new mvdashEventRecorder (cfg.path + "events_" + std::to_string (cfg.nClients) + ".bin"));
+        recorder->Install (clientApps);
+    }
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Simulator::Stop (Seconds (simTime));
+    Simulator::Run ();
+
+    st_benchResult result;
+    result.simSeconds = Simulator::Now ().GetSeconds ();
+    result.events = Simulator::GetEventCount ();
+    Simulator::Destroy ();
+    result.wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    return result;
+}
+
+void SetConfig() {
+    uint32_t nBufSize = 600000;
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (nBufSize));
+}
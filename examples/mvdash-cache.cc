@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash_client.h"
+#include "ns3/mvdash_cache_server.h"
+
+/*
+ * mvdash-v2 dumbbell with an mvdashCacheServer on the client-side router.
+ *
+ *   server -- router0 ==bottleneck== router1 [cache] -- clients
+ *
+ * The clients fetch from the cache; misses cross the bottleneck once per
+ * segment however many clients ask for it.  Run with useCache=0 for the
+ * baseline where every client talks to the origin.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-cache");
+
+int main(int argc, char *argv[]) {
+    uint32_t nBufSize = 600000;
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (nBufSize));
+
+// ===========================================================================================
+    // Simulation Parameters & Variables for Command Line Arguments
+    uint32_t simId=0;
+    double   simTime=100.0;
+    int      nClients = 10;
+    bool     useCache = true;
+    uint64_t cacheSize = 50000000;
+    std::string policy = "lru";
+
+    std::string bwInit = "5Mbps";
+    std::string path = "./contrib/etri_mvdash/";
+    std::string vpInfo = "viewpoint_transition.csv";
+    std::string vpModel = "markovian";
+    std::string mvInfo = "multiviewvideo.csv";
+    std::string mvAlgo = "maximize_current";
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH Streaming Simulation with an edge cache.\n");
+    cmd.AddValue ("simId", "The simulation's index (for logging purposes)", simId);
+    cmd.AddValue ("simTime", "The simulation Finish Time", simTime);
+    cmd.AddValue ("nClients", "Number of Clients", nClients);
+    cmd.AddValue ("useCache", "Serve the clients from a cache on the client-side router", useCache);
+    cmd.AddValue ("cacheSize", "The cache capacity in bytes", cacheSize);
+    cmd.AddValue ("policy", "[lru, lfu]", policy);
+    cmd.AddValue ("bwInit", "The bandwidth of the bottleneck link", bwInit);
+    cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info",vpInfo);
+    cmd.AddValue ("vpModel", "[markovian, free]", vpModel);
+    cmd.AddValue ("mvInfo", "The name of the file containing Multi-View video source info",mvInfo);
+    cmd.AddValue ("mvAlgo", "[maximize_current, newone]", mvAlgo);
+    cmd.Parse (argc, argv);
+
+// ===========================================================================================
+    /* Build Simulation Topology */
+    mvdashTopologyHelper topology;
+    topology.SetBottleneck (bwInit, "40ms");
+    topology.Build (nClients);
+
+    NodeContainer serverNodes (topology.GetServer ());
+    NodeContainer clientNodes = topology.GetClients ();
+
+// ===========================================================================================
+    /* Install Server and Cache Applications */
+    uint16_t serverPort = 9;
+    Address originAddress = InetSocketAddress(topology.GetServerAddress (), serverPort);
+    mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), 0);
+    ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+    serverApp.Start (Seconds (0.0));
+
+    Address serverAddress = originAddress;
+    Ptr<mvdashCacheServer> cache;
+    if (useCache) {
+        mvdashCacheServerHelper cacheHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), originAddress);
+        cacheHelper.SetAttribute ("CacheSize", UintegerValue (cacheSize));
+        cacheHelper.SetAttribute ("Policy", StringValue (policy));
+        ApplicationContainer cacheApp = cacheHelper.Install (topology.GetRouters ().Get (1));
+        cacheApp.Start (Seconds (0.0));
+        cache = DynamicCast<mvdashCacheServer> (cacheApp.Get (0));
+        serverAddress = InetSocketAddress(topology.GetBottleneckInterfaces ().GetAddress (1), serverPort);
+    }
+
+    /* Install DASH Clients at clientNodes */
+    mvdashClientHelper clientHelper (serverAddress, 0);
+    clientHelper.SetAttribute("SimId", UintegerValue(simId));
+    clientHelper.SetAttribute("VPInfo", StringValue(path+vpInfo));
+    clientHelper.SetAttribute("VPModel", StringValue(vpModel));
+    clientHelper.SetAttribute("MVInfo", StringValue(path+mvInfo));
+    clientHelper.SetAttribute("MVAlgo", StringValue(mvAlgo));
+    ApplicationContainer clientApps = clientHelper.Install (clientNodes);
+
+    for (int i=0; i < nClients; i++) {
+        clientApps.Get(i)->SetStartTime(Seconds(0.1+i*0.45));
+    }
+    clientApps.Stop(Seconds(simTime));
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Simulator::Stop (Seconds (simTime + 1.0));
+    Simulator::Run ();
+    if (cache) {
+        NS_LOG_UNCOND ("Cache (" << policy << ", " << cacheSize << " bytes): hits " << cache->GetNHits ()
+                       << " misses " << cache->GetNMisses ()
+                       << " coalesced " << cache->GetNCoalesced ()
+                       << " hit ratio " << cache->GetHitRatio ()
+                       << " origin offload " << cache->GetOriginOffload ());
+    }
+    Simulator::Destroy ();
+    return 0;
+}
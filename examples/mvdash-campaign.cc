@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash-campaign-helper.h"
+#include "ns3/mvdash_client.h"
+#include <fstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-campaign");
+
+struct st_scenarioConfig {
+    double   simTime;
+    uint32_t useHttp3;
+    uint32_t useDynamicBW;
+    int      nClients;
+    std::string bwInit;
+    std::string path;
+    std::string bwTrace;
+    std::string vpInfo;
+    std::string vpModel;
+    std::string mvInfo;
+    std::string mvAlgo;
+};
+
+// Service Function Declartions
+void RunScenario(const st_scenarioConfig &cfg, uint64_t run, mvdashCampaignHelper &campaign);
+void SetConfig();
+
+/*
+ * Monte Carlo campaign over the mvdash-v2 dumbbell scenario.
+ *
+ * The scenario is repeated with RngRun = firstRun, firstRun+1, ... until the
+ * confidence intervals on the mean main-view bitrate and on the rebuffer ratio
+ * are tight enough, or maxRuns is reached.
+ */
+int main(int argc, char *argv[]) {
+    LogComponentEnable ("mvdash-campaign", LOG_LEVEL_INFO);
+    LogComponentEnable ("mvdashCampaignHelper", LOG_LEVEL_INFO);
+    SetConfig();
+// ===========================================================================================
+    // Simulation Parameters & Variables for Command Line Arguments
+    st_scenarioConfig cfg = {100.0, 0, 0, 1, "5Mbps", "./contrib/etri_mvdash/",
+        "sbwtrace_5Mbps_max.csv", "viewpoint_transition.csv", "markovian",
+        "multiviewvideo.csv", "maximize_current"};
+    uint64_t firstRun = 1;
+    uint32_t minRuns = 5;
+    uint32_t maxRuns = 200;
+    double   confidence = 0.95;
+    double   relPrecision = 0.05;           // CI half width relative to the mean bitrate
+    double   rebufferPrecision = 0.005;     // CI half width of the rebuffer ratio (absolute)
+    std::string runLog = "campaign_runs.csv";
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH Monte Carlo QoE campaign.\n");
+    cmd.AddValue ("simTime", "The simulation Finish Time", cfg.simTime);
+    cmd.AddValue ("useHttp3", "[0 - HTTP2/TCP, 1 - HTTP3/QUIC] ", cfg.useHttp3);
+    cmd.AddValue ("useDynamicBW", "[0 - OFF, 1 - ON] ", cfg.useDynamicBW);
+    cmd.AddValue ("nClients", "Number of Clients", cfg.nClients);
+    cmd.AddValue ("bwInit", "The initial bandwidth for the bottleneck link", cfg.bwInit);
+    cmd.AddValue ("bwTrace", "The name of the file containing bandwidth Traces", cfg.bwTrace);
+    cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info", cfg.vpInfo);
+    cmd.AddValue ("vpModel", "[markovian, free]", cfg.vpModel);
+    cmd.AddValue ("mvInfo", "The name of the file containing Multi-View video source info", cfg.mvInfo);
+    cmd.AddValue ("mvAlgo", "[maximize_current, newone]", cfg.mvAlgo);
+    cmd.AddValue ("firstRun", "The RngRun number of the first run", firstRun);
+    cmd.AddValue ("minRuns", "Minimum number of runs before the stop criterion is checked", minRuns);
+    cmd.AddValue ("maxRuns", "Maximum number of runs", maxRuns);
+    cmd.AddValue ("confidence", "Confidence level of the intervals", confidence);
+    cmd.AddValue ("relPrecision", "Target CI half width relative to the mean", relPrecision);
+    cmd.AddValue ("rebufferPrecision", "Target absolute CI half width of the rebuffer ratio", rebufferPrecision);
+    cmd.AddValue ("runLog", "The name of the file receiving one row per run", runLog);
+    cmd.Parse (argc, argv);
+
+    mvdashCampaignHelper campaign;
+    campaign.SetMinRuns (minRuns);
+    campaign.SetMaxRuns (maxRuns);
+    campaign.SetConfidence (confidence);
+    campaign.SetPrecision (relPrecision, rebufferPrecision);
+
+    std::ofstream runLogFile ((cfg.path + runLog).c_str ());
+    runLogFile << "run\tbitrate\trebufferRatio\tstartupDelay\n";
+    campaign.SetRunLog (&runLogFile);
+
+    for (uint64_t run = firstRun; !campaign.IsDone (); run++) {
+        RunScenario (cfg, run, campaign);
+    }
+    runLogFile.close ();
+
+    campaign.Print (std::cout);
+    NS_LOG_INFO ("Done after " << campaign.GetRunCount () << " runs.");
+}
+
+void RunScenario(const st_scenarioConfig &cfg, uint64_t run, mvdashCampaignHelper &campaign) {
+    mvdashCampaignHelper::PrepareRun (run);
+
+// ===========================================================================================
+    /* Build Simulation Topology */
+    mvdashTopologyHelper topology;
+    topology.SetBottleneck (cfg.bwInit, "40ms");
+    topology.Build (cfg.nClients);
+
+    NodeContainer serverNodes (topology.GetServer ());
+    NodeContainer clientNodes = topology.GetClients ();
+
+    if (cfg.useDynamicBW)
+        topology.ReplayBottleneck(cfg.path+cfg.bwTrace, Seconds(cfg.simTime));
+
+// ===========================================================================================
+    /* Install Server Application */
+    uint16_t serverPort = 9;
+    Address serverAddress = InetSocketAddress(topology.GetServerAddress (), serverPort);
+    mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), cfg.useHttp3);
+    ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+    serverApp.Start (Seconds (0.0));
+
+    /* Install DASH Clients at clientNodes, the run number tags the log files */
+    mvdashClientHelper clientHelper (serverAddress, cfg.useHttp3);
+    clientHelper.SetAttribute("SimId", UintegerValue(run));
+    clientHelper.SetAttribute("VPInfo", StringValue(cfg.path+cfg.vpInfo));
+    clientHelper.SetAttribute("VPModel", StringValue(cfg.vpModel));
+    clientHelper.SetAttribute("MVInfo", StringValue(cfg.path+cfg.mvInfo));
+    clientHelper.SetAttribute("MVAlgo", StringValue(cfg.mvAlgo));
+    ApplicationContainer clientApps = clientHelper.Install (clientNodes);
+
+    for (int i=0; i < cfg.nClients; i++) {
+        clientApps.Get(i)->SetStartTime(Seconds(0.1+i*0.45));
+    }
+    clientApps.Stop(Seconds(cfg.simTime));
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Simulator::Stop (Seconds (cfg.simTime + 1.0));
+    Simulator::Run ();
+    campaign.AddRun (run, clientApps);
+    Simulator::Destroy ();
+}
+
+void SetConfig() {
+    uint32_t nBufSize = 600000;
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (nBufSize));
+}
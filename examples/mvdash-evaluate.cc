@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mvdash-trace-player.h"
+#include "ns3/mvdash_manifest.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-evaluate");
+
+/*
+ * Trace-driven evaluation of an adaptation algorithm, without a network run.
+ *
+ * Every bandwidth trace of bwTraces is played with nSeeds viewpoint seeds by
+ * ns3::mvdashPlayerEvaluator, the sessions spread over the cores.  The
+ * per-session QoE goes to output (stdout if empty) and the mean QoE of each
+ * trace to stdout.  Seed s draws the viewpoints of the client with ClientId
+ * s, so a promising result can be confirmed with the mvdash example.
+ *
+ *   ./waf --run "mvdash-evaluate --bwTraces=sbwtrace_5Mbps_min.csv,sbwtrace_5Mbps_max.csv --nSeeds=100"
+ */
+
+int main(int argc, char *argv[]) {
+    std::string path = "./contrib/etri_mvdash/";
+    std::string bwTraces = "sbwtrace_5Mbps_min.csv,sbwtrace_5Mbps_median.csv,sbwtrace_5Mbps_max.csv";
+    std::string bwFormat = "rate";
+    std::string bwInit = "5Mbps";
+    std::string vpModel = "markovian";
+    std::string vpInfo = "viewpoint_transition.csv";
+    std::string mvInfo = "multiviewvideo.csv";
+    std::string mvAlgo = "maximize_current";
+    std::string output = "";
+    uint32_t nSeeds = 10;
+    uint32_t nThreads = 0;
+    double   rtt = 20.0;
+    bool     loop = false;
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH: trace-driven evaluation of an adaptation algorithm.\n");
+    cmd.AddValue ("path", "The directory of the trace and video files", path);
+    cmd.AddValue ("bwTraces", "Comma separated bandwidth traces", bwTraces);
+    cmd.AddValue ("bwFormat", "The bandwidth trace format: rate or mahimahi", bwFormat);
+    cmd.AddValue ("bwInit", "The bandwidth before the first change of a trace", bwInit);
+    cmd.AddValue ("loop", "Restart the bandwidth traces after their last timestamp", loop);
+    cmd.AddValue ("vpModel", "The viewpoint switching model: markovian, free or trace", vpModel);
+    cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info, or a viewpoint trace", vpInfo);
+    cmd.AddValue ("mvInfo", "The name of the file containing Multi-View video source info", mvInfo);
+    cmd.AddValue ("mvAlgo", "The adaptation algorithm", mvAlgo);
+    cmd.AddValue ("nSeeds", "Viewpoint seeds per bandwidth trace", nSeeds);
+    cmd.AddValue ("threads", "Worker threads, 0 for one per core", nThreads);
+    cmd.AddValue ("rtt", "Round-trip time of a request in milliseconds", rtt);
+    cmd.AddValue ("output", "The file of the per-session QoE, stdout if empty", output);
+    cmd.Parse (argc, argv);
+
+    Ptr<mvdashPlayerEvaluator> evaluator = CreateObject<mvdashPlayerEvaluator> ();
+    evaluator->SetAttribute ("MVInfo", StringValue (path + mvInfo));
+    evaluator->SetAttribute ("VPInfo", StringValue (path + vpInfo));
+    evaluator->SetAttribute ("VPModel", StringValue (vpModel));
+    evaluator->SetAttribute ("MVAlgo", StringValue (mvAlgo));
+    evaluator->SetAttribute ("Format", StringValue (bwFormat));
+    evaluator->SetAttribute ("Loop", BooleanValue (loop));
+    evaluator->SetAttribute ("DataRate", DataRateValue (DataRate (bwInit)));
+    evaluator->SetAttribute ("Rtt", TimeValue (MilliSeconds (rtt)));
+    evaluator->SetAttribute ("Threads", UintegerValue (nThreads));
+
+    std::vector <std::string> traces;
+    std::istringstream list (bwTraces);
+    std::string trace;
+    while (std::getline (list, trace, ','))
+        traces.push_back (trace.empty () ? trace : path + trace);
+    evaluator->AddJobs (traces, nSeeds);
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now ();
+    if (!evaluator->Run ()) {
+        NS_LOG_ERROR ("Evaluation failed");
+        return 1;
+    }
+    double wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+
+    if (output.empty ()) {
+        evaluator->Write (std::cout);
+    }
+    else {
+        std::ofstream os (output.c_str ());
+        evaluator->Write (os);
+    }
+
+    // Mean QoE of each trace over its seeds
+    std::cout << "trace\tstartup_ms\tstalls\tstall_ms\tbitrate_kbps\tswitch_kbps\n";
+    for (size_t t = 0; t < traces.size (); t++) {
+        double startup = 0, stalls = 0, stallTime = 0, bitrate = 0, switches = 0;
+        for (uint32_t s = 0; s < nSeeds; s++) {
+            st_mvdashQoeSummary q = evaluator->GetSummary (t * nSeeds + s);
+            startup += q.startupDelay / 1000.0;
+            stalls += q.nStalls;
+            stallTime += q.stallTime / 1000.0;
+            bitrate += q.meanBitrate / 1000;
+            switches += q.meanSwitchMagnitude / 1000;
+        }
+        std::cout << traces[t] << "\t" << startup / nSeeds << "\t" << stalls / nSeeds << "\t"
+                  << stallTime / nSeeds << "\t" << bitrate / nSeeds << "\t" << switches / nSeeds << "\n";
+    }
+    std::cout << evaluator->GetNJobs () << " sessions in " << wallSeconds << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash-qoe-monitor.h"
+#include "ns3/mvdash_client.h"
+#include "ns3/mvdash_fluid_network.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-fluid");
+
+/*
+ * Population-scale runs with the fluid delivery model, and its calibration.
+ *
+ * The mvdash-v2 dumbbell (bottleneck of bwPerClient per client, 100 Mbps /
+ * 5 ms access links) is run with mvdashFluidNetwork delivering the segments.
+ * With calibrate=1 the same clients are first run at packet level; both runs
+ * draw the same viewpoint sequences (the streams follow the ClientId), so
+ * their per-client QoE is compared row by row, followed by the mean
+ * absolute error of each metric and the wall-clock speedup.  A systematic
+ * bias in download times is corrected with ns3::mvdashFluidNetwork::Efficiency.
+ */
+
+struct st_fluidConfig {
+    int      nClients;
+    double   simTime;
+    uint64_t bwPerClient;               // bottleneck bandwidth share per client in bps
+    double   startWindow;               // clients start uniformly within this window (seconds)
+    uint32_t useDynamicBW;
+    std::string path;
+    std::string bwTrace;
+    std::string vpInfo;
+    std::string mvInfo;
+};
+
+struct st_fluidRun {
+    std::vector <st_mvdashQoeSummary> qoe;   // by client
+    double   wallSeconds;
+    uint64_t events;
+};
+
+// Service Function Declartions
+st_fluidRun RunScenario(const st_fluidConfig &cfg, bool fluid);
+void SetConfig();
+
+int main(int argc, char *argv[]) {
+    SetConfig();
+    st_fluidConfig cfg = {10, 100.0, 0, 10.0, 0, "./contrib/etri_mvdash/",
+        "sbwtrace_5Mbps_max.csv", "viewpoint_transition.csv", "multiviewvideo.csv"};
+    std::string bwPerClient = "5Mbps";
+    bool calibrate = false;
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH with the fluid delivery model.\n");
+    cmd.AddValue ("nClients", "Number of Clients", cfg.nClients);
+    cmd.AddValue ("simTime", "The simulation Finish Time", cfg.simTime);
+    cmd.AddValue ("bwPerClient", "Bottleneck bandwidth per client", bwPerClient);
+    cmd.AddValue ("startWindow", "Clients start uniformly within this window (seconds)", cfg.startWindow);
+    cmd.AddValue ("useDynamicBW", "[0 - OFF, 1 - ON] scale bwTrace on the bottleneck", cfg.useDynamicBW);
+    cmd.AddValue ("bwTrace", "The name of the file containing bandwidth Traces", cfg.bwTrace);
+    cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info", cfg.vpInfo);
+    cmd.AddValue ("mvInfo", "The name of the file containing Multi-View video source info", cfg.mvInfo);
+    cmd.AddValue ("calibrate", "Run the packet-level model too and compare", calibrate);
+    cmd.Parse (argc, argv);
+    cfg.bwPerClient = DataRate (bwPerClient).GetBitRate ();
+
+    st_fluidRun packet;
+    if (calibrate)
+        packet = RunScenario (cfg, false);
+    st_fluidRun fluid = RunScenario (cfg, true);
+
+    std::cout << "fluid: " << cfg.nClients << " clients, " << fluid.events << " events, "
+              << fluid.wallSeconds << " s" << std::endl;
+    if (!calibrate)
+        return 0;
+
+    std::cout << "client\tstartup_ms\t\tstalls\t\tstall_ms\t\tbitrate_kbps\n"
+              << "\tpacket\tfluid\tpacket\tfluid\tpacket\tfluid\tpacket\tfluid\n";
+    double errStartup = 0, errStalls = 0, errStallTime = 0, errBitrate = 0;
+    for (int i = 0; i < cfg.nClients; i++) {
+        const st_mvdashQoeSummary &p = packet.qoe[i];
+        const st_mvdashQoeSummary &f = fluid.qoe[i];
+        std::cout << i << "\t" << p.startupDelay / 1000.0 << "\t" << f.startupDelay / 1000.0
+                  << "\t" << p.nStalls << "\t" << f.nStalls
+                  << "\t" << p.stallTime / 1000.0 << "\t" << f.stallTime / 1000.0
+                  << "\t" << p.meanBitrate / 1000 << "\t" << f.meanBitrate / 1000 << "\n";
+        errStartup += std::fabs (p.startupDelay - f.startupDelay) / 1000.0;
+        errStalls += std::fabs ((double) p.nStalls - f.nStalls);
+        errStallTime += std::fabs (p.stallTime - f.stallTime) / 1000.0;
+        errBitrate += std::fabs (p.meanBitrate - f.meanBitrate) / 1000;
+    }
+    std::cout << "mean absolute error: startup " << errStartup / cfg.nClients << " ms, stalls "
+              << errStalls / cfg.nClients << ", stall time " << errStallTime / cfg.nClients
+              << " ms, bitrate " << errBitrate / cfg.nClients << " kbps" << std::endl;
+    std::cout << "packet: " << packet.events << " events, " << packet.wallSeconds << " s; speedup "
+              << packet.wallSeconds / fluid.wallSeconds << std::endl;
+    return 0;
+}
+
+st_fluidRun RunScenario(const st_fluidConfig &cfg, bool fluid) {
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now ();
+
+    mvdashTopologyHelper topology;
+    topology.SetBottleneck (std::to_string (cfg.bwPerClient * cfg.nClients) + "bps", "40ms");
+    topology.SetServerLink (std::to_string (std::max (cfg.bwPerClient * cfg.nClients, (uint64_t) 100000000)) + "bps", "5ms");
+    topology.SetStaticRouting (true);
+    if (fluid)
+        topology.SetFluidNetwork (CreateObject<mvdashFluidNetwork> ());
+    topology.Build (cfg.nClients);
+    if (cfg.useDynamicBW)
+        topology.ReplayBottleneck (cfg.path+cfg.bwTrace, Seconds (cfg.simTime));
+
+    uint16_t serverPort = 9;
+    if (!fluid) {
+        mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), 0);
+        ApplicationContainer serverApp = serverHelper.Install (topology.GetServer ());
+        serverApp.Start (Seconds (0.0));
+    }
+
+    mvdashClientHelper clientHelper (InetSocketAddress(topology.GetServerAddress (), serverPort), 0);
+    clientHelper.SetAttribute("VPInfo", StringValue(cfg.path+cfg.vpInfo));
+    clientHelper.SetAttribute("VPModel", StringValue("markovian"));
+    clientHelper.SetAttribute("MVInfo", StringValue(cfg.path+cfg.mvInfo));
+    clientHelper.SetAttribute("EnableLogs", BooleanValue(false));
+    clientHelper.SetAttribute("FluidNetwork", PointerValue(topology.GetFluidNetwork ()));
+    clientHelper.SetStartTimes(Seconds(0.1), Seconds(cfg.startWindow / cfg.nClients));
+    ApplicationContainer clientApps = clientHelper.Install (topology.GetClients ());
+    clientApps.Stop(Seconds(cfg.simTime));
+
+    mvdashQoeMonitor qoeMonitor;
+    qoeMonitor.Install (clientApps);
+
+    Simulator::Stop (Seconds (cfg.simTime));
+    Simulator::Run ();
+
+    st_fluidRun run;
+    for (uint32_t i = 0; i < clientApps.GetN (); i++)
+        run.qoe.push_back (qoeMonitor.GetSummary (DynamicCast<mvdashClient> (clientApps.Get (i))));
+    run.events = Simulator::GetEventCount ();
+    Simulator::Destroy ();
+    run.wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    return run;
+}
+
+void SetConfig() {
+    uint32_t nBufSize = 600000;
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (nBufSize));
+}
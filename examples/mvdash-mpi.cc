@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mpi-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-bandwidth-trace.h"
+#include "ns3/mvdash-mpi-helper.h"
+#include "ns3/mvdash_client.h"
+
+/*
+ * Distributed version of the mvdash dumbbell.
+ *
+ *   server -- router0 ==bottleneck== router1 -- edge_0 -- clients of rank 0
+ *                                            \- edge_1 -- clients of rank 1
+ *                                             ...
+ *
+ * The server and both routers belong to rank 0.  Each rank owns one edge
+ * router and a contiguous block of clients.  The edge links are the only
+ * links between ranks; their delay is the lookahead.  The edge link delay
+ * plus the access link delay equals the 5 ms access delay of mvdash-v2.
+ *
+ *   mpirun -np 4 ./waf --run "mvdash-mpi --nClients=400"
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-mpi");
+
+int main(int argc, char *argv[]) {
+    mvdashMpiHelper::Enable (&argc, &argv);
+
+    uint32_t nBufSize = 600000;
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (nBufSize));
+
+// ===========================================================================================
+    // Simulation Parameters & Variables for Command Line Arguments
+    uint32_t simId=0;
+    double   simTime=100.0;
+    uint32_t useDynamicBW=0;
+    uint32_t nClients = 8;
+    bool     mergeLogs = true;
+
+    std::string bwInit = "5Mbps";
+    std::string edgeDelay = "4ms";
+    std::string path = "./contrib/etri_mvdash/";
+    std::string bwTrace = "sbwtrace_5Mbps_max.csv";
+    std::string vpInfo = "viewpoint_transition.csv";
+    std::string vpModel = "markovian";
+    std::string mvInfo = "multiviewvideo.csv";
+    std::string mvAlgo = "maximize_current";
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH Streaming Simulation, distributed over MPI ranks.\n");
+    cmd.AddValue ("simId", "The simulation's index (for logging purposes)", simId);
+    cmd.AddValue ("simTime", "The simulation Finish Time", simTime);
+    cmd.AddValue ("useDynamicBW", "[0 - OFF, 1 - ON] ",useDynamicBW);
+    cmd.AddValue ("nClients", "Total number of Clients over all ranks", nClients);
+    cmd.AddValue ("mergeLogs", "Merge the per-client logs into one file per log type", mergeLogs);
+    cmd.AddValue ("bwInit", "The initial bandwidth for the bottleneck link", bwInit);
+    cmd.AddValue ("edgeDelay", "The delay of the links between ranks (the lookahead)", edgeDelay);
+    cmd.AddValue ("bwTrace", "The name of the file containing bandwidth Traces",bwTrace);
+    cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info",vpInfo);
+    cmd.AddValue ("vpModel", "[markovian, free]", vpModel);
+    cmd.AddValue ("mvInfo", "The name of the file containing Multi-View video source info",mvInfo);
+    cmd.AddValue ("mvAlgo", "[maximize_current, newone]", mvAlgo);
+    cmd.Parse (argc, argv);
+
+    NS_ABORT_MSG_IF (Time (edgeDelay) <= Seconds (0) || Time (edgeDelay) >= MilliSeconds (5),
+                     "edgeDelay must be between 0 and 5ms");
+    mvdashMpiHelper mpi (nClients);
+    uint32_t nRanks = mpi.GetSystemCount ();
+    bool isRoot = (mpi.GetSystemId () == 0);
+
+// ===========================================================================================
+    /* Build Simulation Topology, identically on every rank */
+    NodeContainer routerNodes, serverNodes, edgeNodes, clientNodes;
+    routerNodes.Create (2, 0);
+    serverNodes.Create (1, 0);
+    for (uint32_t rank = 0; rank < nRanks; rank++)
+        edgeNodes.Add (CreateObject<Node> (rank));
+    clientNodes = mpi.CreateClientNodes ();
+
+    PointToPointHelper routerLink, serverLink, edgeLinks, clientLinks;
+    routerLink.SetDeviceAttribute ("DataRate", StringValue (bwInit));
+    routerLink.SetChannelAttribute ("Delay", StringValue ("40ms"));
+    serverLink.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+    serverLink.SetChannelAttribute ("Delay", StringValue ("5ms"));
+    edgeLinks.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+    edgeLinks.SetChannelAttribute ("Delay", StringValue (edgeDelay));
+    clientLinks.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+    clientLinks.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (5) - Time (edgeDelay)));
+
+    NetDeviceContainer routerDevices, serverDevices;
+    std::vector <NetDeviceContainer> edgeDevices(nRanks);
+    std::vector <NetDeviceContainer> clientDevices(nClients);
+
+    routerDevices = routerLink.Install(routerNodes.Get(0), routerNodes.Get(1));
+    serverDevices = serverLink.Install(serverNodes.Get(0), routerNodes.Get(0));
+    for (uint32_t rank = 0; rank < nRanks; rank++) {
+        edgeDevices[rank] = edgeLinks.Install(routerNodes.Get(1), edgeNodes.Get(rank));
+    }
+    for (uint32_t i = 0; i < nClients; i++) {
+        Ptr<Node> edge = edgeNodes.Get(mpi.GetClientRank(i));
+        clientDevices[i] = clientLinks.Install(edge, clientNodes.Get(i));
+    }
+
+    InternetStackHelper stack;
+    stack.Install (routerNodes);
+    stack.Install (serverNodes);
+    stack.Install (edgeNodes);
+    stack.Install (clientNodes);
+
+    /* Assign IP addresses */
+    Ipv4AddressHelper address;
+    address.SetBase ("10.1.1.0", "255.255.255.0");
+    address.Assign (routerDevices);
+    address.SetBase ("10.1.2.0", "255.255.255.0");
+    Ipv4InterfaceContainer serverInterfaces = address.Assign (serverDevices);
+    address.SetBase ("10.3.0.0", "255.255.255.252");
+    for (uint32_t rank = 0; rank < nRanks; rank++) {
+        address.Assign (edgeDevices[rank]);
+        address.NewNetwork();
+    }
+    address.SetBase ("10.2.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < nClients; i++) {
+        address.Assign (clientDevices[i]);
+        address.NewNetwork();
+    }
+
+// ===========================================================================================
+    /* Handling Dynamic Bandwidth, on the rank that owns the bottleneck */
+    if (useDynamicBW && isRoot)
+        mvdashBandwidthTrace::Replay(path+bwTrace, routerDevices.Get(0), Seconds(simTime));
+
+// ===========================================================================================
+    /* Install Server Application */
+    uint16_t serverPort = 9;
+    Address serverAddress = InetSocketAddress(serverInterfaces.GetAddress (0), serverPort);
+    if (isRoot) {
+        mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), 0);
+        ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+        serverApp.Start (Seconds (0.0));
+    }
+
+    /* Install the DASH Clients owned by this rank */
+    mvdashClientHelper clientHelper (serverAddress, 0);
+    clientHelper.SetAttribute("SimId", UintegerValue(simId));
+    clientHelper.SetAttribute("VPInfo", StringValue(path+vpInfo));
+    clientHelper.SetAttribute("VPModel", StringValue(vpModel));
+    clientHelper.SetAttribute("MVInfo", StringValue(path+mvInfo));
+    clientHelper.SetAttribute("MVAlgo", StringValue(mvAlgo));
+    ApplicationContainer clientApps = mpi.InstallClients (clientHelper, clientNodes);
+
+    uint32_t firstClient = mpi.GetFirstClient (mpi.GetSystemId ());
+    for (uint32_t i=0; i < clientApps.GetN (); i++) {
+        clientApps.Get(i)->SetStartTime(Seconds(0.1+(firstClient+i)*0.45));
+    }
+    clientApps.Stop(Seconds(simTime));
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Simulator::Stop (Seconds (simTime + 1.0));
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    if (mergeLogs)
+        mpi.MergeClientLogs (path, simId, true);
+    mvdashMpiHelper::Disable ();
+    if (isRoot)
+        NS_LOG_UNCOND ("Done: " << nClients << " clients on " << nRanks << " ranks");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash_client.h"
+
+/*
+ * mvdash-v2 dumbbell where the server also multicasts the popular viewpoints.
+ *
+ *   server -- router0 ==bottleneck== router1 -- clients
+ *
+ * Static multicast routes carry the group from the server through both
+ * routers to every client link, so each multicast segment crosses the
+ * bottleneck once.  The clients take those viewpoints from the group and
+ * fetch the rest (and any higher main-view quality) over unicast.  The
+ * bytes sent into the bottleneck are printed at the end; run with
+ * useMulticast=0 for the unicast baseline.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("mvdash-multicast");
+
+static uint64_t g_bottleneckBytes = 0;
+
+static void BottleneckTx (Ptr<const Packet> p) {
+    g_bottleneckBytes += p->GetSize ();
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t nBufSize = 600000;
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (nBufSize));
+
+// ===========================================================================================
+    // Simulation Parameters & Variables for Command Line Arguments
+    uint32_t simId=0;
+    double   simTime=100.0;
+    int      nClients = 10;
+    bool     useMulticast = true;
+    std::string mcastViewpoints = "0,1";
+    uint32_t mcastQuality = 1;
+
+    std::string bwInit = "20Mbps";
+    std::string path = "./contrib/etri_mvdash/";
+    std::string vpInfo = "viewpoint_transition.csv";
+    std::string vpModel = "markovian";
+    std::string mvInfo = "multiviewvideo.csv";
+    std::string mvAlgo = "maximize_current";
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH Streaming Simulation with multicast of popular viewpoints.\n");
+    cmd.AddValue ("simId", "The simulation's index (for logging purposes)", simId);
+    cmd.AddValue ("simTime", "The simulation Finish Time", simTime);
+    cmd.AddValue ("nClients", "Number of Clients", nClients);
+    cmd.AddValue ("useMulticast", "Multicast the mcastViewpoints to all the clients", useMulticast);
+    cmd.AddValue ("mcastViewpoints", "Comma separated viewpoints to multicast", mcastViewpoints);
+    cmd.AddValue ("mcastQuality", "The quality index of the multicast viewpoints", mcastQuality);
+    cmd.AddValue ("bwInit", "The bandwidth of the bottleneck link", bwInit);
+    cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info",vpInfo);
+    cmd.AddValue ("vpModel", "[markovian, free]", vpModel);
+    cmd.AddValue ("mvInfo", "The name of the file containing Multi-View video source info",mvInfo);
+    cmd.AddValue ("mvAlgo", "[maximize_current, newone]", mvAlgo);
+    cmd.Parse (argc, argv);
+
+// ===========================================================================================
+    /* Build Simulation Topology */
+    mvdashTopologyHelper topology;
+    topology.SetBottleneck (bwInit, "40ms");
+    topology.Build (nClients);
+
+    NodeContainer serverNodes (topology.GetServer ());
+    NodeContainer clientNodes = topology.GetClients ();
+    NodeContainer routerNodes = topology.GetRouters ();
+    NetDeviceContainer routerDevices = topology.GetBottleneckDevices ();
+    NetDeviceContainer serverDevices = topology.GetServerDevices ();
+
+// ===========================================================================================
+    /* Static multicast routes: server -> router0 -> router1 -> every client link */
+    Ipv4Address mcastGroup ("225.1.2.4");
+    uint16_t mcastPort = 5000;
+    if (useMulticast) {
+        Ipv4StaticRoutingHelper multicast;
+        Ipv4Address source = topology.GetServerAddress ();
+        multicast.SetDefaultMulticastRoute (serverNodes.Get (0), serverDevices.Get (0));
+        multicast.AddMulticastRoute (routerNodes.Get (0), source, mcastGroup,
+                                     serverDevices.Get (1), NetDeviceContainer (routerDevices.Get (0)));
+        NetDeviceContainer clientSide;
+        for (int i=0; i < nClients; i++)
+            clientSide.Add (topology.GetAccessLink (i).devices.Get (0));
+        multicast.AddMulticastRoute (routerNodes.Get (1), source, mcastGroup,
+                                     routerDevices.Get (1), clientSide);
+    }
+
+// ===========================================================================================
+    /* Install Server Application */
+    uint16_t serverPort = 9;
+    Address serverAddress = InetSocketAddress(topology.GetServerAddress (), serverPort);
+    mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), 0);
+    if (useMulticast) {
+        serverHelper.SetAttribute ("MVInfo", StringValue (path+mvInfo));
+        serverHelper.SetAttribute ("MulticastGroup", AddressValue (InetSocketAddress (mcastGroup, mcastPort)));
+        serverHelper.SetAttribute ("MulticastViewpoints", StringValue (mcastViewpoints));
+        serverHelper.SetAttribute ("MulticastQuality", UintegerValue (mcastQuality));
+    }
+    ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+    serverApp.Start (Seconds (0.0));
+
+    /* Install DASH Clients at clientNodes */
+    mvdashClientHelper clientHelper (serverAddress, 0);
+    clientHelper.SetAttribute("SimId", UintegerValue(simId));
+    clientHelper.SetAttribute("VPInfo", StringValue(path+vpInfo));
+    clientHelper.SetAttribute("VPModel", StringValue(vpModel));
+    clientHelper.SetAttribute("MVInfo", StringValue(path+mvInfo));
+    clientHelper.SetAttribute("MVAlgo", StringValue(mvAlgo));
+    if (useMulticast) {
+        clientHelper.SetAttribute ("MulticastGroup", AddressValue (InetSocketAddress (mcastGroup, mcastPort)));
+        clientHelper.SetAttribute ("MulticastViewpoints", StringValue (mcastViewpoints));
+        clientHelper.SetAttribute ("MulticastQuality", UintegerValue (mcastQuality));
+    }
+    ApplicationContainer clientApps = clientHelper.Install (clientNodes);
+
+    for (int i=0; i < nClients; i++) {
+        clientApps.Get(i)->SetStartTime(Seconds(0.1+i*0.45));
+    }
+    clientApps.Stop(Seconds(simTime));
+
+    routerDevices.Get (0)->TraceConnectWithoutContext ("PhyTxEnd", MakeCallback (&BottleneckTx));
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Simulator::Stop (Seconds (simTime + 1.0));
+    Simulator::Run ();
+
+    uint64_t repairs = 0;
+    for (int i=0; i < nClients; i++)
+        repairs += DynamicCast<mvdashClient> (clientApps.Get (i))->GetMulticastRepairs ();
+    NS_LOG_UNCOND ((useMulticast ? "multicast" : "unicast") << ": " << nClients << " clients, "
+                   << g_bottleneckBytes << " bytes into the bottleneck, "
+                   << repairs << " multicast segments repaired over unicast");
+    Simulator::Destroy ();
+    return 0;
+}
@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/mvdash-event-recorder.h"
+#include <iostream>
+#include <fstream>
+
+using namespace ns3;
+
+/*
+ * Decoder of mvdashEventRecorder files: writes one tab separated line per
+ * record, in file order (records of a client are in order; use the seq
+ * column, or sort on time_ns, to interleave clients).
+ */
+int main(int argc, char *argv[]) {
+    std::string input = "";
+    std::string output = "";
+
+    CommandLine cmd;
+    cmd.Usage ("Decode a binary mvdash event record file.\n");
+    cmd.AddValue ("input", "The record file written by mvdashEventRecorder", input);
+    cmd.AddValue ("output", "The text file to write; stdout if empty", output);
+    cmd.Parse (argc, argv);
+
+    std::ofstream outFile;
+    if (!output.empty ())
+        outFile.open (output.c_str ());
+
+    int64_t nRecords = mvdashEventRecorder::Decode (input, output.empty () ? std::cout : outFile);
+    if (nRecords < 0) {
+        std::cerr << input << " is not an mvdash event record file" << std::endl;
+        return 1;
+    }
+    std::cerr << nRecords << " records" << std::endl;
+    return 0;
+}
@@ -23,6 +23,10 @@
 #include "ns3/point-to-point-helper.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash-qoe-monitor.h"
+#include <fstream>
+#include <sstream>
 #include "ns3/mvdash_client.h"
 
 using namespace ns3;
@@ -35,7 +39,6 @@ void RxHandler (Ptr<const mvdashClient> c, Ptr<const Packet> p);
 void RequestTraceHandler(Ptr<const mvdashClient> client, requestEvent ev, int32_t id);
 void SegmentTraceHandler(Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
 void ControllerTraceHandler(Ptr<const mvdashClient> client, controllerState state, controllerTraceEvent ev, int32_t tid);
-int  InitDynamicBandwidth(std::string bwTraceFile, Ptr<NetDevice> dev, uint64_t simTime);
 void SetLogLevel(LogLevel log_precision);
 void SetConfig();
 
@@ -49,6 +52,26 @@ int main(int argc, char *argv[]) {
     uint32_t useHttp3=0;                // 0 - HTTP2/TCP, 1 - HTTP3/QUIC
     uint32_t useDynamicBW=0;            // 0 - Dynamic Bandwidth Off, 1 - Dynamic Bandwidth On
     int nClients = 1;
+    uint32_t nConnections=1;            // TCP connections per client
+    std::string connPolicy = "viewpoint";
+    std::string sideViewCc = "";        // e.g. ns3::TcpLedbat for a scavenger side-view connection
+    double   lossRate=0.0;              // Packet loss rate on the bottleneck link, towards the clients
+    std::string accessTraces = "";      // Comma separated bandwidth traces the access links pick from
+    double   accessDelayMax=5.0;        // Access link delays are uniform in [5, accessDelayMax] ms
+    double   accessLossMax=0.0;         // Access link loss rates are uniform in [0, accessLossMax]
+    std::string accessType = "p2p";     // p2p - one link per client, csma - shared LANs of lanSize clients
+    uint32_t lanSize=250;
+    bool     staticRouting=false;       // Routes set by the topology helper instead of global routing
+    bool     fluid=false;               // Fluid delivery model instead of packet-level TCP
+    std::string bufferMode = "group";   // group - one buffer, viewpoint - one buffer and pipeline per viewpoint
+    double   mainBuffer=30.0;           // Buffer target of the main view in seconds, viewpoint mode
+    double   sideBuffer=4.0;            // Buffer target of the side views in seconds, viewpoint mode
+    uint32_t tileColumns=0;             // Equal tiles per viewpoint, 0 for whole viewpoints
+    uint32_t tileRows=1;
+    uint32_t outQuality=0;              // Highest quality of the tiles out of the viewport
+    bool     layered=false;             // Base and enhancement layers made of the rates
+    uint32_t pushDepth=0;               // Main view segments pushed after each request, viewpoint mode
+    double   switchDuration=0.0;        // Switch segments in seconds to bridge a viewpoint switch, 0 for none
 
     std::string bwInit = "5Mbps";
     std::string path = "./contrib/etri_mvdash/";
@@ -65,6 +88,26 @@ int main(int argc, char *argv[]) {
     cmd.AddValue ("useHttp3", "[0 - HTTP2/TCP, 1 - HTTP3/QUIC] ",useHttp3);
     cmd.AddValue ("useDynamicBW", "[0 - OFF, 1 - ON] ",useDynamicBW);
     cmd.AddValue ("nClients", "Number of Clients", nClients);
+    cmd.AddValue ("nConnections", "TCP connections per client", nConnections);
+    cmd.AddValue ("connPolicy", "[viewpoint, least-loaded] request spreading over the connections", connPolicy);
+    cmd.AddValue ("sideViewCc", "Congestion control of a separate side-view connection, e.g. ns3::TcpLedbat, with bufferMode=viewpoint", sideViewCc);
+    cmd.AddValue ("lossRate", "Packet loss rate on the bottleneck link, towards the clients", lossRate);
+    cmd.AddValue ("accessTraces", "Comma separated bandwidth traces, one picked per client access link", accessTraces);
+    cmd.AddValue ("accessDelayMax", "Access link delays are drawn uniformly in [5, accessDelayMax] ms", accessDelayMax);
+    cmd.AddValue ("accessLossMax", "Access link loss rates are drawn uniformly in [0, accessLossMax]", accessLossMax);
+    cmd.AddValue ("accessType", "[p2p, csma] one access link per client or shared LANs", accessType);
+    cmd.AddValue ("lanSize", "Clients per LAN with accessType=csma", lanSize);
+    cmd.AddValue ("staticRouting", "Let the topology helper set the routes instead of global routing", staticRouting);
+    cmd.AddValue ("fluid", "Deliver the segments with the fluid model instead of packet-level TCP", fluid);
+    cmd.AddValue ("bufferMode", "[group, viewpoint] one buffer, or one buffer and pipeline per viewpoint", bufferMode);
+    cmd.AddValue ("mainBuffer", "Buffer target of the main view in seconds, with bufferMode=viewpoint", mainBuffer);
+    cmd.AddValue ("sideBuffer", "Buffer target of the side views in seconds, with bufferMode=viewpoint", sideBuffer);
+    cmd.AddValue ("tileColumns", "Tile columns of every viewpoint, 0 for whole viewpoints", tileColumns);
+    cmd.AddValue ("tileRows", "Tile rows of every viewpoint, with tileColumns", tileRows);
+    cmd.AddValue ("outQuality", "Highest quality of the tiles out of the viewport", outQuality);
+    cmd.AddValue ("layered", "Download the rates as a base layer and enhancement layers", layered);
+    cmd.AddValue ("pushDepth", "Main view segments the server pushes after each request, with bufferMode=viewpoint", pushDepth);
+    cmd.AddValue ("switchDuration", "Switch segments in seconds bridging a viewpoint switch, with bufferMode=viewpoint", switchDuration);
     cmd.AddValue ("bwInit", "The initial bandwidth for the bottleneck link", bwInit);
     cmd.AddValue ("bwTrace", "The name of the file containing bandwidth Traces",bwTrace);
     cmd.AddValue ("vpInfo", "The name of the file containing viewpoint switching info",vpInfo);
@@ -75,57 +118,64 @@ int main(int argc, char *argv[]) {
 
 // ===========================================================================================
     /* Build Simulation Topology */
-    NodeContainer routerNodes, serverNodes, clientNodes;
-    routerNodes.Create (2);
-    serverNodes.Create (1);
-    clientNodes.Create (nClients);
-
-    PointToPointHelper routerLink, serverLink, clientLinks;
-    routerLink.SetDeviceAttribute ("DataRate", StringValue (bwInit));
-    routerLink.SetChannelAttribute ("Delay", StringValue ("40ms"));
-    serverLink.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-    serverLink.SetChannelAttribute ("Delay", StringValue ("5ms"));
-    clientLinks.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-    clientLinks.SetChannelAttribute ("Delay", StringValue ("5ms"));
-
-    NetDeviceContainer routerDevices, serverDevices;
-    std::vector <NetDeviceContainer> clientDevices(nClients);
-    
-    routerDevices = routerLink.Install(routerNodes.Get(0), routerNodes.Get(1));
-    serverDevices = serverLink.Install(serverNodes.Get(0), routerNodes.Get(0));
-    for (int i=0; i < nClients; i++) {
-        clientDevices[i] = clientLinks.Install(routerNodes.Get(1), clientNodes.Get(i));
+    mvdashTopologyHelper topology;
+    topology.SetBottleneck (bwInit, "40ms");
+    topology.SetAccessType (accessType, lanSize);
+    topology.SetStaticRouting (staticRouting);
+    if (fluid)
+        topology.SetFluidNetwork (CreateObject<mvdashFluidNetwork> ());
+    std::stringstream traces (accessTraces);
+    for (std::string trace; std::getline (traces, trace, ',');) {
+        if (!trace.empty ())
+            topology.AddAccessTrace (path+trace);
+    }
+    topology.SetTraceAttribute ("Loop", BooleanValue (true));
+    topology.SetTraceAttribute ("StopTime", TimeValue (Seconds (simTime)));
+    if (accessDelayMax > 5) {
+        Ptr<UniformRandomVariable> delay = CreateObject<UniformRandomVariable> ();
+        delay->SetAttribute ("Min", DoubleValue (5));
+        delay->SetAttribute ("Max", DoubleValue (accessDelayMax));
+        topology.SetAccessDelay (delay);
     }
+    if (accessLossMax > 0) {
+        Ptr<UniformRandomVariable> loss = CreateObject<UniformRandomVariable> ();
+        loss->SetAttribute ("Max", DoubleValue (accessLossMax));
+        topology.SetAccessLoss (loss);
+    }
+    // Every random variable takes its streams from one running counter
+    int64_t stream = 0;
+    stream += topology.AssignStreams (stream);
+    topology.Build (nClients);
+    stream += topology.AssignLossStreams (stream);
 
-    InternetStackHelper stack;
-    stack.Install (routerNodes);
-    stack.Install (serverNodes);
-    stack.Install (clientNodes);
+    NodeContainer serverNodes (topology.GetServer ());
+    NodeContainer clientNodes = topology.GetClients ();
+    NetDeviceContainer routerDevices = topology.GetBottleneckDevices ();
 
-    /* Assign IP addresses */
-    Ipv4AddressHelper address;
-    address.SetBase ("10.1.1.0", "255.255.255.0");
-    address.Assign (routerDevices);
-    address.SetBase ("10.1.2.0", "255.255.255.0");
-    Ipv4InterfaceContainer serverInterfaces = address.Assign (serverDevices);
-    address.SetBase ("10.1.3.0", "255.255.255.0");
-    for (int i=0; i < nClients; i++) {
-        address.Assign (clientDevices[i]);
-        address.NewNetwork();
+    if (lossRate > 0 && !fluid) {
+        Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+        em->SetAttribute ("ErrorRate", DoubleValue (lossRate));
+        em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+        routerDevices.Get(1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+        stream += em->AssignStreams (stream);
     }
 
 // ===========================================================================================
     /* Handling Dynamic Bandwidth */
     if (useDynamicBW)
-        InitDynamicBandwidth(path+bwTrace, routerDevices.Get(0),(uint64_t)(1000000*simTime));
+        topology.ReplayBottleneck(path+bwTrace, Seconds(simTime));
 
 // ===========================================================================================
     /* Install Server Application */
     uint16_t serverPort = 9;
-    Address serverAddress = InetSocketAddress(serverInterfaces.GetAddress (0), serverPort);
+    Address serverAddress = InetSocketAddress(topology.GetServerAddress (), serverPort);
     mvdashServerHelper serverHelper (InetSocketAddress(Ipv4Address::GetAny (), serverPort), useHttp3);
-    ApplicationContainer serverApp = serverHelper.Install (serverNodes);
-    serverApp.Start (Seconds (0.0));
+    serverHelper.SetAttribute("MVInfo", StringValue(path+mvInfo));
+    serverHelper.SetAttribute("Push", BooleanValue(pushDepth > 0));
+    if (!fluid) {
+        ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+        serverApp.Start (Seconds (0.0));
+    }
 
     /* Install DASH Clients at clientNodes */
     mvdashClientHelper clientHelper (serverAddress, useHttp3);
@@ -134,11 +184,25 @@ int main(int argc, char *argv[]) {
     clientHelper.SetAttribute("VPModel", StringValue(vpModel));
     clientHelper.SetAttribute("MVInfo", StringValue(path+mvInfo));
     clientHelper.SetAttribute("MVAlgo", StringValue(mvAlgo));
+    clientHelper.SetAttribute("Connections", UintegerValue(nConnections));
+    clientHelper.SetAttribute("ConnectionPolicy", StringValue(connPolicy));
+    clientHelper.SetAttribute("SideViewCongestionControl", StringValue(sideViewCc));
+    clientHelper.SetAttribute("FluidNetwork", PointerValue(topology.GetFluidNetwork()));
+    clientHelper.SetAttribute("BufferMode", StringValue(bufferMode));
+    clientHelper.SetAttribute("MainBufferTarget", TimeValue(Seconds(mainBuffer)));
+    clientHelper.SetAttribute("SideBufferTarget", TimeValue(Seconds(sideBuffer)));
+    clientHelper.SetAttribute("TileColumns", UintegerValue(tileColumns));
+    clientHelper.SetAttribute("TileRows", UintegerValue(tileRows));
+    clientHelper.SetAttribute("OutOfViewportQuality", UintegerValue(outQuality));
+    clientHelper.SetAttribute("Layered", BooleanValue(layered));
+    clientHelper.SetAttribute("PushDepth", UintegerValue(pushDepth));
+    clientHelper.SetAttribute("SwitchDuration", TimeValue(Seconds(switchDuration)));
+    clientHelper.SetStartTimes(Seconds(0.1), Seconds(0.45));
+    stream += clientHelper.AssignStreams(stream, nClients);
 //    ApplicationContainer clientApps = clientHelper.Install (clientNodes, mvAlgo);
     ApplicationContainer clientApps = clientHelper.Install (clientNodes);
 
     for (int i=0; i < nClients; i++) {
-        clientApps.Get(i)->SetStartTime(Seconds(0.1+i*0.45));
         Ptr<mvdashClient> mvclient = DynamicCast<mvdashClient> (clientApps.Get (i));
         mvclient->TraceConnectWithoutContext ("ControllerTrace", MakeCallback (&ControllerTraceHandler));    
     //    mvclient->TraceConnectWithoutContext ("RequestTrace", MakeCallback (&RequestTraceHandler));
@@ -149,9 +213,19 @@ int main(int argc, char *argv[]) {
 
     clientApps.Stop(Seconds(simTime));
 
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    mvdashQoeMonitor qoeMonitor;
+    qoeMonitor.Install (clientApps);
+
+    if (!staticRouting && !fluid)
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
     Simulator::Run ();
+
+    // One row per client, e.g. to compare the stalls of useHttp3=0 and useHttp3=1 under lossRate
+    std::ofstream qoeLog ((path + "qoe_sim" + std::to_string (simId) + ".csv").c_str ());
+    qoeMonitor.Write (qoeLog);
+    std::ofstream accessLog ((path + "access_sim" + std::to_string (simId) + ".csv").c_str ());
+    topology.WriteAccessLinks (accessLog);
     Simulator::Destroy ();
     NS_LOG_INFO ("Done."); 
 }
@@ -239,34 +313,3 @@ void ControllerTraceHandler(Ptr<const mvdashClient> client, controllerState stat
     };
     NS_LOG_INFO(Simulator::Now ().As (Time::S) << state_names[state] << str << tid);
 }
-
-
-static void bwevent_handler(Ptr<NetDevice> dev, uint64_t bps) {
-  Ptr<PointToPointNetDevice> mdev = DynamicCast<PointToPointNetDevice>(dev);
-  mdev->SetDataRate(DataRate(bps));
-}
-
-int InitDynamicBandwidth(std::string bwTraceFile, Ptr<NetDevice> dev, uint64_t simTime) {
-    NS_LOG_UNCOND("Dynamic Bandwidth Enabled");  
-    std::ifstream myfile;
-    myfile.open (bwTraceFile.c_str ());
-    if (!myfile)    {
-        NS_LOG_ERROR("Dynamic Bandwidth Trace File Open Error");
-        return -1;
-    }
-
-    std::string temp;
-    uint64_t time_change;
-    uint64_t bps;
-    while (std::getline (myfile, temp)) {
-        if (temp.empty ()) break;
-        std::stringstream buffer (temp);
-        buffer >> time_change;
-        buffer >> bps;
-        if (time_change > simTime)
-            break; 
-        //NS_LOG_INFO("Time " << (double)(time_change/1000000.0) << " BPS " << bps);
-        Simulator::Schedule(MicroSeconds(time_change), &bwevent_handler, dev, bps);
-    }
-    return 1;
-}
\ No newline at end of file
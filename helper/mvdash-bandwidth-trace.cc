@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-bandwidth-trace.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/point-to-point-net-device.h"
+#include <algorithm>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashBandwidthTrace");
+
+NS_OBJECT_ENSURE_REGISTERED (mvdashBandwidthTrace);
+
+TypeId
+mvdashBandwidthTrace::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::mvdashBandwidthTrace")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<mvdashBandwidthTrace> ()
+    .AddAttribute ("Format",
+                   "The trace format: rate (microseconds and bits per second) or mahimahi (delivery opportunities in milliseconds)",
+                   StringValue ("rate"),
+                   MakeStringAccessor (&mvdashBandwidthTrace::m_formatName),
+                   MakeStringChecker ())
+    .AddAttribute ("Loop",
+                   "Restart the trace after its last rate held as long as the one before, or after the last mahimahi opportunity",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&mvdashBandwidthTrace::m_loop),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimeScale",
+                   "Factor applied to every trace timestamp",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&mvdashBandwidthTrace::m_timeScale),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MahimahiWindow",
+                   "The window over which mahimahi delivery opportunities are counted",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&mvdashBandwidthTrace::m_window),
+                   MakeTimeChecker ())
+    .AddAttribute ("PacketSize",
+                   "Bytes per mahimahi delivery opportunity",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&mvdashBandwidthTrace::m_packetSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StopTime",
+                   "No change is scheduled after this time; zero replays the whole trace",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&mvdashBandwidthTrace::m_stopTime),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+mvdashBandwidthTrace::mvdashBandwidthTrace ()
+  : m_mahimahi (false),
+    m_loopOffset (0),
+    m_lastTime (0),
+    m_lastInterval (0),
+    m_linesInPass (false),
+    m_windowStart (0),
+    m_nextOpportunity (-1),
+    m_nChanges (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+mvdashBandwidthTrace::~mvdashBandwidthTrace ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+mvdashBandwidthTrace::DoDispose (void)
+{
+  m_device = 0;
+  m_setRate = MakeNullCallback<void, uint64_t> ();
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  Object::DoDispose ();
+}
+
+bool
+mvdashBandwidthTrace::Install (std::string path, Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << path);
+  m_device = DynamicCast<PointToPointNetDevice> (device);
+  NS_ABORT_MSG_IF (!m_device, "mvdashBandwidthTrace drives PointToPointNetDevice only");
+  return Open (path);
+}
+
+bool
+mvdashBandwidthTrace::Install (std::string path, Callback<void, uint64_t> setRate)
+{
+  NS_LOG_FUNCTION (this << path);
+  m_setRate = setRate;
+  return Open (path);
+}
+
+bool
+mvdashBandwidthTrace::Load (std::string path, Time until, std::vector< std::pair<int64_t, uint64_t> > &changes)
+{
+  NS_LOG_FUNCTION (this << path << until);
+  changes.clear ();
+  if (!OpenFile (path))
+    {
+      return false;
+    }
+  int64_t time;
+  uint64_t bps;
+  while (NextChange (time, bps))
+    {
+      time = (int64_t) (time * m_timeScale);
+      if (time > until.GetMicroSeconds ())
+        {
+          break;
+        }
+      if (bps > 0)
+        {
+          changes.push_back (std::make_pair (time, bps));
+        }
+      m_nChanges++;
+    }
+  m_file.close ();
+  return true;
+}
+
+bool
+mvdashBandwidthTrace::Open (std::string path)
+{
+  if (!OpenFile (path))
+    {
+      return false;
+    }
+  ScheduleNext ();
+  return true;
+}
+
+bool
+mvdashBandwidthTrace::OpenFile (std::string path)
+{
+  NS_ABORT_MSG_IF (m_formatName != "rate" && m_formatName != "mahimahi", "Unknown bandwidth trace format " << m_formatName);
+  m_mahimahi = (m_formatName == "mahimahi");
+
+  m_file.open (path.c_str ());
+  if (!m_file)
+    {
+      NS_LOG_ERROR ("Bandwidth trace file " << path << " open error");
+      return false;
+    }
+  return true;
+}
+
+Ptr<mvdashBandwidthTrace>
+mvdashBandwidthTrace::Replay (std::string path, Ptr<NetDevice> device, Time stopTime)
+{
+  NS_LOG_INFO ("Dynamic Bandwidth Enabled");
+  Ptr<mvdashBandwidthTrace> trace = CreateObject<mvdashBandwidthTrace> ();
+  trace->SetAttribute ("StopTime", TimeValue (stopTime));
+  if (!trace->Install (path, device))
+    {
+      return 0;
+    }
+  return trace;
+}
+
+Ptr<mvdashBandwidthTrace>
+mvdashBandwidthTrace::Replay (std::string path, Callback<void, uint64_t> setRate, Time stopTime)
+{
+  NS_LOG_INFO ("Dynamic Bandwidth Enabled");
+  Ptr<mvdashBandwidthTrace> trace = CreateObject<mvdashBandwidthTrace> ();
+  trace->SetAttribute ("StopTime", TimeValue (stopTime));
+  if (!trace->Install (path, setRate))
+    {
+      return 0;
+    }
+  return trace;
+}
+
+bool
+mvdashBandwidthTrace::ReadLine (int64_t &time, uint64_t &value)
+{
+  std::string line;
+  while (true)
+    {
+      if (std::getline (m_file, line))
+        {
+          if (line.empty ())
+            {
+              continue;
+            }
+          std::istringstream buffer (line);
+          int64_t raw = 0;
+          value = 0;
+          buffer >> raw >> value;
+          if (m_mahimahi)
+            {
+              raw *= 1000;
+            }
+          m_lastInterval = raw - (m_linesInPass ? m_lastTime : 0);
+          m_lastTime = raw;
+          m_linesInPass = true;
+          time = m_loopOffset + raw;
+          return true;
+        }
+      if (!m_loop || !m_linesInPass || m_lastTime <= 0)
+        {
+          return false;
+        }
+      // Restart the trace once its last rate held for as long as the rate
+      // before it; a mahimahi trace restarts at its last opportunity
+      m_loopOffset += m_lastTime + (m_mahimahi ? 0 : m_lastInterval);
+      m_linesInPass = false;
+      m_file.clear ();
+      m_file.seekg (0);
+    }
+}
+
+bool
+mvdashBandwidthTrace::NextChange (int64_t &time, uint64_t &bps)
+{
+  if (!m_mahimahi)
+    {
+      return ReadLine (time, bps);
+    }
+
+  uint64_t unused;
+  if (m_nextOpportunity < 0 && !ReadLine (m_nextOpportunity, unused))
+    {
+      return false;
+    }
+  int64_t window = m_window.GetMicroSeconds ();
+  int64_t windowEnd = m_windowStart + window;
+  uint64_t count = 0;
+  while (m_nextOpportunity >= 0 && m_nextOpportunity < windowEnd)
+    {
+      count++;
+      if (!ReadLine (m_nextOpportunity, unused))
+        {
+          m_nextOpportunity = -1;
+        }
+    }
+  // An empty window (an outage) still gets one opportunity: a zero rate
+  // would never finish serializing the packet in flight
+  time = m_windowStart;
+  bps = std::max (count, (uint64_t) 1) * m_packetSize * 8 * 1000000 / window;
+  m_windowStart = windowEnd;
+  return true;
+}
+
+void
+mvdashBandwidthTrace::ScheduleNext (void)
+{
+  int64_t time;
+  uint64_t bps;
+  if (!NextChange (time, bps))
+    {
+      NS_LOG_LOGIC ("Bandwidth trace ended after " << m_nChanges << " changes");
+      m_file.close ();
+      return;
+    }
+  Time at = MicroSeconds ((int64_t) (time * m_timeScale));
+  if (!m_stopTime.IsZero () && at > m_stopTime)
+    {
+      m_file.close ();
+      return;
+    }
+  Time delay = at > Simulator::Now () ? at - Simulator::Now () : Time (0);
+  Simulator::Schedule (delay, &mvdashBandwidthTrace::Apply, Ptr<mvdashBandwidthTrace> (this), bps);
+}
+
+void
+mvdashBandwidthTrace::Apply (uint64_t bps)
+{
+  NS_LOG_FUNCTION (this << bps);
+  if (!m_device && m_setRate.IsNull ())
+    {
+      return;     // disposed
+    }
+  if (bps > 0 && m_device)
+    {
+      m_device->SetDataRate (DataRate (bps));
+    }
+  else if (bps > 0)
+    {
+      m_setRate (bps);
+    }
+  m_nChanges++;
+  ScheduleNext ();
+}
+
+} // namespace ns3
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_BANDWIDTH_TRACE_H
+#define MVDASH_BANDWIDTH_TRACE_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/net-device.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+class PointToPointNetDevice;
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Replays a bandwidth trace on a point-to-point device, one change at a time.
+ *
+ * The trace file is read incrementally: only the next rate change is
+ * scheduled, so a trace of any length costs one open file and one pending
+ * event.  Two formats are understood:
+ *
+ * - rate: lines of "<time in microseconds> <bits per second>", the rate
+ *   holding from that time on (the sbwtrace_*.csv files);
+ * - mahimahi: one line per delivery opportunity of PacketSize bytes, in
+ *   milliseconds; opportunities are counted over MahimahiWindow to give the
+ *   rate of each window.
+ *
+ * With Loop set, a rate trace restarts once its last rate held as long as
+ * the rate before it, and a mahimahi trace after its last opportunity, as
+ * mahimahi does.  TimeScale stretches (> 1) or compresses (< 1) the trace timeline.
+ */
+class mvdashBandwidthTrace : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  mvdashBandwidthTrace ();
+  virtual ~mvdashBandwidthTrace ();
+
+  /**
+   * \brief Open the trace and schedule its first change on device
+   * \returns false if the file cannot be read
+   */
+  bool Install (std::string path, Ptr<NetDevice> device);
+  /**
+   * \brief Open the trace and feed its changes, in bits per second, to setRate
+   *        (e.g. a link of the fluid network)
+   * \returns false if the file cannot be read
+   */
+  bool Install (std::string path, Callback<void, uint64_t> setRate);
+  /**
+   * \brief Read the rate changes of the trace up to until, without scheduling them
+   *
+   * For players that run outside of a simulation.
+   *
+   * \param changes filled with (time in microseconds, bits per second) pairs, TimeScale applied
+   * \returns false if the file cannot be read
+   */
+  bool Load (std::string path, Time until, std::vector< std::pair<int64_t, uint64_t> > &changes);
+  uint64_t GetNChanges (void) const { return m_nChanges; }
+
+  /**
+   * \brief Replay a rate trace on device with the default attributes, up to stopTime
+   * \returns the trace object, null if the file cannot be read
+   */
+  static Ptr<mvdashBandwidthTrace> Replay (std::string path, Ptr<NetDevice> device, Time stopTime);
+  /**
+   * \brief Replay a rate trace through setRate with the default attributes, up to stopTime
+   * \returns the trace object, null if the file cannot be read
+   */
+  static Ptr<mvdashBandwidthTrace> Replay (std::string path, Callback<void, uint64_t> setRate, Time stopTime);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Read the next line, rewinding at the end of the file if looping
+   * \param time the line timestamp in microseconds, loop offset included
+   * \param value the second column, if any
+   */
+  bool ReadLine (int64_t &time, uint64_t &value);
+  bool OpenFile (std::string path);
+  bool Open (std::string path);
+  /**
+   * \brief Compute the next rate change from the trace
+   */
+  bool NextChange (int64_t &time, uint64_t &bps);
+  void ScheduleNext (void);
+  void Apply (uint64_t bps);
+
+  std::string m_formatName;
+  bool        m_mahimahi;
+  bool        m_loop;
+  double      m_timeScale;
+  Time        m_window;         //!< mahimahi rate averaging window
+  uint32_t    m_packetSize;     //!< mahimahi bytes per delivery opportunity
+  Time        m_stopTime;       //!< no change is applied after this time; zero for none
+
+  std::ifstream m_file;
+  Ptr<PointToPointNetDevice> m_device;
+  Callback<void, uint64_t> m_setRate;
+  int64_t     m_loopOffset;     //!< microseconds added to timestamps of the current pass
+  int64_t     m_lastTime;       //!< last raw timestamp read, in microseconds
+  int64_t     m_lastInterval;   //!< microseconds between the last two timestamps of the pass
+  bool        m_linesInPass;    //!< the current pass has read at least one line
+  int64_t     m_windowStart;    //!< start of the next mahimahi window, microseconds
+  int64_t     m_nextOpportunity; //!< next mahimahi timestamp already read, -1 if none
+  uint64_t    m_nChanges;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_BANDWIDTH_TRACE_H */
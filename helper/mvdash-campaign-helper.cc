@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mvdash-campaign-helper.h"
+#include "ns3/mvdash_client.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/rng-seed-manager.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashCampaignHelper");
+
+/*
+ * Quantile of the standard normal distribution (Acklam's rational approximation,
+ * relative error below 1.2e-9).
+ */
+static double
+NormalQuantile (double p)
+{
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                             1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                             6.680131188771972e+01, -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                             -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                             3.754408661907416e+00};
+  const double pLow = 0.02425;
+  double q, r;
+
+  if (p < pLow)
+    {
+      q = std::sqrt (-2 * std::log (p));
+      return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+             ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+  if (p > 1 - pLow)
+    {
+      q = std::sqrt (-2 * std::log (1 - p));
+      return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+              ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+  q = p - 0.5;
+  r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/*
+ * Quantile of the Student t distribution with df degrees of freedom
+ * (closed form for df <= 2, Cornish-Fisher expansion around the normal
+ * quantile otherwise).
+ */
+static double
+StudentQuantile (double p, uint32_t df)
+{
+  if (df == 1)
+    {
+      return std::tan (M_PI * (p - 0.5));
+    }
+  if (df == 2)
+    {
+      return (2 * p - 1) / std::sqrt (2 * p * (1 - p));
+    }
+  double z = NormalQuantile (p);
+  double v = df;
+  double z2 = z * z;
+  return z
+         + z * (z2 + 1) / (4 * v)
+         + z * ((5 * z2 + 16) * z2 + 3) / (96 * v * v)
+         + z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / (384 * v * v * v);
+}
+
+mvdashRunningStat::mvdashRunningStat ()
+  : m_count (0),
+    m_mean (0.0),
+    m_m2 (0.0)
+{
+}
+
+void
+mvdashRunningStat::Add (double value)
+{
+  m_count++;
+  double delta = value - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (value - m_mean);
+}
+
+double
+mvdashRunningStat::GetVariance (void) const
+{
+  if (m_count < 2)
+    {
+      return 0.0;
+    }
+  return m_m2 / (m_count - 1);
+}
+
+double
+mvdashRunningStat::GetHalfWidth (double confidence) const
+{
+  if (m_count < 2)
+    {
+      return INFINITY;
+    }
+  double t = StudentQuantile (1.0 - (1.0 - confidence) / 2, m_count - 1);
+  return t * std::sqrt (GetVariance () / m_count);
+}
+
+mvdashCampaignHelper::mvdashCampaignHelper ()
+  : m_minRuns (5),
+    m_maxRuns (1000),
+    m_confidence (0.95),
+    m_relPrecision (0.05),
+    m_absRebufferPrecision (0.005),
+    m_runLog (0)
+{
+}
+
+void
+mvdashCampaignHelper::SetPrecision (double relPrecision, double absRebufferPrecision)
+{
+  m_relPrecision = relPrecision;
+  m_absRebufferPrecision = absRebufferPrecision;
+}
+
+void
+mvdashCampaignHelper::PrepareRun (uint64_t run)
+{
+  RngSeedManager::SetRun (run);
+  RngSeedManager::ResetNextStreamIndex ();
+}
+
+st_mvdashClientQoe
+mvdashCampaignHelper::GetClientQoe (Ptr<const mvdashClient> client)
+{
+  st_mvdashClientQoe qoe = {0.0, 0.0, 0};
+  const t_videoDataGroup &video = client->GetVideoData ();
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  int nPlayed = play.playbackIndex.size ();
+
+  if (nPlayed == 0 || video.empty ())
+    {
+      return qoe;
+    }
+
+  int64_t segmentDuration = video[0].segmentDuration;
+  int64_t stallTime = 0;
+  double bitrateSum = 0.0;
+  for (int i = 0; i < nPlayed; i++)
+    {
+      int32_t vp = play.mainViewpoint[i];
+      bitrateSum += video[vp].averageBitrate[play.qualityIndex[i][vp]];
+      if (i > 0)
+        {
+          stallTime += std::max (play.playbackStart[i] - play.playbackStart[i - 1] - segmentDuration,
+                                 (int64_t) 0);
+        }
+    }
+
+  TimeValue startTime;
+  client->GetAttribute ("StartTime", startTime);
+
+  qoe.meanBitrate = bitrateSum / nPlayed;
+  qoe.rebufferRatio = (double) stallTime / (stallTime + nPlayed * segmentDuration);
+  qoe.startupDelay = play.playbackStart[0] - startTime.Get ().GetMicroSeconds ();
+  return qoe;
+}
+
+bool
+mvdashCampaignHelper::AddRun (uint64_t run, const ApplicationContainer &clients)
+{
+  NS_LOG_FUNCTION (this << run);
+  double bitrate = 0.0, rebuffer = 0.0, startup = 0.0;
+  uint32_t nClients = 0;
+
+  for (ApplicationContainer::Iterator i = clients.Begin (); i != clients.End (); ++i)
+    {
+      Ptr<mvdashClient> client = DynamicCast<mvdashClient> (*i);
+      if (!client)
+        {
+          continue;
+        }
+      st_mvdashClientQoe qoe = GetClientQoe (client);
+      bitrate += qoe.meanBitrate;
+      rebuffer += qoe.rebufferRatio;
+      startup += qoe.startupDelay;
+      nClients++;
+    }
+  if (nClients == 0)
+    {
+      NS_LOG_WARN ("Run " << run << " has no mvdashClient to evaluate");
+      return IsDone ();
+    }
+
+  m_bitrate.Add (bitrate / nClients);
+  m_rebuffer.Add (rebuffer / nClients);
+  m_startup.Add (startup / nClients);
+
+  if (m_runLog)
+    {
+      *m_runLog << run << "\t" << bitrate / nClients << "\t" << rebuffer / nClients
+                << "\t" << startup / nClients << "\n";
+    }
+  NS_LOG_INFO ("Run " << run << " bitrate " << m_bitrate.GetMean ()
+               << " +- " << m_bitrate.GetHalfWidth (m_confidence)
+               << " rebuffer " << m_rebuffer.GetMean ()
+               << " +- " << m_rebuffer.GetHalfWidth (m_confidence));
+  return IsDone ();
+}
+
+bool
+mvdashCampaignHelper::IsPrecise (const mvdashRunningStat &stat, double absPrecision) const
+{
+  double target = std::max (m_relPrecision * std::fabs (stat.GetMean ()), absPrecision);
+  return stat.GetHalfWidth (m_confidence) <= target;
+}
+
+bool
+mvdashCampaignHelper::IsDone (void) const
+{
+  uint32_t nRuns = GetRunCount ();
+  if (nRuns >= m_maxRuns)
+    {
+      return true;
+    }
+  if (nRuns < m_minRuns)
+    {
+      return false;
+    }
+  return IsPrecise (m_bitrate, 0.0) && IsPrecise (m_rebuffer, m_absRebufferPrecision);
+}
+
+void
+mvdashCampaignHelper::Print (std::ostream &os) const
+{
+  os << "runs\t" << GetRunCount () << "\n"
+     << "confidence\t" << m_confidence << "\n"
+     << "bitrate\t" << m_bitrate.GetMean () << "\t" << m_bitrate.GetHalfWidth (m_confidence) << "\n"
+     << "rebufferRatio\t" << m_rebuffer.GetMean () << "\t" << m_rebuffer.GetHalfWidth (m_confidence) << "\n"
+     << "startupDelay\t" << m_startup.GetMean () << "\t" << m_startup.GetHalfWidth (m_confidence) << "\n";
+}
+
+} // namespace ns3
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MVDASH_CAMPAIGN_HELPER_H
+#define MVDASH_CAMPAIGN_HELPER_H
+
+#include <stdint.h>
+#include <ostream>
+#include "ns3/application-container.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class mvdashClient;
+
+/**
+ * \brief QoE scalars of one client, derived from its playback data.
+ */
+struct st_mvdashClientQoe
+{
+  double  meanBitrate;    //!< average bitrate of the played main view in bits per second
+  double  rebufferRatio;  //!< stall time / (stall time + played time)
+  int64_t startupDelay;   //!< time in microseconds from the application start to the first playback
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Online mean/variance accumulator (Welford) with a Student-t confidence interval.
+ */
+class mvdashRunningStat
+{
+public:
+  mvdashRunningStat ();
+
+  void Add (double value);
+  uint32_t GetCount (void) const { return m_count; }
+  double GetMean (void) const { return m_mean; }
+  double GetVariance (void) const;
+  /**
+   * \param confidence two-sided confidence level, e.g. 0.95
+   * \returns the half width of the confidence interval on the mean
+   */
+  double GetHalfWidth (double confidence) const;
+
+private:
+  uint32_t m_count;
+  double   m_mean;
+  double   m_m2;          //!< sum of squared differences from the current mean
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Monte Carlo campaign over ns-3 RngRun streams.
+ *
+ * The caller runs the same scenario once per run number and hands the
+ * installed clients to AddRun () before Simulator::Destroy ().  Per-run means
+ * of the main-view bitrate and the rebuffer ratio are accumulated online, and
+ * IsDone () turns true as soon as both confidence intervals are tight enough
+ * (or MaxRuns is reached).
+ */
+class mvdashCampaignHelper
+{
+public:
+  mvdashCampaignHelper ();
+
+  void SetMinRuns (uint32_t minRuns) { m_minRuns = minRuns; }
+  void SetMaxRuns (uint32_t maxRuns) { m_maxRuns = maxRuns; }
+  void SetConfidence (double confidence) { m_confidence = confidence; }
+  /**
+   * \param relPrecision target half width relative to the mean, e.g. 0.05
+   * \param absRebufferPrecision target half width of the rebuffer ratio,
+   *        used when its mean is close to zero
+   */
+  void SetPrecision (double relPrecision, double absRebufferPrecision);
+
+  /**
+   * Prepare the random number generators for the given run: select the
+   * RngRun substream and reset the automatic stream index counter, so that
+   * a run is reproducible no matter how many runs preceded it in the process.
+   */
+  static void PrepareRun (uint64_t run);
+
+  /**
+   * \brief Derive QoE scalars of a client from its playback record
+   */
+  static st_mvdashClientQoe GetClientQoe (Ptr<const mvdashClient> client);
+
+  /**
+   * \brief Accumulate the per-client QoE of one finished run
+   * \param run the RngRun number of the finished run
+   * \param clients the mvdashClient applications of the run
+   * \returns true when the stop criterion is met
+   */
+  bool AddRun (uint64_t run, const ApplicationContainer &clients);
+
+  bool IsDone (void) const;
+  uint32_t GetRunCount (void) const { return m_bitrate.GetCount (); }
+
+  /**
+   * \brief Write one tab separated row per finished run to os
+   */
+  void SetRunLog (std::ostream *os) { m_runLog = os; }
+  void Print (std::ostream &os) const;
+
+private:
+  bool IsPrecise (const mvdashRunningStat &stat, double absPrecision) const;
+
+  uint32_t m_minRuns;
+  uint32_t m_maxRuns;
+  double   m_confidence;
+  double   m_relPrecision;
+  double   m_absRebufferPrecision;
+
+  mvdashRunningStat m_bitrate;
+  mvdashRunningStat m_rebuffer;
+  mvdashRunningStat m_startup;
+  std::ostream *m_runLog;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_CAMPAIGN_HELPER_H */
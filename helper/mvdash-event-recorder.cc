@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-event-recorder.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "ns3/packet.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashEventRecorder");
+
+// File header: magic, format version and record size
+static const char     RECORDER_MAGIC[4] = {'M', 'V', 'D', 'R'};
+static const uint32_t RECORDER_VERSION = 1;
+
+mvdashEventRecorder::mvdashEventRecorder (std::string path, uint32_t ringSize)
+  : m_ringSize (ringSize),
+    m_nRecords (0)
+{
+  NS_ABORT_MSG_IF (ringSize == 0, "mvdashEventRecorder needs a non-empty ring");
+  m_file = std::fopen (path.c_str (), "wb");
+  NS_ABORT_MSG_IF (!m_file, "Cannot open the event record file " << path);
+
+  uint32_t header[2] = {RECORDER_VERSION, sizeof (st_mvdashEventRecord)};
+  std::fwrite (RECORDER_MAGIC, sizeof (RECORDER_MAGIC), 1, m_file);
+  std::fwrite (header, sizeof (header), 1, m_file);
+}
+
+mvdashEventRecorder::~mvdashEventRecorder ()
+{
+  Flush ();
+  std::fclose (m_file);
+  for (st_eventRing *ring : m_rings)
+    {
+      delete ring;
+    }
+}
+
+void
+mvdashEventRecorder::Install (const ApplicationContainer &clients, bool packets)
+{
+  for (ApplicationContainer::Iterator i = clients.Begin (); i != clients.End (); ++i)
+    {
+      Ptr<mvdashClient> client = DynamicCast<mvdashClient> (*i);
+      if (!client)
+        {
+          continue;
+        }
+      st_eventRing *ring = new st_eventRing;
+      ring->recorder = this;
+      ring->records.resize (m_ringSize);
+      ring->used = 0;
+      ring->seq = 0;
+      m_rings.push_back (ring);
+
+      if (packets)
+        {
+          client->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&mvdashEventRecorder::RecordRx, ring));
+          client->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&mvdashEventRecorder::RecordTx, ring));
+        }
+      client->TraceConnectWithoutContext ("SegmentTrace", MakeBoundCallback (&mvdashEventRecorder::RecordSegment, ring));
+      client->TraceConnectWithoutContext ("RequestTrace", MakeBoundCallback (&mvdashEventRecorder::RecordRequest, ring));
+      client->TraceConnectWithoutContext ("ControllerTrace", MakeBoundCallback (&mvdashEventRecorder::RecordController, ring));
+    }
+}
+
+st_mvdashEventRecord &
+mvdashEventRecorder::Append (st_eventRing *ring, Ptr<const mvdashClient> client, uint8_t source)
+{
+  if (ring->used == ring->records.size ())
+    {
+      ring->recorder->Dump (ring);
+    }
+  st_mvdashEventRecord &rec = ring->records[ring->used++];
+  rec.time = Simulator::Now ().GetNanoSeconds ();
+  rec.clientId = client->m_clientId;
+  rec.seq = ring->seq++;
+  rec.source = source;
+  rec.event = 0;
+  rec.state = 0;
+  rec.tile = 0;
+  rec.id = -1;
+  rec.viewpoint = -1;
+  rec.timeIndex = -1;
+  rec.qualityIndex = -1;
+  rec.size = -1;
+  return rec;
+}
+
+void
+mvdashEventRecorder::RecordRx (st_eventRing *ring, Ptr<const mvdashClient> client, Ptr<const Packet> packet)
+{
+  Append (ring, client, evsrc_rx).size = packet->GetSize ();
+}
+
+void
+mvdashEventRecorder::RecordTx (st_eventRing *ring, Ptr<const mvdashClient> client, Ptr<const Packet> packet)
+{
+  Append (ring, client, evsrc_tx).size = packet->GetSize ();
+}
+
+void
+mvdashEventRecorder::RecordSegment (st_eventRing *ring, Ptr<const mvdashClient> client, segmentEvent ev,
+                                    st_mvdashRequest sinfo)
+{
+  st_mvdashEventRecord &rec = Append (ring, client, evsrc_segment);
+  rec.event = ev;
+  rec.id = sinfo.id;
+  rec.viewpoint = sinfo.viewpoint;
+  rec.timeIndex = sinfo.timeIndex;
+  rec.qualityIndex = sinfo.qualityIndex;
+  rec.size = sinfo.segmentSize;
+  rec.tile = (uint8_t) sinfo.tile;
+}
+
+void
+mvdashEventRecorder::RecordRequest (st_eventRing *ring, Ptr<const mvdashClient> client, requestEvent ev, int32_t id)
+{
+  st_mvdashEventRecord &rec = Append (ring, client, evsrc_request);
+  rec.event = ev;
+  rec.id = id;
+}
+
+void
+mvdashEventRecorder::RecordController (st_eventRing *ring, Ptr<const mvdashClient> client, controllerState state,
+                                       controllerTraceEvent ev, int32_t tIndex)
+{
+  st_mvdashEventRecord &rec = Append (ring, client, evsrc_controller);
+  rec.event = ev;
+  rec.state = state;
+  rec.timeIndex = tIndex;
+}
+
+void
+mvdashEventRecorder::Dump (st_eventRing *ring)
+{
+  if (ring->used == 0)
+    {
+      return;
+    }
+  std::fwrite (ring->records.data (), sizeof (st_mvdashEventRecord), ring->used, m_file);
+  m_nRecords += ring->used;
+  ring->used = 0;
+}
+
+void
+mvdashEventRecorder::Flush (void)
+{
+  for (st_eventRing *ring : m_rings)
+    {
+      Dump (ring);
+    }
+  std::fflush (m_file);
+}
+
+int64_t
+mvdashEventRecorder::Decode (std::string path, std::ostream &os)
+{
+  static const char *sources[] = {"rx", "tx", "segment", "request", "controller"};
+
+  std::FILE *file = std::fopen (path.c_str (), "rb");
+  if (!file)
+    {
+      return -1;
+    }
+  char magic[4];
+  uint32_t header[2];
+  if (std::fread (magic, sizeof (magic), 1, file) != 1 || std::memcmp (magic, RECORDER_MAGIC, sizeof (magic))
+      || std::fread (header, sizeof (header), 1, file) != 1
+      || header[0] != RECORDER_VERSION || header[1] != sizeof (st_mvdashEventRecord))
+    {
+      std::fclose (file);
+      return -1;
+    }
+
+  os << "time_ns\tclient\tseq\tsource\tevent\tstate\tid\tviewpoint\ttIndex\tquality\tsize\ttile\n";
+  int64_t nRecords = 0;
+  std::vector <st_mvdashEventRecord> buffer (4096);
+  size_t n;
+  while ((n = std::fread (buffer.data (), sizeof (st_mvdashEventRecord), buffer.size (), file)) > 0)
+    {
+      for (size_t i = 0; i < n; i++)
+        {
+          const st_mvdashEventRecord &rec = buffer[i];
+          os << rec.time << "\t" << rec.clientId << "\t" << rec.seq
+             << "\t" << (rec.source <= evsrc_controller ? sources[rec.source] : "?")
+             << "\t" << (int) rec.event << "\t" << (int) rec.state << "\t" << rec.id
+             << "\t" << rec.viewpoint << "\t" << rec.timeIndex << "\t" << rec.qualityIndex
+             << "\t" << rec.size << "\t" << (int) rec.tile << "\n";
+        }
+      nRecords += n;
+    }
+  std::fclose (file);
+  return nRecords;
+}
+
+} // namespace ns3
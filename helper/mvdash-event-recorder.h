@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_EVENT_RECORDER_H
+#define MVDASH_EVENT_RECORDER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/application-container.h"
+#include "ns3/mvdash_client.h"
+
+namespace ns3 {
+
+/// Trace source of an event record
+enum mvdashEventSource
+{
+  evsrc_rx, evsrc_tx, evsrc_segment, evsrc_request, evsrc_controller
+};
+
+/**
+ * \brief One binary event record, 40 bytes, written as is.
+ *
+ * Fields not carried by the source are -1: Rx/Tx fill size only, requests
+ * fill id, controller events fill timeIndex and state.  Segment events of a
+ * tiled viewpoint carry the tile, in grids of up to 256 tiles; it is 0 for
+ * every other record.
+ */
+struct st_mvdashEventRecord
+{
+  int64_t  time;          //!< nanoseconds
+  uint32_t clientId;
+  uint32_t seq;           //!< per-client sequence number
+  uint8_t  source;        //!< mvdashEventSource
+  uint8_t  event;         //!< requestEvent, segmentEvent or controllerTraceEvent
+  uint8_t  state;         //!< controllerState
+  uint8_t  tile;
+  int32_t  id;
+  int32_t  viewpoint;
+  int32_t  timeIndex;
+  int32_t  qualityIndex;
+  int32_t  size;          //!< packet or segment bytes
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Records the Rx, Tx, SegmentTrace, RequestTrace and ControllerTrace
+ *        sources of mvdashClient as fixed-size binary records.
+ *
+ * Each client appends to its own preallocated buffer of RingSize records;
+ * a full buffer is written to the file with a single fwrite, and Flush (or
+ * the destructor) writes the rest.  Nothing is formatted during the run; use
+ * Decode (or the mvdash-trace-decode program) to turn the file into text.
+ */
+class mvdashEventRecorder
+{
+public:
+  /**
+   * \param path the output file
+   * \param ringSize records buffered per client
+   */
+  mvdashEventRecorder (std::string path, uint32_t ringSize = 4096);
+  ~mvdashEventRecorder ();
+
+  /**
+   * \brief Connect to the traces of the mvdashClient applications in clients
+   * \param packets also record every Rx/Tx packet
+   */
+  void Install (const ApplicationContainer &clients, bool packets = true);
+  void Flush (void);
+  uint64_t GetNRecords (void) const { return m_nRecords; }
+
+  /**
+   * \brief Write the records of a recorder file as tab separated text
+   * \returns the number of records, or -1 if the file is not a recorder file
+   */
+  static int64_t Decode (std::string path, std::ostream &os);
+
+private:
+  // The recorder owns its file and the rings the trace sinks write to
+  mvdashEventRecorder (const mvdashEventRecorder &) = delete;
+  mvdashEventRecorder & operator= (const mvdashEventRecorder &) = delete;
+
+  struct st_eventRing
+  {
+    mvdashEventRecorder *recorder;
+    std::vector <st_mvdashEventRecord> records;
+    uint32_t used;
+    uint32_t seq;
+  };
+
+  static st_mvdashEventRecord & Append (st_eventRing *ring, Ptr<const mvdashClient> client, uint8_t source);
+  static void RecordRx (st_eventRing *ring, Ptr<const mvdashClient> client, Ptr<const Packet> packet);
+  static void RecordTx (st_eventRing *ring, Ptr<const mvdashClient> client, Ptr<const Packet> packet);
+  static void RecordSegment (st_eventRing *ring, Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
+  static void RecordRequest (st_eventRing *ring, Ptr<const mvdashClient> client, requestEvent ev, int32_t id);
+  static void RecordController (st_eventRing *ring, Ptr<const mvdashClient> client, controllerState state,
+                                controllerTraceEvent ev, int32_t tIndex);
+  void Dump (st_eventRing *ring);
+
+  std::FILE *m_file;
+  uint32_t   m_ringSize;
+  std::vector <st_eventRing *> m_rings;
+  uint64_t   m_nRecords;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_EVENT_RECORDER_H */
@@ -18,9 +18,11 @@
 
 #include "mvdash-helper.h"
 #include "ns3/mvdash_server.h"
+#include "ns3/mvdash_cache_server.h"
 #include "ns3/mvdash_client.h"
 #include "ns3/string.h"
 #include "ns3/uinteger.h"
+#include "ns3/integer.h"
 #include "ns3/names.h"
 
 namespace ns3 {
@@ -35,7 +37,7 @@ mvdashServerHelper::mvdashServerHelper (Address address, uint16_t bUseQuic)
   m_factory.SetTypeId (mvdashServer::GetTypeId ());
   SetAttribute ("LocalAddress", AddressValue (address));
 //  SetAttribute ("Port", UintegerValue (port));
-//  SetAttribute ("UseQuic", UintegerValue (bUseQuic));  
+  SetAttribute ("UseQuic", UintegerValue (bUseQuic));
 }
 
 mvdashServerHelper::mvdashServerHelper (Ipv4Address ip, uint16_t port, uint16_t bUseQuic)
@@ -43,7 +45,7 @@ mvdashServerHelper::mvdashServerHelper (Ipv4Address ip, uint16_t port, uint16_t
   m_factory.SetTypeId (mvdashServer::GetTypeId ());
   SetAttribute ("LocalAddress", AddressValue (InetSocketAddress(ip, port)));
 //  SetAttribute ("Port", UintegerValue (port));
-//  SetAttribute ("UseQuic", UintegerValue (bUseQuic));  
+  SetAttribute ("UseQuic", UintegerValue (bUseQuic));
 }
 
 void
@@ -88,23 +90,61 @@ mvdashServerHelper::InstallPriv (Ptr<Node> node) const
   return app;
 }
 
+mvdashCacheServerHelper::mvdashCacheServerHelper (Address localAddress, Address originAddress)
+{
+  m_factory.SetTypeId (mvdashCacheServer::GetTypeId ());
+  SetAttribute ("LocalAddress", AddressValue (localAddress));
+  SetAttribute ("OriginAddress", AddressValue (originAddress));
+}
+
+void
+mvdashCacheServerHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+mvdashCacheServerHelper::Install (Ptr<Node> node) const
+{
+  Ptr<Application> app = m_factory.Create<mvdashCacheServer> ();
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+ApplicationContainer
+mvdashCacheServerHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (Install (*i));
+    }
+  return apps;
+}
+
 mvdashClientHelper::mvdashClientHelper ()
+  : m_firstClientId (0),
+    m_setStartTimes (false)
 {
   m_factory.SetTypeId (mvdashClient::GetTypeId ());
 }
 
 mvdashClientHelper::mvdashClientHelper (Address serverAddress, uint16_t bUseQuic)
+  : m_firstClientId (0),
+    m_setStartTimes (false)
 {
   m_factory.SetTypeId (mvdashClient::GetTypeId ());
   SetAttribute ("ServerAddress", AddressValue (serverAddress));
-//  SetAttribute ("UseQuic", UintegerValue (bUseQuic));  
+  SetAttribute ("UseQuic", UintegerValue (bUseQuic));
 }
 
 mvdashClientHelper::mvdashClientHelper (Ipv4Address serverIP, uint16_t serverPort, uint16_t bUseQuic)
+  : m_firstClientId (0),
+    m_setStartTimes (false)
 {
   m_factory.SetTypeId (mvdashClient::GetTypeId ());
   SetAttribute ("ServerAddress", AddressValue (InetSocketAddress(serverIP, serverPort)));
-//  SetAttribute ("UseQuic", UintegerValue (bUseQuic));  
+  SetAttribute ("UseQuic", UintegerValue (bUseQuic));
 }
 
 void
@@ -113,6 +153,39 @@ mvdashClientHelper::SetAttribute (std::string name, const AttributeValue &value)
   m_factory.Set (name, value);
 }
 
+void
+mvdashClientHelper::SetFirstClientId (uint32_t firstClientId)
+{
+  m_firstClientId = firstClientId;
+}
+
+void
+mvdashClientHelper::SetStartTimes (Time start, Time interval, Ptr<RandomVariableStream> jitter)
+{
+  m_setStartTimes = true;
+  m_start = start;
+  m_startInterval = interval;
+  m_startJitter = jitter;
+}
+
+int64_t
+mvdashClientHelper::AssignStreams (int64_t stream, uint32_t nClients)
+{
+  int64_t n = 0;
+  if (m_startJitter)
+    {
+      m_startJitter->SetStream (stream + n++);
+    }
+  m_factory.Set ("StreamBase", IntegerValue (stream + n));
+  return n + mvdashClient::GetViewModelStreams () * nClients;
+}
+
+void
+mvdashClientHelper::SetClientConfigurator (ClientConfigurator configure)
+{
+  m_configure = configure;
+}
+
 ApplicationContainer
 mvdashClientHelper::Install (NodeContainer c) const
 {
@@ -140,12 +213,25 @@ mvdashClientHelper::Install (NodeContainer c, std::string algo) const
 }
 
 Ptr<Application>
-mvdashClientHelper::InstallPriv (Ptr<Node> node, uint16_t clientId) const
+mvdashClientHelper::InstallPriv (Ptr<Node> node, uint32_t index) const
 {
   Ptr<Application> app = m_factory.Create<mvdashClient> ();
-  app->GetObject<mvdashClient> ()->SetAttribute ("ClientId", UintegerValue (clientId));
+  app->GetObject<mvdashClient> ()->SetAttribute ("ClientId", UintegerValue (m_firstClientId + index));
+  if (!m_configure.IsNull ())
+    {
+      m_configure (app, index);
+    }
 //  app->GetObject<mvdashClient> ()->Initialise (algo, clientId);
   app->GetObject<mvdashClient> ()->Initialize();
+  if (m_setStartTimes)
+    {
+      Time start = m_start + m_startInterval * (int64_t) index;
+      if (m_startJitter)
+        {
+          start += Seconds (m_startJitter->GetValue ());
+        }
+      app->SetStartTime (Max (start, Seconds (0)));
+    }
 
   node->AddApplication (app);
   return app;
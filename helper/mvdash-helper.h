@@ -25,6 +25,9 @@
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/random-variable-stream.h"
 
 namespace ns3 {
 
@@ -113,6 +116,46 @@ private:
   ObjectFactory m_factory; //!< Object factory.
 };
 
+/**
+ * \ingroup etri_mvdash
+ * \brief Create an ETRI Multiview DASH edge cache application.
+ */
+class mvdashCacheServerHelper
+{
+public:
+  /**
+   * \param localAddress the address the clients connect to
+   * \param originAddress the address of the origin mvdashServer
+   */
+  mvdashCacheServerHelper (Address localAddress, Address originAddress);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create an mvdashCacheServer on the specified Node.
+   *
+   * \param node The node on which to create the Application.
+   * \returns An ApplicationContainer holding the Application created,
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+  /**
+   * \param c The nodes on which to create the Applications.
+   * \returns The applications created, one Application per Node in the 
+   *          NodeContainer.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
 /**
  * \ingroup etri_mvdash
  * \brief Create an ETRI Multiview DASH client application.
@@ -152,6 +195,48 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * \param firstClientId the ClientId given to the first installed client
+   *
+   * Clients are numbered firstClientId, firstClientId+1, ... in install order.
+   * The ClientId also selects the random variable streams of the viewpoint
+   * model, so a process simulating a slice of a larger population should
+   * start at the global index of its first client.
+   */
+  void SetFirstClientId (uint32_t firstClientId);
+
+  /**
+   * \param start the start time of the first installed client
+   * \param interval the start time step between consecutive clients
+   * \param jitter if set, a draw in seconds added to each start time
+   *
+   * Install sets the start times; without this call they are left to the
+   * caller.
+   */
+  void SetStartTimes (Time start, Time interval, Ptr<RandomVariableStream> jitter = 0);
+  /**
+   * \param stream the first stream index to use
+   * \param nClients the size of the whole population, ClientIds 0 to nClients - 1
+   * \returns the number of streams used: one for the start time jitter, if
+   *          any, then those of the viewpoint models of every ClientId
+   *
+   * Clients installed afterwards get the StreamBase past the jitter stream.
+   * A process simulating a slice of the population passes the same stream
+   * and nClients as the others.
+   */
+  int64_t AssignStreams (int64_t stream, uint32_t nClients);
+
+  /**
+   * Callback setting the attributes of one client before it is initialized,
+   * given its index in install order.
+   */
+  typedef Callback<void, Ptr<Application>, uint32_t> ClientConfigurator;
+  /**
+   * \param configure called on every installed client, so clients of a
+   *        population can differ (algorithm, viewpoint model, connections)
+   */
+  void SetClientConfigurator (ClientConfigurator configure);
+
   /**
    * \param c the nodes to be installedd
    *
@@ -181,12 +266,18 @@ private:
    *
    * \param node The node on which an etri_mvdashClient will be installed.
    * \param algo A string containing the name of the adaptation algorithm to be used on this client
-   * \param clientId distinguish this client object from other parallel running clients, for logging purposes
+   * \param index the install order of the client, offset by the first ClientId to give its ClientId
    * \param simulationId distinguish this simulation from other subsequently started simulations, for logging purposes
    * \returns Ptr to the application installed.
    */
-  Ptr<Application> InstallPriv (Ptr<Node> node, uint16_t clientId) const;
+  Ptr<Application> InstallPriv (Ptr<Node> node, uint32_t index) const;
   ObjectFactory m_factory; //!< Object factory.
+  uint32_t m_firstClientId; //!< ClientId of the first installed client
+  bool     m_setStartTimes; //!< Install sets the start times
+  Time     m_start;
+  Time     m_startInterval;
+  Ptr<RandomVariableStream> m_startJitter;
+  ClientConfigurator m_configure;
 };
 
 } // namespace ns3
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <mpi.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/global-value.h"
+#include "ns3/mpi-interface.h"
+#include "mvdash-mpi-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashMpiHelper");
+
+mvdashMpiHelper::mvdashMpiHelper (uint32_t nClients)
+  : m_nClients (nClients),
+    m_systemId (0),
+    m_systemCount (1)
+{
+  if (MpiInterface::IsEnabled ())
+    {
+      m_systemId = MpiInterface::GetSystemId ();
+      m_systemCount = MpiInterface::GetSize ();
+    }
+}
+
+void
+mvdashMpiHelper::Enable (int *argc, char ***argv)
+{
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (argc, argv);
+}
+
+void
+mvdashMpiHelper::Disable (void)
+{
+  MpiInterface::Disable ();
+}
+
+uint32_t
+mvdashMpiHelper::GetFirstClient (uint32_t rank) const
+{
+  // The first (m_nClients % m_systemCount) ranks get one extra client
+  uint32_t base = m_nClients / m_systemCount;
+  uint32_t extra = m_nClients % m_systemCount;
+  return rank * base + std::min (rank, extra);
+}
+
+uint32_t
+mvdashMpiHelper::GetNClients (uint32_t rank) const
+{
+  return GetFirstClient (rank + 1) - GetFirstClient (rank);
+}
+
+uint32_t
+mvdashMpiHelper::GetClientRank (uint32_t clientId) const
+{
+  uint32_t base = m_nClients / m_systemCount;
+  uint32_t extra = m_nClients % m_systemCount;
+  if (clientId < extra * (base + 1))
+    {
+      return clientId / (base + 1);
+    }
+  return extra + (clientId - extra * (base + 1)) / base;
+}
+
+NodeContainer
+mvdashMpiHelper::CreateClientNodes (void) const
+{
+  NodeContainer nodes;
+  for (uint32_t rank = 0; rank < m_systemCount; rank++)
+    {
+      NodeContainer rankNodes;
+      rankNodes.Create (GetNClients (rank), rank);
+      nodes.Add (rankNodes);
+    }
+  return nodes;
+}
+
+ApplicationContainer
+mvdashMpiHelper::InstallClients (mvdashClientHelper &helper, NodeContainer clientNodes) const
+{
+  NS_ASSERT (clientNodes.GetN () == m_nClients);
+  uint32_t first = GetFirstClient (m_systemId);
+  NodeContainer local;
+  for (uint32_t i = first; i < first + GetNClients (m_systemId); i++)
+    {
+      local.Add (clientNodes.Get (i));
+    }
+  helper.SetFirstClientId (first);
+  return helper.Install (local);
+}
+
+void
+mvdashMpiHelper::MergeClientLogs (std::string path, uint32_t simId, bool removeParts) const
+{
+  NS_LOG_FUNCTION (this << path << simId);
+  if (MpiInterface::IsEnabled ())
+    {
+      MPI_Barrier (MpiInterface::GetCommunicator ());
+    }
+  if (m_systemId != 0)
+    {
+      return;
+    }
+  MergeLog (path, "downlog", simId, removeParts);
+  MergeLog (path, "playback", simId, removeParts);
+  MergeLog (path, "buffer", simId, removeParts);
+}
+
+void
+mvdashMpiHelper::MergeLog (std::string path, std::string prefix, uint32_t simId, bool removeParts) const
+{
+  std::string name = path + prefix + "_sim" + std::to_string (simId);
+  std::ofstream merged ((name + ".csv").c_str ());
+  if (!merged)
+    {
+      NS_LOG_ERROR ("Cannot open " << name << ".csv");
+      return;
+    }
+
+  bool headerWritten = false;
+  uint32_t nMissing = 0;
+  for (uint32_t cl = 0; cl < m_nClients; cl++)
+    {
+      std::string partName = name + "_cl" + std::to_string (cl) + ".csv";
+      std::ifstream part (partName.c_str ());
+      if (!part)
+        {
+          nMissing++;
+          continue;
+        }
+      std::string line;
+      if (std::getline (part, line) && !headerWritten)
+        {
+          merged << "client\t" << line << "\n";
+          headerWritten = true;
+        }
+      while (std::getline (part, line))
+        {
+          merged << cl << "\t" << line << "\n";
+        }
+      part.close ();
+      if (removeParts)
+        {
+          std::remove (partName.c_str ());
+        }
+    }
+  if (nMissing)
+    {
+      NS_LOG_WARN (nMissing << " of " << m_nClients << " " << prefix << " logs are missing");
+    }
+}
+
+} // namespace ns3
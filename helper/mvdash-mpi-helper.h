@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MVDASH_MPI_HELPER_H
+#define MVDASH_MPI_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+#include "mvdash-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Splits the clients of a scenario over MPI logical processes.
+ *
+ * Every rank builds the whole topology, but each client node belongs to one
+ * rank (its system id).  Clients are dealt out in contiguous blocks of
+ * ClientId, so rank r owns clients GetFirstClient (r) ..
+ * GetFirstClient (r) + GetNClients (r) - 1 and installs applications only on
+ * those.  Since the viewpoint model streams follow the ClientId, a client
+ * behaves the same whatever the number of ranks.
+ *
+ * Links between nodes of different ranks must have a non-zero delay; the
+ * smallest such delay is the lookahead of the distributed simulator.
+ */
+class mvdashMpiHelper
+{
+public:
+  /**
+   * \param nClients total number of clients of the scenario
+   */
+  mvdashMpiHelper (uint32_t nClients);
+
+  /**
+   * Select the distributed simulator and initialize MPI.  Must be called
+   * before any node is created.
+   */
+  static void Enable (int *argc, char ***argv);
+  /**
+   * Finalize MPI.  Call after Simulator::Destroy () and MergeClientLogs ().
+   */
+  static void Disable (void);
+
+  uint32_t GetSystemId (void) const { return m_systemId; }
+  uint32_t GetSystemCount (void) const { return m_systemCount; }
+
+  uint32_t GetFirstClient (uint32_t rank) const;
+  uint32_t GetNClients (uint32_t rank) const;
+  /**
+   * \param clientId global client index
+   * \returns the rank that owns the client
+   */
+  uint32_t GetClientRank (uint32_t clientId) const;
+
+  /**
+   * Create the client nodes, each with the system id of its owning rank.
+   * \returns all nClients nodes, in ClientId order
+   */
+  NodeContainer CreateClientNodes (void) const;
+  /**
+   * Install clients on the nodes owned by this rank only.
+   *
+   * \param helper the configured client helper
+   * \param clientNodes the nodes returned by CreateClientNodes ()
+   * \returns the local applications, in ClientId order
+   */
+  ApplicationContainer InstallClients (mvdashClientHelper &helper, NodeContainer clientNodes) const;
+
+  /**
+   * Wait for every rank to finish writing, then concatenate the per-client
+   * download, playback and buffer logs of simId into one file each, with the
+   * ClientId in a leading "client" column.  Rank 0 does the merge.
+   *
+   * \param path the directory of the client logs
+   * \param simId the SimId attribute of the clients
+   * \param removeParts delete the per-client files after merging
+   */
+  void MergeClientLogs (std::string path, uint32_t simId, bool removeParts) const;
+
+private:
+  void MergeLog (std::string path, std::string prefix, uint32_t simId, bool removeParts) const;
+
+  uint32_t m_nClients;
+  uint32_t m_systemId;
+  uint32_t m_systemCount;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_MPI_HELPER_H */
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-qoe-monitor.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashQoeMonitor");
+
+mvdashQoeMonitor::mvdashQoeMonitor ()
+{
+}
+
+void
+mvdashQoeMonitor::Install (const ApplicationContainer &clients)
+{
+  for (ApplicationContainer::Iterator i = clients.Begin (); i != clients.End (); ++i)
+    {
+      Ptr<mvdashClient> client = DynamicCast<mvdashClient> (*i);
+      if (!client)
+        {
+          continue;
+        }
+      TimeValue startTime;
+      client->GetAttribute ("StartTime", startTime);
+
+      m_clients[client->m_clientId] = NewAccumulator (startTime.Get ().GetMicroSeconds ());
+      client->TraceConnectWithoutContext ("ControllerTrace", MakeCallback (&mvdashQoeMonitor::ControllerEvent, this));
+      client->TraceConnectWithoutContext ("SegmentTrace", MakeCallback (&mvdashQoeMonitor::SegmentEvent, this));
+    }
+}
+
+void
+mvdashQoeMonitor::ControllerEvent (Ptr<const mvdashClient> client, controllerState state,
+                                   controllerTraceEvent ev, int32_t tIndex)
+{
+  std::map <uint32_t, st_qoeAccumulator>::iterator it = m_clients.find (client->m_clientId);
+  if (it == m_clients.end ())
+    {
+      return;
+    }
+  st_qoeAccumulator &acc = it->second;
+  int64_t now = Simulator::Now ().GetMicroSeconds ();
+
+  switch (ev)
+    {
+    case cteBufferUnderrun:
+      Stalled (acc, now);
+      break;
+    case cteStartPlayback:
+      {
+        // StartPlayback has just appended the segment to the playback record
+        const struct playbackDataGroup &play = client->GetPlaybackData ();
+        int32_t vp = play.mainViewpoint.back ();
+        Played (acc, client->GetVideoData (), vp, play.qualityIndex.back ()[vp], now);
+      }
+      break;
+    default:
+      break;
+    }
+}
+
+mvdashQoeMonitor::st_qoeAccumulator
+mvdashQoeMonitor::NewAccumulator (int64_t appStart)
+{
+  st_qoeAccumulator acc = {appStart, -1, 0, 0, -1, 0, 0.0, 0.0, 0.0,
+                           -1, 0, -1, 0.0, 0, 0};
+  return acc;
+}
+
+void
+mvdashQoeMonitor::Stalled (st_qoeAccumulator &acc, int64_t now)
+{
+  if (acc.stallStart < 0)
+    {
+      acc.stallStart = now;
+      acc.nStalls++;
+    }
+}
+
+void
+mvdashQoeMonitor::Played (st_qoeAccumulator &acc, const t_videoDataGroup &video, int32_t vp, int32_t quality, int64_t now)
+{
+  if (acc.stallStart >= 0)
+    {
+      acc.stallTime += now - acc.stallStart;
+      acc.stallStart = -1;
+    }
+  if (acc.firstPlayback < 0)
+    {
+      acc.firstPlayback = now;
+    }
+
+  double bitrate = video[vp].averageBitrate[quality];
+  if (acc.nPlayed > 0)
+    {
+      acc.switchMagnitudeSum += std::fabs (bitrate - acc.lastBitrate);
+    }
+  acc.bitrateSum += bitrate;
+  acc.lastBitrate = bitrate;
+  acc.nPlayed++;
+
+  if (acc.lastViewpoint >= 0 && vp != acc.lastViewpoint)
+    {
+      // A pending switch that never reached the top quality is dropped
+      acc.nViewpointSwitches++;
+      acc.switchTime = now;
+    }
+  acc.lastViewpoint = vp;
+  if (acc.switchTime >= 0 && quality + 1 == (int32_t) video[vp].averageBitrate.size ())
+    {
+      acc.switchToHqSum += now - acc.switchTime;
+      acc.nSwitchesToHq++;
+      acc.switchTime = -1;
+    }
+}
+
+void
+mvdashQoeMonitor::SegmentEvent (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo)
+{
+  if (ev != segev_endReceiving)
+    {
+      return;
+    }
+  std::map <uint32_t, st_qoeAccumulator>::iterator it = m_clients.find (client->m_clientId);
+  if (it != m_clients.end ())
+    {
+      it->second.bytesReceived += sinfo.segmentSize;
+    }
+}
+
+st_mvdashQoeSummary
+mvdashQoeMonitor::GetSummary (Ptr<const mvdashClient> client) const
+{
+  std::map <uint32_t, st_qoeAccumulator>::const_iterator it = m_clients.find (client->m_clientId);
+  if (it == m_clients.end ())
+    {
+      st_mvdashQoeSummary none = {-1, 0, 0, 0, 0.0, 0.0, 0, 0.0, 0};
+      return none;
+    }
+  return Summarize (it->second, Simulator::Now ().GetMicroSeconds ());
+}
+
+st_mvdashQoeSummary
+mvdashQoeMonitor::Summarize (const st_qoeAccumulator &acc, int64_t now)
+{
+  st_mvdashQoeSummary summary;
+  summary.startupDelay = acc.firstPlayback < 0 ? -1 : acc.firstPlayback - acc.appStart;
+  summary.nStalls = acc.nStalls;
+  summary.stallTime = acc.stallTime;
+  if (acc.stallStart >= 0)
+    {
+      // Still stalled
+      summary.stallTime += now - acc.stallStart;
+    }
+  summary.nPlayed = acc.nPlayed;
+  summary.meanBitrate = acc.nPlayed ? acc.bitrateSum / acc.nPlayed : 0.0;
+  summary.meanSwitchMagnitude = acc.nPlayed > 1 ? acc.switchMagnitudeSum / (acc.nPlayed - 1) : 0.0;
+  summary.nViewpointSwitches = acc.nViewpointSwitches;
+  summary.meanSwitchToHqLatency = acc.nSwitchesToHq ? acc.switchToHqSum / acc.nSwitchesToHq : 0.0;
+  summary.bytesReceived = acc.bytesReceived;
+  return summary;
+}
+
+void
+mvdashQoeMonitor::WriteHeader (std::ostream &os, std::string key)
+{
+  os << key << "\tstartup_ms\tstalls\tstall_ms\tplayed\tbitrate_kbps\tswitch_kbps\tvp_switches\tswitch_to_hq_ms\tbytes\n";
+}
+
+void
+mvdashQoeMonitor::WriteRow (std::ostream &os, std::string key, const st_mvdashQoeSummary &s)
+{
+  os << key << "\t" << s.startupDelay / 1000.0 << "\t" << s.nStalls
+     << "\t" << s.stallTime / 1000.0 << "\t" << s.nPlayed << "\t" << s.meanBitrate / 1000
+     << "\t" << s.meanSwitchMagnitude / 1000 << "\t" << s.nViewpointSwitches
+     << "\t" << s.meanSwitchToHqLatency / 1000 << "\t" << s.bytesReceived << "\n";
+}
+
+void
+mvdashQoeMonitor::Write (std::ostream &os) const
+{
+  int64_t now = Simulator::Now ().GetMicroSeconds ();
+  WriteHeader (os, "client");
+  for (std::map <uint32_t, st_qoeAccumulator>::const_iterator it = m_clients.begin ();
+       it != m_clients.end (); ++it)
+    {
+      WriteRow (os, std::to_string (it->first), Summarize (it->second, now));
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_QOE_MONITOR_H
+#define MVDASH_QOE_MONITOR_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include "ns3/application-container.h"
+#include "ns3/mvdash_client.h"
+
+namespace ns3 {
+
+/**
+ * \brief QoE summary of one client, accumulated while it plays.
+ */
+struct st_mvdashQoeSummary
+{
+  int64_t  startupDelay;      //!< microseconds from the application start to the first playback, -1 if none
+  uint32_t nStalls;
+  int64_t  stallTime;         //!< total stall duration in microseconds
+  uint32_t nPlayed;           //!< played segments
+  double   meanBitrate;       //!< mean bitrate of the played main view in bits per second
+  double   meanSwitchMagnitude; //!< mean |bitrate change| of the main view between consecutive segments
+  uint32_t nViewpointSwitches;
+  double   meanSwitchToHqLatency; //!< mean microseconds from a viewpoint switch to its first top-quality playback
+  uint64_t bytesReceived;     //!< unicast segment bytes received
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Online QoE accumulator fed by the ControllerTrace and SegmentTrace
+ *        sources of mvdashClient.
+ *
+ * Each client costs a fixed-size record: every playback and segment event
+ * updates running sums, so QoE is available without the per-segment CSV
+ * logs (set the client EnableLogs attribute to false).
+ */
+class mvdashQoeMonitor
+{
+public:
+  mvdashQoeMonitor ();
+
+  /**
+   * \brief Connect to the traces of the mvdashClient applications in clients
+   */
+  void Install (const ApplicationContainer &clients);
+
+  st_mvdashQoeSummary GetSummary (Ptr<const mvdashClient> client) const;
+  /**
+   * \brief Write a header and one tab separated row per installed client
+   */
+  void Write (std::ostream &os) const;
+
+  /// Running sums of one client
+  struct st_qoeAccumulator
+  {
+    int64_t  appStart;
+    int64_t  firstPlayback;     //!< -1 until the first playback
+    uint32_t nStalls;
+    int64_t  stallTime;
+    int64_t  stallStart;        //!< -1 when not stalled
+    uint32_t nPlayed;
+    double   bitrateSum;
+    double   lastBitrate;
+    double   switchMagnitudeSum;
+    int32_t  lastViewpoint;
+    uint32_t nViewpointSwitches;
+    int64_t  switchTime;        //!< time of the last viewpoint switch not yet played at top quality, -1 if none
+    double   switchToHqSum;
+    uint32_t nSwitchesToHq;
+    uint64_t bytesReceived;
+  };
+
+  /**
+   * The accumulator steps below are shared with players that run outside of
+   * a simulation; times are in microseconds.
+   */
+  static st_qoeAccumulator NewAccumulator (int64_t appStart);
+  /**
+   * \brief The buffer ran dry: a stall starts unless one is under way
+   */
+  static void Stalled (st_qoeAccumulator &acc, int64_t now);
+  /**
+   * \brief Segment playback starts with viewpoint vp as the main view at quality
+   */
+  static void Played (st_qoeAccumulator &acc, const t_videoDataGroup &video, int32_t vp, int32_t quality, int64_t now);
+  /**
+   * \param now the end of the session; an ongoing stall lasts up to it
+   */
+  static st_mvdashQoeSummary Summarize (const st_qoeAccumulator &acc, int64_t now);
+  static void WriteHeader (std::ostream &os, std::string key);
+  static void WriteRow (std::ostream &os, std::string key, const st_mvdashQoeSummary &s);
+
+private:
+  void ControllerEvent (Ptr<const mvdashClient> client, controllerState state, controllerTraceEvent ev, int32_t tIndex);
+  void SegmentEvent (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
+
+  std::map <uint32_t, st_qoeAccumulator> m_clients;   //!< by ClientId
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_QOE_MONITOR_H */
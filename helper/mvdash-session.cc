@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-session.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashSession");
+
+mvdashSession::mvdashSession (const t_videoDataGroup &videoData, MultiView_Model *viewModel, std::string algorithm)
+  : mvdashGroupController (videoData),
+    m_now (0),
+    m_playbackEnd (-1),
+    m_groupBytes (0),
+    m_qoe (mvdashQoeMonitor::NewAccumulator (0))
+{
+  m_nViewpoints = videoData.size ();
+  m_tIndexLast = videoData.empty () ? -1 : (int32_t) videoData[0].segmentSize[0].size () - 1;
+  m_layered = !videoData.empty () && !videoData[0].layerSize.empty ();
+  m_pViewModel = viewModel;
+  m_pAlgorithm = mvdashCreateAdaptationAlgorithm (algorithm, m_videoData, m_playData, m_bufferData, m_downData);
+  if (m_pAlgorithm)
+    {
+      m_pAlgorithm->SetClock (&m_now);
+    }
+}
+
+mvdashSession::~mvdashSession ()
+{
+  delete m_pAlgorithm;
+  delete m_pViewModel;
+}
+
+void
+mvdashSession::SetTiling (Ptr<Viewport_Model> viewport, double margin, int32_t outQuality)
+{
+  m_pViewportModel = viewport;
+  m_viewportMargin = margin;
+  m_nTiles = m_videoData.empty () ? 0 : m_videoData[0].tileColumns * m_videoData[0].tileRows;
+  m_tileAllocator.SetOutOfViewportQuality (outQuality);
+}
+
+bool
+mvdashSession::Start (int64_t now)
+{
+  NS_LOG_FUNCTION (this << now);
+  if (!m_pViewModel || !m_pAlgorithm || m_tIndexLast < 0 || m_state != initial
+      || (m_pViewportModel && m_nTiles == 0))
+    {
+      return false;
+    }
+  m_now = now;
+  m_qoe = mvdashQoeMonitor::NewAccumulator (now);
+  m_pViewModel->UpdateViewpoint (0, m_now);
+  Controller (init);
+  return true;
+}
+
+void
+mvdashSession::DownloadStarted (int64_t now)
+{
+  if (!m_downData.time.empty ())
+    {
+      m_downData.time.back ().downloadStart = now;
+    }
+}
+
+void
+mvdashSession::DownloadFinished (int64_t now)
+{
+  m_now = now;
+  st_requestTimeInfo &tinfo = m_downData.time.back ();
+  if (tinfo.downloadStart < tinfo.requestSent)
+    {
+      // No DownloadStarted: count the download from the request
+      tinfo.downloadStart = tinfo.requestSent;
+    }
+  m_qoe.bytesReceived += m_groupBytes;
+  GroupFinished (m_downData.id.size () - 1, m_tIndexReqSent);
+}
+
+void
+mvdashSession::PlaybackFinished (int64_t now)
+{
+  m_now = now;
+  m_playbackEnd = -1;
+  Controller (playbackFinished);
+}
+
+bool
+mvdashSession::SendGroup (const std::vector <st_mvdashRequest> &requests)
+{
+  m_groupBytes = 0;
+  for (const st_mvdashRequest &req : requests)
+    {
+      m_groupBytes += req.segmentSize;
+    }
+  SendRequests (requests);
+  return true;
+}
+
+void
+mvdashSession::PlaybackStarted (void)
+{
+  m_playbackEnd = m_now + m_videoData[0].segmentDuration;
+}
+
+void
+mvdashSession::TraceController (controllerTraceEvent event, int32_t tIndex)
+{
+  if (event == cteStartPlayback)
+    {
+      int32_t vp = m_playData.mainViewpoint.back ();
+      mvdashQoeMonitor::Played (m_qoe, m_videoData, vp, m_playData.qualityIndex.back ()[vp], m_now);
+    }
+  else if (event == cteBufferUnderrun)
+    {
+      mvdashQoeMonitor::Stalled (m_qoe, m_now);
+    }
+}
+
+} // namespace ns3
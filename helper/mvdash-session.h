@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_SESSION_H
+#define MVDASH_SESSION_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/mvdash.h"
+#include "ns3/mvdash_group_controller.h"
+#include "mvdash-qoe-monitor.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup etri_mvdash
+ * \brief The group controller of mvdashClient on an external clock and transport.
+ *
+ * The session runs mvdashGroupController, as mvdashClient does in the
+ * group buffer mode, and accounts the QoE of what plays.  A subclass
+ * carries the requests of a group, and its driver reports, with the time in
+ * microseconds, when the group is in and when the segment playing ends.
+ */
+class mvdashSession : public mvdashGroupController
+{
+public:
+  /**
+   * \param videoData the manifest; kept by reference and only read
+   * \param viewModel the viewpoint model, owned by the session from now on
+   * \param algorithm the adaptation algorithm name, as the client MVAlgo attribute
+   */
+  mvdashSession (const t_videoDataGroup &videoData, MultiView_Model *viewModel, std::string algorithm);
+  virtual ~mvdashSession ();
+
+  /**
+   * \brief Request every viewpoint as tiles, those expected in the viewport
+   *        at the quality of the viewpoint, as mvdashClient does for tiled video
+   * \param viewport the viewport model, with its streams assigned
+   * \param margin degrees added around the current viewport
+   * \param outQuality the quality of the tiles outside
+   *
+   * Call before Start; videoData must be tiled.
+   */
+  void SetTiling (Ptr<Viewport_Model> viewport, double margin, int32_t outQuality);
+
+  /**
+   * \brief Draw the first viewpoint and request the first group
+   * \returns false if the viewpoint model or the algorithm is missing, or the session started already
+   */
+  bool Start (int64_t now);
+  /**
+   * \brief The first byte of the group requested last arrived
+   */
+  void DownloadStarted (int64_t now);
+  /**
+   * \brief Every byte of the group requested last is in
+   */
+  void DownloadFinished (int64_t now);
+  /**
+   * \brief The segment playing ends; the driver calls it at GetPlaybackEnd
+   */
+  void PlaybackFinished (int64_t now);
+
+  /// End of the segment playing, -1 if none
+  int64_t GetPlaybackEnd (void) const { return m_playbackEnd; }
+  bool IsFinished (void) const { return m_state == terminal; }
+  /// Bytes of the group requested last
+  int64_t GetGroupBytes (void) const { return m_groupBytes; }
+
+  st_mvdashQoeSummary GetSummary (int64_t now) const { return mvdashQoeMonitor::Summarize (m_qoe, now); }
+
+protected:
+  /**
+   * \brief Carry the requests of a group, one per viewpoint, per tile or per layer
+   *
+   * Called from within Start and DownloadFinished; the session expects
+   * DownloadFinished once GetGroupBytes bytes are in.
+   */
+  virtual void SendRequests (const std::vector <st_mvdashRequest> &requests) = 0;
+
+  int64_t  m_now;               //!< the session clock, in microseconds
+
+private:
+  // mvdashGroupController
+  virtual int64_t GetTimeNow (void) const { return m_now; }
+  virtual bool SendGroup (const std::vector <st_mvdashRequest> &requests);
+  virtual void PlaybackStarted (void);
+  virtual void TraceController (controllerTraceEvent event, int32_t tIndex);
+
+  int64_t  m_playbackEnd;
+  int64_t  m_groupBytes;
+  mvdashQoeMonitor::st_qoeAccumulator m_qoe;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_SESSION_H */
@@ -0,0 +1,410 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-topology-helper.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/data-rate.h"
+#include "ns3/error-model.h"
+#include "ns3/abort.h"
+#include "ns3/ipv4.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashTopologyHelper");
+
+static void
+SetFluidLinkRate (Ptr<mvdashFluidNetwork> network, uint32_t link, uint64_t bps)
+{
+  network->SetLinkRate (link, bps);
+}
+
+mvdashTopologyHelper::mvdashTopologyHelper ()
+  : m_accessRate ("100Mbps"),
+    m_accessDelay ("5ms"),
+    m_csma (false),
+    m_lanSize (250),
+    m_staticRouting (false),
+    m_fluidBottleneck (0)
+{
+  SetBottleneck ("5Mbps", "40ms");
+  SetServerLink ("100Mbps", "5ms");
+  m_traceFactory.SetTypeId (mvdashBandwidthTrace::GetTypeId ());
+  m_tracePick = CreateObject<UniformRandomVariable> ();
+}
+
+void
+mvdashTopologyHelper::SetBottleneck (std::string rate, std::string delay)
+{
+  m_bottleneckRate = rate;
+  m_bottleneckDelay = delay;
+  m_bottleneck.SetDeviceAttribute ("DataRate", StringValue (rate));
+  m_bottleneck.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+void
+mvdashTopologyHelper::SetServerLink (std::string rate, std::string delay)
+{
+  m_serverRate = rate;
+  m_serverDelay = delay;
+  m_serverLink.SetDeviceAttribute ("DataRate", StringValue (rate));
+  m_serverLink.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+void
+mvdashTopologyHelper::SetAccessLink (std::string rate, std::string delay)
+{
+  m_accessRate = rate;
+  m_accessDelay = delay;
+}
+
+void
+mvdashTopologyHelper::SetAccessType (std::string type, uint32_t lanSize)
+{
+  NS_ABORT_MSG_IF (type != "p2p" && type != "csma", "Unknown access type " << type);
+  NS_ABORT_MSG_IF (lanSize == 0, "A LAN holds at least one client");
+  m_csma = (type == "csma");
+  m_lanSize = lanSize;
+}
+
+void
+mvdashTopologyHelper::SetStaticRouting (bool staticRouting)
+{
+  m_staticRouting = staticRouting;
+}
+
+void
+mvdashTopologyHelper::SetFluidNetwork (Ptr<mvdashFluidNetwork> network)
+{
+  m_fluid = network;
+}
+
+void
+mvdashTopologyHelper::AddAccessTrace (std::string path)
+{
+  m_tracePool.push_back (path);
+}
+
+void
+mvdashTopologyHelper::SetTraceAttribute (std::string name, const AttributeValue &value)
+{
+  m_traceFactory.Set (name, value);
+}
+
+void
+mvdashTopologyHelper::SetAccessRate (Ptr<RandomVariableStream> mbps)
+{
+  m_rateVariable = mbps;
+}
+
+void
+mvdashTopologyHelper::SetAccessDelay (Ptr<RandomVariableStream> ms)
+{
+  m_delayVariable = ms;
+}
+
+void
+mvdashTopologyHelper::SetAccessLoss (Ptr<RandomVariableStream> lossRate)
+{
+  m_lossVariable = lossRate;
+}
+
+int64_t
+mvdashTopologyHelper::AssignStreams (int64_t stream)
+{
+  int64_t n = 0;
+  m_tracePick->SetStream (stream + n++);
+  Ptr<RandomVariableStream> variables[] = {m_rateVariable, m_delayVariable, m_lossVariable};
+  for (Ptr<RandomVariableStream> v : variables)
+    {
+      if (v)
+        {
+          v->SetStream (stream + n++);
+        }
+    }
+  return n;
+}
+
+int64_t
+mvdashTopologyHelper::AssignLossStreams (int64_t stream)
+{
+  int64_t n = 0;
+  for (st_mvdashAccessLink &link : m_accessLinks)
+    {
+      if (link.errorModel)
+        {
+          n += link.errorModel->AssignStreams (stream + n);
+        }
+    }
+  return n;
+}
+
+st_mvdashAccessLink
+mvdashTopologyHelper::DrawAccessLink (void)
+{
+  st_mvdashAccessLink link;
+  if (!m_tracePool.empty ())
+    {
+      link.trace = m_tracePool[m_tracePick->GetInteger (0, m_tracePool.size () - 1)];
+    }
+  // A link needs some rate to serialize packets; 1 kbps stands for an outage
+  link.rate = m_rateVariable ? (uint64_t) (std::max (m_rateVariable->GetValue (), 0.001) * 1000000)
+                             : DataRate (m_accessRate).GetBitRate ();
+  link.delay = m_delayVariable ? MicroSeconds ((int64_t) (std::max (m_delayVariable->GetValue (), 0.0) * 1000))
+                               : Time (m_accessDelay);
+  link.lossRate = m_lossVariable ? std::min (std::max (m_lossVariable->GetValue (), 0.0), 1.0) : 0.0;
+  return link;
+}
+
+void
+mvdashTopologyHelper::Build (uint32_t nClients)
+{
+  NS_LOG_FUNCTION (this << nClients);
+  m_routers.Create (2);
+  m_server.Create (1);
+  m_clients.Create (nClients);
+  m_accessLinks.clear ();
+  m_accessLinks.reserve (nClients);
+  if (m_fluid)
+    {
+      BuildFluid (nClients);
+      return;
+    }
+
+  InternetStackHelper stack;
+  stack.Install (m_routers);
+  stack.Install (m_server);
+  stack.Install (m_clients);
+
+  m_bottleneckDevices = m_bottleneck.Install (m_routers.Get (0), m_routers.Get (1));
+  m_serverDevices = m_serverLink.Install (m_server.Get (0), m_routers.Get (0));
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  m_bottleneckInterfaces = address.Assign (m_bottleneckDevices);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer serverInterfaces = address.Assign (m_serverDevices);
+  m_serverAddress = serverInterfaces.GetAddress (0);
+
+  if (m_csma)
+    {
+      BuildCsmaAccess (nClients);
+    }
+  else
+    {
+      BuildPointToPointAccess (nClients);
+    }
+
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      st_mvdashAccessLink &link = m_accessLinks[i];
+      if (link.lossRate > 0)
+        {
+          Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+          em->SetAttribute ("ErrorRate", DoubleValue (link.lossRate));
+          em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+          link.devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+          link.errorModel = em;
+        }
+      if (link.trace.empty ())
+        {
+          continue;
+        }
+      // Traces drive the router side, towards the client
+      Ptr<mvdashBandwidthTrace> replay = m_traceFactory.Create<mvdashBandwidthTrace> ();
+      if (replay->Install (link.trace, link.devices.Get (0)))
+        {
+          link.replay = replay;
+        }
+      else
+        {
+          NS_LOG_ERROR ("Access link of client " << i << " keeps a fixed rate");
+        }
+    }
+
+  if (m_staticRouting)
+    {
+      AddStaticRoutes (m_bottleneckInterfaces, serverInterfaces);
+    }
+}
+
+void
+mvdashTopologyHelper::BuildPointToPointAccess (uint32_t nClients)
+{
+  PointToPointHelper access;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.128.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      st_mvdashAccessLink link = DrawAccessLink ();
+      access.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (link.rate)));
+      access.SetChannelAttribute ("Delay", TimeValue (link.delay));
+      link.devices = access.Install (m_routers.Get (1), m_clients.Get (i));
+      Ipv4InterfaceContainer interfaces = address.Assign (link.devices);
+      link.gateway = interfaces.GetAddress (0);
+      link.address = interfaces.GetAddress (1);
+      address.NewNetwork ();
+      m_accessLinks.push_back (link);
+    }
+}
+
+void
+mvdashTopologyHelper::BuildCsmaAccess (uint32_t nClients)
+{
+  if (!m_tracePool.empty () || m_rateVariable || m_delayVariable)
+    {
+      NS_LOG_WARN ("Access traces and per-client rates and delays are ignored on CSMA LANs");
+    }
+  CsmaHelper lan;
+  lan.SetChannelAttribute ("DataRate", StringValue (m_accessRate));
+  lan.SetChannelAttribute ("Delay", StringValue (m_accessDelay));
+
+  // Smallest subnet holding the clients, the router, the network and the broadcast addresses
+  uint32_t hostBits = 2;
+  while ((1u << hostBits) < m_lanSize + 3)
+    {
+      hostBits++;
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.128.0.0", Ipv4Mask (~((1u << hostBits) - 1)));
+
+  for (uint32_t first = 0; first < nClients; first += m_lanSize)
+    {
+      uint32_t last = std::min (first + m_lanSize, nClients);
+      NodeContainer members (m_routers.Get (1));
+      for (uint32_t i = first; i < last; i++)
+        {
+          members.Add (m_clients.Get (i));
+        }
+      NetDeviceContainer devices = lan.Install (members);
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      for (uint32_t i = first; i < last; i++)
+        {
+          st_mvdashAccessLink link = DrawAccessLink ();
+          link.trace.clear ();
+          link.rate = DataRate (m_accessRate).GetBitRate ();
+          link.delay = Time (m_accessDelay);
+          link.devices.Add (devices.Get (0));
+          link.devices.Add (devices.Get (1 + i - first));
+          link.gateway = interfaces.GetAddress (0);
+          link.address = interfaces.GetAddress (1 + i - first);
+          m_accessLinks.push_back (link);
+        }
+    }
+}
+
+void
+mvdashTopologyHelper::BuildFluid (uint32_t nClients)
+{
+  if (m_lossVariable)
+    {
+      NS_LOG_WARN ("Access loss is not modelled by the fluid network");
+    }
+  uint32_t serverLink = m_fluid->AddLink (DataRate (m_serverRate).GetBitRate ());
+  m_fluidBottleneck = m_fluid->AddLink (DataRate (m_bottleneckRate).GetBitRate ());
+  Time coreDelay = Time (m_serverDelay) + Time (m_bottleneckDelay);
+  std::vector <uint32_t> path (3);
+  path[0] = serverLink;
+  path[1] = m_fluidBottleneck;
+
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      st_mvdashAccessLink link = DrawAccessLink ();
+      link.lossRate = 0;
+      if (m_csma)
+        {
+          // One shared link per LAN
+          link.trace.clear ();
+          link.rate = DataRate (m_accessRate).GetBitRate ();
+          link.delay = Time (m_accessDelay);
+          if (i % m_lanSize == 0)
+            {
+              path[2] = m_fluid->AddLink (link.rate);
+            }
+        }
+      else
+        {
+          path[2] = m_fluid->AddLink (link.rate);
+        }
+      m_fluid->SetPath (m_clients.Get (i), path, coreDelay + link.delay);
+
+      if (!link.trace.empty ())
+        {
+          Ptr<mvdashBandwidthTrace> replay = m_traceFactory.Create<mvdashBandwidthTrace> ();
+          if (replay->Install (link.trace, MakeBoundCallback (&SetFluidLinkRate, m_fluid, path[2])))
+            {
+              link.replay = replay;
+            }
+        }
+      m_accessLinks.push_back (link);
+    }
+}
+
+Ptr<mvdashBandwidthTrace>
+mvdashTopologyHelper::ReplayBottleneck (std::string path, Time stopTime)
+{
+  if (m_fluid)
+    {
+      return mvdashBandwidthTrace::Replay (path, MakeBoundCallback (&SetFluidLinkRate, m_fluid, m_fluidBottleneck), stopTime);
+    }
+  return mvdashBandwidthTrace::Replay (path, m_bottleneckDevices.Get (0), stopTime);
+}
+
+void
+mvdashTopologyHelper::AddStaticRoutes (const Ipv4InterfaceContainer &bottleneck, const Ipv4InterfaceContainer &server)
+{
+  Ipv4StaticRoutingHelper routing;
+  Ptr<Ipv4> ipv4 = m_server.Get (0)->GetObject<Ipv4> ();
+  routing.GetStaticRouting (ipv4)->SetDefaultRoute (server.GetAddress (1), ipv4->GetInterfaceForAddress (m_serverAddress));
+
+  ipv4 = m_routers.Get (0)->GetObject<Ipv4> ();
+  routing.GetStaticRouting (ipv4)->AddNetworkRouteTo (Ipv4Address ("10.128.0.0"), Ipv4Mask ("255.128.0.0"),
+                                                      bottleneck.GetAddress (1),
+                                                      ipv4->GetInterfaceForAddress (bottleneck.GetAddress (0)));
+  ipv4 = m_routers.Get (1)->GetObject<Ipv4> ();
+  routing.GetStaticRouting (ipv4)->SetDefaultRoute (bottleneck.GetAddress (0),
+                                                    ipv4->GetInterfaceForAddress (bottleneck.GetAddress (1)));
+
+  for (uint32_t i = 0; i < m_accessLinks.size (); i++)
+    {
+      const st_mvdashAccessLink &link = m_accessLinks[i];
+      ipv4 = m_clients.Get (i)->GetObject<Ipv4> ();
+      routing.GetStaticRouting (ipv4)->SetDefaultRoute (link.gateway, ipv4->GetInterfaceForAddress (link.address));
+    }
+}
+
+void
+mvdashTopologyHelper::WriteAccessLinks (std::ostream &os) const
+{
+  os << "client\ttrace\trate_kbps\tdelay_ms\tloss\trate_changes\n";
+  for (uint32_t i = 0; i < m_accessLinks.size (); i++)
+    {
+      const st_mvdashAccessLink &link = m_accessLinks[i];
+      os << i << "\t" << (link.trace.empty () ? "-" : link.trace) << "\t" << link.rate / 1000
+         << "\t" << link.delay.GetMicroSeconds () / 1000.0 << "\t" << link.lossRate
+         << "\t" << (link.replay ? link.replay->GetNChanges () : 0) << "\n";
+    }
+}
+
+} // namespace ns3
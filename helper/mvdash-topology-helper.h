@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_TOPOLOGY_HELPER_H
+#define MVDASH_TOPOLOGY_HELPER_H
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/error-model.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/mvdash-bandwidth-trace.h"
+#include "ns3/mvdash_fluid_network.h"
+
+namespace ns3 {
+
+/**
+ * \brief The access link drawn for one client.
+ */
+struct st_mvdashAccessLink
+{
+  std::string trace;          //!< bandwidth trace replayed towards the client, empty for a fixed rate
+  uint64_t rate;              //!< initial rate in bits per second
+  Time     delay;
+  double   lossRate;          //!< packet loss rate towards the client
+  NetDeviceContainer devices; //!< router side, client side
+  Ipv4Address address;        //!< of the client
+  Ipv4Address gateway;        //!< router side address of the access network
+  Ptr<mvdashBandwidthTrace> replay;
+  Ptr<RateErrorModel> errorModel;   //!< on the client side, if lossRate is set
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Build the dumbbell of the examples: server - router - bottleneck -
+ *        router - one access link per client.
+ *
+ * Access links are uniform (AccessRate/AccessDelay) unless a trace pool or
+ * a distribution is given, in which case every client draws its own:
+ *
+ * - AddAccessTrace: each client replays a trace picked uniformly from the
+ *   pool on the router side of its access link, with mvdashBandwidthTrace,
+ *   so only the next change of each trace is pending;
+ * - SetAccessRate, SetAccessDelay, SetAccessLoss: rate in Mbps, one-way
+ *   delay in milliseconds and packet loss rate, drawn per client.
+ *
+ * The draws only depend on the streams given by AssignStreams, so two runs
+ * with the same streams build the same population; the losses depend on
+ * those given by AssignLossStreams once it is built.
+ *
+ * For large populations, SetAccessType ("csma") puts up to LanSize clients
+ * on each shared LAN behind the access router instead of one link each:
+ * one channel and one subnet per LAN rather than per client.  Clients of
+ * a LAN share its rate and delay, so traces and per-client rate and delay
+ * draws apply to point-to-point access only; loss is still drawn per
+ * client.  Clients are addressed in blocks out of 10.128.0.0/9, a /30 per
+ * point-to-point link or the smallest subnet holding a LAN, so the access
+ * router side is one aggregate route.  With SetStaticRouting, Build fills
+ * the routing tables itself (default routes towards the server, the
+ * aggregate on the server side) and global routing can be skipped: its
+ * cost grows with the square of the number of nodes.
+ *
+ * With SetFluidNetwork, Build creates the nodes only and mirrors every link
+ * (a CSMA LAN being one shared link) in the mvdashFluidNetwork, with the
+ * path and one-way delay of each client; no Internet stack is installed and
+ * the clients must be given the network through their FluidNetwork
+ * attribute.  Loss is not modelled there.
+ */
+class mvdashTopologyHelper
+{
+public:
+  mvdashTopologyHelper ();
+
+  void SetBottleneck (std::string rate, std::string delay);
+  void SetServerLink (std::string rate, std::string delay);
+  /**
+   * \brief Rate and delay of the access links, unless drawn per client
+   */
+  void SetAccessLink (std::string rate, std::string delay);
+  /**
+   * \param type p2p, one link per client, or csma, shared LANs
+   * \param lanSize the number of clients per LAN with csma
+   */
+  void SetAccessType (std::string type, uint32_t lanSize = 250);
+  void SetStaticRouting (bool staticRouting);
+  /**
+   * \brief Build the links in network instead of as packet-level devices
+   */
+  void SetFluidNetwork (Ptr<mvdashFluidNetwork> network);
+  Ptr<mvdashFluidNetwork> GetFluidNetwork (void) const { return m_fluid; }
+
+  /**
+   * \brief Add a bandwidth trace to the pool the access links pick from
+   */
+  void AddAccessTrace (std::string path);
+  /**
+   * \brief Set an attribute of the mvdashBandwidthTrace of every access link
+   */
+  void SetTraceAttribute (std::string name, const AttributeValue &value);
+  void SetAccessRate (Ptr<RandomVariableStream> mbps);
+  void SetAccessDelay (Ptr<RandomVariableStream> ms);
+  void SetAccessLoss (Ptr<RandomVariableStream> lossRate);
+
+  /**
+   * \returns the number of streams used by the per-client draws
+   */
+  int64_t AssignStreams (int64_t stream);
+  /**
+   * \brief Assign the streams of the error models of the lossy access links, after Build
+   * \returns the number of streams used, one per lossy access link
+   */
+  int64_t AssignLossStreams (int64_t stream);
+
+  /**
+   * \brief Create the nodes and links, install the Internet stack and assign
+   *        the addresses: 10.1.1.0/24 for the bottleneck, 10.1.2.0/24 for
+   *        the server and the clients out of 10.128.0.0/9
+   */
+  void Build (uint32_t nClients);
+
+  Ptr<Node> GetServer (void) const { return m_server.Get (0); }
+  Ipv4Address GetServerAddress (void) const { return m_serverAddress; }
+  const NodeContainer & GetClients (void) const { return m_clients; }
+  const NodeContainer & GetRouters (void) const { return m_routers; }
+  /// The bottleneck devices, server side first
+  const NetDeviceContainer & GetBottleneckDevices (void) const { return m_bottleneckDevices; }
+  /// The addresses of the bottleneck devices, server side first
+  const Ipv4InterfaceContainer & GetBottleneckInterfaces (void) const { return m_bottleneckInterfaces; }
+  /// The server link devices, server first
+  const NetDeviceContainer & GetServerDevices (void) const { return m_serverDevices; }
+  const st_mvdashAccessLink & GetAccessLink (uint32_t i) const { return m_accessLinks.at (i); }
+
+  /**
+   * \brief Replay a rate trace on the bottleneck, towards the clients, up to stopTime
+   * \returns the trace object, null if the file cannot be read
+   */
+  Ptr<mvdashBandwidthTrace> ReplayBottleneck (std::string path, Time stopTime);
+
+  /**
+   * \brief Write a header and one tab separated row per access link
+   */
+  void WriteAccessLinks (std::ostream &os) const;
+
+private:
+  st_mvdashAccessLink DrawAccessLink (void);
+  void BuildPointToPointAccess (uint32_t nClients);
+  void BuildCsmaAccess (uint32_t nClients);
+  void BuildFluid (uint32_t nClients);
+  void AddStaticRoutes (const Ipv4InterfaceContainer &bottleneck, const Ipv4InterfaceContainer &server);
+
+  PointToPointHelper m_bottleneck;
+  PointToPointHelper m_serverLink;
+  std::string   m_bottleneckRate;
+  std::string   m_bottleneckDelay;
+  std::string   m_serverRate;
+  std::string   m_serverDelay;
+  std::string   m_accessRate;
+  std::string   m_accessDelay;
+  bool          m_csma;
+  uint32_t      m_lanSize;
+  bool          m_staticRouting;
+  Ptr<mvdashFluidNetwork> m_fluid;
+  uint32_t      m_fluidBottleneck;  //!< bottleneck link id in m_fluid
+  std::vector <std::string> m_tracePool;
+  ObjectFactory m_traceFactory;
+  Ptr<UniformRandomVariable> m_tracePick;
+  Ptr<RandomVariableStream>  m_rateVariable;
+  Ptr<RandomVariableStream>  m_delayVariable;
+  Ptr<RandomVariableStream>  m_lossVariable;
+
+  NodeContainer m_routers;
+  NodeContainer m_server;
+  NodeContainer m_clients;
+  NetDeviceContainer m_bottleneckDevices;
+  Ipv4InterfaceContainer m_bottleneckInterfaces;
+  NetDeviceContainer m_serverDevices;
+  Ipv4Address   m_serverAddress;
+  std::vector <st_mvdashAccessLink> m_accessLinks;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_TOPOLOGY_HELPER_H */
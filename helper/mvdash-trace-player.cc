@@ -0,0 +1,366 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-trace-player.h"
+#include "mvdash-bandwidth-trace.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/mvdash_manifest.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashTracePlayer");
+
+NS_OBJECT_ENSURE_REGISTERED (mvdashPlayerEvaluator);
+
+/// Random streams per viewpoint model, as in mvdashClient
+static const int64_t VIEW_MODEL_STREAMS = 2;
+
+mvdashTracePlayer::mvdashTracePlayer (const t_videoDataGroup &videoData, const t_mvdashRateChanges &bandwidth,
+                                      MultiView_Model *viewModel, std::string algorithm)
+  : mvdashSession (videoData, viewModel, algorithm),
+    m_bandwidth (bandwidth),
+    m_initialRate (5000000),
+    m_rtt (20000),
+    m_efficiency (1.0),
+    m_stopTime (0),
+    m_downloadStart (-1),
+    m_downloadEnd (-1)
+{
+  m_summary = mvdashSession::GetSummary (0);
+}
+
+mvdashTracePlayer::~mvdashTracePlayer ()
+{
+}
+
+void
+mvdashTracePlayer::Configure (uint64_t initialRate, int64_t rtt, double efficiency, int64_t stopTime)
+{
+  m_initialRate = initialRate;
+  m_rtt = rtt;
+  m_efficiency = efficiency;
+  m_stopTime = stopTime;
+}
+
+bool
+mvdashTracePlayer::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!Start (0))
+    {
+      return false;
+    }
+
+  // Two events at most are pending: the end of a download and the end of a playback
+  while (m_downloadEnd >= 0 || GetPlaybackEnd () >= 0)
+    {
+      int64_t playbackEnd = GetPlaybackEnd ();
+      bool download = m_downloadEnd >= 0 && (playbackEnd < 0 || m_downloadEnd <= playbackEnd);
+      int64_t next = download ? m_downloadEnd : playbackEnd;
+      if (m_stopTime > 0 && next > m_stopTime)
+        {
+          m_now = m_stopTime;
+          break;
+        }
+      if (download)
+        {
+          m_downloadEnd = -1;
+          DownloadStarted (m_downloadStart);
+          DownloadFinished (next);
+        }
+      else
+        {
+          PlaybackFinished (next);
+        }
+    }
+  m_summary = mvdashSession::GetSummary (m_now);
+  return true;
+}
+
+void
+mvdashTracePlayer::SendRequests (const std::vector <st_mvdashRequest> &requests)
+{
+  // The request reaches the server half a round trip later; the last byte
+  // arrives half a round trip after the server is done
+  m_downloadEnd = TransferEnd (m_now + m_rtt / 2, GetGroupBytes ()) + m_rtt / 2;
+  m_downloadStart = std::min (m_now + m_rtt, m_downloadEnd);
+}
+
+int64_t
+mvdashTracePlayer::TransferEnd (int64_t start, int64_t bytes) const
+{
+  // The change in force at start is the last one not after it
+  t_mvdashRateChanges::const_iterator it =
+    std::upper_bound (m_bandwidth.begin (), m_bandwidth.end (), std::make_pair (start, std::numeric_limits<uint64_t>::max ()));
+  double rate = (it == m_bandwidth.begin () ? m_initialRate : (it - 1)->second) * m_efficiency / 1e6;   // bits per microsecond
+  double bits = bytes * 8.0;
+  int64_t time = start;
+  for (; it != m_bandwidth.end (); ++it)
+    {
+      double served = rate * (it->first - time);
+      if (bits <= served)
+        {
+          break;
+        }
+      bits -= served;
+      time = it->first;
+      rate = it->second * m_efficiency / 1e6;
+    }
+  return time + (int64_t) std::ceil (bits / rate);
+}
+
+// ===========================================================================================
+
+TypeId
+mvdashPlayerEvaluator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::mvdashPlayerEvaluator")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<mvdashPlayerEvaluator> ()
+    .AddAttribute ("MVInfo",
+                   "The relative path to the file containing the Multi-View Video Source Info",
+                   StringValue ("./contrib/etri_mvdash/multiviewvideo.csv"),
+                   MakeStringAccessor (&mvdashPlayerEvaluator::m_mvInfoFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("VPInfo",
+                   "The viewpoint model parameters, or the viewpoint trace, of jobs that give none",
+                   StringValue ("./contrib/etri_mvdash/viewpoint_transition.csv"),
+                   MakeStringAccessor (&mvdashPlayerEvaluator::m_vpInfoFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("VPModel",
+                   "The View-point Switching Model: markovian, free or trace",
+                   StringValue ("markovian"),
+                   MakeStringAccessor (&mvdashPlayerEvaluator::m_vpModelName),
+                   MakeStringChecker ())
+    .AddAttribute ("MVAlgo",
+                   "The Multi-View Video Streaming Adaptation Algorithm",
+                   StringValue ("maximize_current"),
+                   MakeStringAccessor (&mvdashPlayerEvaluator::m_mvAlgoName),
+                   MakeStringChecker ())
+    .AddAttribute ("Format",
+                   "The bandwidth trace format: rate or mahimahi",
+                   StringValue ("rate"),
+                   MakeStringAccessor (&mvdashPlayerEvaluator::m_formatName),
+                   MakeStringChecker ())
+    .AddAttribute ("Loop",
+                   "Restart the bandwidth traces at their end, as the mvdashBandwidthTrace Loop attribute",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&mvdashPlayerEvaluator::m_loop),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DataRate",
+                   "The bottleneck rate before the first change of a trace",
+                   DataRateValue (DataRate ("5Mbps")),
+                   MakeDataRateAccessor (&mvdashPlayerEvaluator::m_initialRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Rtt",
+                   "The round-trip time of a request",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&mvdashPlayerEvaluator::m_rtt),
+                   MakeTimeChecker ())
+    .AddAttribute ("Efficiency",
+                   "Share of the bottleneck rate that segment bytes get",
+                   DoubleValue (0.97),
+                   MakeDoubleAccessor (&mvdashPlayerEvaluator::m_efficiency),
+                   MakeDoubleChecker<double> (0.01, 1.0))
+    .AddAttribute ("StopTime",
+                   "Sessions are cut at this time; zero for ten times the content duration",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&mvdashPlayerEvaluator::m_stopTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("Threads",
+                   "Worker threads; zero for one per hardware thread",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashPlayerEvaluator::m_nThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+mvdashPlayerEvaluator::mvdashPlayerEvaluator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+mvdashPlayerEvaluator::~mvdashPlayerEvaluator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+mvdashPlayerEvaluator::AddJob (std::string bwTrace, uint32_t seed, std::string vpInfo)
+{
+  st_evaluationJob job;
+  job.bwTrace = bwTrace;
+  job.vpInfo = vpInfo;
+  job.seed = seed;
+  job.done = false;
+  job.summary = mvdashQoeMonitor::Summarize (mvdashQoeMonitor::NewAccumulator (0), 0);
+  m_jobs.push_back (job);
+  return m_jobs.size () - 1;
+}
+
+void
+mvdashPlayerEvaluator::AddJobs (const std::vector<std::string> &bwTraces, uint32_t nSeeds)
+{
+  for (const std::string &trace : bwTraces)
+    {
+      for (uint32_t seed = 0; seed < nSeeds; seed++)
+        {
+          AddJob (trace, seed);
+        }
+    }
+}
+
+const t_mvdashRateChanges *
+mvdashPlayerEvaluator::LoadTrace (std::string path)
+{
+  std::map <std::string, t_mvdashRateChanges>::iterator it = m_traces.find (path);
+  if (it != m_traces.end ())
+    {
+      return &it->second;
+    }
+  t_mvdashRateChanges &changes = m_traces[path];
+  if (path.empty ())
+    {
+      return &changes;
+    }
+  Ptr<mvdashBandwidthTrace> trace = CreateObject<mvdashBandwidthTrace> ();
+  trace->SetAttribute ("Format", StringValue (m_formatName));
+  trace->SetAttribute ("Loop", BooleanValue (m_loop));
+  if (!trace->Load (path, m_stopTime, changes))
+    {
+      m_traces.erase (path);
+      return 0;
+    }
+  return &changes;
+}
+
+bool
+mvdashPlayerEvaluator::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_initialRate.GetBitRate () == 0, "mvdashPlayerEvaluator needs a non-zero DataRate");
+  if (m_videoData.empty ())
+    {
+      int32_t nSegments = mvdashReadManifest (m_mvInfoFilePath, m_videoData);
+      if (nSegments <= 0)
+        {
+          NS_LOG_ERROR ("Manifest " << m_mvInfoFilePath << " cannot be read");
+          m_videoData.clear ();
+          return false;
+        }
+      if (m_stopTime.IsZero ())
+        {
+          m_stopTime = MicroSeconds (10 * nSegments * m_videoData[0].segmentDuration);
+        }
+    }
+
+  // Everything touching the random streams or ns-3 objects happens here, on
+  // the calling thread; the workers only play
+  std::vector <uint32_t> pending;
+  std::vector <mvdashTracePlayer *> players;
+  for (uint32_t j = 0; j < m_jobs.size (); j++)
+    {
+      if (m_jobs[j].done)
+        {
+          continue;
+        }
+      const t_mvdashRateChanges *bandwidth = LoadTrace (m_jobs[j].bwTrace);
+      if (!bandwidth)
+        {
+          for (mvdashTracePlayer *player : players)
+            {
+              delete player;
+            }
+          return false;
+        }
+      std::string vpInfo = m_jobs[j].vpInfo.empty () ? m_vpInfoFilePath : m_jobs[j].vpInfo;
+      MultiView_Model *viewModel = mvdashCreateViewpointModel (m_vpModelName, vpInfo, m_videoData.size ());
+      NS_ABORT_MSG_IF (!viewModel, "Unknown viewpoint model " << m_vpModelName);
+      viewModel->AssignStreams (VIEW_MODEL_STREAMS * (int64_t) m_jobs[j].seed);
+      mvdashTracePlayer *player = new mvdashTracePlayer (m_videoData, *bandwidth, viewModel, m_mvAlgoName);
+      player->Configure (m_initialRate.GetBitRate (), m_rtt.GetMicroSeconds (), m_efficiency,
+                         m_stopTime.GetMicroSeconds ());
+      pending.push_back (j);
+      players.push_back (player);
+    }
+
+  uint32_t nThreads = m_nThreads ? m_nThreads : std::max (std::thread::hardware_concurrency (), 1u);
+  nThreads = std::min (nThreads, (uint32_t) players.size ());
+  std::atomic<size_t> next (0);
+  std::vector <std::thread> workers;
+  for (uint32_t t = 0; t < nThreads; t++)
+    {
+      workers.push_back (std::thread ([&players, &next] ()
+        {
+          size_t i;
+          while ((i = next++) < players.size ())
+            {
+              players[i]->Run ();
+            }
+        }));
+    }
+  for (std::thread &worker : workers)
+    {
+      worker.join ();
+    }
+
+  for (size_t i = 0; i < players.size (); i++)
+    {
+      st_evaluationJob &job = m_jobs[pending[i]];
+      job.summary = players[i]->GetSummary ();
+      job.done = true;
+      if (job.summary.nPlayed == 0)
+        {
+          NS_LOG_WARN ("Job " << pending[i] << " played nothing; check MVAlgo and the viewpoint model");
+        }
+      delete players[i];
+    }
+  NS_LOG_INFO ("Evaluated " << players.size () << " sessions on " << nThreads << " threads");
+  return true;
+}
+
+st_mvdashQoeSummary
+mvdashPlayerEvaluator::GetSummary (uint32_t job) const
+{
+  return m_jobs.at (job).summary;
+}
+
+void
+mvdashPlayerEvaluator::Write (std::ostream &os) const
+{
+  os << "trace\tseed\t";
+  mvdashQoeMonitor::WriteHeader (os, "job");
+  for (uint32_t j = 0; j < m_jobs.size (); j++)
+    {
+      os << m_jobs[j].bwTrace << "\t" << m_jobs[j].seed << "\t";
+      mvdashQoeMonitor::WriteRow (os, std::to_string (j), m_jobs[j].summary);
+    }
+}
+
+} // namespace ns3
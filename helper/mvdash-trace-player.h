@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_TRACE_PLAYER_H
+#define MVDASH_TRACE_PLAYER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/mvdash.h"
+#include "mvdash-session.h"
+
+namespace ns3 {
+
+/// Rate changes of a bandwidth trace: (time in microseconds, bits per second)
+typedef std::vector< std::pair<int64_t, uint64_t> > t_mvdashRateChanges;
+
+/**
+ * \ingroup etri_mvdash
+ * \brief One client session played against a bandwidth trace, outside of any simulation.
+ *
+ * The player runs the controller of mvdashClient, as mvdashSession, over a
+ * single bottleneck whose rate follows the trace; each request group takes
+ * one round-trip time plus its bytes at the current rate.  The viewpoint
+ * model and the adaptation algorithm are the ones of the client, clocked
+ * by the player instead of the simulator, so one session takes
+ * milliseconds instead of a network run.  There is no TCP dynamics, loss or
+ * competing traffic: use the player to rank and tune algorithms, and confirm
+ * the result with a full run.
+ */
+class mvdashTracePlayer : public mvdashSession
+{
+public:
+  /**
+   * \param videoData the manifest; kept by reference and only read
+   * \param bandwidth the rate changes of the bottleneck; kept by reference and only read
+   * \param viewModel the viewpoint model, owned by the player from now on
+   * \param algorithm the adaptation algorithm name, as the client MVAlgo attribute
+   */
+  mvdashTracePlayer (const t_videoDataGroup &videoData, const t_mvdashRateChanges &bandwidth,
+                     MultiView_Model *viewModel, std::string algorithm);
+  virtual ~mvdashTracePlayer ();
+
+  /**
+   * \param initialRate bits per second before the first change of the trace
+   * \param rtt round-trip time of a request in microseconds
+   * \param efficiency share of the bottleneck rate that segment bytes get
+   * \param stopTime the session is cut at this time, in microseconds
+   */
+  void Configure (uint64_t initialRate, int64_t rtt, double efficiency, int64_t stopTime);
+  /**
+   * \brief Play the session through; a player runs once
+   * \returns false if the viewpoint model or the algorithm is missing
+   */
+  bool Run (void);
+
+  st_mvdashQoeSummary GetSummary (void) const { return m_summary; }
+
+protected:
+  /**
+   * \brief Schedule the end of the download of a group
+   */
+  virtual void SendRequests (const std::vector <st_mvdashRequest> &requests);
+
+private:
+  /**
+   * \returns the time, in microseconds, the bottleneck needs from start on to serve bytes
+   */
+  int64_t TransferEnd (int64_t start, int64_t bytes) const;
+
+  const t_mvdashRateChanges &m_bandwidth;
+
+  uint64_t m_initialRate;
+  int64_t  m_rtt;
+  double   m_efficiency;
+  int64_t  m_stopTime;
+
+  int64_t  m_downloadStart;     //!< first byte of the pending download
+  int64_t  m_downloadEnd;       //!< end of the pending download, -1 if none
+  st_mvdashQoeSummary m_summary;
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief Evaluates an adaptation algorithm over many bandwidth traces and
+ *        viewpoint seeds, spreading the sessions over a pool of threads.
+ *
+ * Each job is one mvdashTracePlayer session.  The manifest and every
+ * distinct bandwidth trace are read once and shared read-only; the players,
+ * whose viewpoint models draw from ns-3 random streams, are built on the
+ * calling thread, and only their Run happens on the workers.  A job of
+ * seed s replays the viewpoints the client of ClientId s would draw, so a
+ * result can be checked against a full run.  Logging of the models prints
+ * the simulator time and is not thread safe: enable it with Threads set to 1.
+ */
+class mvdashPlayerEvaluator : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  mvdashPlayerEvaluator ();
+  virtual ~mvdashPlayerEvaluator ();
+
+  /**
+   * \param bwTrace the bandwidth trace, in the Format attribute; empty keeps DataRate all along
+   * \param seed selects the random streams of the viewpoint model, as the client ClientId
+   * \param vpInfo the viewpoint model parameters or trace; empty uses the VPInfo attribute
+   * \returns the job index
+   */
+  uint32_t AddJob (std::string bwTrace, uint32_t seed, std::string vpInfo = "");
+  /**
+   * \brief Add one job per trace and seed in [0, nSeeds)
+   */
+  void AddJobs (const std::vector<std::string> &bwTraces, uint32_t nSeeds);
+  uint32_t GetNJobs (void) const { return m_jobs.size (); }
+
+  /**
+   * \brief Run every job not run yet
+   * \returns false if the manifest or a trace cannot be read
+   */
+  bool Run (void);
+  st_mvdashQoeSummary GetSummary (uint32_t job) const;
+  /**
+   * \brief Write a header and one tab separated row per job
+   */
+  void Write (std::ostream &os) const;
+
+private:
+  struct st_evaluationJob
+  {
+    std::string bwTrace;
+    std::string vpInfo;
+    uint32_t    seed;
+    bool        done;
+    st_mvdashQoeSummary summary;
+  };
+
+  const t_mvdashRateChanges * LoadTrace (std::string path);
+
+  std::string m_mvInfoFilePath;
+  std::string m_vpInfoFilePath;
+  std::string m_vpModelName;
+  std::string m_mvAlgoName;
+  std::string m_formatName;
+  bool        m_loop;
+  DataRate    m_initialRate;
+  Time        m_rtt;
+  double      m_efficiency;
+  Time        m_stopTime;
+  uint32_t    m_nThreads;
+
+  std::vector <st_evaluationJob> m_jobs;
+  t_videoDataGroup m_videoData;
+  std::map <std::string, t_mvdashRateChanges> m_traces;   //!< by path
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_TRACE_PLAYER_H */
@@ -29,18 +29,16 @@ Free_Viewpoint_Model::Free_Viewpoint_Model()
 /*    m_nViews = 9;
     m_minDwellTime = 2;
 
-    m_cumulativeProb = {0.6, 0.7, 0.8, 0.85, 0.9, 0.925, 0.95, 0.975, 1.0};
+    m_viewpointTable.Build({{0.6, 0.1, 0.1, 0.05, 0.05, 0.025, 0.025, 0.025, 0.025}});
     m_avgDwellTime = {10,5,5,5,5,8,8,5,5};*/
 
     m_nViews = 5;
     m_minDwellTime = 2;
 
-    m_cumulativeProb = {0.4, 0.6, 0.80, 0.90, 1.0};
+    m_viewpointTable.Build({{0.4, 0.2, 0.2, 0.1, 0.1}});
 //    m_avgDwellTime = {10,5,5,8,8};
     m_avgDwellTime = {4,2,2,3,3};
 
-    ns3::RngSeedManager::SetSeed(2);
-
     m_pUniRNG = CreateObject<UniformRandomVariable>();
     m_pUniRNG->SetAttribute ("Min", DoubleValue(0.0));
     m_pUniRNG->SetAttribute ("Max", DoubleValue(1.0));
@@ -50,8 +48,15 @@ Free_Viewpoint_Model::Free_Viewpoint_Model()
 }
 
 Free_Viewpoint_Model::Free_Viewpoint_Model(const std::string free_viewpoint_file)
+    : Free_Viewpoint_Model()
+{
+}
+
+int64_t Free_Viewpoint_Model::AssignStreams(int64_t stream)
 {
-    Free_Viewpoint_Model();
+    m_pUniRNG->SetStream(stream);
+    m_pExpRNG->SetStream(stream + 1);
+    return 2;
 }
 
 int32_t Free_Viewpoint_Model::InitViewpoint() {
@@ -67,13 +72,7 @@ int32_t Free_Viewpoint_Model::GetNextViewpoint(const int64_t t_index) {
     int32_t viewpoint = CurrentViewpoint();
     m_remDwellTime -= 1;
     if (m_remDwellTime <= 0) {  // Switch Viewpoint
-        double ranval = m_pUniRNG->GetValue();
-        viewpoint = 0;
-        for (double prob : m_cumulativeProb) {
-            if (ranval <= prob)
-                break;
-            viewpoint += 1;
-        }
+        viewpoint = m_viewpointTable.Sample(0, m_pUniRNG->GetValue());
         m_remDwellTime = m_minDwellTime + ceil(m_pExpRNG->GetValue(m_avgDwellTime.at(viewpoint), 10));
 //        NS_LOG_INFO("GetNextView - Dwell Time : " << m_remDwellTime);
     }
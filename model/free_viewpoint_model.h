@@ -19,6 +19,7 @@
 #define FREE_VIEWPOINT_MODEL_H
 
 #include "multiview-model.h"
+#include "viewpoint_alias_table.h"
 #include "ns3/core-module.h"
 #include "ns3/random-variable-stream.h"
 
@@ -29,6 +30,7 @@ class Free_Viewpoint_Model : public MultiView_Model
 public:
   Free_Viewpoint_Model();
   Free_Viewpoint_Model(const std::string free_viewpoint_file);
+  int64_t AssignStreams(int64_t stream);
 
 protected:
   int32_t InitViewpoint();
@@ -37,7 +39,7 @@ protected:
 private:
   Ptr<UniformRandomVariable> m_pUniRNG;
   Ptr<ExponentialRandomVariable> m_pExpRNG;
-  std::vector <double> m_cumulativeProb;
+  Viewpoint_Alias_Table m_viewpointTable;     //!< a single row, the next viewpoint does not depend on the current one
   std::vector <double> m_avgDwellTime;
   int m_remDwellTime;
   int m_minDwellTime;
@@ -30,12 +30,12 @@ Markovian_Viewpoint_Model::Markovian_Viewpoint_Model()
     m_minDwellTime = 2;
     m_UpperBound_ExpRNG = 10.0;
 
+    std::vector < std::vector<double> > transitionMatrix;
     for (int vp = 0; vp < m_nViews; vp++) {
-        m_cumulativeTransitionMatrix.push_back({0.4, 0.6, 0.8, 0.9, 1.0});
+        transitionMatrix.push_back({0.4, 0.2, 0.2, 0.1, 0.1});
         m_avgDwellTimeMatrix.push_back({4,2,2,3,3});
     }
-
-    ns3::RngSeedManager::SetSeed(2);
+    m_transitionTable.Build(transitionMatrix);
 
     m_pUniRNG = CreateObject<UniformRandomVariable>();
     m_pUniRNG->SetAttribute ("Min", DoubleValue(0.0));
@@ -64,26 +64,26 @@ Markovian_Viewpoint_Model::Markovian_Viewpoint_Model(const std::string viewpoint
     m_nViews = first_line[1];
     m_minDwellTime = first_line[2];
     m_UpperBound_ExpRNG = (double) first_line[3];
-    ns3::RngSeedManager::SetSeed(first_line[4]);    // first_line[4] --> Random Seed Values
+    // first_line[4] (random seed) is no longer applied: reseeding the global
+    // generator here would change the sequence of every other client.
+    // Use --RngSeed/--RngRun and AssignStreams() instead.
     m_pUniRNG = CreateObject<UniformRandomVariable>();
     m_pUniRNG->SetAttribute ("Min", DoubleValue(0.0));
     m_pUniRNG->SetAttribute ("Max", DoubleValue(1.0));
     m_pExpRNG = CreateObject<ExponentialRandomVariable>();    
 
     if (switching_model_type == SimpleType) {
-        int vp_i, vp_j;
+        int vp_i;
+        std::vector < std::vector<double> > transitionMatrix;
         for (vp_i=0; vp_i < m_nViews; vp_i++) {
             std::getline (vpfile, temp);
             std::istringstream buffer(temp);
             std::vector<double> prob_trans ((std::istream_iterator<double> (buffer)),
                  std::istream_iterator<double>());
-            
-            for (vp_j=1; vp_j < m_nViews; vp_j++) {
-                prob_trans[vp_j] += prob_trans[vp_j-1];
-//              NS_LOG_INFO("[" << vp_i << "," << vp_j << "] = " << prob_trans[vp_j]);
-            }
-            m_cumulativeTransitionMatrix.push_back(prob_trans);           
+            prob_trans.resize(m_nViews, 0.0);
+            transitionMatrix.push_back(prob_trans);           
         }
+        m_transitionTable.Build(transitionMatrix);
         for (vp_i=0; vp_i < m_nViews; vp_i++) {
             std::getline (vpfile, temp);
             std::istringstream buffer(temp);
@@ -100,6 +100,16 @@ Markovian_Viewpoint_Model::Markovian_Viewpoint_Model(const std::string viewpoint
     vpfile.close();
 }
 
+int64_t Markovian_Viewpoint_Model::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    if (!m_pUniRNG || !m_pExpRNG)
+        return 0;
+    m_pUniRNG->SetStream(stream);
+    m_pExpRNG->SetStream(stream + 1);
+    return 2;
+}
+
 int32_t Markovian_Viewpoint_Model::InitViewpoint() {
     int32_t  viewpoint = 0;
     m_remDwellTime = 2*m_minDwellTime;
@@ -110,14 +120,8 @@ int32_t Markovian_Viewpoint_Model::GetNextViewpoint(const int64_t t_index) {
     int32_t viewpoint = CurrentViewpoint();
     m_remDwellTime -= 1;
     if (m_remDwellTime <= 0) {  // Switch Viewpoint
-        double ranval = m_pUniRNG->GetValue();
         int old_viewpoint = viewpoint;
-        viewpoint = 0;
-        for (double prob : m_cumulativeTransitionMatrix[old_viewpoint]) {
-            if (ranval <= prob)
-                break;
-            viewpoint += 1;
-        }
+        viewpoint = m_transitionTable.Sample(old_viewpoint, m_pUniRNG->GetValue());
         m_remDwellTime = m_minDwellTime + ceil(m_pExpRNG->GetValue(m_avgDwellTimeMatrix[old_viewpoint][viewpoint], m_UpperBound_ExpRNG));
     }
     return viewpoint; 
@@ -19,6 +19,7 @@
 #define MARKOVIAN_VIEWPOINT_MODEL_H
 
 #include "multiview-model.h"
+#include "viewpoint_alias_table.h"
 #include "ns3/core-module.h"
 #include "ns3/random-variable-stream.h"
 
@@ -29,6 +30,7 @@ class Markovian_Viewpoint_Model : public MultiView_Model
 public:
     Markovian_Viewpoint_Model();
     Markovian_Viewpoint_Model(const std::string viewpoint_file);
+    int64_t AssignStreams(int64_t stream);
 
 protected:
     int32_t InitViewpoint();
@@ -38,7 +40,7 @@ private:
     enum Switching_Model_Type {SimpleType, CompositeType};
     Ptr<UniformRandomVariable> m_pUniRNG;
     Ptr<ExponentialRandomVariable> m_pExpRNG;
-    std::vector < std::vector<double> > m_cumulativeTransitionMatrix;
+    Viewpoint_Alias_Table m_transitionTable;
     std::vector < std::vector<double> > m_avgDwellTimeMatrix;
     int m_remDwellTime;
     int m_minDwellTime;
@@ -49,7 +49,7 @@ int64_t maximizeCurrentAdaptation::SelectRateIndexes (int32_t tIndexReq,
     
     if (tIndexReq > 0) {
         // Estimate Avaiable Bandwidth
-        int64_t timeNow = Simulator::Now ().GetMicroSeconds ();        
+        int64_t timeNow = GetTimeNow ();        
         int32_t idLast = m_downData.playbackIndex.back();
         if (m_downData.time[idLast].downloadEnd <= 0) 
             idLast -= 1;
@@ -68,7 +68,7 @@ int64_t maximizeCurrentAdaptation::SelectRateIndexes (int32_t tIndexReq,
             << " bwPerDuration : " << bwBytesPerDuration
         );
 
-        NS_LOG_INFO(Simulator::Now ().As (Time::S)
+        NS_LOG_INFO(timeNow
             << " Buffer Status at : "  << m_bufferData.timeNow.back()
             << " Level Old " << m_bufferData.bufferLevelOld.back()
             << " Level New " << m_bufferData.bufferLevelNew.back()
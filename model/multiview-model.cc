@@ -17,6 +17,9 @@
  */
 
  #include "multiview-model.h"
+#include "markovian_viewpoint_model.h"
+#include "free_viewpoint_model.h"
+#include "trace_viewpoint_model.h"
 
 namespace ns3 {
 
@@ -25,6 +28,11 @@ NS_LOG_COMPONENT_DEFINE ("MultiView_Model");
 NS_OBJECT_ENSURE_REGISTERED (MultiView_Model);
 
 int32_t MultiView_Model::UpdateViewpoint(const int64_t t_index)
+{
+    return UpdateViewpoint(t_index, Simulator::Now ().GetMicroSeconds ());
+}
+
+int32_t MultiView_Model::UpdateViewpoint(const int64_t t_index, const int64_t timeNow)
 {
     int32_t viewpoint;
     
@@ -36,10 +44,27 @@ int32_t MultiView_Model::UpdateViewpoint(const int64_t t_index)
         viewpoint = GetNextViewpoint(t_index);
 
     m_viewpointData.viewpointIndex.push_back(viewpoint);
-    m_viewpointData.viewpointTime.push_back(Simulator::Now ().GetMicroSeconds ());
+    m_viewpointData.viewpointTime.push_back(timeNow);
     m_nViewpointSelected.at(viewpoint) += 1;
         
     return viewpoint;
 }
 
+MultiView_Model * mvdashCreateViewpointModel (std::string name, std::string vpInfoFile, int32_t nViewpoints)
+{
+    MultiView_Model *model = 0;
+    if (name == "markovian") {
+        model = new Markovian_Viewpoint_Model(vpInfoFile);
+    }
+    else if (name == "free") {
+        model = new Free_Viewpoint_Model();
+        model->m_nViews = nViewpoints;
+    }
+    else if (name == "trace") {
+        model = new Trace_Viewpoint_Model(vpInfoFile);
+        model->m_nViews = nViewpoints;
+    }
+    return model;
+}
+
 } // namespace ns3
\ No newline at end of file
@@ -35,9 +35,21 @@ class MultiView_Model : public Object
 public:
   MultiView_Model () {};
   int32_t UpdateViewpoint(const int64_t t_index);
+  /**
+   * \brief Select the viewpoint of t_index at timeNow (microseconds), for runs outside a simulation
+   */
+  int32_t UpdateViewpoint(const int64_t t_index, const int64_t timeNow);
   int32_t CurrentViewpoint() { return m_viewpointData.viewpointIndex.back();}
   double ViewpointRatio(int viewpoint) 
     { return (double)m_nViewpointSelected.at(viewpoint)/m_viewpointData.viewpointIndex.size();}
+  /**
+   * Assign fixed random variable stream numbers to the random variables
+   * used by this model.  Return the number of streams that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  virtual int64_t AssignStreams(int64_t stream)=0;
   int32_t m_nViews;
 
 protected:
@@ -46,6 +58,14 @@ protected:
   st_viewpointData m_viewpointData;
   std::vector <int32_t> m_nViewpointSelected;
 };
+
+/**
+ * \param name the model name: "markovian", "free" or "trace"
+ * \param vpInfoFile the model parameters, or the viewpoint trace
+ * \param nViewpoints the number of viewpoints of the video
+ * \returns a new model, null if the name is unknown
+ */
+MultiView_Model * mvdashCreateViewpointModel (std::string name, std::string vpInfoFile, int32_t nViewpoints);
 } // namespace ns3
 
 #endif /* MULTIVIEW_MODEL_H */
\ No newline at end of file
@@ -38,18 +38,46 @@ enum segmentEvent
     segev_endReceiving
 };
 
+/**
+ * Server push: ids of the control messages that share the request stream
+ * with the segment requests, and of the segments the server pushes.
+ */
+enum pushControlId
+{
+    pushid_framed = -1,     //!< first message of a connection: every segment sent on it follows a copy of its request
+    pushid_cancel = -2,     //!< drop the pushed segments of viewpoint from timeIndex on that have not started
+    pushid_pushed = -3      //!< in the copy preceding a pushed segment, whose push field is the id of the request that triggered it
+};
+
 struct st_mvdashRequest {
     int32_t id;
     int32_t viewpoint;
     int32_t timeIndex;
     int32_t qualityIndex; 
     int32_t segmentSize;
-    st_mvdashRequest() {};
-    st_mvdashRequest(int32_t i, int32_t v, int32_t t, int32_t q, int32_t s) 
-    : id(i), viewpoint(v), timeIndex(t), qualityIndex(q), segmentSize(s)
+    int32_t tile;           //!< tile of the viewpoint, 0 for a whole viewpoint
+    int32_t push;           //!< segments of the viewpoint the server is asked to push after this one; in the copy, those it will push
+    int32_t part;           //!< switch segment of the time index plus one, 0 for the regular segment
+    int32_t mainView;       //!< 1 if the viewpoint is the main view of the client when requested
+    st_mvdashRequest() : tile(0), push(0), part(0), mainView(0) {};
+    st_mvdashRequest(int32_t i, int32_t v, int32_t t, int32_t q, int32_t s, int32_t tl = 0) 
+    : id(i), viewpoint(v), timeIndex(t), qualityIndex(q), segmentSize(s), tile(tl), push(0), part(0), mainView(0)
     {};
 };
 
+/**
+ * Prefix of every multicast datagram: one chunk of a segment that the server
+ * sends to all the clients of a multicast group.
+ */
+struct st_mvdashMulticastChunk {
+    int32_t viewpoint;
+    int32_t timeIndex;
+    int32_t qualityIndex;
+    int32_t segmentSize;
+    int32_t offset;         //!< position of the chunk in the segment
+    int32_t length;         //!< payload bytes following this prefix
+};
+
 /*
 struct st_mvdashRequestMessage {
     int32_t id;
@@ -68,6 +96,12 @@ struct videoData
   std::vector < std::vector<int64_t > > segmentSize;       //!< vector holding representation levels in the first dimension and their particular segment sizes in bytes in the second dimension
   std::vector < double > averageBitrate;       //!< holding the average bitrate of a segment in representation i in bits
   int64_t segmentDuration;       //!< duration of a segment in microseconds
+  int32_t tileColumns;           //!< tile grid over the equirectangular picture, 0 if not tiled
+  int32_t tileRows;
+  std::vector < std::vector<int64_t> > tileSize;  //!< by representation level, then tile sizes in bytes at [segment * nTiles + tile], tiles row-major
+  std::vector < std::vector<int64_t> > layerSize; //!< layered video only: by layer, the bytes of the layer alone; segmentSize then holds the sums of the layers up to each level
+  int64_t switchDuration;        //!< duration of a switch segment in microseconds, 0 without switch segments
+  std::vector < std::vector<int64_t> > switchSize; //!< by representation level, then switch segment sizes in bytes at [segment * nSwitch + j]
 };
 
 typedef std::vector <struct videoData> t_videoDataGroup;
@@ -78,6 +112,9 @@ struct playbackDataGroup
   std::vector <int32_t> mainViewpoint;
   std::vector <int64_t> playbackStart;      //!< Point in time in microseconds when playback of this segment started
   std::vector <std::vector<int32_t>> qualityIndex;       //!< Index of the video quality
+  std::vector <double> viewportCoverage;    //!< tiled video only: share of the viewport played at the quality of the main viewpoint
+  std::vector <int32_t> switchPart;         //!< with switch segments only: the first one played in place of the rest of the segment, 0 if none
+  std::vector <int32_t> switchQuality;      //!< with switch segments only: their quality, -1 if none played
 };
 
 struct st_requestTimeInfo {
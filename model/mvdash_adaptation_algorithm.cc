@@ -17,6 +17,9 @@
  */
 
 #include "mvdash_adaptation_algorithm.h"
+#include "maximize_current_adaptation.h"
+#include "ns3/simulator.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -32,7 +35,43 @@ mvdashAdaptationAlgorithm::mvdashAdaptationAlgorithm (
 : m_videoData (videoData),
   m_playData (playData),  
   m_bufferData (bufferData),
-  m_downData (downData)
+  m_downData (downData),
+  m_clock (0)
 {}
 
+int64_t mvdashAdaptationAlgorithm::GetTimeNow (void) const
+{
+  if (m_clock)
+    return *m_clock;
+  return Simulator::Now ().GetMicroSeconds ();
+}
+
+int32_t mvdashAdaptationAlgorithm::SelectViewpointRate (int32_t tIndexReq, int32_t viewpoint, int32_t curViewpoint,
+                                                        int64_t bufferLevel, double throughput)
+{
+  if (viewpoint != curViewpoint || throughput <= 0)
+    return 0;
+
+  // Bytes the link delivers in one segment duration, less on a short buffer
+  int64_t duration = m_videoData[viewpoint].segmentDuration;
+  double share = std::min ((double) bufferLevel / (2 * duration), 1.0) * 0.9;
+  double allowed = throughput * share * duration / 1e6;
+  for (int32_t q = m_videoData[viewpoint].segmentSize.size () - 1; q > 0; q--) {
+    if (m_videoData[viewpoint].segmentSize[q][tIndexReq] <= allowed)
+      return q;
+  }
+  return 0;
+}
+
+mvdashAdaptationAlgorithm * mvdashCreateAdaptationAlgorithm (std::string name,
+                        const t_videoDataGroup &videoData,
+                        const struct playbackDataGroup & playData,
+                        const struct bufferData & bufferData,
+                        const struct downloadDataGroup & downData)
+{
+  if (name == "maximize_current" || name == "newone")
+    return new maximizeCurrentAdaptation(videoData, playData, bufferData, downData);
+  return 0;
+}
+
 } // namespace ns3
\ No newline at end of file
@@ -34,12 +34,49 @@ public:
 
   virtual int64_t SelectRateIndexes (int32_t tIndexReq, int32_t curViewpoint, std::vector <int32_t> *pIndexes) = 0;
 
+  /**
+   * \brief Select the quality of one segment for the per-viewpoint buffers of the client
+   *
+   * The default keeps the side views at the lowest quality and gives the
+   * main view the highest quality the throughput sustains, with less of the
+   * throughput while its buffer holds less than two segments.
+   *
+   * \param bufferLevel microseconds buffered ahead of playback on viewpoint
+   * \param throughput bytes per second of the recent downloads, zero if none yet
+   * \returns the quality index
+   */
+  virtual int32_t SelectViewpointRate (int32_t tIndexReq, int32_t viewpoint, int32_t curViewpoint,
+                                       int64_t bufferLevel, double throughput);
+
+  /**
+   * \brief Read the time from clock, in microseconds, instead of the simulator
+   *
+   * Lets the algorithm run in a player loop outside of any simulation.
+   */
+  void SetClock (const int64_t *clock) { m_clock = clock; }
+
 protected:
+  /**
+   * \returns the current time in microseconds
+   */
+  int64_t GetTimeNow (void) const;
+
   const t_videoDataGroup & m_videoData;
   const struct playbackDataGroup & m_playData;
   const struct bufferData & m_bufferData;
   const struct downloadDataGroup &m_downData;
+  const int64_t *m_clock;       //!< null to follow the simulator
 };
+
+/**
+ * \param name the algorithm name, e.g. "maximize_current"
+ * \returns a new algorithm reading the given session records, null if the name is unknown
+ */
+mvdashAdaptationAlgorithm * mvdashCreateAdaptationAlgorithm (std::string name,
+                        const t_videoDataGroup &videoData,
+                        const struct playbackDataGroup & playData,
+                        const struct bufferData & bufferData,
+                        const struct downloadDataGroup & downData);
 } // namespace ns3
 
 #endif /* MVDASH_ADAPTATION_ALGORITHM_H */
\ No newline at end of file
@@ -0,0 +1,441 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash_cache_server.h"
+#include <ns3/core-module.h>
+#include "ns3/tcp-socket.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashCacheServer");
+
+NS_OBJECT_ENSURE_REGISTERED (mvdashCacheServer);
+
+TypeId mvdashCacheServer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::mvdashCacheServer")
+    .SetParent<Application> ()
+    .SetGroupName("Applications")
+    .AddConstructor<mvdashCacheServer> ()
+    .AddAttribute ("LocalAddress",
+                   "The local Address",
+                   AddressValue (),
+                   MakeAddressAccessor (&mvdashCacheServer::m_localAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("OriginAddress",
+                   "The Address of the origin mvdashServer",
+                   AddressValue (),
+                   MakeAddressAccessor (&mvdashCacheServer::m_originAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("CacheSize",
+                   "The cache capacity in bytes",
+                   UintegerValue (100000000),
+                   MakeUintegerAccessor (&mvdashCacheServer::m_cacheSize),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Policy",
+                   "The replacement policy [lru, lfu]",
+                   StringValue ("lru"),
+                   MakeStringAccessor (&mvdashCacheServer::m_policyName),
+                   MakeStringChecker ())
+    .AddTraceSource ("Rx", "A packet has been received",
+                     MakeTraceSourceAccessor (&mvdashCacheServer::m_rxTrace),
+                     "ns3::Packet::AddressTracedCallback") 
+    .AddTraceSource ("Tx", "A new packet is sent",
+                     MakeTraceSourceAccessor (&mvdashCacheServer::m_txTrace),
+                     "ns3::Packet::AddressTracedCallback")
+  ;
+  return tid;
+}
+
+mvdashCacheServer::mvdashCacheServer ()
+  : m_originConnected (false),
+    m_nextFetchId (1),
+    m_nHits (0),
+    m_nMisses (0),
+    m_nCoalesced (0),
+    m_bytesRequested (0),
+    m_bytesFetched (0)
+{
+    NS_LOG_FUNCTION (this);
+    m_socket = 0;
+    m_originSocket = 0;
+}
+
+mvdashCacheServer::~mvdashCacheServer ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void mvdashCacheServer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_originSocket = 0;
+  m_clients.clear ();
+
+  // chain up
+  Application::DoDispose ();
+}
+
+double mvdashCacheServer::GetHitRatio (void) const
+{
+    uint64_t nRequests = m_nHits + m_nMisses + m_nCoalesced;
+    return nRequests ? (double) m_nHits / nRequests : 0.0;
+}
+
+double mvdashCacheServer::GetOriginOffload (void) const
+{
+    return m_bytesRequested ? 1.0 - (double) m_bytesFetched / m_bytesRequested : 0.0;
+}
+
+// Application Methods
+void mvdashCacheServer::StartApplication ()    // Called at time specified by Start
+{
+  NS_LOG_FUNCTION (this);
+
+  m_cache.SetCapacity (m_cacheSize);
+  if (m_policyName == "lfu")
+    m_cache.SetPolicy (mvdashSegmentCache::LFU);
+  else if (m_policyName == "lru")
+    m_cache.SetPolicy (mvdashSegmentCache::LRU);
+  else
+    NS_FATAL_ERROR ("Unknown cache policy " << m_policyName);
+
+  TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+  if (!m_socket)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      if (m_socket->Bind (m_localAddress) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_socket->Listen ();      
+    }
+  m_socket->SetAcceptCallback (
+    MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+    MakeCallback (&mvdashCacheServer::HandleAccept, this));
+  m_socket->SetCloseCallbacks (
+    MakeCallback (&mvdashCacheServer::HandlePeerClose, this),
+    MakeCallback (&mvdashCacheServer::HandlePeerError, this));
+
+  if (!m_originSocket)
+    {
+      m_originSocket = Socket::CreateSocket (GetNode (), tid);
+      if (m_originSocket->Bind () == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind origin socket");
+        }
+      m_originSocket->Connect (m_originAddress);
+      m_originSocket->SetConnectCallback (
+        MakeCallback (&mvdashCacheServer::OriginConnectionSucceeded, this),
+        MakeCallback (&mvdashCacheServer::OriginConnectionFailed, this));
+      m_originSocket->SetRecvCallback (MakeCallback (&mvdashCacheServer::HandleOriginRead, this));
+      m_originSocket->SetSendCallback (MakeCallback (&mvdashCacheServer::HandleOriginSend, this));
+    }
+}
+
+void mvdashCacheServer::StopApplication ()      // Called at time specified by Stop
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("Cache hits " << m_nHits << " misses " << m_nMisses
+               << " coalesced " << m_nCoalesced << " hit ratio " << GetHitRatio ()
+               << " origin offload " << GetOriginOffload ()
+               << " evictions " << m_cache.GetNEvictions ());
+
+  for (std::map<Address, st_cacheClient>::iterator it = m_clients.begin (); it != m_clients.end (); ++it)
+    {
+      it->second.socket->Close ();
+    }
+  m_clients.clear ();
+  if (m_socket) 
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  if (m_originSocket)
+    {
+      m_originSocket->Close ();
+      m_originSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_originConnected = false;
+    }
+}
+
+// ===========================================================================================
+// Client side
+
+void mvdashCacheServer::HandleAccept (Ptr<Socket> socket, const Address& from)
+{
+    NS_LOG_FUNCTION (this << socket << from);
+
+    st_cacheClient &client = m_clients[from];
+    client.socket = socket;
+    client.bytesSent = 0;
+    client.unsentPacket = 0;
+    client.partialRequest = 0;
+    socket->SetRecvCallback (MakeCallback (&mvdashCacheServer::HandleRead, this));
+    socket->SetSendCallback (MakeCallback (&mvdashCacheServer::HandleSend, this));
+}
+
+void mvdashCacheServer::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Address from;
+  Ptr<Packet> packet = socket->RecvFrom (from);
+  m_rxTrace (packet, from);
+
+  if (ParseRequest (packet, from))
+    SendResponse (from);
+  FlushOriginRequests ();
+}
+
+bool mvdashCacheServer::ParseRequest (Ptr<Packet> packet, const Address &from)
+{
+    NS_LOG_FUNCTION (this);
+    st_cacheClient &client = m_clients[from];
+
+    if (client.partialRequest) {
+      client.partialRequest->AddAtEnd (packet);
+      packet = client.partialRequest;
+      client.partialRequest = 0;
+    }
+    uint32_t nRequests = packet->GetSize () / sizeof (st_mvdashRequest);
+    uint32_t remainder = packet->GetSize () % sizeof (st_mvdashRequest);
+    if (remainder)
+      client.partialRequest = packet->CreateFragment (packet->GetSize () - remainder, remainder);
+    if (nRequests == 0)
+      return false;
+
+    std::vector <st_mvdashRequest> requests (nRequests);
+    packet->CopyData ((uint8_t *) requests.data (), nRequests * sizeof (st_mvdashRequest));
+
+    bool wasIdle = client.requests.empty ();
+    for (const st_mvdashRequest &req : requests) {
+      if (req.id < 0) {
+        // Push is between a client and the origin; the cache answers pulls only
+        NS_LOG_WARN ("mvdashCacheServer ignores the push control message " << req.id);
+        continue;
+      }
+      st_cacheRequest creq;
+      creq.req = req;
+      creq.fetchId = LookupSegment (req, from);
+      client.requests.push (creq);
+    }
+    if (wasIdle)
+      client.bytesSent = 0;
+    return !client.requests.empty ();
+}
+
+uint64_t mvdashCacheServer::LookupSegment (const st_mvdashRequest &req, const Address &from)
+{
+    uint64_t key = mvdashSegmentCache::MakeKey (req.viewpoint, req.timeIndex, req.qualityIndex, req.tile, req.part);
+    m_bytesRequested += req.segmentSize;
+
+    if (m_cache.Lookup (key)) {
+      m_nHits++;
+      return 0;
+    }
+
+    std::map<uint64_t, uint64_t>::iterator inFlight = m_fetchByKey.find (key);
+    if (inFlight != m_fetchByKey.end ()) {
+      m_nCoalesced++;
+      m_fetches[inFlight->second].waiters.push_back (from);
+      return inFlight->second;
+    }
+
+    m_nMisses++;
+    m_bytesFetched += req.segmentSize;
+    uint64_t fetchId = m_nextFetchId++;
+    st_originFetch &fetch = m_fetches[fetchId];
+    fetch.key = key;
+    fetch.segmentSize = req.segmentSize;
+    fetch.bytesReceived = 0;
+    fetch.waiters.push_back (from);
+    m_fetchByKey[key] = fetchId;
+    m_originQueue.push (fetchId);
+    m_originBacklog.push (req);
+    return fetchId;
+}
+
+void mvdashCacheServer::SendResponse (const Address &from)
+{
+    NS_LOG_FUNCTION (this);
+
+    std::map<Address, st_cacheClient>::iterator it = m_clients.find (from);
+    if (it == m_clients.end ()) return;
+    st_cacheClient &client = it->second;
+
+    while (!client.requests.empty ())
+    {
+      const st_cacheRequest &curReq = client.requests.front ();
+
+      // Bytes of the head segment present at the cache so far
+      int64_t available = curReq.req.segmentSize;
+      std::map<uint64_t, st_originFetch>::iterator fetch = m_fetches.find (curReq.fetchId);
+      if (fetch != m_fetches.end ())
+        available = fetch->second.bytesReceived;
+
+      Ptr<Packet> packet;
+      int64_t toSend = std::min ((int64_t)1446, available - client.bytesSent);
+
+      if (client.unsentPacket)
+      {
+          packet = client.unsentPacket;
+          toSend = packet->GetSize ();
+      }
+      else if (toSend <= 0)
+      {
+          break;    // wait for the origin
+      }
+      else
+      {
+          packet = Create<Packet> (toSend);
+      }
+
+      int actual = client.socket->Send (packet);
+      if (actual == -1)
+      {
+          client.unsentPacket = packet;
+          break;
+      }
+      else if (actual == toSend)
+      {
+          m_txTrace (packet, from);
+          client.unsentPacket = 0;
+          client.bytesSent += actual;
+      }
+      else if (actual > 0 && actual < toSend)
+      {
+          Ptr<Packet> sent = packet->CreateFragment (0, actual);
+          Ptr<Packet> unsent = packet->CreateFragment (actual, (toSend - (unsigned) actual));
+          m_txTrace (sent, from);
+          client.unsentPacket = unsent;
+          client.bytesSent += actual;
+          break;
+      }
+      else
+      {
+          NS_FATAL_ERROR ("[CACHE] Unexpected return value from m_socket->Send ()");
+      }
+
+      if (client.bytesSent == curReq.req.segmentSize)
+      {
+        client.bytesSent = 0;
+        client.requests.pop ();
+      }
+    }
+}
+
+void mvdashCacheServer::HandleSend (Ptr<Socket> socket, unsigned int unused)
+{
+    NS_LOG_FUNCTION (this);
+    
+    Address from;
+    socket->GetPeerName (from);
+    std::map<Address, st_cacheClient>::iterator it = m_clients.find (from);
+    if (it != m_clients.end () && it->second.unsentPacket)
+      SendResponse (from);    
+}
+
+void mvdashCacheServer::HandlePeerClose (Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION (this << socket);
+
+    for (std::map<Address, st_cacheClient>::iterator it = m_clients.begin (); it != m_clients.end (); ++it)
+    {
+      if (it->second.socket == socket)
+      {
+        // The origin connection stays up for clients that connect later;
+        // it is closed in StopApplication
+        m_clients.erase (it);
+        return;
+      }
+    }
+}
+ 
+void mvdashCacheServer::HandlePeerError (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+}
+
+// ===========================================================================================
+// Origin side
+
+void mvdashCacheServer::OriginConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  m_originConnected = true;
+  FlushOriginRequests ();
+}
+
+void mvdashCacheServer::OriginConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  NS_LOG_ERROR ("mvdashCacheServer, connection to the origin failed");
+}
+
+void mvdashCacheServer::FlushOriginRequests (void)
+{
+    NS_LOG_FUNCTION (this);
+    if (!m_originConnected) return;
+
+    while (!m_originBacklog.empty ()) {
+      Ptr<Packet> packet = Create<Packet> ((uint8_t *) &m_originBacklog.front (), sizeof (st_mvdashRequest));
+      if (m_originSocket->Send (packet) < (int) sizeof (st_mvdashRequest))
+        break;    // retried from HandleOriginSend
+      m_originBacklog.pop ();
+    }
+}
+
+void mvdashCacheServer::HandleOriginSend (Ptr<Socket> socket, unsigned int unused)
+{
+  FlushOriginRequests ();
+}
+
+void mvdashCacheServer::HandleOriginRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+
+  while ((packet = socket->Recv ())) {
+    if (packet->GetSize () == 0)   // EOF
+      break;
+
+    // The origin answers in request order; spread the bytes over the fetches
+    int64_t bytes = packet->GetSize ();
+    while (bytes > 0 && !m_originQueue.empty ()) {
+      uint64_t fetchId = m_originQueue.front ();
+      st_originFetch &fetch = m_fetches[fetchId];
+      int64_t take = std::min (bytes, (int64_t) (fetch.segmentSize - fetch.bytesReceived));
+      fetch.bytesReceived += take;
+      bytes -= take;
+
+      std::vector <Address> waiters = fetch.waiters;
+      if (fetch.bytesReceived >= fetch.segmentSize) {
+        m_cache.Insert (fetch.key, fetch.segmentSize);
+        m_fetchByKey.erase (fetch.key);
+        m_fetches.erase (fetchId);
+        m_originQueue.pop ();
+      }
+      for (const Address &from : waiters)
+        SendResponse (from);
+    }
+  }
+}
+
+}// Namespace ns3
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MVDASH_CACHE_SERVER_H
+#define MVDASH_CACHE_SERVER_H
+
+#include "ns3/application.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/traced-callback.h"
+#include <map>
+#include <queue>
+#include <vector>
+#include "mvdash.h"
+#include "mvdash_segment_cache.h"
+
+namespace ns3 {
+
+class Address;
+class Socket;
+class Packet;
+
+/**
+ * \brief Edge cache between mvdashClients and the origin mvdashServer.
+ *
+ * Clients connect to the cache exactly as to an mvdashServer.  A request is
+ * served from the segment cache on a hit.  A miss for a segment that is
+ * already being fetched waits for that fetch (coalescing), otherwise the
+ * request is forwarded to the origin over a single upstream connection.
+ * Fetched bytes are relayed to the waiting clients as they arrive, and each
+ * client gets its responses in request order.
+ */
+class mvdashCacheServer : public Application 
+{
+public:
+  static TypeId GetTypeId (void);
+  mvdashCacheServer ();
+  virtual ~mvdashCacheServer ();
+
+  uint64_t GetNHits (void) const { return m_nHits; }
+  uint64_t GetNMisses (void) const { return m_nMisses; }
+  uint64_t GetNCoalesced (void) const { return m_nCoalesced; }
+  /**
+   * \returns hits / requests; coalesced misses do not count as hits
+   */
+  double GetHitRatio (void) const;
+  /**
+   * \returns 1 - (bytes fetched from the origin) / (bytes requested by the clients)
+   */
+  double GetOriginOffload (void) const;
+  const mvdashSegmentCache & GetCache (void) const { return m_cache; }
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);    // Called at time specified by Start
+  virtual void StopApplication (void);     // Called at time specified by Stop
+
+  /// A client request and the fetch it waits for (0 if the segment is complete)
+  struct st_cacheRequest
+  {
+    st_mvdashRequest req;
+    uint64_t fetchId;
+  };
+
+  /// Per-client connection state
+  struct st_cacheClient
+  {
+    Ptr<Socket> socket;
+    std::queue <st_cacheRequest> requests;
+    int64_t bytesSent;          //!< bytes of the head request already sent
+    Ptr<Packet> unsentPacket;
+    Ptr<Packet> partialRequest; //!< leading bytes of a request split by TCP
+  };
+
+  /// A segment being fetched from the origin
+  struct st_originFetch
+  {
+    uint64_t key;
+    int32_t segmentSize;
+    int32_t bytesReceived;
+    std::vector <Address> waiters;
+  };
+
+  void HandleRead (Ptr<Socket> socket);
+  void HandleSend (Ptr<Socket> socket, unsigned int unused);
+  void HandleAccept (Ptr<Socket> socket, const Address& from);
+  void HandlePeerClose (Ptr<Socket> socket);
+  void HandlePeerError (Ptr<Socket> socket);
+
+  void OriginConnectionSucceeded (Ptr<Socket> socket);
+  void OriginConnectionFailed (Ptr<Socket> socket);
+  void HandleOriginRead (Ptr<Socket> socket);
+  void HandleOriginSend (Ptr<Socket> socket, unsigned int unused);
+
+  bool ParseRequest (Ptr<Packet> packet, const Address &from);
+  /**
+   * \returns the id of the fetch the request waits for, 0 on a hit
+   */
+  uint64_t LookupSegment (const st_mvdashRequest &req, const Address &from);
+  void FlushOriginRequests (void);
+  void SendResponse (const Address &from);
+
+  Ptr<Socket>     m_socket;       //!< Listening socket
+  Address m_localAddress;         //!< Local Address on which we listen for incoming packets.
+  Address m_originAddress;        //!< Address of the origin mvdashServer
+  Ptr<Socket>     m_originSocket; //!< Upstream connection to the origin
+  bool            m_originConnected;
+
+  uint64_t        m_cacheSize;
+  std::string     m_policyName;
+  mvdashSegmentCache m_cache;
+
+  std::map <Address, st_cacheClient> m_clients;
+  std::map <uint64_t, st_originFetch> m_fetches;      //!< in flight, by fetch id
+  std::map <uint64_t, uint64_t> m_fetchByKey;         //!< segment key -> fetch id
+  std::queue <uint64_t> m_originQueue;                //!< fetch ids in upstream response order
+  std::queue <st_mvdashRequest> m_originBacklog;      //!< requests not yet written upstream
+  uint64_t        m_nextFetchId;
+
+  uint64_t        m_nHits;
+  uint64_t        m_nMisses;
+  uint64_t        m_nCoalesced;
+  uint64_t        m_bytesRequested;
+  uint64_t        m_bytesFetched;
+
+  /// Traced Callback: received packets, source address.
+  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+  /// Traced Callback: sent packets
+  TracedCallback<Ptr<const Packet>, const Address &> m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_CACHE_SERVER_H */
@@ -18,12 +18,15 @@
 #include "mvdash_client.h"
 #include <ns3/core-module.h>
 #include "ns3/tcp-socket.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-congestion-ops.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
-#include "free_viewpoint_model.h"
-#include "markovian_viewpoint_model.h"
-#include "maximize_current_adaptation.h"
-#include <numeric>
+#include "ns3/udp-socket-factory.h"
+#include "mvdash_manifest.h"
+#include "ns3/pointer.h"
+#include <algorithm>
+#include <limits>
 
 namespace ns3 {
 
@@ -31,6 +34,22 @@ NS_LOG_COMPONENT_DEFINE ("mvdashClient");
 
 NS_OBJECT_ENSURE_REGISTERED (mvdashClient);
 
+// Streams reserved per client for its viewpoint model, from StreamBase on.
+// Stream numbers are fixed by ClientId, so a client draws the same viewpoint
+// sequence whichever other clients share the simulation (or the process).
+static const int64_t VIEW_MODEL_STREAMS = 2;
+// The viewport models draw from streams past those of any viewpoint model,
+// so tiling the video leaves the viewpoint sequences unchanged
+static const int64_t VIEWPORT_MODEL_STREAMS = 2;
+static const int64_t VIEWPORT_STREAM_BASE = (int64_t) 1 << 32;
+
+// Key of m_mcastBytes, ordered by time index so that the segments of played
+// groups are erased as a range
+static uint64_t MulticastKey (int32_t tIndex, int32_t viewpoint)
+{
+  return ((uint64_t) (uint32_t) tIndex << 32) | (uint32_t) viewpoint;
+}
+
 TypeId mvdashClient::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::mvdashClient")
@@ -47,18 +66,46 @@ TypeId mvdashClient::GetTypeId (void)
                    AddressValue (),
                    MakeAddressAccessor (&mvdashClient::m_serverAddress),
                    MakeAddressChecker ())
+    .AddAttribute ("UseQuic",
+                   "0 - requests and segments over TCP, 1 - over the UDP transport with one stream per viewpoint",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashClient::m_useQuic),
+                   MakeUintegerChecker<uint32_t> (0, 1))
+    .AddAttribute ("Connections",
+                   "The number of parallel TCP connections to the server",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&mvdashClient::m_nConnections),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ConnectionPolicy",
+                   "How requests are spread over the connections: viewpoint (viewpoint modulo Connections) or least-loaded",
+                   StringValue ("viewpoint"),
+                   MakeStringAccessor (&mvdashClient::m_connPolicyName),
+                   MakeStringChecker ())
+    .AddAttribute ("SideViewCongestionControl",
+                   "TypeId of the congestion control, e.g. ns3::TcpLedbat, of an extra connection that carries the side views; "
+                   "empty sends every viewpoint over the Connections pool. BufferMode=viewpoint only: a group waits for "
+                   "its slowest part, so a yielding side-view connection would hold up the main view",
+                   StringValue (""),
+                   MakeStringAccessor (&mvdashClient::m_sideViewCcName),
+                   MakeStringChecker ())
     .AddAttribute ("ClientId",
-                   "The ID of the this client object, for logging purposes",
+                   "The ID of this client object, used in log file names and to select the random variable streams of its viewpoint model",
                    UintegerValue (0),
                    MakeUintegerAccessor (&mvdashClient::m_clientId),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StreamBase",
+                   "The first random variable stream of the viewpoint models: a client takes the streams from "
+                   "StreamBase + 2 * ClientId, and mvdashClientHelper::AssignStreams sets it past the other streams of a simulation",
+                   IntegerValue (0),
+                   MakeIntegerAccessor (&mvdashClient::m_streamBase),
+                   MakeIntegerChecker<int64_t> ())
     .AddAttribute ("VPInfo",
                    "The relative path to the file containing viewpoint switching info",
                    StringValue ("./contrib/etri_mvdash/viewpoint_transition.csv"),
                    MakeStringAccessor (&mvdashClient::m_vpInfoFilePath),
                    MakeStringChecker ())
     .AddAttribute ("VPModel",
-                   "The View-point Switching Model",
+                   "The View-point Switching Model: markovian, free, or trace to replay the viewpoints of VPInfo",
                    StringValue ("markovian"),
                    MakeStringAccessor (&mvdashClient::m_vpModelName),
                    MakeStringChecker ())  
@@ -72,6 +119,118 @@ TypeId mvdashClient::GetTypeId (void)
                    StringValue ("maximize_current"),
                    MakeStringAccessor (&mvdashClient::m_mvAlgoName),
                    MakeStringChecker ())  
+    .AddAttribute ("BufferMode",
+                   "group - the viewpoints of a time index are downloaded as one group into one buffer, "
+                   "viewpoint - each viewpoint has its own buffer and download pipeline",
+                   StringValue ("group"),
+                   MakeStringAccessor (&mvdashClient::m_bufferModeName),
+                   MakeStringChecker ())
+    .AddAttribute ("MainBufferTarget",
+                   "In the viewpoint buffer mode, the buffer the main view is filled to",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&mvdashClient::m_mainBufferTarget),
+                   MakeTimeChecker ())
+    .AddAttribute ("SideBufferTarget",
+                   "In the viewpoint buffer mode, the buffer the side views are filled to",
+                   TimeValue (Seconds (4)),
+                   MakeTimeAccessor (&mvdashClient::m_sideBufferTarget),
+                   MakeTimeChecker ())
+    .AddAttribute ("PushDepth",
+                   "In the viewpoint buffer mode over TCP, the segments of the main view a server with Push "
+                   "sends after each one requested; 0 pulls every segment.  The client must connect to the "
+                   "mvdashServer itself, an mvdashCacheServer does not frame its responses",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashClient::m_pushDepth),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("TileInfo",
+                   "The path to the tile sizes of the video, see mvdashReadTileManifest; empty for whole viewpoints, "
+                   "or tiles of equal size when TileColumns and TileRows are set",
+                   StringValue (""),
+                   MakeStringAccessor (&mvdashClient::m_tileInfoFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("TileColumns",
+                   "Without TileInfo, the columns of tiles of equal size each segment is cut into; 0 for whole viewpoints",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashClient::m_tileColumns),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("TileRows",
+                   "Without TileInfo, the rows of tiles of equal size each segment is cut into",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&mvdashClient::m_tileRows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("OutOfViewportQuality",
+                   "The quality index of the tiles outside the expected viewport",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashClient::m_outOfViewportQuality),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ViewportMargin",
+                   "Degrees added around the current viewport to predict the viewport of a requested segment",
+                   DoubleValue (15.0),
+                   MakeDoubleAccessor (&mvdashClient::m_viewportMargin),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("LayerInfo",
+                   "The path to the layer sizes of a scalable video, see mvdashReadLayerManifest; "
+                   "empty for single-layer representations unless Layered is set",
+                   StringValue (""),
+                   MakeStringAccessor (&mvdashClient::m_layerInfoFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("Layered",
+                   "Without LayerInfo, make a base layer and enhancement layers of the rates of MVInfo",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&mvdashClient::m_layered),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LayerOverhead",
+                   "Without LayerInfo, the share by which a layered level outgrows its single-layer size",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&mvdashClient::m_layerOverhead),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("SwitchInfo",
+                   "The path to the switch segment sizes of the video, see mvdashReadSwitchManifest; empty for none "
+                   "unless SwitchDuration is set",
+                   StringValue (""),
+                   MakeStringAccessor (&mvdashClient::m_switchInfoFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("SwitchDuration",
+                   "Without SwitchInfo, the duration of switch segments made of the rates of MVInfo, a whole fraction "
+                   "of the segment duration; 0 for none",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&mvdashClient::m_switchDuration),
+                   MakeTimeChecker ())
+    .AddAttribute ("SwitchOverhead",
+                   "Without SwitchInfo, the share by which switch segments outgrow their share of the regular segment",
+                   DoubleValue (0.15),
+                   MakeDoubleAccessor (&mvdashClient::m_switchOverhead),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MulticastGroup",
+                   "The group Address and port of the server multicast; unset disables multicast reception",
+                   AddressValue (),
+                   MakeAddressAccessor (&mvdashClient::m_mcastGroup),
+                   MakeAddressChecker ())
+    .AddAttribute ("MulticastViewpoints",
+                   "Comma separated indexes of the viewpoints the server multicasts",
+                   StringValue (""),
+                   MakeStringAccessor (&mvdashClient::m_mcastViewpointsStr),
+                   MakeStringChecker ())
+    .AddAttribute ("MulticastQuality",
+                   "The quality index of the multicast viewpoints",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashClient::m_mcastQuality),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MulticastTimeout",
+                   "Multicast silence after which missing multicast segments are fetched over unicast",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&mvdashClient::m_mcastTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("FluidNetwork",
+                   "Fluid model delivering the segments instead of sockets, for population-scale runs",
+                   PointerValue (),
+                   MakePointerAccessor (&mvdashClient::m_fluid),
+                   MakePointerChecker<mvdashFluidNetwork> ())
+    .AddAttribute ("EnableLogs",
+                   "Write the download, playback and buffer CSV logs when the client stops",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&mvdashClient::m_enableLogs),
+                   MakeBooleanChecker ())
     .AddTraceSource ("ControllerTrace", "Tracing Controller related events",
                      MakeTraceSourceAccessor (&mvdashClient::m_ctrlTrace),
                      "ns3::mvdashClient::ControllerEventCallback")
@@ -91,14 +250,40 @@ TypeId mvdashClient::GetTypeId (void)
   return tid;
 }
 
+int64_t mvdashClient::GetViewModelStreams (void)
+{
+  return VIEW_MODEL_STREAMS;
+}
+
 mvdashClient::mvdashClient ()
-    : m_socket(0),
+    : mvdashGroupController (m_video),
+      m_nConnections (1),
+      m_leastLoaded (false),
+      m_nConnected (0),
       m_connected (false),
-      m_state(initial),
-      m_bytesReceived(0),
-      m_sendRequestCounter(0),
+      m_useQuic (0),
       m_recvRequestCounter(-1),
-      m_segStarted(false)
+      m_udpSocket(0),
+      m_udpRequestMsgId(0),
+      m_mcastQuality(0),
+      m_mcastSocket(0),
+      m_nMcastRepairs(0),
+      m_vpBuffering(false),
+      m_tIndexViewDrawn(0),
+      m_throughput(0),
+      m_lastDownloadEnd(0),
+      m_pushDepth(0),
+      m_nPushed(0),
+      m_nPushCancels(0),
+      m_switchOverhead(0.15),
+      m_nSwitchParts(0),
+      m_switchTIndex(-1),
+      m_switchQuality(-1),
+      m_switchPlayIndex(0),
+      m_tileColumns(0),
+      m_tileRows(1),
+      m_outOfViewportQuality(0),
+      m_layerOverhead(0.1)
 {
     NS_LOG_FUNCTION (this);
     m_tIndexLast = 10;
@@ -115,7 +300,15 @@ mvdashClient::~mvdashClient ()
 void mvdashClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
+  m_connections.clear ();
+  m_udpSocket = 0;
+  m_mcastSocket = 0;
+  m_fluid = 0;
+  if (m_udpConnection)
+    {
+      m_udpConnection->Dispose ();
+      m_udpConnection = 0;
+    }
   // chain up
   Application::DoDispose ();
 }
@@ -124,100 +317,170 @@ void mvdashClient::Controller (controllerEvent event)
 {
     NS_LOG_FUNCTION (this);
 
-    //NS_LOG_INFO("Controller S: " << m_state << " E:" << event << " at " << Simulator::Now ().GetSeconds ());
-  
-    if (m_state == initial) {
-      st_mvdashRequest * pReq = PrepareRequest(0);
-      if (SendRequest(pReq, 5)) {
-        m_state = downloading;
-      }
-      free(pReq);
+    if (m_vpBuffering) {
+      ViewpointController(event);
       return;
     }
+    mvdashGroupController::Controller(event);
+}
 
-    if (m_state == downloading) {
-      switch (event) {
-        case downloadFinished :
-          StartPlayback();
-          if (m_tIndexDownloaded >= m_tIndexLast) { // *e_df
-            m_ctrlTrace(this, m_state, cteAllDownloaded, m_tIndexLast);
-            m_state = playing;
-          } 
-          else { // *e_d
-            st_mvdashRequest * pReq = PrepareRequest(m_tIndexReqSent+1);
-            if (SendRequest(pReq, 5)) {
-              m_state = downloadingPlaying;      
-            }
-            free(pReq);
-          }
-          break;
-        default : break;
-      }
-      return;
-    }
+// mvdashGroupController
+int64_t mvdashClient::GetTimeNow (void) const
+{
+  return Simulator::Now ().GetMicroSeconds ();
+}
 
-    if (m_state == downloadingPlaying) {
-      switch (event) {
-        case downloadFinished :
-          if (m_tIndexDownloaded >= m_tIndexLast) { // *e_df
-            m_ctrlTrace(this, m_state, cteAllDownloaded, m_tIndexLast);
-            m_state = playing;
-          } 
-          else { // *e_d
-            st_mvdashRequest * pReq = PrepareRequest(m_tIndexReqSent+1);
-            SendRequest(pReq, 5);
-            free(pReq);
-          }
-          break;
-        case playbackFinished :
-          m_ctrlTrace(this, m_state, cteEndPlayback, m_tIndexPlay-1);
-          if (!StartPlayback()) {// Buffer Underrun // *e_pu
-            m_state = downloading;
-          }
-          break;
-        default : break;
-      }
-      return;
-    }
+bool mvdashClient::SendGroup (const std::vector <st_mvdashRequest> &requests)
+{
+  NS_LOG_FUNCTION (this << requests.size());
+  if (!m_connected)
+    return false;
+
+  std::vector <st_mvdashRequest> unicast, multicast;
+  for (const st_mvdashRequest &req : requests) {
+    if (!m_mcastGroup.IsInvalid() && m_isMcastViewpoint[req.viewpoint]
+        && req.qualityIndex == (int32_t) m_mcastQuality)
+      multicast.push_back(req);
+    else
+      unicast.push_back(req);
+  }
+  if (!unicast.empty() && !SendUnicast (unicast))
+    return false;
+
+  m_mcastRequests = multicast;
+  m_reqTrace (this, reqev_reqMsgSent, m_sendRequestCounter);
+  if (unicast.empty())  // the whole group comes from the multicast group
+    Simulator::ScheduleNow (&mvdashClient::CheckMulticastGroup, this);
+  return true;
+}
 
-    if (m_state == playing) {
-      switch (event) {
-        case playbackFinished :
-          m_ctrlTrace(this, m_state, cteEndPlayback, m_tIndexPlay-1);
-          if (m_tIndexPlay <= m_tIndexLast) {
-            if (!StartPlayback()) {// Buffer Underrun // *e_pu
-              NS_LOG_INFO("SOMETHING WRONG : S_P and Buffer Underrun");
-            } 
-          }
-          else { // *e_pf
-            m_state = terminal;
-            StopApplication();
-          }
-          break;
-        default : break;
-      }
-      return;      
-    }
+void mvdashClient::AdjustQualities (std::vector <int32_t> &qIndex)
+{
+  // Only a higher quality than the multicast one is worth a unicast download
+  for (int vp = 0; vp < m_nViewpoints && !m_mcastGroup.IsInvalid(); vp ++) {
+    if (m_isMcastViewpoint[vp] && qIndex[vp] <= (int32_t) m_mcastQuality)
+      qIndex[vp] = m_mcastQuality;
+  }
+}
+
+void mvdashClient::PlaybackStarted (void)
+{
+  Simulator::Schedule (MicroSeconds (m_videoData[0].segmentDuration), &mvdashClient::Controller, this, playbackFinished);
+}
+
+void mvdashClient::SessionFinished (void)
+{
+  StopApplication();
+}
+
+void mvdashClient::TraceController (controllerTraceEvent event, int32_t tIndex)
+{
+  m_ctrlTrace(this, m_state, event, tIndex);
 }
+
 // Application Methods
 void mvdashClient::StartApplication ()    // Called at time specified by Start
 {
   NS_LOG_FUNCTION (this);
   // Create the socket if not already
   //Initialize(); 
-  if (!m_socket)
+  NS_ABORT_MSG_IF (m_connPolicyName != "viewpoint" && m_connPolicyName != "least-loaded",
+                   "Unknown ConnectionPolicy " << m_connPolicyName);
+  m_leastLoaded = (m_connPolicyName == "least-loaded");
+  NS_ABORT_MSG_IF (!m_sideViewCcName.empty () && !m_vpBuffering,
+                   "A side-view connection needs the viewpoint buffer mode");
+  NS_ABORT_MSG_IF (m_vpBuffering && !m_mcastGroup.IsInvalid (),
+                   "The viewpoint buffer mode downloads over unicast only");
+  NS_ABORT_MSG_IF (m_nTiles > 0 && (m_vpBuffering || m_useQuic || !m_mcastGroup.IsInvalid ()),
+                   "Tiles are downloaded in the group buffer mode, over TCP or the fluid network");
+  NS_ABORT_MSG_IF (m_layered && (m_nTiles > 0 || m_useQuic || !m_mcastGroup.IsInvalid ()),
+                   "Layers are downloaded whole, over TCP or the fluid network");
+  NS_ABORT_MSG_IF (m_pushDepth > 0 && (!m_vpBuffering || m_useQuic || m_fluid || m_layered),
+                   "Pushed segments are received in the viewpoint buffer mode over TCP, whole");
+  NS_ABORT_MSG_IF (m_nSwitchParts > 0 && (!m_vpBuffering || m_useQuic || m_layered),
+                   "Switch segments are fetched in the viewpoint buffer mode, over TCP or the fluid network, whole");
+
+  if (m_fluid && m_connections.empty ())
+    {
+        NS_ABORT_MSG_IF (m_useQuic || !m_mcastGroup.IsInvalid (),
+                         "The fluid network carries unicast TCP connections only");
+        m_connections.resize (m_nConnections + (m_sideViewCcName.empty () ? 0 : 1));
+        for (st_clientConnection &conn : m_connections)
+        {
+            conn.pendingBytes = 0;
+            conn.bytesReceived = 0;
+            conn.segStarted = false;
+            conn.frameBytes = 0;
+            conn.lowPriority = (&conn == &m_connections.back () && !m_sideViewCcName.empty ());
+            conn.flow = m_fluid->AddFlow (GetNode (), conn.lowPriority,
+                                          MakeCallback (&mvdashClient::HandleFluidStart, this),
+                                          MakeCallback (&mvdashClient::HandleFluidSegment, this));
+        }
+        // Start after the handshake the sockets would take
+        m_connected = true;
+        Time oneWayDelay = m_fluid->GetOneWayDelay (GetNode ());
+        Simulator::Schedule (oneWayDelay + oneWayDelay, &mvdashClient::Controller, this, init);
+    }
+  else if (!m_udpSocket && m_useQuic)
+    {
+        m_udpSocket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+        if (m_udpSocket->Bind () == -1)
+        {
+            NS_FATAL_ERROR ("Failed to bind socket");
+        }
+        m_udpSocket->Connect (m_serverAddress);
+        m_udpSocket->SetRecvCallback (MakeCallback (&mvdashClient::HandleUdpRead, this));
+
+        m_udpConnection = CreateObject<mvdashUdpConnection> ();
+        m_udpConnection->Setup (m_udpSocket, m_serverAddress);
+        m_udpConnection->SetDataCallback (MakeCallback (&mvdashClient::HandleUdpData, this));
+        m_udpConnection->SetMessageCallback (MakeCallback (&mvdashClient::HandleUdpSegment, this));
+        m_udpSegStarted.assign (m_nViewpoints, false);
+
+        // No handshake: the first request opens the connection on the server
+        m_connected = true;
+        Simulator::ScheduleNow (&mvdashClient::Controller, this, init);
+    }
+  else if (!m_useQuic && m_connections.empty ())
     {
         TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
-        m_socket = Socket::CreateSocket (GetNode (), tid);
+        m_connections.resize (m_nConnections + (m_sideViewCcName.empty () ? 0 : 1));
+        for (st_clientConnection &conn : m_connections)
+        {
+            conn.socket = Socket::CreateSocket (GetNode (), tid);
+            conn.pendingBytes = 0;
+            conn.bytesReceived = 0;
+            conn.segStarted = false;
+            conn.frameBytes = 0;
+            conn.lowPriority = (&conn == &m_connections.back () && !m_sideViewCcName.empty ());
+            if (conn.lowPriority)
+            {
+                // Speculative side views yield to the main view under contention
+                ObjectFactory ccFactory;
+                ccFactory.SetTypeId (m_sideViewCcName);
+                DynamicCast<TcpSocketBase> (conn.socket)->SetCongestionControlAlgorithm (ccFactory.Create<TcpCongestionOps> ());
+            }
 
-        if (m_socket->Bind () == -1)
+            if (conn.socket->Bind () == -1)
+            {
+                NS_FATAL_ERROR ("Failed to bind socket");
+            }
+            conn.socket->Connect (m_serverAddress);
+            conn.socket->SetConnectCallback (
+                MakeCallback (&mvdashClient::ConnectionSucceeded, this),
+                MakeCallback (&mvdashClient::ConnectionFailed, this));
+        }
+    }
+  if (!m_mcastGroup.IsInvalid () && !m_mcastSocket)
+    {
+        m_mcastSocket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+        uint16_t port = InetSocketAddress::ConvertFrom (m_mcastGroup).GetPort ();
+        if (m_mcastSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), port)) == -1)
         {
-            NS_FATAL_ERROR ("Failed to bind socket");
+            NS_FATAL_ERROR ("Failed to bind multicast socket");
         }
-        m_socket->Connect (m_serverAddress);
-        m_socket->SetConnectCallback (
-            MakeCallback (&mvdashClient::ConnectionSucceeded, this),
-            MakeCallback (&mvdashClient::ConnectionFailed, this));
+        m_mcastSocket->SetRecvCallback (MakeCallback (&mvdashClient::HandleMulticastRead, this));
+        m_mcastLastRx = Simulator::Now ();
     }
 }
 
@@ -225,29 +488,59 @@ void mvdashClient::StopApplication ()      // Called at time specified by Stop
 {
   NS_LOG_FUNCTION (this);
 
-  LogDownload();
-  LogPlayback();
-  LogBuffer();
+  if (m_enableLogs) {
+    LogDownload();
+    LogPlayback();
+    LogBuffer();
+  }
 
-  if (m_socket != 0)
+  for (st_clientConnection &conn : m_connections)
     {
-      m_socket->Close ();
-      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-      m_connected = false;
+      if (!conn.socket)
+        continue;   // fluid flow
+      conn.socket->Close ();
+      conn.socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
-  else
+  if (m_udpSocket != 0)
+    {
+      m_udpConnection->Close ();
+      m_udpSocket->Close ();
+      m_udpSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  else if (m_connections.empty ())
     {
       NS_LOG_WARN ("mvdashClient found null socket to close in StopApplication");
-    }  
+    }
+  m_connected = false;
+  if (m_mcastSocket != 0)
+    {
+      m_mcastSocket->Close ();
+      m_mcastSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  Simulator::Cancel (m_mcastTimeoutEvent);
 }
 
 void mvdashClient::ConnectionSucceeded (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   NS_LOG_LOGIC ("mvdashClient Connection succeeded");
-  m_connected = true;
+  socket->SetRecvCallback (MakeCallback (&mvdashClient::HandleRead, this));
+  if (m_pushDepth > 0) {
+    // Pushed segments are told apart by the copy of the request before each segment
+    st_mvdashRequest framed (pushid_framed, 0, 0, 0, 0);
+    Ptr<Packet> packet = Create<Packet> ((uint8_t const *) &framed, sizeof(st_mvdashRequest));
+    // Unframed, the connection would carry pushed segments the client cannot find
+    NS_ABORT_MSG_IF (socket->GetTxAvailable() < packet->GetSize(),
+                     "mvdashClient has no room to frame a new connection");
+    int sent = socket->Send (packet);
+    NS_ABORT_MSG_IF (sent != (int) packet->GetSize(), "mvdashClient could not frame a new connection");
+    m_txTrace (this, packet);
+  }
 
-  m_socket->SetRecvCallback (MakeCallback (&mvdashClient::HandleRead, this));
+  // Start once the whole pool is up
+  if (++m_nConnected < m_connections.size ())
+    return;
+  m_connected = true;
 
   controllerEvent ev = init;
   Controller(ev);
@@ -266,218 +559,827 @@ void mvdashClient::HandleRead (Ptr<Socket> socket)
   NS_LOG_FUNCTION (this << socket);
   Ptr<Packet> packet;
 
+  st_clientConnection *pConn = 0;
+  for (st_clientConnection &conn : m_connections) {
+    if (conn.socket == socket)
+      pConn = &conn;
+  }
+  NS_ASSERT (pConn);
+
   while ((packet = socket->Recv())) {
     int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
     if (packet->GetSize() == 0)   // EOF
       break;
 
-    st_mvdashRequest curSeg = m_requests.front();
+    m_rxTrace(this, packet);
+    if (m_pushDepth > 0) {
+      ReceiveFramed(pConn - m_connections.data(), packet);
+      continue;
+    }
+    pConn->bytesReceived += packet->GetSize();
+    pConn->pendingBytes -= packet->GetSize();
+
+    // The server fills its packets across segment boundaries, so one packet
+    // may end several small segments, e.g. tiles, and start the next one
+    while (!pConn->requests.empty()) {
+      st_mvdashRequest curSeg = pConn->requests.front();
+      if (pConn->bytesReceived == 0 && curSeg.segmentSize > 0)
+        break;  // the next segment has not started yet
+
+      if (m_recvRequestCounter < curSeg.id) {
+        // the first of the request
+        m_recvRequestCounter = curSeg.id;
+        m_downData.time.at(curSeg.id).downloadStart = timeNow;      
+        m_reqTrace(this, reqev_startReceiving, m_recvRequestCounter);
+      }
 
-    if (m_recvRequestCounter < curSeg.id) {
-      // the first of the request
-      m_recvRequestCounter = curSeg.id;
-      m_downData.time.at(curSeg.id).downloadStart = timeNow;      
-      m_reqTrace(this, reqev_startReceiving, m_recvRequestCounter);
+      if (!pConn->segStarted) {
+          if (m_vpBuffering)   // segments of different requests interleave over the pool
+            m_downData.time.at(curSeg.id).downloadStart = timeNow;
+          m_segTrace(this, segev_startReceiving, curSeg);
+          pConn->segStarted = true;
+      }
+
+      if (pConn->bytesReceived < curSeg.segmentSize)
+        break;
+      pConn->bytesReceived -= curSeg.segmentSize;
+      m_segTrace(this, segev_endReceiving, curSeg);
+      pConn->segStarted = false;
+      pConn->requests.pop();
+
+      // The segments of a group may still be on other connections
+      if (m_vpBuffering)
+        ViewpointSegmentFinished(curSeg);
+      else if (!UnicastPending())
+        UnicastPartFinished(curSeg.id, curSeg.timeIndex);
     }
+  }
+}
+
+void mvdashClient::ReceiveFramed (size_t connection, Ptr<Packet> packet)
+{
+  st_clientConnection &conn = m_connections[connection];
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  const uint32_t header = sizeof(st_mvdashRequest);
+  uint32_t offset = 0;
+
+  while (offset < packet->GetSize()) {
+    if (conn.frameBytes < header) {
+      uint32_t take = std::min(header - conn.frameBytes, packet->GetSize() - offset);
+      packet->CreateFragment(offset, take)->CopyData((uint8_t *) &conn.frame + conn.frameBytes, take);
+      conn.frameBytes += take;
+      offset += take;
+      if (conn.frameBytes < header)
+        break;
+
+      st_mvdashRequest &frame = conn.frame;
+      // Without framing the header is payload: it matches neither the next
+      // pulled request nor a push of a request sent earlier
+      bool valid = frame.viewpoint >= 0 && frame.viewpoint < m_nViewpoints;
+      if (frame.id == pushid_pushed)
+        valid = valid && frame.push >= 0 && frame.push < m_sendRequestCounter;
+      else
+        valid = valid && !conn.requests.empty() && conn.requests.front().id == frame.id;
+      NS_ABORT_MSG_IF (!valid, "The server does not frame its responses; PushDepth needs an mvdashServer, "
+                       "not an mvdashCacheServer or another server without push");
+
+      st_viewpointBuffer &buf = m_vpBuffers.at(frame.viewpoint);
+      if (frame.id == pushid_pushed) {
+        // A download of its own, requested along with the segment that triggered it
+        int32_t trigger = frame.push;
+        frame.id = m_sendRequestCounter++;
+        frame.push = 0;
+        conn.pendingBytes += frame.segmentSize;
+        std::vector <int32_t> qIndexes(m_nViewpoints, -1);
+        qIndexes[frame.viewpoint] = frame.qualityIndex;
+        m_downData.id.push_back(frame.id);
+        m_downData.playbackIndex.push_back(frame.timeIndex);
+        struct st_requestTimeInfo tinfo = {m_downData.time.at(trigger).requestSent, 0, 0};
+        m_downData.time.push_back(tinfo);
+        m_downData.qualityIndex.push_back(qIndexes);
+        if (m_tIndexReqSent < frame.timeIndex)
+          m_tIndexReqSent = frame.timeIndex;
+        m_nPushed++;
+      }
+      else if (frame.push > 0) {
+        // The server promises the segments up to timeIndex + push
+        buf.tIndexPushed = frame.timeIndex + frame.push;
+        buf.pushQuality = frame.qualityIndex;
+        buf.pushConnection = connection;
+        buf.tIndexNext = std::max(buf.tIndexNext, buf.tIndexPushed + 1);
+      }
+      buf.tIndexPushStarted = std::max(buf.tIndexPushStarted, frame.timeIndex);
 
-    if (!m_segStarted) {
-        m_segTrace(this, segev_startReceiving, curSeg);
-        m_segStarted = true;
+      if (m_recvRequestCounter < frame.id) {
+        m_recvRequestCounter = frame.id;
+        m_reqTrace(this, reqev_startReceiving, m_recvRequestCounter);
+      }
+      m_downData.time.at(frame.id).downloadStart = timeNow;
+      m_segTrace(this, segev_startReceiving, frame);
+      conn.segStarted = true;
     }
-    m_rxTrace(this, packet);
 
-    m_bytesReceived += packet->GetSize();
+    uint32_t take = std::min((int64_t) conn.frame.segmentSize - conn.bytesReceived, (int64_t) packet->GetSize() - offset);
+    conn.bytesReceived += take;
+    conn.pendingBytes -= take;
+    offset += take;
+    if (conn.bytesReceived < conn.frame.segmentSize)
+      break;
 
-    if (m_bytesReceived >= curSeg.segmentSize) {
-      m_bytesReceived -= curSeg.segmentSize;
-      m_segTrace(this, segev_endReceiving, curSeg);
-      m_segStarted = false;
-      m_requests.pop();
+    st_mvdashRequest curSeg = conn.frame;
+    conn.frameBytes = 0;
+    conn.bytesReceived = 0;
+    conn.segStarted = false;
+    m_segTrace(this, segev_endReceiving, curSeg);
+    if (!conn.requests.empty() && conn.requests.front().id == curSeg.id)
+      conn.requests.pop();    // pulled, not pushed
+    ViewpointSegmentFinished(curSeg);
+  }
+}
 
-      bool bGroupReceived = false;
-      if (m_requests.empty())
-        bGroupReceived = true;
-      else if (m_requests.front().id > m_recvRequestCounter)
-        bGroupReceived = true;
+bool mvdashClient::UnicastPending (void) const
+{
+  for (const st_clientConnection &conn : m_connections) {
+    if (!conn.requests.empty())
+      return true;
+  }
+  return !m_udpRequests.empty();
+}
 
-      if (bGroupReceived) {
-        if (m_tIndexDownloaded <= curSeg.timeIndex)
-          m_tIndexDownloaded = curSeg.timeIndex;
+void mvdashClient::UnicastPartFinished(int32_t id, int32_t tIndex)
+{
+  if (m_mcastRequests.empty())
+    DownloadGroupFinished(id, tIndex);
+  else
+    CheckMulticastGroup();
+}
 
-        m_downData.time.at(curSeg.id).downloadEnd =  timeNow;
+// ===========================================================================================
+// UDP transport
 
-        m_bufferData.timeNow.push_back(timeNow);
-        if (curSeg.id > 0) {
-          m_bufferData.bufferLevelOld.push_back (std::max (m_bufferData.bufferLevelNew.back() 
-            - (timeNow - m_downData.time.at(curSeg.id-1).downloadEnd),(int64_t) 0));
-        }
-        else { // first segment
-          m_bufferData.bufferLevelOld.push_back(0);
-        }
-        m_bufferData.bufferLevelNew.push_back(m_bufferData.bufferLevelOld.back() + m_videoData[0].segmentDuration);
+void mvdashClient::HandleUdpRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
 
- 
-        m_reqTrace(this, reqev_endReceiving, m_tIndexDownloaded);
-        m_ctrlTrace(this, m_state, cteDownloaded, m_tIndexDownloaded);
-        controllerEvent ev = downloadFinished;
-        Controller(ev);
-      }
-    }
+  while ((packet = socket->Recv())) {
+    m_udpConnection->Receive(packet);
   }
 }
 
-void mvdashClient::SelectRateIndexes(int tIndexReq, std::vector <int32_t> *pIndexes) 
+void mvdashClient::HandleUdpData (Ptr<mvdashUdpConnection> connection, uint16_t viewpoint, uint32_t id, Ptr<const Packet> packet)
 {
-  (*pIndexes)[0] = 1;
-  (*pIndexes)[1] = 1;
+  std::map <int32_t, st_mvdashRequest>::iterator it = m_udpRequests.find(viewpoint);
+  if (it == m_udpRequests.end() || it->second.id != (int32_t) id)
+    return;
+
+  if (m_recvRequestCounter < (int32_t) id) {
+    m_recvRequestCounter = id;
+    m_downData.time.at(id).downloadStart = Simulator::Now ().GetMicroSeconds ();
+    m_reqTrace(this, reqev_startReceiving, m_recvRequestCounter);
+  }
+  if (!m_udpSegStarted[viewpoint]) {
+    if (m_vpBuffering)
+      m_downData.time.at(id).downloadStart = Simulator::Now ().GetMicroSeconds ();
+    m_segTrace(this, segev_startReceiving, it->second);
+    m_udpSegStarted[viewpoint] = true;
+  }
+  m_rxTrace(this, packet);
+}
 
-//  qIndexes = (std::vector <int32_t>) {1, 0, 0, 0, 0};
+void mvdashClient::HandleUdpSegment (Ptr<mvdashUdpConnection> connection, uint16_t viewpoint, uint32_t id, uint32_t size, Ptr<Packet> payload)
+{
+  NS_LOG_FUNCTION (this << viewpoint << id);
+  std::map <int32_t, st_mvdashRequest>::iterator it = m_udpRequests.find(viewpoint);
+  if (it == m_udpRequests.end() || it->second.id != (int32_t) id)
+    return;
+
+  st_mvdashRequest curSeg = it->second;
+  m_udpRequests.erase(it);
+  m_udpSegStarted[viewpoint] = false;
+  m_segTrace(this, segev_endReceiving, curSeg);
+
+  if (m_vpBuffering)
+    ViewpointSegmentFinished(curSeg);
+  else if (m_udpRequests.empty())
+    UnicastPartFinished(curSeg.id, curSeg.timeIndex);
 }
-struct st_mvdashRequest * mvdashClient::PrepareRequest(int tIndexReq)
+
+// ===========================================================================================
+// Fluid network
+
+void mvdashClient::HandleFluidStart (uint32_t flow)
 {
-  NS_LOG_FUNCTION (this);
-  struct st_mvdashRequest * pReq = 
-    (struct st_mvdashRequest*) malloc(m_nViewpoints * sizeof(st_mvdashRequest));
+  if (!m_connected)
+    return;
+  for (st_clientConnection &conn : m_connections) {
+    if (conn.flow != flow || conn.requests.empty())
+      continue;
+    st_mvdashRequest &curSeg = conn.requests.front();
+    if (m_recvRequestCounter < curSeg.id) {
+      m_recvRequestCounter = curSeg.id;
+      m_downData.time.at(curSeg.id).downloadStart = Simulator::Now ().GetMicroSeconds ();
+      m_reqTrace(this, reqev_startReceiving, m_recvRequestCounter);
+    }
+    if (m_vpBuffering)
+      m_downData.time.at(curSeg.id).downloadStart = Simulator::Now ().GetMicroSeconds ();
+    m_segTrace(this, segev_startReceiving, curSeg);
+    conn.segStarted = true;
+    return;
+  }
+}
+
+void mvdashClient::HandleFluidSegment (uint32_t flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+  if (!m_connected)
+    return;
+  for (st_clientConnection &conn : m_connections) {
+    if (conn.flow != flow || conn.requests.empty())
+      continue;
+    st_mvdashRequest curSeg = conn.requests.front();
+    conn.pendingBytes -= curSeg.segmentSize;
+    m_segTrace(this, segev_endReceiving, curSeg);
+    conn.segStarted = false;
+    conn.requests.pop();
+
+    if (m_vpBuffering)
+      ViewpointSegmentFinished(curSeg);
+    else if (!UnicastPending())
+      UnicastPartFinished(curSeg.id, curSeg.timeIndex);
+    return;
+  }
+}
 
-  //std::vector <int32_t> qIndex = {1, 0, 0, 0, 0};
-  std::vector <int32_t> qIndex (m_nViewpoints, 0);
-  //SelectRateIndexes(tIndexReq, &qIndex);
+void mvdashClient::DownloadGroupFinished(int32_t id, int32_t tIndex)
+{
+  NS_LOG_FUNCTION (this << id << tIndex);
 
-  m_pAlgorithm->SelectRateIndexes(tIndexReq, m_pViewModel->CurrentViewpoint(), &qIndex);
+  if (m_recvRequestCounter < id) {
+    // Nothing of this group came over unicast
+    m_recvRequestCounter = id;
+    m_downData.time.at(id).downloadStart = m_downData.time.at(id).requestSent;
+  }
+  m_mcastBytes.erase(m_mcastBytes.begin(), m_mcastBytes.lower_bound(MulticastKey(tIndex + 1, 0)));
+
+  m_reqTrace(this, reqev_endReceiving, std::max(m_tIndexDownloaded, tIndex));
+  GroupFinished(id, tIndex);
+}
+
+// ===========================================================================================
+// Multicast reception
+
+void mvdashClient::HandleMulticastRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
 
-  for (int vp = 0; vp < m_nViewpoints; vp ++) {
-    pReq[vp].id = m_sendRequestCounter;
-    pReq[vp].viewpoint = vp;
-    pReq[vp].timeIndex = tIndexReq;
-    pReq[vp].qualityIndex = qIndex[vp];
-    pReq[vp].segmentSize = m_videoData[vp].segmentSize[qIndex[vp]][tIndexReq];
+  while ((packet = socket->Recv())) {
+    if (packet->GetSize() < sizeof(st_mvdashMulticastChunk))
+      continue;
+    st_mvdashMulticastChunk chunk;
+    packet->CopyData((uint8_t *) &chunk, sizeof(st_mvdashMulticastChunk));
+    m_rxTrace(this, packet);
+    m_mcastLastRx = Simulator::Now ();
+
+    if (chunk.viewpoint < 0 || chunk.viewpoint >= m_nViewpoints)
+      continue;
+    if (m_mcastLatest[chunk.viewpoint] < chunk.timeIndex)
+      m_mcastLatest[chunk.viewpoint] = chunk.timeIndex;
+    // Keep only what is still to be played: the group being downloaded and later ones
+    if (chunk.timeIndex >= m_tIndexReqSent && chunk.qualityIndex == (int32_t) m_mcastQuality)
+      m_mcastBytes[MulticastKey(chunk.timeIndex, chunk.viewpoint)] += chunk.length;
   }
-  return pReq;
+  CheckMulticastGroup();
 }
 
-int mvdashClient::SendRequest(struct st_mvdashRequest *pMsg, int nReq)
+void mvdashClient::CheckMulticastGroup (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_mcastRequests.empty() || UnicastPending())
+    return;     // nothing awaited from the group, or the unicast part is not done
+
+  std::vector <st_mvdashRequest> missing, passed;
+  for (const st_mvdashRequest &req : m_mcastRequests) {
+    if (m_mcastBytes[MulticastKey(req.timeIndex, req.viewpoint)] >= req.segmentSize)
+      continue;
+    missing.push_back(req);
+    // The source moved on to a later segment: a chunk was lost or we joined too late
+    if (m_mcastLatest[req.viewpoint] > req.timeIndex)
+      passed.push_back(req);
+  }
 
-  if (m_connected) {
-      Ptr<Packet> packet = Create<Packet> ((uint8_t const *)pMsg, nReq * sizeof(st_mvdashRequest));
-
-      int actual = m_socket->Send (packet);
+  if (missing.empty()) {
+    int32_t id = m_mcastRequests[0].id;
+    int32_t tIndex = m_mcastRequests[0].timeIndex;
+    m_mcastRequests.clear();
+    Simulator::Cancel(m_mcastTimeoutEvent);
+    DownloadGroupFinished(id, tIndex);
+  }
+  else if (!passed.empty()) {
+    SendRepairRequest(passed);
+  }
+  else if (!m_mcastTimeoutEvent.IsRunning()) {
+    m_mcastTimeoutEvent = Simulator::Schedule(m_mcastTimeout, &mvdashClient::MulticastTimeout, this);
+  }
+}
 
-      if (actual == (int) packet->GetSize()) {
-        m_txTrace (this, packet);
-        std::vector <int32_t> qIndexes(m_nViewpoints, -1);
-        for (int i=0; i < nReq; i++) {
-            m_requests.push(pMsg[i]);
-            qIndexes[pMsg[i].viewpoint] = pMsg[i].qualityIndex;
-        }
-        if (m_tIndexReqSent < pMsg[0].timeIndex)
-          m_tIndexReqSent = pMsg[0].timeIndex;
+void mvdashClient::MulticastTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_mcastRequests.empty())
+    return;
 
-        m_downData.id.push_back(pMsg[0].id);
-        m_downData.playbackIndex.push_back(pMsg[0].timeIndex);
-        struct st_requestTimeInfo tinfo = {Simulator::Now ().GetMicroSeconds (), 0, 0};        
-        m_downData.time.push_back(tinfo);        
-        m_downData.qualityIndex.push_back(qIndexes);
+  Time silence = Simulator::Now () - m_mcastLastRx;
+  if (silence < m_mcastTimeout) {
+    m_mcastTimeoutEvent = Simulator::Schedule(m_mcastTimeout - silence, &mvdashClient::MulticastTimeout, this);
+    return;
+  }
+  // The multicast group went silent: fetch the rest of the group over unicast
+  std::vector <st_mvdashRequest> missing;
+  for (const st_mvdashRequest &req : m_mcastRequests) {
+    if (m_mcastBytes[MulticastKey(req.timeIndex, req.viewpoint)] < req.segmentSize)
+      missing.push_back(req);
+  }
+  SendRepairRequest(missing);
+}
 
+void mvdashClient::SendRepairRequest (const std::vector <st_mvdashRequest> &requests)
+{
+  NS_LOG_FUNCTION (this << requests.size());
+  if (requests.empty())
+    return;
 
-        m_reqTrace (this, reqev_reqMsgSent, m_sendRequestCounter++);
-        m_ctrlTrace(this, m_state, cteSendRequest, m_tIndexReqSent); 
+  if (!SendUnicast (requests)) {
+    NS_LOG_WARN ("mvdashClient Unable to send a multicast repair request");
+    return;
+  }
 
-        return 1;
-      }
-      else {
-          NS_LOG_DEBUG ("  mvdashClient Unable to send a request packet" << actual);        
+  // The repaired segments now belong to the unicast part of the group
+  for (const st_mvdashRequest &req : requests) {
+    for (std::vector<st_mvdashRequest>::iterator it = m_mcastRequests.begin(); it != m_mcastRequests.end(); ++it) {
+      if (it->viewpoint == req.viewpoint) {
+        m_mcastRequests.erase(it);
+        break;
       }
+    }
   }
-  return 0;
-/*    if (m_connected) {
-      int nViews = 5;
-      int nSize = sizeof(struct st_mvdashRequestMessage) + nViews * sizeof(struct st_mvdashRequest);
-      struct st_mvdashRequestMessage * pReqMsg = 
-        (struct st_mvdashRequestMessage *) malloc(nSize);
-
-      pReqMsg->id = m_sendRequestCounter++;
-      pReqMsg->nRequests = nViews;
-
-      for (int viewpoint = 0; viewpoint < nViews; viewpoint ++) {
-        pReqMsg->requests[viewpoint].viewpoint = viewpoint;
-        pReqMsg->reqeests[viewpoint].timeIndex = m_tindex;
-        pReqMsg->requests[viewpoint].qualityIndex = 0;
-        pReqMsg->requests[viewpoint].segmentSize = 4000 - viewpoint * 800);
-      }
-      
-      Ptr<Packet> packet = Create<Packet> ((uint8_t const *)pReqMsg, nSize);
+  m_nMcastRepairs += requests.size();
+}
+
+// ===========================================================================================
+// Viewpoint buffer mode
 
-      int actual = m_socket->Send (packet);
+void mvdashClient::ViewpointController (controllerEvent event)
+{
+  NS_LOG_FUNCTION (this << event);
 
-      if (actual == (int) packet->GetSize()) {
-        m_txTrace (this, packet);
-        m_reqTrace (this, reqev_reqMsgSent, m_sendRequestCounter++);
-        m_tindex += 1;
+  switch (m_state) {
+    case initial :
+      m_state = downloading;
+      break;
+    case downloading :  // startup or stall: waiting for the segment of the main view
+      if (event == downloadFinished && ViewpointPlaybackReady()) {
+        StartViewpointPlayback();
+        m_state = downloadingPlaying;
       }
-      else {
-          NS_LOG_INFO (packet->GetSize () << " bytes at time " 
-                  << Simulator::Now ().As (Time::S));
-          NS_LOG_DEBUG ("  mvdashClient Unable to send a request packet" << actual);        
+      break;
+    case downloadingPlaying :
+      if (event != playbackFinished)
+        break;
+      m_ctrlTrace(this, m_state, cteEndPlayback, m_tIndexPlay-1);
+      if (m_tIndexPlay > m_tIndexLast) {
+        m_state = terminal;
+        StopApplication();
+        return;
       }
-    }
-*/
-/*    if (m_connected) {
-      int nViews = 5;
-      std::vector <st_mvdashRequest> groupRequest; 
-      
-      for (int viewpoint = 0; viewpoint < nViews; viewpoint ++) {
-        st_mvdashRequest aRequest(viewpoint, m_tindex, 0, 4000 - viewpoint * 800);
-        groupRequest.push_back(aRequest);
-        m_requests.push(aRequest);
+      if (ViewpointPlaybackReady()) {
+        StartViewpointPlayback();
+      }
+      else {  // Buffer Underrun
+        m_ctrlTrace(this, m_state, cteBufferUnderrun, m_tIndexPlay);
+        m_state = downloading;
       }
+      break;
+    default : break;
+  }
+  ScheduleDownloads();
+}
 
-      Ptr<Packet> packet = Create<Packet> ((uint8_t const *)groupRequest.data(), 
-        sizeof(st_mvdashRequest)*nViews);
+bool mvdashClient::ViewpointPlaybackReady (void)
+{
+  // A stalled segment keeps the viewpoint drawn when it was due
+  if (m_tIndexViewDrawn < m_tIndexPlay) {
+    m_pViewModel->UpdateViewpoint(m_tIndexPlay);
+    m_tIndexViewDrawn = m_tIndexPlay;
+  }
+  return m_vpBuffers[m_pViewModel->CurrentViewpoint()].quality[m_tIndexPlay] >= 0;
+}
 
-      int actual = m_socket->Send (packet);
+void mvdashClient::StartViewpointPlayback (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Schedule (MicroSeconds (m_videoData[0].segmentDuration), &mvdashClient::Controller, this, playbackFinished);
+
+  std::vector <int32_t> qIndexes(m_nViewpoints);
+  for (int32_t vp = 0; vp < m_nViewpoints; vp++)
+    qIndexes[vp] = m_vpBuffers[vp].quality[m_tIndexPlay];
+  m_playData.playbackIndex.push_back(m_tIndexPlay);
+  m_playData.mainViewpoint.push_back(m_pViewModel->CurrentViewpoint());
+  m_playData.playbackStart.push_back(Simulator::Now ().GetMicroSeconds ());
+  m_playData.qualityIndex.push_back(qIndexes);
+
+  m_ctrlTrace(this, m_state, cteStartPlayback, m_tIndexPlay);
+  m_tIndexPlay++;
+
+  // A new main view plays its side view copy: bridge it to the main view quality
+  if (m_nSwitchParts > 0) {
+    m_playData.switchPart.push_back(0);
+    m_playData.switchQuality.push_back(-1);
+    size_t nPlayed = m_playData.mainViewpoint.size();
+    if (nPlayed > 1 && m_playData.mainViewpoint[nPlayed - 1] != m_playData.mainViewpoint[nPlayed - 2])
+      SendSwitchRequest(m_playData.mainViewpoint[nPlayed - 1], m_tIndexPlay - 1);
+  }
+}
 
-      if (actual == (int) packet->GetSize()) {
-        m_txTrace (this, packet);
-        m_reqTrace (this, reqev_reqMsgSent, m_sendRequestCounter++);
-        m_tindex += 1;
-      }
-      else {
-          NS_LOG_INFO (packet->GetSize () << " bytes at time " 
-                  << Simulator::Now ().As (Time::S));
-          NS_LOG_DEBUG ("  mvdashClient Unable to send a request packet" << actual);        
-      }
-    } */
+int64_t mvdashClient::GetBufferLevel (int32_t viewpoint) const
+{
+  const st_viewpointBuffer &buf = m_vpBuffers[viewpoint];
+  int32_t t = m_tIndexPlay;
+  while (t <= m_tIndexLast && buf.quality[t] >= 0)
+    t++;
+  return (t - m_tIndexPlay) * m_videoData[0].segmentDuration;
 }
 
-bool mvdashClient::StartPlayback (void)
+void mvdashClient::ScheduleDownloads (void)
 {
   NS_LOG_FUNCTION (this);
-  // int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
-  // if we got called and there are no segments left in the buffer, there is a buffer underrun
-  if (m_tIndexPlay > m_tIndexDownloaded) {
-      //m_bufferUnderrun = true;
-      m_ctrlTrace(this, m_state, cteBufferUnderrun, m_tIndexPlay);
-      // NS_LOG_INFO("Buffer Underrun" << m_tIndexPlay << "  " << m_tIndexDownloaded);
-      return false;
+  if (!m_connected || m_state == terminal)
+    return;
+
+  int32_t mainVp = m_pViewModel->CurrentViewpoint();
+  int64_t mainLevel = GetBufferLevel(mainVp);
+  // While the main view is shorter than the side views may be, it has the link to itself
+  bool mainShort = mainLevel < m_sideBufferTarget.GetMicroSeconds()
+                   && m_tIndexPlay + mainLevel / m_videoData[0].segmentDuration <= m_tIndexLast;
+
+  // Enhancement layers for what the main view buffered as a side view come
+  // before more of its buffer
+  if (m_layered && !mainShort && m_vpBuffers[mainVp].tIndexPending < 0)
+    SendUpgradeRequest(mainVp);
+
+  // Promised segments the viewpoint no longer needs at their quality; not
+  // while a request past them is out, as they come before its response
+  for (int32_t vp = 0; vp < m_nViewpoints && m_pushDepth > 0; vp++) {
+    const st_viewpointBuffer &buf = m_vpBuffers[vp];
+    if (buf.tIndexPushed <= buf.tIndexPushStarted || buf.tIndexPending > buf.tIndexPushed)
+      continue;
+    int32_t tIndex = buf.tIndexPushStarted + 1;
+    if (vp != mainVp
+        || m_pAlgorithm->SelectViewpointRate(tIndex, vp, mainVp, GetBufferLevel(vp), m_throughput) != buf.pushQuality)
+      CancelPush(vp);
   }
-  else {  // m_tIndexPlay <= m_tIndexDownloaded
-      //m_bufferUnderrun = false;
-      if (m_tIndexPlay > 0)
-        m_pViewModel->UpdateViewpoint(m_tIndexPlay);
-      controllerEvent ev = playbackFinished;
-      Simulator::Schedule (MicroSeconds (m_videoData[0].segmentDuration), &mvdashClient::Controller, this, ev); 
 
-      m_playData.playbackIndex.push_back(m_tIndexPlay);
-      m_playData.mainViewpoint.push_back(m_pViewModel->CurrentViewpoint());
-      m_playData.playbackStart.push_back(Simulator::Now ().GetMicroSeconds ());
-      m_playData.qualityIndex.push_back(m_downData.qualityIndex[m_tIndexPlay]);
+  // Earliest playback deadline first, the main view first on a tie
+  std::vector < std::pair<int64_t, int32_t> > ready;
+  for (int32_t vp = 0; vp < m_nViewpoints; vp++) {
+    st_viewpointBuffer &buf = m_vpBuffers[vp];
+    if (buf.tIndexPending >= 0)
+      continue;
+    // Played time indexes are of no use any more
+    buf.tIndexNext = std::max(buf.tIndexNext, m_tIndexPlay);
+    while (buf.tIndexNext <= m_tIndexLast && buf.quality[buf.tIndexNext] >= 0)
+      buf.tIndexNext++;
+    if (buf.tIndexNext > m_tIndexLast)
+      continue;
+    Time target = (vp == mainVp) ? m_mainBufferTarget : m_sideBufferTarget;
+    if (GetBufferLevel(vp) >= target.GetMicroSeconds() || (vp != mainVp && mainShort))
+      continue;
+    ready.push_back(std::make_pair(2 * (int64_t) buf.tIndexNext + (vp != mainVp), vp));
+  }
+  std::sort(ready.begin(), ready.end());
+  for (const std::pair<int64_t, int32_t> &r : ready) {
+    int32_t tIndex = m_vpBuffers[r.second].tIndexNext;
+    int32_t quality = m_pAlgorithm->SelectViewpointRate(tIndex, r.second, mainVp, GetBufferLevel(r.second), m_throughput);
+    if (!SendViewpointRequest(r.second, tIndex, quality))
+      break;    // no room in the socket buffers; the next event tries again
+  }
+}
 
-      m_ctrlTrace(this, m_state, cteStartPlayback, m_tIndexPlay);
-      m_tIndexPlay++;     
-      return true;
+bool mvdashClient::SendUpgradeRequest (int32_t viewpoint)
+{
+  NS_LOG_FUNCTION (this << viewpoint);
+  const st_viewpointBuffer &buf = m_vpBuffers[viewpoint];
+  const struct videoData &video = m_videoData[viewpoint];
+  int64_t level = GetBufferLevel(viewpoint);
+  if (m_throughput <= 0 || m_playData.playbackStart.empty())
+    return false;
+
+  // The earliest buffered segment whose missing layers come in before it is
+  // due, that is before the segments ahead of it have played
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  for (int32_t t = m_tIndexPlay; t <= m_tIndexLast && buf.quality[t] >= 0; t++) {
+    int32_t quality = m_pAlgorithm->SelectViewpointRate(t, viewpoint, viewpoint, level, m_throughput);
+    if (quality <= buf.quality[t])
+      continue;
+    // Layers add to those buffered; a single-layer segment comes again whole
+    int64_t bytes = video.segmentSize[quality][t] - (m_layered ? video.segmentSize[buf.quality[t]][t] : 0);
+    int64_t due = m_playData.playbackStart.back() + (t - m_tIndexPlay + 1) * video.segmentDuration;
+    if (timeNow + bytes * 1e6 / m_throughput < due)
+      return m_layered ? SendViewpointRequest(viewpoint, t, quality) : SendRefetchRequest(viewpoint, t, quality);
+  }
+  return false;
+}
+
+bool mvdashClient::SendRefetchRequest (int32_t viewpoint, int32_t tIndex, int32_t quality)
+{
+  NS_LOG_FUNCTION (this << viewpoint << tIndex << quality);
+  // The segment in flight for the viewpoint and the segments promised after
+  // it stay awaited; the one fetched again is buffered already, so it moves
+  // neither, and it asks for no push of its own
+  st_mvdashRequest req (m_sendRequestCounter, viewpoint, tIndex, quality,
+                        m_videoData[viewpoint].segmentSize[quality][tIndex]);
+  req.mainView = viewpoint == m_pViewModel->CurrentViewpoint();
+  if (!SendUnicast (std::vector <st_mvdashRequest> (1, req)))
+    return false;
+
+  RecordViewpointRequest(viewpoint, tIndex, quality);
+  return true;
+}
+
+void mvdashClient::CancelPush (int32_t viewpoint)
+{
+  NS_LOG_FUNCTION (this << viewpoint);
+  st_viewpointBuffer &buf = m_vpBuffers[viewpoint];
+  Ptr<Socket> socket = m_connections[buf.pushConnection].socket;
+  if (socket->GetTxAvailable() < sizeof(st_mvdashRequest))
+    return;
+
+  // A segment the server started before the cancel arrives still comes, and
+  // is taken in on top of the one requested again
+  int32_t tIndex = buf.tIndexPushStarted + 1;
+  st_mvdashRequest cancel (pushid_cancel, viewpoint, tIndex, 0, 0);
+  Ptr<Packet> packet = Create<Packet> ((uint8_t const *) &cancel, sizeof(st_mvdashRequest));
+  socket->Send (packet);
+  m_txTrace (this, packet);
+
+  m_nPushCancels += buf.tIndexPushed - tIndex + 1;
+  buf.tIndexPushed = tIndex - 1;
+  buf.tIndexNext = tIndex;
+  if (buf.tIndexPending >= tIndex)
+    buf.tIndexPending = -1;
+}
+
+bool mvdashClient::SendSwitchRequest (int32_t viewpoint, int32_t tIndex)
+{
+  NS_LOG_FUNCTION (this << viewpoint << tIndex);
+  st_viewpointBuffer &buf = m_vpBuffers[viewpoint];
+  const struct videoData &video = m_videoData[viewpoint];
+  int32_t quality = m_pAlgorithm->SelectViewpointRate(tIndex, viewpoint, viewpoint, GetBufferLevel(viewpoint), m_throughput);
+  if (quality <= buf.quality[tIndex])
+    return false;
+
+  // The first switch segment starts with the regular one, too early to come in
+  std::vector <st_mvdashRequest> requests;
+  for (int32_t j = 1; j < m_nSwitchParts; j++) {
+    requests.push_back(st_mvdashRequest(m_sendRequestCounter, viewpoint, tIndex, quality,
+                                        video.switchSize[quality][tIndex * m_nSwitchParts + j]));
+    requests.back().part = j + 1;
+    requests.back().mainView = viewpoint == m_pViewModel->CurrentViewpoint();
   }
+  if (!SendUnicast (requests))
+    return false;
+
+  m_switchTIndex = tIndex;
+  m_switchQuality = quality;
+  m_switchPlayIndex = m_playData.playbackIndex.size() - 1;
+  m_switchArrival.assign(m_nSwitchParts, std::numeric_limits<int64_t>::max());
+  RecordViewpointRequest(viewpoint, tIndex, quality);
+
+  // The bridge leads to the next regular segment, buffered as a side view
+  SendUpgradeRequest(viewpoint);
+  return true;
+}
+
+void mvdashClient::RecordViewpointRequest (int32_t viewpoint, int32_t tIndex, int32_t quality)
+{
+  std::vector <int32_t> qIndexes(m_nViewpoints, -1);
+  qIndexes[viewpoint] = quality;
+  m_downData.id.push_back(m_sendRequestCounter);
+  m_downData.playbackIndex.push_back(tIndex);
+  struct st_requestTimeInfo tinfo = {Simulator::Now ().GetMicroSeconds (), 0, 0};
+  m_downData.time.push_back(tinfo);
+  m_downData.qualityIndex.push_back(qIndexes);
+  if (m_tIndexReqSent < tIndex)
+    m_tIndexReqSent = tIndex;
+
+  m_reqTrace (this, reqev_reqMsgSent, m_sendRequestCounter++);
+  m_ctrlTrace(this, m_state, cteSendRequest, tIndex);
+}
+
+bool mvdashClient::SendViewpointRequest (int32_t viewpoint, int32_t tIndex, int32_t quality)
+{
+  NS_LOG_FUNCTION (this << viewpoint << tIndex << quality);
+  st_viewpointBuffer &buf = m_vpBuffers[viewpoint];
+  bool mainView = viewpoint == m_pViewModel->CurrentViewpoint();
+  std::vector <st_mvdashRequest> requests;
+  if (m_layered) {
+    // Only the layers above those buffered
+    for (int32_t layer = buf.quality[tIndex] + 1; layer <= quality; layer++)
+      requests.push_back(st_mvdashRequest(m_sendRequestCounter, viewpoint, tIndex, layer,
+                                          m_videoData[viewpoint].layerSize[layer][tIndex]));
+  }
+  else {
+    requests.push_back(st_mvdashRequest(m_sendRequestCounter, viewpoint, tIndex, quality,
+                                        m_videoData[viewpoint].segmentSize[quality][tIndex]));
+    if (mainView)
+      requests.back().push = m_pushDepth;
+  }
+  for (st_mvdashRequest &req : requests)
+    req.mainView = mainView;
+  if (!SendUnicast (requests))
+    return false;
+
+  buf.tIndexPending = tIndex;
+  buf.qualityPending = quality;
+  buf.tIndexNext = std::max(buf.tIndexNext, tIndex + 1);
+  RecordViewpointRequest(viewpoint, tIndex, quality);
+  return true;
+}
+
+void mvdashClient::ViewpointSegmentFinished (const st_mvdashRequest &seg)
+{
+  NS_LOG_FUNCTION (this << seg.viewpoint << seg.timeIndex);
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  struct st_requestTimeInfo &tinfo = m_downData.time.at(seg.id);
+  tinfo.downloadEnd = timeNow;
+
+  // The link spent on the segment the time since it was requested or since
+  // the previous segment ended, whichever is later
+  int64_t busy = timeNow - std::max(tinfo.requestSent, m_lastDownloadEnd);
+  if (busy > 0) {
+    double sample = seg.segmentSize * 1e6 / busy;
+    m_throughput = (m_throughput > 0) ? 0.8 * m_throughput + 0.2 * sample : sample;
+  }
+  m_lastDownloadEnd = timeNow;
+
+  if (seg.part > 0) {
+    // The switch segments play from the first one that, like all those after
+    // it, came in before it was due
+    if (seg.viewpoint == m_playData.mainViewpoint[m_switchPlayIndex] && seg.timeIndex == m_switchTIndex) {
+      m_switchArrival[seg.part - 1] = timeNow;
+      int64_t start = m_playData.playbackStart[m_switchPlayIndex];
+      int64_t duration = m_videoData[seg.viewpoint].switchDuration;
+      int32_t first = 0;
+      for (int32_t j = m_nSwitchParts - 1; j > 0 && m_switchArrival[j] <= start + j * duration; j--)
+        first = j;
+      m_playData.switchPart[m_switchPlayIndex] = first;
+      m_playData.switchQuality[m_switchPlayIndex] = first ? m_switchQuality : -1;
+    }
+    m_reqTrace(this, reqev_endReceiving, seg.id);
+    Controller(downloadFinished);
+    return;
+  }
+
+  int32_t mainVp = m_pViewModel->CurrentViewpoint();
+  int64_t levelOld = GetBufferLevel(mainVp);
+  st_viewpointBuffer &buf = m_vpBuffers[seg.viewpoint];
+  bool newSegment = buf.quality[seg.timeIndex] < 0;
+  // The layers of a segment arrive in order, each one level up; a push the
+  // cancel came too late for may arrive next to the segment requested again
+  buf.quality[seg.timeIndex] = std::max(buf.quality[seg.timeIndex], seg.qualityIndex);
+  if (seg.timeIndex == buf.tIndexPending && seg.qualityIndex == buf.qualityPending) {
+    buf.tIndexPending = -1;
+    // The promised segments are awaited in turn, but the last one only while
+    // the request for those after it is on its way
+    if (seg.timeIndex + 1 < buf.tIndexPushed) {
+      buf.tIndexPending = seg.timeIndex + 1;
+      buf.qualityPending = buf.pushQuality;
+    }
+  }
+  if (seg.viewpoint == mainVp && newSegment) {
+    m_bufferData.timeNow.push_back(timeNow);
+    m_bufferData.bufferLevelOld.push_back(levelOld);
+    m_bufferData.bufferLevelNew.push_back(GetBufferLevel(mainVp));
+  }
+  if (m_tIndexDownloaded < seg.timeIndex)
+    m_tIndexDownloaded = seg.timeIndex;
+
+  m_reqTrace(this, reqev_endReceiving, seg.id);
+  m_ctrlTrace(this, m_state, cteDownloaded, seg.timeIndex);
+  Controller(downloadFinished);
+}
+
+void mvdashClient::SelectRateIndexes(int tIndexReq, std::vector <int32_t> *pIndexes) 
+{
+  (*pIndexes)[0] = 1;
+  (*pIndexes)[1] = 1;
+
+//  qIndexes = (std::vector <int32_t>) {1, 0, 0, 0, 0};
+}
+bool mvdashClient::SendUnicast (const std::vector <st_mvdashRequest> &requests)
+{
+  NS_LOG_FUNCTION (this << requests.size());
+
+  if (m_useQuic) {
+    Ptr<Packet> packet = Create<Packet> ((uint8_t const *)requests.data(), requests.size() * sizeof(st_mvdashRequest));
+    NS_ABORT_MSG_IF (packet->GetSize() > mvdashUdpConnection::MAX_PAYLOAD,
+                     "A request of " << packet->GetSize() << " bytes does not fit in one datagram");
+    m_udpConnection->SendMessage(mvdashUdpConnection::REQUEST_STREAM, m_udpRequestMsgId++, packet->GetSize(), packet);
+    m_txTrace (this, packet);
+    for (const st_mvdashRequest &req : requests)
+      m_udpRequests[req.viewpoint] = req;
+    return true;
+  }
+
+  // Spread the requests over the pool; side views go to the low priority connection if any
+  std::vector < std::vector<st_mvdashRequest> > perConn (m_connections.size());
+  std::vector <int64_t> load (m_connections.size());
+  for (size_t i = 0; i < m_connections.size(); i++)
+    load[i] = m_connections[i].pendingBytes;
+  int32_t mainViewpoint = m_pViewModel->CurrentViewpoint();
+  size_t c = 0;
+  for (size_t r = 0; r < requests.size(); r++) {
+    const st_mvdashRequest &req = requests[r];
+    // The layers of a segment follow each other on one connection, so that
+    // each arrives on top of those below
+    bool nextLayer = m_layered && r > 0 && requests[r-1].viewpoint == req.viewpoint
+                     && requests[r-1].timeIndex == req.timeIndex;
+    if (!nextLayer) {
+      c = req.viewpoint % m_nConnections;
+      if (m_connections.back().lowPriority && req.viewpoint != mainViewpoint)
+        c = m_connections.size() - 1;
+      else if (m_leastLoaded)
+        c = std::min_element(load.begin(), load.begin() + m_nConnections) - load.begin();
+    }
+    perConn[c].push_back(req);
+    load[c] += req.segmentSize;
+  }
+
+  // All or nothing, so that the server never gets half a group
+  for (size_t i = 0; i < m_connections.size() && !m_fluid; i++) {
+    if (m_connections[i].socket->GetTxAvailable() < perConn[i].size() * sizeof(st_mvdashRequest))
+      return false;
+  }
+  for (size_t i = 0; i < m_connections.size(); i++) {
+    if (perConn[i].empty())
+      continue;
+    st_clientConnection &conn = m_connections[i];
+    if (m_fluid) {
+      for (const st_mvdashRequest &req : perConn[i]) {
+        m_fluid->Send(conn.flow, req.segmentSize);
+        conn.requests.push(req);
+        conn.pendingBytes += req.segmentSize;
+      }
+      continue;
+    }
+    Ptr<Packet> packet = Create<Packet> ((uint8_t const *)perConn[i].data(), perConn[i].size() * sizeof(st_mvdashRequest));
+    conn.socket->Send (packet);
+    m_txTrace (this, packet);
+    for (const st_mvdashRequest &req : perConn[i]) {
+      conn.requests.push(req);
+      conn.pendingBytes += req.segmentSize;
+    }
+  }
+  return true;
+}
+
+uint64_t mvdashClient::GetStateBytes (void) const
+{
+  uint64_t bytes = 0;
+
+  bytes += m_downData.id.capacity() * sizeof(int32_t);
+  bytes += m_downData.playbackIndex.capacity() * sizeof(int32_t);
+  bytes += m_downData.time.capacity() * sizeof(st_requestTimeInfo);
+  bytes += m_downData.qualityIndex.capacity() * sizeof(std::vector<int32_t>);
+  for (const std::vector<int32_t> &q : m_downData.qualityIndex)
+    bytes += q.capacity() * sizeof(int32_t);
+
+  bytes += m_playData.playbackIndex.capacity() * sizeof(int32_t);
+  bytes += m_playData.mainViewpoint.capacity() * sizeof(int32_t);
+  bytes += m_playData.playbackStart.capacity() * sizeof(int64_t);
+  bytes += m_playData.qualityIndex.capacity() * sizeof(std::vector<int32_t>);
+  for (const std::vector<int32_t> &q : m_playData.qualityIndex)
+    bytes += q.capacity() * sizeof(int32_t);
+  bytes += m_playData.viewportCoverage.capacity() * sizeof(double);
+  bytes += m_playData.switchPart.capacity() * sizeof(int32_t);
+  bytes += m_playData.switchQuality.capacity() * sizeof(int32_t);
+  bytes += m_switchArrival.capacity() * sizeof(int64_t);
+
+  bytes += m_bufferData.timeNow.capacity() * sizeof(int64_t);
+  bytes += m_bufferData.bufferLevelOld.capacity() * sizeof(int64_t);
+  bytes += m_bufferData.bufferLevelNew.capacity() * sizeof(int64_t);
+
+  bytes += m_timeReqSent.capacity() * sizeof(int64_t);
+  for (const st_clientConnection &conn : m_connections)
+    bytes += conn.requests.size() * sizeof(st_mvdashRequest);
+  bytes += m_udpRequests.size() * sizeof(std::pair<const int32_t, st_mvdashRequest>);
+  bytes += m_mcastBytes.size() * sizeof(std::pair<const uint64_t, int32_t>);
+  for (const st_viewpointBuffer &buf : m_vpBuffers)
+    bytes += buf.quality.capacity() * sizeof(int32_t);
+  for (const std::pair<const int32_t, std::vector<int32_t> > &tq : m_tileQualities)
+    bytes += sizeof(tq) + tq.second.capacity() * sizeof(int32_t);
+  return bytes;
 }
 
 void mvdashClient::Initialize(void) 
@@ -488,14 +1390,52 @@ void mvdashClient::Initialize(void)
   ReadInBitrateValues(m_mvInfoFilePath);
 
 // ===========================================================================================
-  // Initialze View-Point Switching Model
-  if (m_vpModelName == "markovian") {
-    m_pViewModel = new Markovian_Viewpoint_Model(m_vpInfoFilePath);
-    m_pViewModel->UpdateViewpoint(m_tIndexPlay);
+  // Tiled viewpoints: the viewport model tells which tiles get the viewpoint quality
+  if (!m_tileInfoFilePath.empty()) {
+    NS_ABORT_MSG_IF (mvdashReadTileManifest(m_tileInfoFilePath, m_video) < 0,
+                     "Cannot read the tile sizes of " << m_tileInfoFilePath);
+  }
+  else if (m_tileColumns > 0) {
+    mvdashSplitTiles(m_video, m_tileColumns, m_tileRows);
+  }
+  m_nTiles = m_videoData.empty() ? 0 : m_videoData[0].tileColumns * m_videoData[0].tileRows;
+
+// ===========================================================================================
+  // Switch segments: short closed-GOP segments bridge a new main view to its quality
+  if (!m_switchInfoFilePath.empty()) {
+    NS_ABORT_MSG_IF (mvdashReadSwitchManifest(m_switchInfoFilePath, m_video) < 0,
+                     "Cannot read the switch segment sizes of " << m_switchInfoFilePath);
+  }
+  else if (m_switchDuration.IsStrictlyPositive() && !m_videoData.empty()) {
+    int64_t duration = m_switchDuration.GetMicroSeconds();
+    NS_ABORT_MSG_IF (m_videoData[0].segmentDuration % duration || m_videoData[0].segmentDuration / duration < 2,
+                     "SwitchDuration is not a whole fraction, a half or less, of the segment duration");
+    mvdashMakeSwitchSegments(m_video, duration, m_switchOverhead);
+  }
+  m_nSwitchParts = (m_videoData.empty() || m_videoData[0].switchDuration <= 0) ? 0
+                   : m_videoData[0].segmentDuration / m_videoData[0].switchDuration;
+  if (m_nTiles > 0) {
+    m_tileAllocator.SetOutOfViewportQuality(m_outOfViewportQuality);
+    m_pViewportModel = CreateObject<Viewport_Model>();
+    m_pViewportModel->AssignStreams(m_streamBase + VIEWPORT_STREAM_BASE + VIEWPORT_MODEL_STREAMS * (int64_t) m_clientId);
+  }
+
+// ===========================================================================================
+  // Scalable video: a level is downloaded as the layers above those buffered
+  if (!m_layerInfoFilePath.empty()) {
+    NS_ABORT_MSG_IF (mvdashReadLayerManifest(m_layerInfoFilePath, m_video) < 0,
+                     "Cannot read the layer sizes of " << m_layerInfoFilePath);
+    m_layered = true;
   }
-  else if (m_vpModelName == "free") {
-    m_pViewModel = new Free_Viewpoint_Model();
-    m_pViewModel->m_nViews = m_nViewpoints;
+  else if (m_layered) {
+    mvdashSplitLayers(m_video, m_layerOverhead);
+  }
+
+// ===========================================================================================
+  // Initialze View-Point Switching Model
+  m_pViewModel = mvdashCreateViewpointModel(m_vpModelName, m_vpInfoFilePath, m_nViewpoints);
+  if (m_pViewModel) {
+    m_pViewModel->AssignStreams(m_streamBase + VIEW_MODEL_STREAMS * (int64_t) m_clientId);
     m_pViewModel->UpdateViewpoint(m_tIndexPlay);
   }
   else {
@@ -505,14 +1445,37 @@ void mvdashClient::Initialize(void)
   }
 
 // ===========================================================================================
-  // Initialze Multi-View Adaptation Algorithm
-  if (m_mvAlgoName == "maximize_current") {
-    m_pAlgorithm = new maximizeCurrentAdaptation(m_videoData, m_playData, m_bufferData, m_downData);
+  // Viewpoints received from the server multicast
+  m_isMcastViewpoint.assign(m_nViewpoints, false);
+  m_mcastLatest.assign(m_nViewpoints, -1);
+  for (int32_t vp : mvdashParseViewpointList(m_mcastViewpointsStr)) {
+    NS_ABORT_MSG_IF (vp < 0 || vp >= m_nViewpoints, "Invalid multicast viewpoint " << vp);
+    NS_ABORT_MSG_IF (m_mcastQuality >= m_videoData[vp].segmentSize.size(), "Invalid multicast quality");
+    m_isMcastViewpoint[vp] = true;
   }
-  else if (m_mvAlgoName == "newone") {
-    m_pAlgorithm = new maximizeCurrentAdaptation(m_videoData, m_playData, m_bufferData, m_downData);
+
+// ===========================================================================================
+  // One buffer per viewpoint
+  NS_ABORT_MSG_IF (m_bufferModeName != "group" && m_bufferModeName != "viewpoint",
+                   "Unknown BufferMode " << m_bufferModeName);
+  m_vpBuffering = (m_bufferModeName == "viewpoint");
+  if (m_vpBuffering) {
+    st_viewpointBuffer empty;
+    empty.quality.assign(m_tIndexLast + 1, -1);
+    empty.tIndexNext = 0;
+    empty.tIndexPending = -1;
+    empty.qualityPending = -1;
+    empty.tIndexPushed = -1;
+    empty.tIndexPushStarted = -1;
+    empty.pushQuality = -1;
+    empty.pushConnection = 0;
+    m_vpBuffers.assign(m_nViewpoints, empty);
   }
-  else {
+
+// ===========================================================================================
+  // Initialze Multi-View Adaptation Algorithm
+  m_pAlgorithm = mvdashCreateAdaptationAlgorithm(m_mvAlgoName, m_videoData, m_playData, m_bufferData, m_downData);
+  if (!m_pAlgorithm) {
     NS_LOG_ERROR ("Invalid Adaptation Algorithm name entered. Terminating");
     StopApplication();
     Simulator::Stop();
@@ -522,59 +1485,12 @@ void mvdashClient::Initialize(void)
 int mvdashClient::ReadInBitrateValues (std::string segmentSizeFile)
 {
   NS_LOG_FUNCTION (this);
-  std::ifstream myfile;
-  myfile.open (segmentSizeFile.c_str ());
-  if (!myfile) {
-      return -1;
-  }
-  
-  // Local Variables for Iterations
-  int vp, rindex;   // viewpoints index, rate index
-  int nRates, nSegments;
-  int64_t averageByteSizeTemp = 0;
-
-  std::string temp;
-  std::getline(myfile, temp);     // Get the first line
-  std::istringstream buffer(temp);
-  std::vector<int32_t> first_line ((std::istream_iterator<int32_t> (buffer)),
-                 std::istream_iterator<int32_t>());
-
-  m_nViewpoints = first_line[0];
-  nSegments = first_line[1];
-  m_tIndexLast = 0;
-  for (vp = 0; vp < m_nViewpoints; vp++) {
-    nRates = first_line[vp+3];
-    std::vector <std::vector<int64_t>> vals(nRates, std::vector<int64_t>(nSegments,0));
-    struct videoData v1 = {vals, std::vector<double>(nRates,0.0), first_line[2]}; // firstline[2] --> Duration
-    m_videoData.push_back(v1);
-  }
-
-  while (std::getline (myfile, temp) && m_tIndexLast < nSegments) {
-    if (temp.empty ()) break;
-    std::istringstream buffer (temp);
-    std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
-                                std::istream_iterator<int64_t>());
-    int32_t i=0;                           
-    for (vp = 0; vp < m_nViewpoints; vp++) {
-      nRates = first_line[vp+3];
-      for (rindex = 0; rindex < nRates; rindex++) {
-        m_videoData[vp].segmentSize[rindex][m_tIndexLast] = line[i++];
-      }
-    }
-    m_tIndexLast++;
-  }
-
-  // Calculate Average Video Segment Size in Bytes and Video Rates in Kbps
-  for (vp=0; vp < m_nViewpoints; vp++) {
-    nRates = first_line[vp+3];
-    for (rindex = 0; rindex < nRates; rindex++) {
-      averageByteSizeTemp = (int64_t) std::accumulate ( m_videoData[vp].segmentSize[rindex].begin (), 
-        m_videoData[vp].segmentSize[rindex].end(), 0.0) / nSegments;
-      m_videoData[vp].averageBitrate[rindex] = 8.0 * averageByteSizeTemp / m_videoData[vp].segmentDuration * 1000000;
-    }
-  }
+  int32_t nSegments = mvdashReadManifest (segmentSizeFile, m_video);
+  if (nSegments < 0)
+    return -1;
 
-  myfile.close();
+  m_nViewpoints = m_videoData.size();
+  m_tIndexLast = nSegments - 1;    // index of the last segment, not the number of segments
   return m_nViewpoints;
 }
 
@@ -628,6 +1544,10 @@ void mvdashClient::LogPlayback(void) {
     playbackLog << "tIndex\tvpoint\tStart";
     for (vp=0; vp < m_nViewpoints; vp++)
       playbackLog << "\tq_v" << vp+1; 
+    if (m_nTiles > 0)
+      playbackLog << "\tviewport";
+    if (m_nSwitchParts > 0)
+      playbackLog << "\tswitchPart\tswitchQuality";
     playbackLog << "\n";
 
     for (int i=0; i < nPlay; i++) {
@@ -636,6 +1556,10 @@ void mvdashClient::LogPlayback(void) {
       logStr.append("\t" + std::to_string(m_playData.playbackStart[i]));
       for (vp=0; vp < m_nViewpoints; vp++) 
         logStr.append("\t" + std::to_string(m_playData.qualityIndex[i][vp]));
+      if (m_nTiles > 0)
+        logStr.append("\t" + std::to_string(m_playData.viewportCoverage[i]));
+      if (m_nSwitchParts > 0)
+        logStr.append("\t" + std::to_string(m_playData.switchPart[i]) + "\t" + std::to_string(m_playData.switchQuality[i]));
       // NS_LOG_INFO(logStr);
       playbackLog << logStr << "\n";
     }
@@ -23,10 +23,16 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include <map>
 #include <queue>
 #include "multiview-model.h"
 #include "mvdash_adaptation_algorithm.h"
 #include "mvdash.h"
+#include "mvdash_udp_transport.h"
+#include "mvdash_fluid_network.h"
+#include "mvdash_group_controller.h"
 
 namespace ns3 {
 
@@ -35,27 +41,10 @@ class Socket;
 class Packet;
 
 /**
-  * \brief This enum is used to define the states of the state machine which controls the behaviour of the client.
-  */
-enum controllerState
-{
-  initial, downloading, downloadingPlaying, playing, terminal
-};
-
-/**
-  * \brief This enum is used to define the controller events of the state machine which controls the behaviour of the client.
-  */
-enum controllerEvent
-{
-  downloadFinished, playbackFinished, irdFinished, init
-};
-
-enum controllerTraceEvent
-{
-  cteSendRequest, cteDownloaded, cteAllDownloaded, cteStartPlayback, cteEndPlayback, cteBufferUnderrun  
-};
-
-class mvdashClient : public Application 
+ * \brief The multi-view DASH client: the group buffer mode runs on
+ *        mvdashGroupController, the viewpoint buffer mode on its own
+ */
+class mvdashClient : public Application, public mvdashGroupController
 {
 public:
   static TypeId GetTypeId (void);
@@ -63,8 +52,34 @@ public:
   virtual ~mvdashClient ();
   void Initialize (void);
 
+  const t_videoDataGroup & GetVideoData (void) const { return m_videoData; }
+  /**
+   * \returns the heap bytes held by the per-segment session records
+   *          (download, playback and buffer data and the pending requests)
+   */
+  uint64_t GetStateBytes (void) const;
+  /**
+   * \returns the number of multicast segments fetched over unicast because
+   *          they were lost or missed
+   */
+  uint64_t GetMulticastRepairs (void) const { return m_nMcastRepairs; }
+  /**
+   * \returns the number of segments the server pushed without a request
+   */
+  uint64_t GetPushedSegments (void) const { return m_nPushed; }
+  /**
+   * \returns the number of promised pushes cancelled because the main view
+   *          or the chosen quality changed
+   */
+  uint64_t GetCancelledPushes (void) const { return m_nPushCancels; }
+  /**
+   * \returns the streams each ClientId takes from StreamBase on
+   */
+  static int64_t GetViewModelStreams (void);
+
   uint32_t   m_simId;
   uint32_t   m_clientId;
+  int64_t    m_streamBase;
 
   /**
    * Callback signature for `RequestTrace` trace source.
@@ -101,6 +116,11 @@ private:
    * \param socket the receiving socket
    */
   void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Receive the bytes of a framed connection: segments, pulled or
+   *        pushed, each after a copy of its request
+   */
+  void ReceiveFramed (size_t connection, Ptr<Packet> packet);
   /**
    * \brief Connection Succeeded (called by Socket through a callback)
    * \param socket the connected socket
@@ -112,12 +132,132 @@ private:
    */
   void ConnectionFailed (Ptr<Socket> socket);
 
-  int SendRequest(struct st_mvdashRequest *pMsg, int nReq);
+  /**
+   * \brief Send unicast requests over the TCP connections or on the request stream of the UDP transport
+   * \returns true if every request was sent, false if none was
+   */
+  bool SendUnicast (const std::vector <st_mvdashRequest> &requests);
+  /**
+   * \returns true while some unicast segment of the current group is awaited
+   */
+  bool UnicastPending (void) const;
+  /**
+   * \brief Finish the current group, or wait for its multicast part, once its unicast part is in
+   */
+  void UnicastPartFinished(int32_t id, int32_t tIndex);
+  /**
+   * \brief Update the buffer and move the controller on once all the segments of a request group are in
+   */
+  void DownloadGroupFinished(int32_t id, int32_t tIndex);
+
+  /**
+   * \brief Feed datagrams of the UDP transport to m_udpConnection
+   */
+  void HandleUdpRead (Ptr<Socket> socket);
+  /**
+   * \brief A datagram of a unicast segment arrived over the UDP transport
+   */
+  void HandleUdpData (Ptr<mvdashUdpConnection> connection, uint16_t viewpoint, uint32_t id, Ptr<const Packet> packet);
+  /**
+   * \brief A unicast segment is complete; segments of a group complete in any order over UDP
+   */
+  void HandleUdpSegment (Ptr<mvdashUdpConnection> connection, uint16_t viewpoint, uint32_t id, uint32_t size, Ptr<Packet> payload);
+
+  /**
+   * \brief The head segment of a fluid flow starts arriving
+   */
+  void HandleFluidStart (uint32_t flow);
+  /**
+   * \brief The head segment of a fluid flow is in
+   */
+  void HandleFluidSegment (uint32_t flow);
+
+  /**
+   * \brief Receive multicast chunks
+   */
+  void HandleMulticastRead (Ptr<Socket> socket);
+  /**
+   * \brief Finish the current group if its multicast part is complete, or repair what the group source has passed
+   */
+  void CheckMulticastGroup (void);
+  void MulticastTimeout (void);
+  void SendRepairRequest (const std::vector <st_mvdashRequest> &requests);
 
-  struct st_mvdashRequest * PrepareRequest(int tIndexDownload);
-  bool StartPlayback (void);
+  // mvdashGroupController
+  virtual int64_t GetTimeNow (void) const;
+  /**
+   * \brief Send the multicast viewpoints of a group at the multicast quality
+   *        to the multicast group, the rest over unicast
+   */
+  virtual bool SendGroup (const std::vector <st_mvdashRequest> &requests);
+  /**
+   * \brief A multicast viewpoint comes for free at the multicast quality
+   */
+  virtual void AdjustQualities (std::vector <int32_t> &qIndex);
+  virtual void PlaybackStarted (void);
+  virtual void SessionFinished (void);
+  virtual void TraceController (controllerTraceEvent event, int32_t tIndex);
 
+  /**
+   * \brief The controller of the buffer mode
+   */
   void Controller (controllerEvent event);
+
+  /**
+   * \brief The controller of the viewpoint buffer mode: playback waits for the
+   *        segment of the main view only, downloads are left to ScheduleDownloads
+   */
+  void ViewpointController (controllerEvent event);
+  /**
+   * \brief Draw the viewpoint of the next segment to play, once per time index
+   * \returns true if the main view has that segment
+   */
+  bool ViewpointPlaybackReady (void);
+  void StartViewpointPlayback (void);
+  /**
+   * \brief Request the next segment of every idle viewpoint below its buffer
+   *        target, earliest playback deadline first; for layered video, the
+   *        enhancement layers of the main view first
+   */
+  void ScheduleDownloads (void);
+  /**
+   * \brief Request a segment of viewpoint at quality; for layered video, only
+   *        the layers above those buffered
+   */
+  bool SendViewpointRequest (int32_t viewpoint, int32_t tIndex, int32_t quality);
+  /**
+   * \brief Request the enhancement layers the algorithm would now choose for
+   *        the earliest buffered segment of viewpoint they can reach in time;
+   *        with switch segments, the whole segment at that quality
+   * \returns true if a request was sent
+   */
+  bool SendUpgradeRequest (int32_t viewpoint);
+  /**
+   * \brief Request a buffered segment of viewpoint again at a higher quality,
+   *        without a push and leaving the request in flight awaited
+   */
+  bool SendRefetchRequest (int32_t viewpoint, int32_t tIndex, int32_t quality);
+  /**
+   * \brief On a switch to viewpoint while tIndex plays, request the switch
+   *        segments of tIndex at the quality of a main view, then the
+   *        earliest buffered regular segment they bridge to at that quality
+   * \returns true if the switch segments were requested
+   */
+  bool SendSwitchRequest (int32_t viewpoint, int32_t tIndex);
+  /**
+   * \brief Record a request just sent for viewpoint and count it
+   */
+  void RecordViewpointRequest (int32_t viewpoint, int32_t tIndex, int32_t quality);
+  /**
+   * \brief Tell the server to drop the promised segments of viewpoint that
+   *        have not started arriving, and request them again
+   */
+  void CancelPush (int32_t viewpoint);
+  void ViewpointSegmentFinished (const st_mvdashRequest &seg);
+  /**
+   * \returns microseconds of segments buffered on viewpoint from the next one to play on
+   */
+  int64_t GetBufferLevel (int32_t viewpoint) const;
   /**
    * \brief Read in bitrate values
    *
@@ -131,39 +271,111 @@ private:
 
   void SelectRateIndexes(int tIndexReq, std::vector <int32_t> *pIndexes);
 
-  Ptr<Socket>   m_socket;           //!< Socket
-  bool          m_connected;        //!< True if connected
+  /// One TCP connection of the pool and the segments it is to deliver, in order
+  struct st_clientConnection
+  {
+    Ptr<Socket> socket;
+    std::queue <st_mvdashRequest> requests;
+    int64_t pendingBytes;       //!< requested bytes not received yet
+    int32_t bytesReceived;      //!< bytes of the head segment received
+    bool segStarted;
+    bool lowPriority;           //!< carries the side views only
+    uint32_t flow;              //!< flow of the fluid network standing in for the socket
+    st_mvdashRequest frame;     //!< with PushDepth, the copy of the request of the segment arriving
+    uint32_t frameBytes;        //!< bytes of frame received
+  };
+
+  std::vector <st_clientConnection> m_connections;  //!< TCP connection pool
+  uint32_t      m_nConnections;
+  std::string   m_connPolicyName;
+  bool          m_leastLoaded;      //!< requests go to the connection with the least pending bytes, else by viewpoint
+  std::string   m_sideViewCcName;   //!< congestion control of the side-view connection; empty shares the pool
+  uint32_t      m_nConnected;
+  bool          m_connected;        //!< True once every connection is up
   Address       m_serverAddress;    //!< Server address
+  uint32_t      m_useQuic;          //!< 0 - TCP, 1 - the mvdash UDP multi-stream transport
+  Ptr<mvdashFluidNetwork> m_fluid;  //!< if set, segments are delivered by this fluid model instead of sockets
 
   std::string   m_vpInfoFilePath;
   std::string   m_vpModelName;
   std::string   m_mvInfoFilePath;
   std::string   m_mvAlgoName;
+  bool          m_enableLogs;       //!< Write the download/playback/buffer CSV logs at stop
 
-  controllerState m_state;
-
-  int32_t       m_tIndexLast;
-  int32_t       m_tIndexPlay;
-  int32_t       m_tIndexReqSent;
-  int32_t       m_tIndexDownloaded;  
-  int32_t       m_bytesReceived;
-  int32_t       m_sendRequestCounter;
   int32_t       m_recvRequestCounter;
-  bool          m_segStarted;
-
-  int32_t       m_nViewpoints;
 
-  MultiView_Model *m_pViewModel;
-  mvdashAdaptationAlgorithm *m_pAlgorithm;
-
-  //std::vector <videoData> m_videoData;
-  t_videoDataGroup m_videoData;
-  struct downloadDataGroup m_downData;
-  struct playbackDataGroup m_playData;
-  struct bufferData m_bufferData;
+  t_videoDataGroup m_video;         //!< the manifest, read through m_videoData
 
   std::vector <int64_t> m_timeReqSent;
-  std::queue <st_mvdashRequest> m_requests;
+
+  // UDP transport, one stream per viewpoint
+  Ptr<Socket>   m_udpSocket;
+  Ptr<mvdashUdpConnection> m_udpConnection;
+  std::map <int32_t, st_mvdashRequest> m_udpRequests;  //!< unicast segments of the current group, by viewpoint
+  std::vector <bool> m_udpSegStarted;                 //!< per viewpoint, the first datagram of its segment arrived
+  uint32_t      m_udpRequestMsgId;                    //!< message id on the request stream
+
+  // Multicast reception, off unless MulticastGroup is set
+  Address       m_mcastGroup;
+  std::string   m_mcastViewpointsStr;
+  uint32_t      m_mcastQuality;
+  Time          m_mcastTimeout;
+  Ptr<Socket>   m_mcastSocket;
+  std::vector <bool> m_isMcastViewpoint;
+  std::vector <int32_t> m_mcastLatest;            //!< latest time index seen per viewpoint
+  std::map <uint64_t, int32_t> m_mcastBytes;      //!< received bytes by (time index, viewpoint)
+  std::vector <st_mvdashRequest> m_mcastRequests; //!< segments of the current group awaited from multicast
+  Time          m_mcastLastRx;
+  EventId       m_mcastTimeoutEvent;
+  uint64_t      m_nMcastRepairs;
+
+  /// Buffer and download pipeline of one viewpoint, in the viewpoint buffer mode
+  struct st_viewpointBuffer
+  {
+    std::vector <int32_t> quality;  //!< downloaded quality by time index, -1 if not downloaded
+    int32_t tIndexNext;             //!< next time index to request
+    int32_t tIndexPending;          //!< time index in flight, -1 if none
+    int32_t qualityPending;         //!< quality, the top layer for layered video, in flight
+    int32_t tIndexPushed;           //!< last time index the server promised to push, -1 if none
+    int32_t tIndexPushStarted;      //!< latest time index of the viewpoint that started arriving
+    int32_t pushQuality;            //!< quality of the promised segments
+    size_t  pushConnection;         //!< connection the promised segments come on
+  };
+
+  // Viewpoint buffer mode, off unless BufferMode is viewpoint
+  std::string   m_bufferModeName;
+  bool          m_vpBuffering;
+  Time          m_mainBufferTarget;
+  Time          m_sideBufferTarget;
+  std::vector <st_viewpointBuffer> m_vpBuffers;
+  int32_t       m_tIndexViewDrawn;    //!< latest time index whose viewpoint is drawn
+  double        m_throughput;         //!< bytes per second, moving average over the downloads
+  int64_t       m_lastDownloadEnd;
+
+  // Server push of the main view, off unless PushDepth is set
+  uint32_t      m_pushDepth;          //!< segments to be pushed after each main view request
+  uint64_t      m_nPushed;
+  uint64_t      m_nPushCancels;
+
+  // Switch segments, off unless SwitchInfo or SwitchDuration is set
+  std::string   m_switchInfoFilePath;
+  Time          m_switchDuration;
+  double        m_switchOverhead;
+  int32_t       m_nSwitchParts;       //!< switch segments per segment, 0 without switch segments
+  int32_t       m_switchTIndex;       //!< time index of the latest switch, -1 if none
+  int32_t       m_switchQuality;
+  size_t        m_switchPlayIndex;    //!< its entry in m_playData
+  std::vector <int64_t> m_switchArrival;  //!< when each of its switch segments came in
+
+  // Tiled viewpoints, off unless TileInfo or TileColumns is set
+  std::string   m_tileInfoFilePath;
+  uint32_t      m_tileColumns;
+  uint32_t      m_tileRows;
+  uint32_t      m_outOfViewportQuality;
+
+  // Layered video, off unless LayerInfo or Layered is set
+  std::string   m_layerInfoFilePath;
+  double        m_layerOverhead;
 
   //std::vector <st_mvdashRequest> m_requests;
 
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash_fluid_network.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashFluidNetwork");
+
+NS_OBJECT_ENSURE_REGISTERED (mvdashFluidNetwork);
+
+static void
+NotifyFlow (mvdashFluidNetwork::FlowCallback cb, uint32_t flow)
+{
+  cb (flow);
+}
+
+TypeId
+mvdashFluidNetwork::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::mvdashFluidNetwork")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<mvdashFluidNetwork> ()
+    .AddAttribute ("Efficiency",
+                   "Fraction of a link rate carried as payload (TCP/IP and link headers excluded)",
+                   DoubleValue (0.97),
+                   MakeDoubleAccessor (&mvdashFluidNetwork::m_efficiency),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("LowPriorityWeight",
+                   "Share of a low priority flow relative to a normal one",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&mvdashFluidNetwork::m_lowPriorityWeight),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+mvdashFluidNetwork::mvdashFluidNetwork ()
+  : m_nReallocations (0),
+    m_nMessages (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+mvdashFluidNetwork::~mvdashFluidNetwork ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+mvdashFluidNetwork::DoDispose (void)
+{
+  Simulator::Cancel (m_reallocateEvent);
+  Simulator::Cancel (m_completionEvent);
+  m_flows.clear ();
+  m_links.clear ();
+  m_paths.clear ();
+  m_active.clear ();
+  m_finish.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+mvdashFluidNetwork::AddLink (uint64_t bps)
+{
+  st_fluidLink link;
+  link.capacity = bps / 8.0;
+  link.residual = 0;
+  link.weight = 0;
+  link.key = 0;
+  m_links.push_back (link);
+  return m_links.size () - 1;
+}
+
+void
+mvdashFluidNetwork::SetLinkRate (uint32_t link, uint64_t bps)
+{
+  NS_LOG_FUNCTION (this << link << bps);
+  m_links.at (link).capacity = bps / 8.0;
+  if (!m_active.empty ())
+    {
+      MarkDirty ();
+    }
+}
+
+void
+mvdashFluidNetwork::SetPath (Ptr<Node> node, const std::vector <uint32_t> &links, Time oneWayDelay)
+{
+  NS_ABORT_MSG_IF (links.empty (), "A fluid path crosses at least one link");
+  st_fluidPath &path = m_paths[node->GetId ()];
+  path.links = links;
+  path.oneWayDelay = oneWayDelay;
+}
+
+Time
+mvdashFluidNetwork::GetOneWayDelay (Ptr<Node> node) const
+{
+  std::map <uint32_t, st_fluidPath>::const_iterator it = m_paths.find (node->GetId ());
+  NS_ABORT_MSG_IF (it == m_paths.end (), "No fluid path to node " << node->GetId ());
+  return it->second.oneWayDelay;
+}
+
+uint32_t
+mvdashFluidNetwork::AddFlow (Ptr<Node> node, bool lowPriority, FlowCallback started, FlowCallback delivered)
+{
+  std::map <uint32_t, st_fluidPath>::const_iterator it = m_paths.find (node->GetId ());
+  NS_ABORT_MSG_IF (it == m_paths.end (), "No fluid path to node " << node->GetId ());
+  double weight = lowPriority ? m_lowPriorityWeight : 1.0;
+  NS_ABORT_MSG_IF (weight <= 0, "A fluid flow needs a positive weight");
+
+  st_fluidFlow flow;
+  flow.links = it->second.links;
+  flow.oneWayDelay = it->second.oneWayDelay;
+  flow.weight = weight;
+  flow.rate = 0;
+  flow.remaining = 0;
+  flow.fixed = false;
+  flow.started = started;
+  flow.delivered = delivered;
+  m_flows.push_back (flow);
+  return m_flows.size () - 1;
+}
+
+void
+mvdashFluidNetwork::Send (uint32_t flow, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << flow << bytes);
+  Simulator::Schedule (m_flows.at (flow).oneWayDelay, &mvdashFluidNetwork::Arrive, this, flow, bytes);
+}
+
+void
+mvdashFluidNetwork::Arrive (uint32_t flow, uint32_t bytes)
+{
+  st_fluidFlow &f = m_flows[flow];
+  m_nMessages++;
+  f.backlog.push (bytes);
+  if (f.backlog.size () == 1)
+    {
+      m_active.insert (flow);
+      StartHead (flow);
+      MarkDirty ();
+    }
+}
+
+void
+mvdashFluidNetwork::Advance (st_fluidFlow &f)
+{
+  Time now = Simulator::Now ();
+  f.remaining = std::max (f.remaining - f.rate * (now - f.lastUpdate).GetSeconds (), 0.0);
+  f.lastUpdate = now;
+}
+
+void
+mvdashFluidNetwork::StartHead (uint32_t flow)
+{
+  st_fluidFlow &f = m_flows[flow];
+  f.remaining = f.backlog.front ();
+  f.lastUpdate = Simulator::Now ();
+  if (!f.started.IsNull ())
+    {
+      Simulator::Schedule (f.oneWayDelay, &NotifyFlow, f.started, flow);
+    }
+}
+
+void
+mvdashFluidNetwork::MarkDirty (void)
+{
+  // Every change of this instant is folded into one reallocation
+  if (!m_reallocateEvent.IsRunning ())
+    {
+      m_reallocateEvent = Simulator::ScheduleNow (&mvdashFluidNetwork::Reallocate, this);
+    }
+}
+
+void
+mvdashFluidNetwork::Reallocate (void)
+{
+  NS_LOG_FUNCTION (this << m_active.size ());
+  m_nReallocations++;
+
+  for (st_fluidLink &link : m_links)
+    {
+      link.residual = link.capacity * m_efficiency;
+      link.weight = 0;
+      link.flows.clear ();
+    }
+  for (uint32_t id : m_active)
+    {
+      st_fluidFlow &f = m_flows[id];
+      Advance (f);
+      f.rate = 0;
+      f.fixed = false;
+      for (uint32_t l : f.links)
+        {
+          m_links[l].weight += f.weight;
+          m_links[l].flows.push_back (id);
+        }
+    }
+
+  // Progressive filling: the link offering the smallest share per unit of
+  // weight fixes the rate of its flows, which leave the other links
+  std::set < std::pair<double, uint32_t> > order;
+  for (uint32_t l = 0; l < m_links.size (); l++)
+    {
+      st_fluidLink &link = m_links[l];
+      if (link.weight > 0)
+        {
+          link.key = link.residual / link.weight;
+          order.insert (std::make_pair (link.key, l));
+        }
+    }
+  while (!order.empty ())
+    {
+      double share = order.begin ()->first;
+      uint32_t l = order.begin ()->second;
+      order.erase (order.begin ());
+      m_links[l].weight = 0;
+      for (uint32_t id : m_links[l].flows)
+        {
+          st_fluidFlow &f = m_flows[id];
+          if (f.fixed)
+            {
+              continue;
+            }
+          f.fixed = true;
+          f.rate = share * f.weight;
+          for (uint32_t other : f.links)
+            {
+              st_fluidLink &o = m_links[other];
+              if (other == l || o.weight <= 0)
+                {
+                  continue;
+                }
+              order.erase (std::make_pair (o.key, other));
+              o.residual -= f.rate;
+              o.weight -= f.weight;
+              if (o.weight > 1e-9)
+                {
+                  o.key = std::max (o.residual, 0.0) / o.weight;
+                  order.insert (std::make_pair (o.key, other));
+                }
+              else
+                {
+                  o.weight = 0;
+                }
+            }
+        }
+    }
+
+  m_finish.clear ();
+  for (uint32_t id : m_active)
+    {
+      Project (id);
+    }
+  ScheduleCompletion ();
+}
+
+void
+mvdashFluidNetwork::Project (uint32_t flow)
+{
+  st_fluidFlow &f = m_flows[flow];
+  if (f.rate <= 0)
+    {
+      return;     // stalled until a link speeds up
+    }
+  f.finish = Simulator::Now () + NanoSeconds ((int64_t) std::ceil (f.remaining / f.rate * 1e9));
+  m_finish.insert (std::make_pair (f.finish, flow));
+}
+
+void
+mvdashFluidNetwork::ScheduleCompletion (void)
+{
+  Simulator::Cancel (m_completionEvent);
+  if (!m_finish.empty ())
+    {
+      m_completionEvent = Simulator::Schedule (m_finish.begin ()->first - Simulator::Now (),
+                                               &mvdashFluidNetwork::Complete, this);
+    }
+}
+
+void
+mvdashFluidNetwork::Complete (void)
+{
+  Time now = Simulator::Now ();
+  bool dirty = false;
+  while (!m_finish.empty () && m_finish.begin ()->first <= now)
+    {
+      uint32_t id = m_finish.begin ()->second;
+      m_finish.erase (m_finish.begin ());
+      st_fluidFlow &f = m_flows[id];
+      f.backlog.pop ();
+      if (!f.delivered.IsNull ())
+        {
+          Simulator::Schedule (f.oneWayDelay, &NotifyFlow, f.delivered, id);
+        }
+      if (!f.backlog.empty ())
+        {
+          // Same flows, same rates: only this flow moves on to its next message
+          StartHead (id);
+          Project (id);
+        }
+      else
+        {
+          m_active.erase (id);
+          f.rate = 0;
+          dirty = true;
+        }
+    }
+  if (dirty)
+    {
+      MarkDirty ();
+    }
+  ScheduleCompletion ();
+}
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_FLUID_NETWORK_H
+#define MVDASH_FLUID_NETWORK_H
+
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include <map>
+#include <queue>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Flow-level delivery engine standing in for packet-level TCP.
+ *
+ * Links are fluid pipes of a given rate.  Each flow (a client connection)
+ * crosses a fixed set of links and carries a FIFO backlog of messages
+ * (segments).  Backlogged flows share the links by weighted max-min
+ * fairness, and between two events every flow progresses at a constant
+ * rate, so completion times are computed, not simulated: the only events
+ * are message arrivals, completions and link rate changes.  Changes at the
+ * same instant are batched into a single reallocation.
+ *
+ * A message enters its flow's backlog one one-way delay after it is sent
+ * (the request trip), and is reported started and delivered one one-way
+ * delay after it starts and ends service.  Slow start, losses and queueing
+ * are not modelled; Efficiency accounts for the header overhead.
+ */
+class mvdashFluidNetwork : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  mvdashFluidNetwork ();
+  virtual ~mvdashFluidNetwork ();
+
+  /// Called with the flow id when a message starts or ends arriving
+  typedef Callback<void, uint32_t> FlowCallback;
+
+  /**
+   * \returns the id of a new link of rate bps
+   */
+  uint32_t AddLink (uint64_t bps);
+  void SetLinkRate (uint32_t link, uint64_t bps);
+
+  /**
+   * \brief Register the links crossed from the server to node and the
+   *        one-way delay of that path
+   */
+  void SetPath (Ptr<Node> node, const std::vector <uint32_t> &links, Time oneWayDelay);
+  Time GetOneWayDelay (Ptr<Node> node) const;
+
+  /**
+   * \brief Open a flow along the path of node
+   * \param lowPriority the flow gets LowPriorityWeight instead of one, like a
+   *        scavenger congestion control
+   * \returns the flow id
+   */
+  uint32_t AddFlow (Ptr<Node> node, bool lowPriority, FlowCallback started, FlowCallback delivered);
+  /**
+   * \brief Send a message of bytes on flow, behind its backlog
+   */
+  void Send (uint32_t flow, uint32_t bytes);
+
+  uint64_t GetNReallocations (void) const { return m_nReallocations; }
+  uint64_t GetNMessages (void) const { return m_nMessages; }
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct st_fluidLink
+  {
+    double   capacity;        //!< bytes per second
+    double   residual;        //!< capacity left during a reallocation
+    double   weight;          //!< weight of the flows not fixed yet during a reallocation
+    double   key;             //!< residual / weight as inserted in the reallocation order
+    std::vector <uint32_t> flows;
+  };
+
+  struct st_fluidPath
+  {
+    std::vector <uint32_t> links;
+    Time     oneWayDelay;
+  };
+
+  struct st_fluidFlow
+  {
+    std::vector <uint32_t> links;
+    Time     oneWayDelay;
+    double   weight;
+    double   rate;            //!< bytes per second
+    double   remaining;       //!< bytes of the head message left at lastUpdate
+    Time     lastUpdate;
+    Time     finish;          //!< projected end of the head message, key in m_finish
+    bool     fixed;           //!< rate set in the current reallocation
+    std::queue <uint32_t> backlog;
+    FlowCallback started;
+    FlowCallback delivered;
+  };
+
+  void Arrive (uint32_t flow, uint32_t bytes);
+  /// Bring the head message of flow up to now
+  void Advance (st_fluidFlow &f);
+  void StartHead (uint32_t flow);
+  void MarkDirty (void);
+  /// Weighted max-min fair rates of the backlogged flows by progressive filling
+  void Reallocate (void);
+  void Project (uint32_t flow);
+  void ScheduleCompletion (void);
+  void Complete (void);
+
+  double   m_efficiency;
+  double   m_lowPriorityWeight;
+  std::vector <st_fluidLink> m_links;
+  std::vector <st_fluidFlow> m_flows;
+  std::map <uint32_t, st_fluidPath> m_paths;        //!< by node id
+  std::set <uint32_t> m_active;                     //!< backlogged flows
+  std::set < std::pair<Time, uint32_t> > m_finish;  //!< projected completions
+  EventId  m_reallocateEvent;
+  EventId  m_completionEvent;
+  uint64_t m_nReallocations;
+  uint64_t m_nMessages;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_FLUID_NETWORK_H */
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include "ns3/log.h"
+#include "mvdash_group_controller.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashGroupController");
+
+mvdashGroupController::mvdashGroupController (const t_videoDataGroup &videoData)
+  : m_videoData (videoData),
+    m_state (initial),
+    m_nViewpoints (0),
+    m_tIndexLast (-1),
+    m_tIndexPlay (0),
+    m_tIndexReqSent (-1),
+    m_tIndexDownloaded (-1),
+    m_sendRequestCounter (0),
+    m_pViewModel (0),
+    m_pAlgorithm (0),
+    m_nTiles (0),
+    m_viewportMargin (15.0),
+    m_layered (false)
+{
+}
+
+mvdashGroupController::~mvdashGroupController ()
+{
+}
+
+void
+mvdashGroupController::AdjustQualities (std::vector <int32_t> &qIndex)
+{
+}
+
+void
+mvdashGroupController::SessionFinished (void)
+{
+}
+
+void
+mvdashGroupController::TraceController (controllerTraceEvent event, int32_t tIndex)
+{
+}
+
+void
+mvdashGroupController::Controller (controllerEvent event)
+{
+  NS_LOG_FUNCTION (this << m_state << event);
+  switch (m_state)
+    {
+    case initial:
+      if (RequestGroup (0))
+        {
+          m_state = downloading;
+        }
+      break;
+    case downloading:
+      if (event != downloadFinished)
+        {
+          break;
+        }
+      StartPlayback ();
+      if (m_tIndexDownloaded >= m_tIndexLast)
+        {
+          TraceController (cteAllDownloaded, m_tIndexLast);
+          m_state = playing;
+        }
+      else if (RequestGroup (m_tIndexReqSent + 1))
+        {
+          m_state = downloadingPlaying;
+        }
+      break;
+    case downloadingPlaying:
+      if (event == downloadFinished)
+        {
+          if (m_tIndexDownloaded >= m_tIndexLast)
+            {
+              TraceController (cteAllDownloaded, m_tIndexLast);
+              m_state = playing;
+            }
+          else
+            {
+              RequestGroup (m_tIndexReqSent + 1);
+            }
+        }
+      else if (event == playbackFinished)
+        {
+          TraceController (cteEndPlayback, m_tIndexPlay - 1);
+          if (!StartPlayback ())
+            {
+              m_state = downloading;
+            }
+        }
+      break;
+    case playing:
+      if (event != playbackFinished)
+        {
+          break;
+        }
+      TraceController (cteEndPlayback, m_tIndexPlay - 1);
+      if (m_tIndexPlay <= m_tIndexLast)
+        {
+          if (!StartPlayback ())
+            {
+              NS_LOG_INFO ("SOMETHING WRONG : S_P and Buffer Underrun");
+            }
+        }
+      else
+        {
+          m_state = terminal;
+          SessionFinished ();
+        }
+      break;
+    default:
+      break;
+    }
+}
+
+std::vector <st_mvdashRequest>
+mvdashGroupController::PrepareRequest (int32_t tIndexReq)
+{
+  NS_LOG_FUNCTION (this << tIndexReq);
+  std::vector <int32_t> qIndex (m_nViewpoints, 0);
+  m_pAlgorithm->SelectRateIndexes (tIndexReq, m_pViewModel->CurrentViewpoint (), &qIndex);
+  AdjustQualities (qIndex);
+
+  std::vector <st_mvdashRequest> requests;
+  if (m_layered)
+    {
+      // Every level comes as its layers, the base layer first
+      for (int32_t vp = 0; vp < m_nViewpoints; vp++)
+        {
+          for (int32_t layer = 0; layer <= qIndex[vp]; layer++)
+            {
+              requests.push_back (st_mvdashRequest (m_sendRequestCounter, vp, tIndexReq, layer,
+                                                    m_videoData[vp].layerSize[layer][tIndexReq]));
+            }
+        }
+    }
+  else if (m_nTiles > 0)
+    {
+      // The viewport of the segment is predicted by the current one, widened by the margin
+      std::vector <bool> visible = m_pViewportModel->GetVisibleTiles (m_videoData[0].tileColumns,
+                                                                      m_videoData[0].tileRows, m_viewportMargin);
+      std::vector <int32_t> &requested = m_tileQualities[tIndexReq];
+      requested.clear ();
+      std::vector <int32_t> qualities;
+      for (int32_t vp = 0; vp < m_nViewpoints; vp++)
+        {
+          m_tileAllocator.Allocate (m_videoData[vp], tIndexReq, qIndex[vp], visible, qualities);
+          for (int32_t tile = 0; tile < m_nTiles; tile++)
+            {
+              requests.push_back (st_mvdashRequest (m_sendRequestCounter, vp, tIndexReq, qualities[tile],
+                                                    m_videoData[vp].tileSize[qualities[tile]][tIndexReq * m_nTiles + tile],
+                                                    tile));
+              requested.push_back (qualities[tile]);
+            }
+        }
+    }
+  else
+    {
+      for (int32_t vp = 0; vp < m_nViewpoints; vp++)
+        {
+          requests.push_back (st_mvdashRequest (m_sendRequestCounter, vp, tIndexReq, qIndex[vp],
+                                                m_videoData[vp].segmentSize[qIndex[vp]][tIndexReq]));
+        }
+    }
+
+  // The server serves the main view first
+  int32_t mainViewpoint = m_pViewModel->CurrentViewpoint ();
+  for (st_mvdashRequest &req : requests)
+    {
+      req.mainView = req.viewpoint == mainViewpoint;
+    }
+  return requests;
+}
+
+bool
+mvdashGroupController::RequestGroup (int32_t tIndexReq)
+{
+  std::vector <st_mvdashRequest> requests = PrepareRequest (tIndexReq);
+  if (!SendGroup (requests))
+    {
+      NS_LOG_DEBUG ("Unable to send the requests of " << tIndexReq);
+      return false;
+    }
+
+  // The quality of a tiled viewpoint is that of its viewport tiles, of a
+  // layered one that of its top layer
+  std::vector <int32_t> qIndexes (m_nViewpoints, -1);
+  for (const st_mvdashRequest &req : requests)
+    {
+      qIndexes[req.viewpoint] = std::max (qIndexes[req.viewpoint], req.qualityIndex);
+    }
+  if (m_tIndexReqSent < tIndexReq)
+    {
+      m_tIndexReqSent = tIndexReq;
+    }
+
+  m_downData.id.push_back (m_sendRequestCounter);
+  m_downData.playbackIndex.push_back (tIndexReq);
+  struct st_requestTimeInfo tinfo = {GetTimeNow (), 0, 0};
+  m_downData.time.push_back (tinfo);
+  m_downData.qualityIndex.push_back (qIndexes);
+  m_sendRequestCounter++;
+  TraceController (cteSendRequest, m_tIndexReqSent);
+  return true;
+}
+
+void
+mvdashGroupController::GroupFinished (int32_t id, int32_t tIndex)
+{
+  NS_LOG_FUNCTION (this << id << tIndex);
+  int64_t timeNow = GetTimeNow ();
+  if (m_tIndexDownloaded <= tIndex)
+    {
+      m_tIndexDownloaded = tIndex;
+    }
+  m_downData.time.at (id).downloadEnd = timeNow;
+
+  m_bufferData.timeNow.push_back (timeNow);
+  if (id > 0)
+    {
+      m_bufferData.bufferLevelOld.push_back (std::max (m_bufferData.bufferLevelNew.back ()
+        - (timeNow - m_downData.time.at (id - 1).downloadEnd), (int64_t) 0));
+    }
+  else
+    {
+      // first segment
+      m_bufferData.bufferLevelOld.push_back (0);
+    }
+  m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelOld.back () + m_videoData[0].segmentDuration);
+
+  TraceController (cteDownloaded, m_tIndexDownloaded);
+  Controller (downloadFinished);
+}
+
+bool
+mvdashGroupController::StartPlayback (void)
+{
+  NS_LOG_FUNCTION (this);
+  // if we got called and there are no segments left in the buffer, there is a buffer underrun
+  if (m_tIndexPlay > m_tIndexDownloaded)
+    {
+      TraceController (cteBufferUnderrun, m_tIndexPlay);
+      return false;
+    }
+
+  if (m_tIndexPlay > 0)
+    {
+      m_pViewModel->UpdateViewpoint (m_tIndexPlay, GetTimeNow ());
+    }
+  m_playData.playbackIndex.push_back (m_tIndexPlay);
+  m_playData.mainViewpoint.push_back (m_pViewModel->CurrentViewpoint ());
+  m_playData.playbackStart.push_back (GetTimeNow ());
+  m_playData.qualityIndex.push_back (m_downData.qualityIndex[m_tIndexPlay]);
+  if (m_nTiles > 0)
+    {
+      RecordViewportCoverage ();
+    }
+
+  TraceController (cteStartPlayback, m_tIndexPlay);
+  m_tIndexPlay++;
+  PlaybackStarted ();
+  return true;
+}
+
+void
+mvdashGroupController::RecordViewportCoverage (void)
+{
+  // Where the viewer looks now, against the tiles requested a buffer ago
+  m_pViewportModel->UpdateViewport (m_tIndexPlay, m_videoData[0].segmentDuration);
+  int32_t vp = m_pViewModel->CurrentViewpoint ();
+  std::map <int32_t, std::vector<int32_t> >::iterator it = m_tileQualities.find (m_tIndexPlay);
+  if (it == m_tileQualities.end ())
+    {
+      m_playData.viewportCoverage.push_back (0.0);
+      return;
+    }
+  std::vector <int32_t> tiles (it->second.begin () + vp * m_nTiles, it->second.begin () + (vp + 1) * m_nTiles);
+  std::vector <bool> visible = m_pViewportModel->GetVisibleTiles (m_videoData[0].tileColumns,
+                                                                  m_videoData[0].tileRows, 0.0);
+  m_playData.viewportCoverage.push_back (
+    mvdashTileAllocator::GetCoverage (tiles, m_downData.qualityIndex[m_tIndexPlay][vp], visible));
+  m_tileQualities.erase (m_tileQualities.begin (), ++it);
+}
+
+} // namespace ns3
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_GROUP_CONTROLLER_H
+#define MVDASH_GROUP_CONTROLLER_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/ptr.h"
+#include "mvdash.h"
+#include "multiview-model.h"
+#include "mvdash_adaptation_algorithm.h"
+#include "mvdash_tile_allocator.h"
+#include "viewport_model.h"
+
+namespace ns3 {
+
+/**
+  * \brief This enum is used to define the states of the state machine which controls the behaviour of the client.
+  */
+enum controllerState
+{
+  initial, downloading, downloadingPlaying, playing, terminal
+};
+
+/**
+  * \brief This enum is used to define the controller events of the state machine which controls the behaviour of the client.
+  */
+enum controllerEvent
+{
+  downloadFinished, playbackFinished, irdFinished, init
+};
+
+enum controllerTraceEvent
+{
+  cteSendRequest, cteDownloaded, cteAllDownloaded, cteStartPlayback, cteEndPlayback, cteBufferUnderrun
+};
+
+/**
+ * \ingroup etri_mvdash
+ * \brief The controller of the group buffer mode of mvdashClient.
+ *
+ * The viewpoints of a time index are requested as one group, the next
+ * group once it is in, and playback runs on the groups downloaded.  The
+ * controller keeps the download, playback and buffer records that the
+ * viewpoint model and the adaptation algorithm read.  It neither schedules
+ * nor sends anything itself.  mvdashClient carries the groups over its
+ * transports in the simulator; mvdashSession lets a driver with its own
+ * clock carry them.
+ */
+class mvdashGroupController
+{
+public:
+  /**
+   * \param videoData the manifest, kept by reference
+   */
+  mvdashGroupController (const t_videoDataGroup &videoData);
+  virtual ~mvdashGroupController ();
+
+  const struct playbackDataGroup & GetPlaybackData (void) const { return m_playData; }
+  const struct downloadDataGroup & GetDownloadData (void) const { return m_downData; }
+
+protected:
+  /**
+   * \brief The state machine: request the next group while there is one,
+   *        play the groups downloaded, and stall when none is
+   */
+  void Controller (controllerEvent event);
+  /**
+   * \brief Build the requests of a group: one per viewpoint, one per tile of
+   *        every viewpoint for tiled video, or one per layer for layered video
+   */
+  std::vector <st_mvdashRequest> PrepareRequest (int32_t tIndexReq);
+  /**
+   * \brief Send the group of tIndexReq and record it
+   * \returns false if SendGroup sent nothing
+   */
+  bool RequestGroup (int32_t tIndexReq);
+  /**
+   * \brief Update the buffer and move the controller on once all the segments of a request group are in
+   */
+  void GroupFinished (int32_t id, int32_t tIndex);
+  /**
+   * \returns false on a buffer underrun
+   */
+  bool StartPlayback (void);
+  /**
+   * \brief Record the share of the viewport of the segment starting to play
+   *        that came at the quality of its viewpoint
+   */
+  void RecordViewportCoverage (void);
+
+  /**
+   * \returns the time now, in microseconds
+   */
+  virtual int64_t GetTimeNow (void) const = 0;
+  /**
+   * \brief Carry the requests of a group
+   * \returns false if none was sent; the next event of the controller tries again
+   */
+  virtual bool SendGroup (const std::vector <st_mvdashRequest> &requests) = 0;
+  /**
+   * \brief Change the qualities the algorithm selected for a group before it is requested
+   */
+  virtual void AdjustQualities (std::vector <int32_t> &qIndex);
+  /**
+   * \brief Segment m_tIndexPlay - 1 started playing: call Controller
+   *        (playbackFinished) one segment duration from now
+   */
+  virtual void PlaybackStarted (void) = 0;
+  /**
+   * \brief Every segment has played
+   */
+  virtual void SessionFinished (void);
+  /**
+   * \brief A controller event, for the traces of a subclass
+   */
+  virtual void TraceController (controllerTraceEvent event, int32_t tIndex);
+
+  const t_videoDataGroup &m_videoData;
+
+  controllerState m_state;
+  int32_t       m_nViewpoints;
+  int32_t       m_tIndexLast;
+  int32_t       m_tIndexPlay;
+  int32_t       m_tIndexReqSent;
+  int32_t       m_tIndexDownloaded;
+  int32_t       m_sendRequestCounter;
+
+  MultiView_Model *m_pViewModel;
+  mvdashAdaptationAlgorithm *m_pAlgorithm;
+
+  struct downloadDataGroup m_downData;
+  struct playbackDataGroup m_playData;
+  struct bufferData m_bufferData;
+
+  // Tiled viewpoints, if m_nTiles is set
+  int32_t       m_nTiles;             //!< tiles per viewpoint, 0 if not tiled
+  double        m_viewportMargin;     //!< degrees
+  mvdashTileAllocator m_tileAllocator;
+  Ptr<Viewport_Model> m_pViewportModel;
+  std::map <int32_t, std::vector<int32_t> > m_tileQualities;  //!< requested tile qualities by time index, viewpoint-major, until played
+
+  // Layered video
+  bool          m_layered;            //!< a request names a layer, not a whole level
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_GROUP_CONTROLLER_H */
@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <numeric>
+#include "ns3/log.h"
+#include "mvdash_manifest.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashManifest");
+
+// Average bitrate of every representation, from its segment sizes
+static void ComputeAverageBitrates (t_videoDataGroup &videoData, int32_t nSegments)
+{
+  for (struct videoData &video : videoData) {
+    for (size_t rindex = 0; rindex < video.segmentSize.size(); rindex++) {
+      int64_t averageByteSize = (int64_t) std::accumulate ( video.segmentSize[rindex].begin (),
+        video.segmentSize[rindex].end(), 0.0) / nSegments;
+      video.averageBitrate[rindex] = 8.0 * averageByteSize / video.segmentDuration * 1000000;
+    }
+  }
+}
+
+int32_t mvdashReadManifest (std::string mvInfoFile, t_videoDataGroup &videoData)
+{
+  std::ifstream myfile;
+  myfile.open (mvInfoFile.c_str ());
+  if (!myfile) {
+      NS_LOG_ERROR ("Cannot open " << mvInfoFile);
+      return -1;
+  }
+  
+  // Local Variables for Iterations
+  int vp, rindex;   // viewpoints index, rate index
+  int nViewpoints, nRates, nSegments, tIndex = 0;
+
+  std::string temp;
+  std::getline(myfile, temp);     // Get the first line
+  std::istringstream buffer(temp);
+  std::vector<int32_t> first_line ((std::istream_iterator<int32_t> (buffer)),
+                 std::istream_iterator<int32_t>());
+
+  nViewpoints = first_line[0];
+  nSegments = first_line[1];
+  videoData.clear();
+  for (vp = 0; vp < nViewpoints; vp++) {
+    nRates = first_line[vp+3];
+    std::vector <std::vector<int64_t>> vals(nRates, std::vector<int64_t>(nSegments,0));
+    struct videoData v1 = {vals, std::vector<double>(nRates,0.0), first_line[2], 0, 0, {}, {}, 0, {}}; // firstline[2] --> Duration
+    videoData.push_back(v1);
+  }
+
+  while (std::getline (myfile, temp) && tIndex < nSegments) {
+    if (temp.empty ()) break;
+    std::istringstream buffer (temp);
+    std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                std::istream_iterator<int64_t>());
+    int32_t i=0;                           
+    for (vp = 0; vp < nViewpoints; vp++) {
+      nRates = first_line[vp+3];
+      for (rindex = 0; rindex < nRates; rindex++) {
+        videoData[vp].segmentSize[rindex][tIndex] = line[i++];
+      }
+    }
+    tIndex++;
+  }
+
+  ComputeAverageBitrates (videoData, nSegments);
+
+  myfile.close();
+  return tIndex;
+}
+
+int32_t mvdashReadTileManifest (std::string tileInfoFile, t_videoDataGroup &videoData)
+{
+  std::ifstream myfile;
+  myfile.open (tileInfoFile.c_str ());
+  if (!myfile) {
+      NS_LOG_ERROR ("Cannot open " << tileInfoFile);
+      return -1;
+  }
+
+  std::string temp;
+  std::getline(myfile, temp);
+  std::istringstream buffer(temp);
+  std::vector<int32_t> first_line ((std::istream_iterator<int32_t> (buffer)),
+                 std::istream_iterator<int32_t>());
+  if (first_line.size() < 4 || first_line[0] != (int32_t) videoData.size() || first_line[2] <= 0 || first_line[3] <= 0) {
+      NS_LOG_ERROR (tileInfoFile << " does not match the viewpoints of the video");
+      return -1;
+  }
+  int32_t nSegments = first_line[1];
+  int32_t nTiles = first_line[2] * first_line[3];
+  for (struct videoData &video : videoData) {
+    if (video.segmentSize.empty() || (int32_t) video.segmentSize[0].size() != nSegments) {
+      NS_LOG_ERROR (tileInfoFile << " does not match the segments of the video");
+      return -1;
+    }
+    video.tileColumns = first_line[2];
+    video.tileRows = first_line[3];
+    video.tileSize.assign(video.segmentSize.size(), std::vector<int64_t>(nSegments * nTiles, 0));
+  }
+
+  size_t lineLength = 0;
+  for (const struct videoData &video : videoData)
+    lineLength += video.segmentSize.size() * nTiles;
+
+  int32_t tIndex = 0;
+  while (std::getline (myfile, temp) && tIndex < nSegments) {
+    if (temp.empty ()) break;
+    std::istringstream buffer (temp);
+    std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                std::istream_iterator<int64_t>());
+    if (line.size() != lineLength) break;
+    size_t i = 0;
+    for (struct videoData &video : videoData) {
+      for (size_t rindex = 0; rindex < video.tileSize.size(); rindex++) {
+        // The tiles of a segment are what is downloaded of it
+        int64_t total = 0;
+        for (int32_t tile = 0; tile < nTiles; tile++) {
+          video.tileSize[rindex][tIndex * nTiles + tile] = line[i];
+          total += line[i++];
+        }
+        video.segmentSize[rindex][tIndex] = total;
+      }
+    }
+    tIndex++;
+  }
+  myfile.close();
+  if (tIndex < nSegments) {
+    NS_LOG_ERROR (tileInfoFile << ": time index " << tIndex << " is missing or incomplete");
+    return -1;
+  }
+
+  ComputeAverageBitrates (videoData, nSegments);
+  return tIndex;
+}
+
+void mvdashSplitTiles (t_videoDataGroup &videoData, int32_t columns, int32_t rows)
+{
+  int32_t nTiles = columns * rows;
+  for (struct videoData &video : videoData) {
+    video.tileColumns = columns;
+    video.tileRows = rows;
+    video.tileSize.resize(video.segmentSize.size());
+    for (size_t rindex = 0; rindex < video.segmentSize.size(); rindex++) {
+      const std::vector<int64_t> &sizes = video.segmentSize[rindex];
+      video.tileSize[rindex].resize(sizes.size() * nTiles);
+      for (size_t tIndex = 0; tIndex < sizes.size(); tIndex++) {
+        // Even shares; the first tiles take the remainder, so the tiles add up to the segment
+        for (int32_t tile = 0; tile < nTiles; tile++)
+          video.tileSize[rindex][tIndex * nTiles + tile] = sizes[tIndex] / nTiles + (tile < sizes[tIndex] % nTiles);
+      }
+    }
+  }
+}
+
+int32_t mvdashReadLayerManifest (std::string layerInfoFile, t_videoDataGroup &videoData)
+{
+  std::ifstream myfile;
+  myfile.open (layerInfoFile.c_str ());
+  if (!myfile) {
+      NS_LOG_ERROR ("Cannot open " << layerInfoFile);
+      return -1;
+  }
+
+  std::string temp;
+  std::getline(myfile, temp);
+  std::istringstream buffer(temp);
+  std::vector<int32_t> first_line ((std::istream_iterator<int32_t> (buffer)),
+                 std::istream_iterator<int32_t>());
+  if (first_line.size() < 2 || first_line[0] != (int32_t) videoData.size()) {
+      NS_LOG_ERROR (layerInfoFile << " does not match the viewpoints of the video");
+      return -1;
+  }
+  int32_t nSegments = first_line[1];
+  size_t lineLength = 0;
+  for (struct videoData &video : videoData) {
+    if (video.segmentSize.empty() || (int32_t) video.segmentSize[0].size() != nSegments) {
+      NS_LOG_ERROR (layerInfoFile << " does not match the segments of the video");
+      return -1;
+    }
+    video.layerSize.assign(video.segmentSize.size(), std::vector<int64_t>(nSegments, 0));
+    lineLength += video.segmentSize.size();
+  }
+
+  int32_t tIndex = 0;
+  while (std::getline (myfile, temp) && tIndex < nSegments) {
+    if (temp.empty ()) break;
+    std::istringstream buffer (temp);
+    std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                std::istream_iterator<int64_t>());
+    if (line.size() != lineLength) break;
+    size_t i = 0;
+    for (struct videoData &video : videoData) {
+      // A level is played from its layer and all the layers below
+      int64_t total = 0;
+      for (size_t layer = 0; layer < video.layerSize.size(); layer++) {
+        video.layerSize[layer][tIndex] = line[i];
+        total += line[i++];
+        video.segmentSize[layer][tIndex] = total;
+      }
+    }
+    tIndex++;
+  }
+  myfile.close();
+  if (tIndex < nSegments) {
+    NS_LOG_ERROR (layerInfoFile << ": time index " << tIndex << " is missing or incomplete");
+    return -1;
+  }
+
+  ComputeAverageBitrates (videoData, nSegments);
+  return tIndex;
+}
+
+void mvdashSplitLayers (t_videoDataGroup &videoData, double overhead)
+{
+  for (struct videoData &video : videoData) {
+    video.layerSize.assign(video.segmentSize.size(), std::vector<int64_t>());
+    for (size_t layer = 0; layer < video.segmentSize.size(); layer++) {
+      std::vector<int64_t> &sizes = video.segmentSize[layer];
+      video.layerSize[layer].resize(sizes.size());
+      for (size_t tIndex = 0; tIndex < sizes.size(); tIndex++) {
+        // The base layer is the lowest level as it is; each enhancement layer
+        // costs the step up the ladder plus the overhead of the higher level
+        int64_t below = layer ? video.segmentSize[layer - 1][tIndex] : 0;
+        int64_t total = layer ? (int64_t) (sizes[tIndex] * (1.0 + overhead)) : sizes[tIndex];
+        video.layerSize[layer][tIndex] = std::max (total - below, (int64_t) 0);
+        sizes[tIndex] = below + video.layerSize[layer][tIndex];
+      }
+    }
+  }
+  if (!videoData.empty() && !videoData[0].segmentSize.empty())
+    ComputeAverageBitrates (videoData, videoData[0].segmentSize[0].size());
+}
+
+int32_t mvdashReadSwitchManifest (std::string switchInfoFile, t_videoDataGroup &videoData)
+{
+  std::ifstream myfile;
+  myfile.open (switchInfoFile.c_str ());
+  if (!myfile) {
+      NS_LOG_ERROR ("Cannot open " << switchInfoFile);
+      return -1;
+  }
+
+  std::string temp;
+  std::getline(myfile, temp);
+  std::istringstream buffer(temp);
+  std::vector<int64_t> first_line ((std::istream_iterator<int64_t> (buffer)),
+                 std::istream_iterator<int64_t>());
+  if (first_line.size() < 3 || first_line[0] != (int64_t) videoData.size() || first_line[2] <= 0) {
+      NS_LOG_ERROR (switchInfoFile << " does not match the viewpoints of the video");
+      return -1;
+  }
+  int32_t nSegments = first_line[1];
+  int64_t switchDuration = first_line[2];
+  size_t lineLength = 0;
+  int32_t nSwitch = 0;
+  for (struct videoData &video : videoData) {
+    if (video.segmentSize.empty() || (int32_t) video.segmentSize[0].size() != nSegments) {
+      NS_LOG_ERROR (switchInfoFile << " does not match the segments of the video");
+      return -1;
+    }
+    // Switch segments start on the boundaries of the regular ones
+    if (video.segmentDuration % switchDuration || video.segmentDuration / switchDuration < 2) {
+      NS_LOG_ERROR (switchInfoFile << ": a segment is not two or more switch segments");
+      return -1;
+    }
+    nSwitch = video.segmentDuration / switchDuration;
+    video.switchDuration = switchDuration;
+    video.switchSize.assign(video.segmentSize.size(), std::vector<int64_t>(nSegments * nSwitch, 0));
+    lineLength += video.segmentSize.size() * nSwitch;
+  }
+
+  int32_t tIndex = 0;
+  while (std::getline (myfile, temp) && tIndex < nSegments) {
+    if (temp.empty ()) break;
+    std::istringstream buffer (temp);
+    std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                std::istream_iterator<int64_t>());
+    if (line.size() != lineLength) break;
+    size_t i = 0;
+    for (struct videoData &video : videoData) {
+      for (size_t rindex = 0; rindex < video.switchSize.size(); rindex++) {
+        for (int32_t j = 0; j < nSwitch; j++)
+          video.switchSize[rindex][tIndex * nSwitch + j] = line[i++];
+      }
+    }
+    tIndex++;
+  }
+  myfile.close();
+  if (tIndex < nSegments) {
+    NS_LOG_ERROR (switchInfoFile << ": time index " << tIndex << " is missing or incomplete");
+    return -1;
+  }
+  return tIndex;
+}
+
+void mvdashMakeSwitchSegments (t_videoDataGroup &videoData, int64_t switchDuration, double overhead)
+{
+  for (struct videoData &video : videoData) {
+    int32_t nSwitch = video.segmentDuration / switchDuration;
+    video.switchDuration = switchDuration;
+    video.switchSize.resize(video.segmentSize.size());
+    for (size_t rindex = 0; rindex < video.segmentSize.size(); rindex++) {
+      const std::vector<int64_t> &sizes = video.segmentSize[rindex];
+      video.switchSize[rindex].resize(sizes.size() * nSwitch);
+      // An even share of the segment, plus the intra frames of the shorter GOPs
+      for (size_t tIndex = 0; tIndex < sizes.size(); tIndex++) {
+        for (int32_t j = 0; j < nSwitch; j++)
+          video.switchSize[rindex][tIndex * nSwitch + j] = (int64_t) (sizes[tIndex] * (1.0 + overhead) / nSwitch);
+      }
+    }
+  }
+}
+
+std::vector <int32_t> mvdashParseViewpointList (std::string list)
+{
+  std::vector <int32_t> viewpoints;
+  std::istringstream buffer (list);
+  std::string item;
+  while (std::getline (buffer, item, ',')) {
+    if (!item.empty ())
+      viewpoints.push_back (std::stoi (item));
+  }
+  return viewpoints;
+}
+
+} // namespace ns3
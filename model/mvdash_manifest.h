@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MVDASH_MANIFEST_H
+#define MVDASH_MANIFEST_H
+
+#include <string>
+#include <vector>
+#include "mvdash.h"
+
+namespace ns3 {
+
+/**
+ * \brief Read a multi-view video source file (MVInfo).
+ *
+ * The first line is "nViewpoints nSegments segmentDuration nRates_v1 ...";
+ * each following line holds the segment sizes of one time index, viewpoint
+ * by viewpoint and rate by rate.  The average bitrate of every rate is
+ * computed as well.
+ *
+ * \param mvInfoFile the path of the file
+ * \param videoData filled with one entry per viewpoint
+ * \returns the number of segments read, or -1 if the file cannot be opened
+ */
+int32_t mvdashReadManifest (std::string mvInfoFile, t_videoDataGroup &videoData);
+
+/**
+ * \brief Read the tile sizes (TileInfo) of a video read by mvdashReadManifest.
+ *
+ * The first line is "nViewpoints nSegments tileColumns tileRows"; each
+ * following line holds the tile sizes of one time index, viewpoint by
+ * viewpoint, rate by rate and tile by tile, the tiles row-major from the top
+ * left of the equirectangular picture.  The segment sizes of videoData become
+ * the sums of their tiles, as tiling adds coding overhead.
+ *
+ * \param tileInfoFile the path of the file
+ * \param videoData the video, with the viewpoints and rates of the file
+ * \returns the number of segments read, or -1 if the file cannot be opened or
+ *          does not match videoData (which is then left partly tiled)
+ */
+int32_t mvdashReadTileManifest (std::string tileInfoFile, t_videoDataGroup &videoData);
+
+/**
+ * \brief Cut every segment of videoData into columns x rows tiles of equal size,
+ *        for a video without tile sizes of its own
+ */
+void mvdashSplitTiles (t_videoDataGroup &videoData, int32_t columns, int32_t rows);
+
+/**
+ * \brief Read the layer sizes (LayerInfo) of a scalable video read by
+ *        mvdashReadManifest, one layer per rate of the manifest.
+ *
+ * The first line is "nViewpoints nSegments"; each following line holds the
+ * layer sizes of one time index, viewpoint by viewpoint, the base layer first.
+ * Playing a level takes its layer and all the layers below, so the segment
+ * sizes of videoData become the sums of the layers up to each level.
+ *
+ * \param layerInfoFile the path of the file
+ * \param videoData the video, with the viewpoints and rates of the file
+ * \returns the number of segments read, or -1 if the file cannot be opened or
+ *          does not match videoData
+ */
+int32_t mvdashReadLayerManifest (std::string layerInfoFile, t_videoDataGroup &videoData);
+
+/**
+ * \brief Make layers of the rates of videoData, for a video without layer
+ *        sizes of its own: the base layer is the lowest rate, and every level
+ *        costs its single-layer size times 1 + overhead.
+ */
+void mvdashSplitLayers (t_videoDataGroup &videoData, double overhead);
+
+/**
+ * \brief Read the switch segment sizes (SwitchInfo) of a video read by
+ *        mvdashReadManifest: short closed-GOP representations of every rate,
+ *        cut on the boundaries of the regular segments.
+ *
+ * The first line is "nViewpoints nSegments switchDuration", the duration in
+ * microseconds and a whole fraction, a half or less, of the segment duration;
+ * each following line holds the switch segment sizes of one time index,
+ * viewpoint by viewpoint, rate by rate and switch segment by switch segment.
+ *
+ * \param switchInfoFile the path of the file
+ * \param videoData the video, with the viewpoints and rates of the file
+ * \returns the number of segments read, or -1 if the file cannot be opened or
+ *          does not match videoData
+ */
+int32_t mvdashReadSwitchManifest (std::string switchInfoFile, t_videoDataGroup &videoData);
+
+/**
+ * \brief Make switch segments of switchDuration microseconds, a whole fraction
+ *        of the segment duration, for a video without switch segment sizes of
+ *        its own: each costs its share of the segment times 1 + overhead.
+ */
+void mvdashMakeSwitchSegments (t_videoDataGroup &videoData, int64_t switchDuration, double overhead);
+
+/**
+ * \param list comma separated viewpoint indexes, e.g. "0,2"
+ * \returns the indexes, in the order given
+ */
+std::vector <int32_t> mvdashParseViewpointList (std::string list);
+
+} // namespace ns3
+
+#endif /* MVDASH_MANIFEST_H */
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/log.h"
+#include "mvdash_segment_cache.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashSegmentCache");
+
+mvdashSegmentCache::mvdashSegmentCache ()
+  : m_policy (LRU),
+    m_capacity (0),
+    m_usedBytes (0),
+    m_clock (0),
+    m_nEvictions (0)
+{
+}
+
+void
+mvdashSegmentCache::SetCapacity (uint64_t bytes)
+{
+  m_capacity = bytes;
+}
+
+void
+mvdashSegmentCache::SetPolicy (Policy policy)
+{
+  NS_ASSERT_MSG (m_entries.empty (), "The policy must be set before the cache is used");
+  m_policy = policy;
+}
+
+uint64_t
+mvdashSegmentCache::MakeKey (int32_t viewpoint, int32_t timeIndex, int32_t qualityIndex, int32_t tile, int32_t part)
+{
+  return ((uint64_t) (viewpoint & 0xfff) << 52)
+         | ((uint64_t) (tile & 0xfff) << 40)
+         | ((uint64_t) (timeIndex & 0xffffff) << 16)
+         | ((uint64_t) (uint8_t) part << 8)
+         | (uint64_t) (uint8_t) qualityIndex;
+}
+
+mvdashSegmentCache::t_rankKey
+mvdashSegmentCache::RankKey (uint64_t key, const st_cacheEntry &entry) const
+{
+  return t_rankKey (m_policy == LFU ? entry.uses : 0, entry.lastUse, key);
+}
+
+bool
+mvdashSegmentCache::Lookup (uint64_t key)
+{
+  std::map<uint64_t, st_cacheEntry>::iterator it = m_entries.find (key);
+  if (it == m_entries.end ())
+    {
+      return false;
+    }
+  m_order.erase (RankKey (key, it->second));
+  it->second.uses++;
+  it->second.lastUse = ++m_clock;
+  m_order.insert (RankKey (key, it->second));
+  return true;
+}
+
+void
+mvdashSegmentCache::Insert (uint64_t key, uint32_t size)
+{
+  if (size > m_capacity || Lookup (key))
+    {
+      return;
+    }
+  while (m_usedBytes + size > m_capacity)
+    {
+      uint64_t victim = std::get<2> (*m_order.begin ());
+      m_order.erase (m_order.begin ());
+      m_usedBytes -= m_entries[victim].size;
+      m_entries.erase (victim);
+      m_nEvictions++;
+    }
+  st_cacheEntry entry = {size, 1, ++m_clock};
+  m_entries[key] = entry;
+  m_order.insert (RankKey (key, entry));
+  m_usedBytes += size;
+}
+
+} // namespace ns3
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MVDASH_SEGMENT_CACHE_H
+#define MVDASH_SEGMENT_CACHE_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace ns3 {
+
+/**
+ * \brief Byte-bounded segment cache with LRU or LFU replacement.
+ *
+ * Only the segment sizes are stored.  Entries are kept in an ordered set by
+ * (rank, last use); the smallest one is evicted first.  The rank is always 0
+ * for LRU and the use count for LFU, so LFU breaks ties by recency.
+ */
+class mvdashSegmentCache
+{
+public:
+  enum Policy { LRU, LFU };
+
+  mvdashSegmentCache ();
+
+  void SetCapacity (uint64_t bytes);
+  void SetPolicy (Policy policy);
+
+  /**
+   * \returns the key of a segment, or of one of its tiles or switch
+   *          segments; up to 4096 viewpoints, 4096 tiles, 2^24 time indexes,
+   *          256 switch segments and 256 qualities
+   */
+  static uint64_t MakeKey (int32_t viewpoint, int32_t timeIndex, int32_t qualityIndex, int32_t tile = 0,
+                           int32_t part = 0);
+
+  /**
+   * \returns true on a hit; a hit refreshes the entry
+   */
+  bool Lookup (uint64_t key);
+  /**
+   * Insert a segment, evicting others until it fits.  Segments larger than
+   * the capacity are not cached.
+   */
+  void Insert (uint64_t key, uint32_t size);
+
+  uint64_t GetCapacity (void) const { return m_capacity; }
+  uint64_t GetUsedBytes (void) const { return m_usedBytes; }
+  uint32_t GetNEntries (void) const { return m_entries.size (); }
+  uint64_t GetNEvictions (void) const { return m_nEvictions; }
+
+private:
+  struct st_cacheEntry
+  {
+    uint32_t size;
+    uint64_t uses;
+    uint64_t lastUse;
+  };
+  typedef std::tuple<uint64_t, uint64_t, uint64_t> t_rankKey;  //!< (rank, last use, key)
+
+  t_rankKey RankKey (uint64_t key, const st_cacheEntry &entry) const;
+
+  Policy   m_policy;
+  uint64_t m_capacity;
+  uint64_t m_usedBytes;
+  uint64_t m_clock;             //!< incremented on every lookup and insert
+  uint64_t m_nEvictions;
+  std::map <uint64_t, st_cacheEntry> m_entries;
+  std::set <t_rankKey> m_order;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_SEGMENT_CACHE_H */
@@ -20,6 +20,9 @@
 #include "ns3/tcp-socket.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "mvdash_manifest.h"
+#include <cstring>
 
 namespace ns3 {
 
@@ -38,6 +41,41 @@ TypeId mvdashServer::GetTypeId (void)
                    AddressValue (),
                    MakeAddressAccessor (&mvdashServer::m_localAddress),
                    MakeAddressChecker ())
+    .AddAttribute ("UseQuic",
+                   "1 - also serve requests over the UDP transport with one stream per viewpoint",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashServer::m_useQuic),
+                   MakeUintegerChecker<uint32_t> (0, 1))
+    .AddAttribute ("Push",
+                   "Push the segments that follow a request to the clients that ask for them on a framed connection",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&mvdashServer::m_push),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MVInfo",
+                   "The relative path to the file containing the Multi-View Video Source Info, used for push and multicast",
+                   StringValue ("./contrib/etri_mvdash/multiviewvideo.csv"),
+                   MakeStringAccessor (&mvdashServer::m_mvInfoFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("MulticastGroup",
+                   "The group Address and port to multicast the MulticastViewpoints to; unset disables multicast",
+                   AddressValue (),
+                   MakeAddressAccessor (&mvdashServer::m_mcastGroup),
+                   MakeAddressChecker ())
+    .AddAttribute ("MulticastViewpoints",
+                   "Comma separated indexes of the viewpoints to multicast, e.g. 0,1",
+                   StringValue (""),
+                   MakeStringAccessor (&mvdashServer::m_mcastViewpointsStr),
+                   MakeStringChecker ())
+    .AddAttribute ("MulticastQuality",
+                   "The quality index of the multicast viewpoints",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&mvdashServer::m_mcastQuality),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MulticastStart",
+                   "The time, relative to the application start, of the first multicast segment",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&mvdashServer::m_mcastStart),
+                   MakeTimeChecker ())
     .AddTraceSource ("Rx", "A packet has been received",
                      MakeTraceSourceAccessor (&mvdashServer::m_rxTrace),
                      "ns3::Packet::AddressTracedCallback") 
@@ -49,9 +87,17 @@ TypeId mvdashServer::GetTypeId (void)
 }
 
 mvdashServer::mvdashServer ()
+  : m_useQuic (0),
+    m_push (false),
+    m_nSegments (0),
+    m_mcastQuality (0),
+    m_mcastNextChunk (0),
+    m_mcastTIndex (0)
 {
     NS_LOG_FUNCTION (this);
     m_socket = 0;
+    m_mcastSocket = 0;
+    m_udpSocket = 0;
 }
 
 mvdashServer::~mvdashServer ()
@@ -63,7 +109,14 @@ void mvdashServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
+  m_mcastSocket = 0;
+  m_udpSocket = 0;
   m_connectedClients.clear ();
+  for (std::map <Address, Ptr<mvdashUdpConnection> >::iterator it = m_udpConnections.begin (); it != m_udpConnections.end (); ++it)
+    {
+      it->second->Dispose ();
+    }
+  m_udpConnections.clear ();
 
   // chain up
   Application::DoDispose ();
@@ -94,6 +147,27 @@ void mvdashServer::StartApplication ()    // Called at time specified by Start
   m_socket->SetCloseCallbacks (
     MakeCallback (&mvdashServer::HandlePeerClose, this),
     MakeCallback (&mvdashServer::HandlePeerError, this));
+
+  if (m_useQuic && !m_udpSocket)
+    {
+      m_udpSocket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+      if (m_udpSocket->Bind (m_localAddress) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind UDP socket");
+        }
+      m_udpSocket->SetRecvCallback (MakeCallback (&mvdashServer::HandleUdpRead, this));
+    }
+
+  if ((m_push || !m_mcastGroup.IsInvalid ()) && m_videoData.empty ())
+    {
+      m_nSegments = mvdashReadManifest (m_mvInfoFilePath, m_videoData);
+      if (m_nSegments <= 0)
+        NS_LOG_ERROR ("No video source info in " << m_mvInfoFilePath);
+    }
+  NS_ABORT_MSG_IF (m_push && m_nSegments <= 0, "Push needs the video source info of MVInfo");
+
+  if (!m_mcastGroup.IsInvalid ())
+    m_mcastEvent = Simulator::Schedule (m_mcastStart, &mvdashServer::StartMulticast, this);
 }
 
 void mvdashServer::StopApplication ()      // Called at time specified by Stop
@@ -110,6 +184,20 @@ void mvdashServer::StopApplication ()      // Called at time specified by Stop
       m_socket->Close ();
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
+  for (std::map <Address, Ptr<mvdashUdpConnection> >::iterator it = m_udpConnections.begin (); it != m_udpConnections.end (); ++it)
+    {
+      it->second->Close ();
+    }
+  if (m_udpSocket)
+    {
+      m_udpSocket->Close ();
+      m_udpSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  Simulator::Cancel (m_mcastEvent);
+  if (m_mcastSocket)
+    {
+      m_mcastSocket->Close ();
+    }
 }
 
 void mvdashServer::HandleRead (Ptr<Socket> socket)
@@ -120,71 +208,144 @@ void mvdashServer::HandleRead (Ptr<Socket> socket)
   //NS_LOG_INFO (packet->GetSize () << " bytes at time " << Simulator::Now ().As (Time::S));
   m_rxTrace(packet,from);
 
-  if (ParseRequest (packet, from))
-    SendResponse(socket, from);
+  st_serverClient &client = m_clients[from];
+  if (ParseRequest (packet, client))
+    SendResponse(socket, from, client);
 }
 
-bool mvdashServer::ParseRequest(Ptr<Packet> packet, const Address &from)
+bool mvdashServer::ParseRequest(Ptr<Packet> packet, st_serverClient &client)
 {
     NS_LOG_FUNCTION (this);
 
-    uint8_t *buffer = new uint8_t [packet->GetSize ()];
-    packet->CopyData (buffer, packet->GetSize ());
-    st_mvdashRequest * pReq = (st_mvdashRequest *) buffer;
-    int nRequests = packet->GetSize() / sizeof(st_mvdashRequest);
-
-    if (m_requests[from].empty()) {
-      m_unsentPacket[from] = 0;
-      m_bytesSent[from] = 0;
+    // Requests may be split across TCP reads, e.g. when an mvdashCacheServer
+    // forwards many of them on one connection; keep the tail for the next read
+    if (client.partialRequest) {
+      client.partialRequest->AddAtEnd (packet);
+      packet = client.partialRequest;
+      client.partialRequest = 0;
     }
+    uint32_t remainder = packet->GetSize() % sizeof(st_mvdashRequest);
+    if (remainder)
+      client.partialRequest = packet->CreateFragment (packet->GetSize() - remainder, remainder);
 
-    for (int nR = 0; nR < nRequests; nR++) {
-      m_requests[from].push(pReq[nR]);
-      //NS_LOG_INFO("Viewpoint " << pReq[nR].viewpoint << "  time" << pReq[nR].timeIndex << " quality " << pReq[nR].qualityIndex);
+    int nRequests = packet->GetSize() / sizeof(st_mvdashRequest);
+    std::vector <st_mvdashRequest> buffer (nRequests);
+    packet->CopyData ((uint8_t *) buffer.data (), nRequests * sizeof(st_mvdashRequest));
+
+    bool queued = false;
+    for (st_mvdashRequest req : buffer) {
+      //NS_LOG_INFO("Viewpoint " << req.viewpoint << "  time" << req.timeIndex << " quality " << req.qualityIndex);
+      if (req.id == pushid_framed) {
+        client.framed = true;
+        continue;
+      }
+      if (req.id == pushid_cancel) {
+        // Segments already started go out whole
+        std::deque<st_mvdashRequest>::iterator it = client.requests.begin ();
+        if (it != client.requests.end () && client.bytesPacked > 0)
+          ++it;
+        while (it != client.requests.end ()) {
+          if (it->id == pushid_pushed && it->viewpoint == req.viewpoint && it->timeIndex >= req.timeIndex)
+            it = client.requests.erase (it);
+          else
+            ++it;
+        }
+        std::map<int32_t, int32_t>::iterator until = client.pushedUntil.find (req.viewpoint);
+        if (until != client.pushedUntil.end ())
+          until->second = std::min (until->second, req.timeIndex - 1);
+        continue;
+      }
+      if (req.id < 0)
+        continue;
+
+      int32_t push = req.push;
+      req.push = 0;
+      if (m_push && client.framed && push > 0 && req.tile == 0) {
+        // The copy preceding the segment tells the client how many follow
+        client.requests.push_back (req);
+        st_mvdashRequest &copy = client.requests.back ();
+        req.push = push;
+        copy.push = QueuePush (req, client);
+      }
+      else {
+        client.requests.push_back (req);
+      }
+      queued = true;
     }
-    //int64_t packetSizeToReturn = *(int64_t *)(buffer);
-    //NS_LOG_INFO("Parse Request Called : " << packetSizeToReturn);
+    return queued;
+}
 
-    return 1;
+int32_t mvdashServer::QueuePush (const st_mvdashRequest &req, st_serverClient &client)
+{
+    NS_LOG_FUNCTION (this << req.viewpoint << req.timeIndex << req.push);
+    if (req.viewpoint < 0 || req.viewpoint >= (int32_t) m_videoData.size ()
+        || req.qualityIndex < 0 || req.qualityIndex >= (int32_t) m_videoData[req.viewpoint].segmentSize.size ())
+      return 0;
+
+    std::map<int32_t, int32_t>::iterator until = client.pushedUntil.insert (std::make_pair (req.viewpoint, -1)).first;
+    int32_t last = std::min (req.timeIndex + req.push, m_nSegments - 1);
+    for (int32_t t = std::max (req.timeIndex, until->second) + 1; t <= last; t++) {
+      int32_t size = m_videoData[req.viewpoint].segmentSize[req.qualityIndex][t];
+      st_mvdashRequest pushed (pushid_pushed, req.viewpoint, t, req.qualityIndex, size);
+      pushed.push = req.id;
+      client.requests.push_back (pushed);
+      until->second = t;
+    }
+    // Those already queued by an earlier request count as promised too
+    return std::max (last - req.timeIndex, 0);
 }
 
-void mvdashServer::SendResponse(Ptr<Socket> socket, const Address &from)
+void mvdashServer::SendResponse(Ptr<Socket> socket, const Address &from, st_serverClient &client)
 {
     NS_LOG_FUNCTION (this);
 
-    if (m_requests[from].empty()) return;
-    st_mvdashRequest curReq = m_requests[from].front();
-
-    while (m_bytesSent[from] < curReq.segmentSize) 
+    while (client.unsentPacket || !client.requests.empty()) 
     {
-      Ptr<Packet> packet;
-
-      int64_t toSend = std::min ((int64_t)1446, curReq.segmentSize - m_bytesSent[from]);
-
-      if (m_unsentPacket[from])
+      Ptr<Packet> packet = client.unsentPacket;
+      if (!packet)
       {
-          packet = m_unsentPacket[from];
-          toSend = packet->GetSize ();
-      }
-      else
-      {
-          packet = Create<Packet> (toSend);
+          // On a framed connection a segment is the copy of its request, in
+          // real bytes, followed by its payload
+          int64_t header = client.framed ? sizeof (st_mvdashRequest) : 0;
+          uint8_t data[1446];
+          int64_t length = 0;
+          while (length < 1446 && !client.requests.empty())
+          {
+              const st_mvdashRequest &curReq = client.requests.front();
+              int64_t take = std::min (1446 - length, header + curReq.segmentSize - client.bytesPacked);
+              if (client.framed)
+              {
+                  int64_t headerTake = std::max ((int64_t) 0, std::min (take, header - client.bytesPacked));
+                  memcpy (data + length, (const uint8_t *) &curReq + client.bytesPacked, headerTake);
+                  memset (data + length + headerTake, 0, take - headerTake);
+              }
+              length += take;
+              client.bytesPacked += take;
+              if (client.bytesPacked == header + curReq.segmentSize)
+              {
+                  client.bytesPacked = 0;
+                  client.requests.pop_front();
+              }
+          }
+          if (length == 0)
+              break;    // only empty segments were left
+          packet = client.framed ? Create<Packet> (data, length) : Create<Packet> (length);
       }
+      uint32_t toSend = packet->GetSize ();
 
       int actual = socket->Send (packet);
       if (actual == -1)
       {
           //NS_LOG_DEBUG ("[SERVER] Send Error - Caching for later attempt");
-          m_unsentPacket[from] = packet;
+          client.unsentPacket = packet;
           break;
       }
-      else if (actual == toSend)
+      else if (actual == (int) toSend)
       {
           m_txTrace (packet, from);
-          m_unsentPacket[from] = 0;
-          m_bytesSent[from] += actual;
+          client.unsentPacket = 0;
       }
-      else if (actual > 0 && actual < toSend)
+      else if (actual > 0 && actual < (int) toSend)
       {
           // A Linux socket (non-blocking, such as in DCE) may return
           // a quantity less than the packet size.  Split the packet
@@ -193,27 +354,13 @@ void mvdashServer::SendResponse(Ptr<Socket> socket, const Address &from)
           Ptr<Packet> sent = packet->CreateFragment (0, actual);
           Ptr<Packet> unsent = packet->CreateFragment (actual, (toSend - (unsigned) actual));
           m_txTrace (sent, from);
-          m_unsentPacket[from] = unsent;
-          m_bytesSent[from] += actual;
+          client.unsentPacket = unsent;
           break;
       }
       else
       {
             NS_FATAL_ERROR ("[SERVER] Unexpected return value from m_socket->Send ()");
       }
-
-      if (m_bytesSent[from] == curReq.segmentSize)
-      {
-/*        NS_LOG_INFO("Response to the Request <" << curReq.viewpoint
-                    << "," << curReq.timeIndex
-                    << "," << curReq.qualityIndex
-                    << "," << curReq.segmentSize <<"> is completely Sent");*/
-        m_bytesSent[from] = 0;
-        m_requests[from].pop();
-        if (m_requests[from].empty())
-          break;
-        curReq = m_requests[from].front();
-      }
     }
 }
 
@@ -223,9 +370,10 @@ void mvdashServer::HandleSend (Ptr<Socket> socket, unsigned int unused)
     
     Address from;
     socket->GetPeerName (from);
-    if (m_unsentPacket[from]) {
+    std::map<Address, st_serverClient>::iterator it = m_clients.find (from);
+    if (it != m_clients.end () && it->second.unsentPacket) {
       //NS_LOG_DEBUG("[SERVER] HANDLE SEND - THERE IS An UNSENT PACKET");
-      SendResponse (socket, from);    
+      SendResponse (socket, from, it->second);    
     }
 }
 
@@ -233,7 +381,7 @@ void mvdashServer::HandleAccept (Ptr<Socket> socket, const Address& from)
 {
     NS_LOG_FUNCTION (this << socket << from);
 
-    m_unsentPacket[from] = 0;
+    m_clients[from] = st_serverClient ();
     m_connectedClients.push_back (socket);
     socket->SetRecvCallback (MakeCallback (&mvdashServer::HandleRead, this));
     socket->SetSendCallback (MakeCallback (&mvdashServer::HandleSend, this));
@@ -265,4 +413,111 @@ void mvdashServer::HandlePeerError (Ptr<Socket> socket)
   NS_LOG_FUNCTION (this << socket);
 }
 
+// ===========================================================================================
+// UDP transport
+
+void mvdashServer::HandleUdpRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Address from;
+  Ptr<Packet> packet;
+
+  while ((packet = socket->RecvFrom (from)))
+    {
+      m_rxTrace (packet, from);
+      Ptr<mvdashUdpConnection> &connection = m_udpConnections[from];
+      if (!connection)
+        {
+          connection = CreateObject<mvdashUdpConnection> ();
+          connection->Setup (socket, from);
+          connection->SetMessageCallback (MakeCallback (&mvdashServer::HandleUdpRequest, this));
+        }
+      connection->Receive (packet);
+    }
+}
+
+void mvdashServer::HandleUdpRequest (Ptr<mvdashUdpConnection> connection, uint16_t streamId, uint32_t msgId,
+                                     uint32_t msgSize, Ptr<Packet> payload)
+{
+  NS_LOG_FUNCTION (this << streamId << msgId << msgSize);
+  if (streamId != mvdashUdpConnection::REQUEST_STREAM || !payload)
+    return;
+
+  int nRequests = payload->GetSize () / sizeof (st_mvdashRequest);
+  std::vector <st_mvdashRequest> buffer (nRequests);
+  payload->CopyData ((uint8_t *) buffer.data (), nRequests * sizeof (st_mvdashRequest));
+  // Each segment on the stream of its viewpoint, so a loss on one viewpoint
+  // does not hold back the others
+  for (const st_mvdashRequest &req : buffer)
+    connection->SendMessage (req.viewpoint, req.id, req.segmentSize, 0);
+}
+
+// ===========================================================================================
+// Multicast delivery
+
+void mvdashServer::StartMulticast (void)
+{
+    NS_LOG_FUNCTION (this);
+
+    m_mcastViewpoints = mvdashParseViewpointList (m_mcastViewpointsStr);
+    if (m_nSegments <= 0 || m_mcastViewpoints.empty ()) {
+      NS_LOG_ERROR ("Multicast disabled: no video source info or no multicast viewpoints");
+      return;
+    }
+    for (int32_t vp : m_mcastViewpoints) {
+      NS_ABORT_MSG_IF (vp < 0 || vp >= (int32_t) m_videoData.size (), "Invalid multicast viewpoint " << vp);
+      NS_ABORT_MSG_IF (m_mcastQuality >= m_videoData[vp].segmentSize.size (), "Invalid multicast quality");
+    }
+
+    m_mcastSocket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+    m_mcastSocket->Bind ();
+    m_mcastSocket->Connect (m_mcastGroup);
+    m_mcastOrigin = Simulator::Now ();
+    SendMulticastSegment (0);
+}
+
+void mvdashServer::SendMulticastSegment (int32_t tIndex)
+{
+    NS_LOG_FUNCTION (this << tIndex);
+    const int32_t chunkPayload = 1400;
+
+    m_mcastTIndex = tIndex;
+    m_mcastChunks.clear ();
+    for (int32_t vp : m_mcastViewpoints) {
+      int32_t segmentSize = m_videoData[vp].segmentSize[m_mcastQuality][tIndex];
+      for (int32_t offset = 0; offset < segmentSize; offset += chunkPayload) {
+        st_mvdashMulticastChunk chunk = {vp, tIndex, (int32_t) m_mcastQuality, segmentSize,
+                                         offset, std::min (chunkPayload, segmentSize - offset)};
+        m_mcastChunks.push_back (chunk);
+      }
+    }
+    m_mcastNextChunk = 0;
+    SendMulticastChunk ();
+}
+
+void mvdashServer::SendMulticastChunk (void)
+{
+    NS_LOG_FUNCTION (this);
+    int64_t segmentDuration = m_videoData[0].segmentDuration;
+
+    if (m_mcastNextChunk < m_mcastChunks.size ()) {
+      const st_mvdashMulticastChunk &chunk = m_mcastChunks[m_mcastNextChunk++];
+      Ptr<Packet> packet = Create<Packet> ((uint8_t const *) &chunk, sizeof (st_mvdashMulticastChunk));
+      packet->AddAtEnd (Create<Packet> (chunk.length));
+      if (m_mcastSocket->Send (packet) >= 0)
+        m_txTrace (packet, m_mcastGroup);
+    }
+
+    if (m_mcastNextChunk < m_mcastChunks.size ()) {
+      int64_t interval = segmentDuration / m_mcastChunks.size ();
+      m_mcastEvent = Simulator::Schedule (MicroSeconds (interval), &mvdashServer::SendMulticastChunk, this);
+    }
+    else if (m_mcastTIndex + 1 < m_nSegments) {
+      // Next segment on the segment boundary, as a live source would produce it
+      Time next = m_mcastOrigin + MicroSeconds ((m_mcastTIndex + 1) * segmentDuration);
+      m_mcastEvent = Simulator::Schedule (next - Simulator::Now (), &mvdashServer::SendMulticastSegment,
+                                          this, m_mcastTIndex + 1);
+    }
+}
+
 }// Namespace ns3
\ No newline at end of file
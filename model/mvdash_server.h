@@ -24,9 +24,12 @@
 #include "ns3/address.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
 #include <map>
-#include <queue>
+#include <deque>
 #include "mvdash.h"
+#include "mvdash_udp_transport.h"
 
 namespace ns3 {
 
@@ -76,15 +79,90 @@ private:
    */
   void HandlePeerError (Ptr<Socket> socket);
 
-  bool ParseRequest(Ptr<Packet> packet, const Address &from);
-  void SendResponse(Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Feed a datagram of the UDP transport to the connection of its sender
+   */
+  void HandleUdpRead (Ptr<Socket> socket);
+  /**
+   * \brief Answer a request message with one message per segment, on the stream of its viewpoint
+   */
+  void HandleUdpRequest (Ptr<mvdashUdpConnection> connection, uint16_t streamId, uint32_t msgId,
+                         uint32_t msgSize, Ptr<Packet> payload);
+
+  /// Requests of one client and how far their responses went
+  struct st_serverClient
+  {
+    std::deque <st_mvdashRequest> requests;   //!< segments not yet packed into a packet
+    int64_t     bytesPacked;                  //!< bytes of the head segment packed
+    Ptr<Packet> unsentPacket;                 //!< packet, or its tail, the socket did not take
+    Ptr<Packet> partialRequest;               //!< leading bytes of a request split by TCP
+    bool        framed;                       //!< every segment follows a copy of its request
+    std::map <int32_t, int32_t> pushedUntil;  //!< by viewpoint, the latest time index queued for push
+  };
+
+  /**
+   * \brief Queue the requests of packet; on a framed connection, also handle
+   *        the push control messages and queue the segments a request asks
+   *        to be pushed
+   * \returns true if a segment was queued
+   */
+  bool ParseRequest(Ptr<Packet> packet, st_serverClient &client);
+  /**
+   * \brief Queue the segments that follow req on its viewpoint, at its quality
+   * \returns the number of segments after req the client will get pushed
+   */
+  int32_t QueuePush (const st_mvdashRequest &req, st_serverClient &client);
+  /**
+   * \brief Send the queued segments in packets of up to 1446 bytes
+   *
+   * A packet is filled from as many segments as it takes, on every TCP
+   * connection and not only for tiles.  The byte stream is unchanged, but a
+   * segment no longer ends in a short packet of its own: only the packet that
+   * empties the queue is short, one per request group instead of one per
+   * segment.
+   */
+  void SendResponse(Ptr<Socket> socket, const Address &from, st_serverClient &client);
+
+  /**
+   * \brief Start sending the multicast viewpoints to MulticastGroup
+   */
+  void StartMulticast (void);
+  /**
+   * \brief Cut the multicast segments of tIndex into chunks and send the first one
+   */
+  void SendMulticastSegment (int32_t tIndex);
+  /**
+   * \brief Send the next chunk; chunks are paced evenly over the segment duration
+   */
+  void SendMulticastChunk (void);
 
   Ptr<Socket>     m_socket;   //!< Listening socket
   Address m_localAddress;     //!< Local Address on which we listen for incoming packets.
   std::list<Ptr<Socket> > m_connectedClients; //!< the accepted sockets
-  std::map <Address, std::queue <st_mvdashRequest> > m_requests;
-  std::map <Address, Ptr<Packet>> m_unsentPacket; //!< Variable to cache unsent packet
-  std::map <Address, int64_t> m_bytesSent;  
+  std::map <Address, st_serverClient> m_clients;  //!< by client address
+
+  uint32_t        m_useQuic;              //!< also serve the UDP transport on LocalAddress
+  bool            m_push;                 //!< push segments to framed connections that ask for them
+  Ptr<Socket>     m_udpSocket;
+  std::map <Address, Ptr<mvdashUdpConnection> > m_udpConnections;  //!< by client address
+
+  // The video source info, read when pushing or multicasting
+  std::string     m_mvInfoFilePath;
+  t_videoDataGroup m_videoData;
+  int32_t         m_nSegments;
+
+  // Multicast delivery of popular viewpoints, off unless MulticastGroup is set
+  Address         m_mcastGroup;           //!< group address and port, e.g. 225.1.2.4:5000
+  std::string     m_mcastViewpointsStr;
+  uint32_t        m_mcastQuality;
+  Time            m_mcastStart;
+  Time            m_mcastOrigin;          //!< when segment 0 was multicast
+  Ptr<Socket>     m_mcastSocket;
+  std::vector <int32_t> m_mcastViewpoints;
+  std::vector <st_mvdashMulticastChunk> m_mcastChunks;  //!< chunks of the segment being sent
+  uint32_t        m_mcastNextChunk;
+  int32_t         m_mcastTIndex;
+  EventId         m_mcastEvent;
 
   /// Traced Callback: received packets, source address.
   TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include "mvdash_tile_allocator.h"
+
+namespace ns3 {
+
+mvdashTileAllocator::mvdashTileAllocator ()
+  : m_outQuality (0)
+{
+}
+
+int64_t
+mvdashTileAllocator::Allocate (const struct videoData &video, int32_t tIndex, int32_t quality,
+                               const std::vector<bool> &visible, std::vector<int32_t> &qualities) const
+{
+  int32_t nTiles = video.tileColumns * video.tileRows;
+  int32_t outQuality = std::min (m_outQuality, quality);
+  int64_t bytes = 0;
+  qualities.resize (nTiles);
+  for (int32_t tile = 0; tile < nTiles; tile++)
+    {
+      qualities[tile] = visible[tile] ? quality : outQuality;
+      bytes += video.tileSize[qualities[tile]][tIndex * nTiles + tile];
+    }
+  return bytes;
+}
+
+double
+mvdashTileAllocator::GetCoverage (const std::vector<int32_t> &qualities, int32_t quality,
+                                  const std::vector<bool> &visible)
+{
+  int32_t nVisible = 0, nCovered = 0;
+  for (size_t tile = 0; tile < visible.size (); tile++)
+    {
+      if (!visible[tile])
+        {
+          continue;
+        }
+      nVisible++;
+      nCovered += (qualities[tile] >= quality);
+    }
+  return nVisible ? (double) nCovered / nVisible : 1.0;
+}
+
+} // namespace ns3
@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_TILE_ALLOCATOR_H
+#define MVDASH_TILE_ALLOCATOR_H
+
+#include <stdint.h>
+#include <vector>
+#include "mvdash.h"
+
+namespace ns3 {
+
+/**
+ * \brief Qualities of the tiles of a viewpoint segment.
+ *
+ * The tiles expected in the viewport are fetched at the quality the
+ * adaptation algorithm selected for the viewpoint, the others at the
+ * out-of-viewport quality, or at the selected one if it is lower.
+ */
+class mvdashTileAllocator
+{
+public:
+  mvdashTileAllocator ();
+
+  void SetOutOfViewportQuality (int32_t quality) { m_outQuality = quality; }
+  int32_t GetOutOfViewportQuality (void) const { return m_outQuality; }
+
+  /**
+   * \param video the viewpoint, tiled
+   * \param tIndex the segment
+   * \param quality the quality selected for the viewpoint
+   * \param visible the tiles expected in the viewport, row-major
+   * \param qualities filled with one quality per tile
+   * \returns the bytes of the tiles
+   */
+  int64_t Allocate (const struct videoData &video, int32_t tIndex, int32_t quality,
+                    const std::vector<bool> &visible, std::vector<int32_t> &qualities) const;
+
+  /**
+   * \returns the share of the visible tiles of at least quality, 1 if none is visible
+   */
+  static double GetCoverage (const std::vector<int32_t> &qualities, int32_t quality,
+                             const std::vector<bool> &visible);
+
+private:
+  int32_t m_outQuality;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_TILE_ALLOCATOR_H */
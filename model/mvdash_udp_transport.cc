@@ -0,0 +1,420 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/log.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "mvdash_udp_transport.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("mvdashUdpTransport");
+
+NS_OBJECT_ENSURE_REGISTERED (mvdashUdpHeader);
+NS_OBJECT_ENSURE_REGISTERED (mvdashUdpConnection);
+
+// ===========================================================================================
+// mvdashUdpHeader
+
+mvdashUdpHeader::mvdashUdpHeader ()
+  : m_type (DATA),
+    m_streamId (0),
+    m_packetNumber (0),
+    m_msgId (0),
+    m_msgSize (0),
+    m_offset (0),
+    m_length (0)
+{
+}
+
+TypeId
+mvdashUdpHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::mvdashUdpHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<mvdashUdpHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+mvdashUdpHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+mvdashUdpHeader::GetSerializedSize (void) const
+{
+  return m_type == ACK ? 1 + 4 : 1 + 2 + 4 + 4 + 4 + 4 + 2;
+}
+
+void
+mvdashUdpHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteU8 (m_type);
+  start.WriteHtonU32 (m_packetNumber);
+  if (m_type == ACK)
+    {
+      return;
+    }
+  start.WriteHtonU16 (m_streamId);
+  start.WriteHtonU32 (m_msgId);
+  start.WriteHtonU32 (m_msgSize);
+  start.WriteHtonU32 (m_offset);
+  start.WriteHtonU16 (m_length);
+}
+
+uint32_t
+mvdashUdpHeader::Deserialize (Buffer::Iterator start)
+{
+  m_type = start.ReadU8 ();
+  m_packetNumber = start.ReadNtohU32 ();
+  if (m_type != ACK)
+    {
+      m_streamId = start.ReadNtohU16 ();
+      m_msgId = start.ReadNtohU32 ();
+      m_msgSize = start.ReadNtohU32 ();
+      m_offset = start.ReadNtohU32 ();
+      m_length = start.ReadNtohU16 ();
+    }
+  return GetSerializedSize ();
+}
+
+void
+mvdashUdpHeader::Print (std::ostream &os) const
+{
+  if (m_type == ACK)
+    {
+      os << "ACK pn=" << m_packetNumber;
+    }
+  else
+    {
+      os << "DATA pn=" << m_packetNumber << " stream=" << m_streamId << " msg=" << m_msgId
+         << " [" << m_offset << "+" << m_length << "/" << m_msgSize << "]";
+    }
+}
+
+// ===========================================================================================
+// mvdashUdpConnection
+
+TypeId
+mvdashUdpConnection::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::mvdashUdpConnection")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<mvdashUdpConnection> ()
+  ;
+  return tid;
+}
+
+mvdashUdpConnection::mvdashUdpConnection ()
+  : m_lastStream (0),
+    m_nextPacketNumber (1),
+    m_bytesInFlight (0),
+    m_cwnd (10 * MAX_PAYLOAD),
+    m_ssthresh (0xffffffff),
+    m_recoveryStart (0),
+    m_srtt (Time (0)),
+    m_rttVar (Time (0)),
+    m_rto (Seconds (1)),
+    m_nRetransmissions (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+mvdashUdpConnection::~mvdashUdpConnection ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+mvdashUdpConnection::DoDispose (void)
+{
+  Close ();
+  m_socket = 0;
+  m_messageCallback = MessageCallback ();
+  m_dataCallback = DataCallback ();
+  Object::DoDispose ();
+}
+
+void
+mvdashUdpConnection::Setup (Ptr<Socket> socket, const Address &peer)
+{
+  m_socket = socket;
+  m_peer = peer;
+}
+
+void
+mvdashUdpConnection::Close (void)
+{
+  Simulator::Cancel (m_rtoEvent);
+  m_streams.clear ();
+  m_inFlight.clear ();
+  m_bytesInFlight = 0;
+}
+
+void
+mvdashUdpConnection::SendMessage (uint16_t streamId, uint32_t msgId, uint32_t msgSize, Ptr<Packet> payload)
+{
+  NS_LOG_FUNCTION (this << streamId << msgId << msgSize);
+  NS_ASSERT (!payload || (msgSize <= MAX_PAYLOAD && payload->GetSize () == msgSize));
+  st_udpMessage msg = {msgId, msgSize, 0, payload};
+  m_streams[streamId].messages.push_back (msg);
+  TrySend ();
+}
+
+bool
+mvdashUdpConnection::NextChunk (st_udpChunk &chunk)
+{
+  if (m_streams.empty ())
+    {
+      return false;
+    }
+  // Round robin over the streams, starting after the one served last
+  std::map<uint16_t, st_udpStream>::iterator it = m_streams.upper_bound (m_lastStream);
+  for (size_t n = 0; n < m_streams.size (); n++, it++)
+    {
+      if (it == m_streams.end ())
+        {
+          it = m_streams.begin ();
+        }
+      st_udpStream &stream = it->second;
+      if (!stream.retransmit.empty ())
+        {
+          chunk = stream.retransmit.front ();
+          stream.retransmit.pop_front ();
+          m_nRetransmissions++;
+          m_lastStream = it->first;
+          return true;
+        }
+      if (!stream.messages.empty ())
+        {
+          st_udpMessage &msg = stream.messages.front ();
+          chunk.streamId = it->first;
+          chunk.msgId = msg.msgId;
+          chunk.msgSize = msg.msgSize;
+          chunk.offset = msg.nextOffset;
+          chunk.length = std::min (MAX_PAYLOAD, msg.msgSize - msg.nextOffset);
+          chunk.payload = msg.payload;
+          msg.nextOffset += chunk.length;
+          if (msg.nextOffset >= msg.msgSize)
+            {
+              stream.messages.pop_front ();
+            }
+          m_lastStream = it->first;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+mvdashUdpConnection::TrySend (void)
+{
+  st_udpChunk chunk;
+  while (m_bytesInFlight + MAX_PAYLOAD <= m_cwnd && NextChunk (chunk))
+    {
+      SendChunk (chunk);
+    }
+}
+
+void
+mvdashUdpConnection::SendChunk (const st_udpChunk &chunk)
+{
+  mvdashUdpHeader header;
+  header.m_type = mvdashUdpHeader::DATA;
+  header.m_streamId = chunk.streamId;
+  header.m_packetNumber = m_nextPacketNumber++;
+  header.m_msgId = chunk.msgId;
+  header.m_msgSize = chunk.msgSize;
+  header.m_offset = chunk.offset;
+  header.m_length = chunk.length;
+
+  Ptr<Packet> packet = chunk.payload ? chunk.payload->Copy () : Create<Packet> (chunk.length);
+  packet->AddHeader (header);
+  m_socket->SendTo (packet, 0, m_peer);
+
+  st_sentChunk sent = {chunk, Simulator::Now ()};
+  m_inFlight[header.m_packetNumber] = sent;
+  m_bytesInFlight += chunk.length;
+  if (!m_rtoEvent.IsRunning ())
+    {
+      RestartTimer ();
+    }
+}
+
+void
+mvdashUdpConnection::SendAck (uint32_t packetNumber)
+{
+  mvdashUdpHeader header;
+  header.m_type = mvdashUdpHeader::ACK;
+  header.m_packetNumber = packetNumber;
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  m_socket->SendTo (packet, 0, m_peer);
+}
+
+void
+mvdashUdpConnection::Receive (Ptr<Packet> packet)
+{
+  mvdashUdpHeader header;
+  packet->RemoveHeader (header);
+  if (header.m_type == mvdashUdpHeader::ACK)
+    {
+      HandleAck (header.m_packetNumber);
+    }
+  else
+    {
+      SendAck (header.m_packetNumber);
+      HandleData (header, packet);
+    }
+}
+
+void
+mvdashUdpConnection::HandleAck (uint32_t packetNumber)
+{
+  std::map<uint32_t, st_sentChunk>::iterator it = m_inFlight.find (packetNumber);
+  if (it == m_inFlight.end ())
+    {
+      return;   // already declared lost
+    }
+
+  // RTT estimate as in RFC 6298
+  Time rtt = Simulator::Now () - it->second.sent;
+  if (m_srtt.IsZero ())
+    {
+      m_srtt = rtt;
+      m_rttVar = Seconds (rtt.GetSeconds () / 2);
+    }
+  else
+    {
+      double err = std::fabs (m_srtt.GetSeconds () - rtt.GetSeconds ());
+      m_rttVar = Seconds (0.75 * m_rttVar.GetSeconds () + 0.25 * err);
+      m_srtt = Seconds (0.875 * m_srtt.GetSeconds () + 0.125 * rtt.GetSeconds ());
+    }
+  m_rto = Max (Seconds (m_srtt.GetSeconds () + 4 * m_rttVar.GetSeconds ()), MilliSeconds (200));
+
+  uint32_t acked = it->second.chunk.length;
+  m_bytesInFlight -= acked;
+  m_inFlight.erase (it);
+
+  if (m_cwnd < m_ssthresh)
+    {
+      m_cwnd += acked;                                   // slow start
+    }
+  else
+    {
+      m_cwnd += std::max (1u, MAX_PAYLOAD * acked / m_cwnd);  // congestion avoidance
+    }
+
+  // Packet threshold loss detection
+  while (!m_inFlight.empty () && m_inFlight.begin ()->first + 3 <= packetNumber)
+    {
+      OnLoss (m_inFlight.begin ()->first);
+    }
+
+  RestartTimer ();
+  TrySend ();
+}
+
+void
+mvdashUdpConnection::OnLoss (uint32_t packetNumber)
+{
+  std::map<uint32_t, st_sentChunk>::iterator it = m_inFlight.find (packetNumber);
+  const st_udpChunk &chunk = it->second.chunk;
+  NS_LOG_LOGIC ("Lost pn " << packetNumber << " stream " << chunk.streamId << " msg " << chunk.msgId);
+
+  m_streams[chunk.streamId].retransmit.push_back (chunk);
+  m_bytesInFlight -= chunk.length;
+  if (packetNumber >= m_recoveryStart)
+    {
+      // One window reduction per round trip
+      m_ssthresh = std::max (m_cwnd / 2, 2 * MAX_PAYLOAD);
+      m_cwnd = m_ssthresh;
+      m_recoveryStart = m_nextPacketNumber;
+    }
+  m_inFlight.erase (it);
+}
+
+void
+mvdashUdpConnection::RetransmissionTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_inFlight.empty ())
+    {
+      return;
+    }
+  m_recoveryStart = 0;
+  while (!m_inFlight.empty ())
+    {
+      OnLoss (m_inFlight.begin ()->first);
+    }
+  m_cwnd = 2 * MAX_PAYLOAD;
+  m_rto = Min (Seconds (2 * m_rto.GetSeconds ()), Seconds (60));
+  RestartTimer ();
+  TrySend ();
+}
+
+void
+mvdashUdpConnection::RestartTimer (void)
+{
+  Simulator::Cancel (m_rtoEvent);
+  if (!m_inFlight.empty ())
+    {
+      m_rtoEvent = Simulator::Schedule (m_rto, &mvdashUdpConnection::RetransmissionTimeout, this);
+    }
+}
+
+void
+mvdashUdpConnection::HandleData (const mvdashUdpHeader &header, Ptr<Packet> packet)
+{
+  t_messageKey key (header.m_streamId, header.m_msgId);
+  if (m_rxCompleted.count (key))
+    {
+      return;   // a spurious retransmission
+    }
+  st_rxMessage &msg = m_rxMessages[key];
+  msg.msgSize = header.m_msgSize;
+  if (!msg.offsets.insert (header.m_offset).second)
+    {
+      return;
+    }
+  msg.received += header.m_length;
+  if (!m_dataCallback.IsNull ())
+    {
+      m_dataCallback (this, header.m_streamId, header.m_msgId, packet);
+    }
+
+  if (msg.received >= msg.msgSize)
+    {
+      uint32_t msgSize = msg.msgSize;
+      m_rxMessages.erase (key);
+      m_rxCompleted.insert (key);
+      if (!m_messageCallback.IsNull ())
+        {
+          m_messageCallback (this, header.m_streamId, header.m_msgId, msgSize,
+                             msgSize <= MAX_PAYLOAD ? packet : Ptr<Packet> ());
+        }
+    }
+}
+
+} // namespace ns3
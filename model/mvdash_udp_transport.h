@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MVDASH_UDP_TRANSPORT_H
+#define MVDASH_UDP_TRANSPORT_H
+
+#include "ns3/object.h"
+#include "ns3/header.h"
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include <deque>
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \brief Header of every mvdash UDP transport datagram.
+ *
+ * A DATA datagram carries bytes [offset, offset + length) of message msgId on
+ * stream streamId.  An ACK acknowledges the DATA datagram packetNumber.
+ */
+class mvdashUdpHeader : public Header
+{
+public:
+  enum PacketType { DATA = 0, ACK = 1 };
+
+  mvdashUdpHeader ();
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  uint8_t  m_type;
+  uint16_t m_streamId;
+  uint32_t m_packetNumber;
+  uint32_t m_msgId;
+  uint32_t m_msgSize;
+  uint32_t m_offset;
+  uint16_t m_length;
+};
+
+/**
+ * \brief One peer of the mvdash UDP transport: reliable messages on
+ * independent streams over a single UDP socket.
+ *
+ * Streams share one NewReno-style congestion window and are served round
+ * robin, so a loss only delays the stream it hit.  Every DATA datagram is
+ * acknowledged; a datagram is declared lost once three later ones are
+ * acknowledged, or on a retransmission timeout, and its bytes are resent on
+ * their own stream.  Message payload is delivered only for messages that fit
+ * in one datagram (e.g. requests); larger messages are counted, not stored.
+ */
+class mvdashUdpConnection : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  mvdashUdpConnection ();
+  virtual ~mvdashUdpConnection ();
+
+  /// Stream reserved for client requests; viewpoints use their index
+  static const uint16_t REQUEST_STREAM = 0xffff;
+  static const uint32_t MAX_PAYLOAD = 1400;
+
+  /**
+   * \param connection this connection
+   * \param streamId the stream of the message
+   * \param msgId the message id, unique in its stream
+   * \param msgSize the message size in bytes
+   * \param payload the message bytes for single-datagram messages, else 0
+   */
+  typedef Callback<void, Ptr<mvdashUdpConnection>, uint16_t, uint32_t, uint32_t, Ptr<Packet> > MessageCallback;
+  /// Called for every new DATA datagram, with its stream, message id and payload
+  typedef Callback<void, Ptr<mvdashUdpConnection>, uint16_t, uint32_t, Ptr<const Packet> > DataCallback;
+
+  void Setup (Ptr<Socket> socket, const Address &peer);
+  void SetMessageCallback (MessageCallback cb) { m_messageCallback = cb; }
+  void SetDataCallback (DataCallback cb) { m_dataCallback = cb; }
+
+  /**
+   * Queue a message on a stream.
+   * \param payload the bytes to deliver, only for msgSize <= MAX_PAYLOAD; 0 sends zeros
+   */
+  void SendMessage (uint16_t streamId, uint32_t msgId, uint32_t msgSize, Ptr<Packet> payload);
+  /**
+   * \brief Handle a datagram received from the peer
+   */
+  void Receive (Ptr<Packet> packet);
+  void Close (void);
+
+  const Address & GetPeer (void) const { return m_peer; }
+  uint64_t GetNRetransmissions (void) const { return m_nRetransmissions; }
+  uint32_t GetCongestionWindow (void) const { return m_cwnd; }
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct st_udpChunk
+  {
+    uint16_t streamId;
+    uint32_t msgId;
+    uint32_t msgSize;
+    uint32_t offset;
+    uint16_t length;
+    Ptr<Packet> payload;
+  };
+  struct st_udpMessage
+  {
+    uint32_t msgId;
+    uint32_t msgSize;
+    uint32_t nextOffset;
+    Ptr<Packet> payload;
+  };
+  struct st_udpStream
+  {
+    std::deque <st_udpChunk> retransmit;  //!< lost chunks, sent before new data
+    std::deque <st_udpMessage> messages;
+  };
+  struct st_sentChunk
+  {
+    st_udpChunk chunk;
+    Time sent;
+  };
+  struct st_rxMessage
+  {
+    uint32_t msgSize;
+    uint32_t received;
+    std::set <uint32_t> offsets;
+  };
+  typedef std::pair<uint16_t, uint32_t> t_messageKey;  //!< (stream, message id)
+
+  bool NextChunk (st_udpChunk &chunk);
+  void TrySend (void);
+  void SendChunk (const st_udpChunk &chunk);
+  void SendAck (uint32_t packetNumber);
+  void HandleAck (uint32_t packetNumber);
+  void HandleData (const mvdashUdpHeader &header, Ptr<Packet> packet);
+  void OnLoss (uint32_t packetNumber);
+  void RetransmissionTimeout (void);
+  void RestartTimer (void);
+
+  Ptr<Socket> m_socket;
+  Address     m_peer;
+  MessageCallback m_messageCallback;
+  DataCallback    m_dataCallback;
+
+  // Sender
+  std::map <uint16_t, st_udpStream> m_streams;
+  uint16_t    m_lastStream;                     //!< round robin position
+  std::map <uint32_t, st_sentChunk> m_inFlight;  //!< by packet number
+  uint32_t    m_nextPacketNumber;
+  uint32_t    m_bytesInFlight;
+  uint32_t    m_cwnd;
+  uint32_t    m_ssthresh;
+  uint32_t    m_recoveryStart;    //!< losses of packets below this number do not reduce the window again
+  Time        m_srtt;
+  Time        m_rttVar;
+  Time        m_rto;
+  EventId     m_rtoEvent;
+  uint64_t    m_nRetransmissions;
+
+  // Receiver
+  std::map <t_messageKey, st_rxMessage> m_rxMessages;
+  std::set <t_messageKey> m_rxCompleted;
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_UDP_TRANSPORT_H */
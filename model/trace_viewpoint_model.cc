@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/log.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "trace_viewpoint_model.h"
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Trace_Viewpoint_Model");
+
+NS_OBJECT_ENSURE_REGISTERED (Trace_Viewpoint_Model);
+
+Trace_Viewpoint_Model::Trace_Viewpoint_Model(const std::string viewpoint_file)
+{
+    NS_LOG_FUNCTION (this << viewpoint_file);
+    m_nViews = 0;
+    std::ifstream vpfile (viewpoint_file.c_str ());
+    if (!vpfile) {
+        NS_LOG_ERROR("Viewpoint trace " << viewpoint_file << " open error");
+        return;
+    }
+    std::string line;
+    while (std::getline(vpfile, line)) {
+        std::istringstream buffer(line);
+        int64_t tIndex;
+        int32_t viewpoint;
+        if (!(buffer >> tIndex >> viewpoint) || tIndex < 0 || viewpoint < 0)
+            continue;
+        if ((int64_t) m_trace.size() <= tIndex)
+            m_trace.resize(tIndex + 1, -1);
+        m_trace[tIndex] = viewpoint;
+        m_nViews = std::max(m_nViews, viewpoint + 1);
+    }
+}
+
+int32_t Trace_Viewpoint_Model::TraceViewpoint(const int64_t t_index, int32_t current) {
+    if (t_index >= (int64_t) m_trace.size() || m_trace[t_index] < 0)
+        return current;
+    if (m_trace[t_index] >= m_nViews) {
+        NS_LOG_ERROR("Viewpoint " << m_trace[t_index] << " of time index " << t_index << " out of range");
+        return current;
+    }
+    return m_trace[t_index];
+}
+
+int32_t Trace_Viewpoint_Model::InitViewpoint() {
+    return TraceViewpoint(0, 0);
+}
+
+int32_t Trace_Viewpoint_Model::GetNextViewpoint(const int64_t t_index) {
+    return TraceViewpoint(t_index, CurrentViewpoint());
+}
+} // namespace ns3
@@ -0,0 +1,50 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TRACE_VIEWPOINT_MODEL_H
+#define TRACE_VIEWPOINT_MODEL_H
+
+#include "multiview-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief Replays recorded viewpoints instead of drawing them.
+ *
+ * Each line of the file is "<time index> <viewpoint> ...", so the playback
+ * log of a client (tIndex, vpoint, ...) replays its viewpoint sequence; lines
+ * that do not start with a number, such as the log header, are skipped.
+ * Time indexes past the end of the trace keep the last viewpoint.
+ */
+class Trace_Viewpoint_Model : public MultiView_Model
+{
+public:
+    Trace_Viewpoint_Model(const std::string viewpoint_file);
+    int64_t AssignStreams(int64_t stream) { return 0; }
+    int32_t GetNTraceEntries() const { return m_trace.size(); }
+
+protected:
+    int32_t InitViewpoint();
+    int32_t GetNextViewpoint(const int64_t t_index);
+
+private:
+    int32_t TraceViewpoint(const int64_t t_index, int32_t current);
+    std::vector <int32_t> m_trace;      //!< viewpoint by time index, -1 where the trace has none
+};
+} // namespace ns3
+
+#endif /* TRACE_VIEWPOINT_MODEL_H */
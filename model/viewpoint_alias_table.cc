@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/log.h"
+#include "viewpoint_alias_table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Viewpoint_Alias_Table");
+
+// Vose's variant of the alias method, one row at a time
+void Viewpoint_Alias_Table::Build (const std::vector < std::vector<double> > &probMatrix)
+{
+    m_nRows = probMatrix.size();
+    m_nViews = m_nRows ? probMatrix[0].size() : 0;
+    m_prob.assign(m_nRows * m_nViews, 1.0);
+    m_alias.assign(m_nRows * m_nViews, 0);
+
+    std::vector <double> scaled(m_nViews);
+    std::vector <int32_t> small, large;
+    small.reserve(m_nViews);
+    large.reserve(m_nViews);
+
+    for (int32_t row = 0; row < m_nRows; row++) {
+        int32_t base = row * m_nViews;
+        double sum = 0.0;
+        for (int32_t vp = 0; vp < m_nViews; vp++)
+            sum += probMatrix[row].at(vp);
+        if (sum <= 0.0) {
+            NS_LOG_ERROR("Transition probabilities of viewpoint " << row << " sum to zero");
+            for (int32_t vp = 0; vp < m_nViews; vp++)
+                m_alias[base + vp] = vp;
+            continue;
+        }
+
+        small.clear();
+        large.clear();
+        for (int32_t vp = 0; vp < m_nViews; vp++) {
+            scaled[vp] = probMatrix[row][vp] * m_nViews / sum;
+            if (scaled[vp] < 1.0)
+                small.push_back(vp);
+            else
+                large.push_back(vp);
+        }
+
+        while (!small.empty() && !large.empty()) {
+            int32_t s = small.back();
+            int32_t l = large.back();
+            small.pop_back();
+            m_prob[base + s] = scaled[s];
+            m_alias[base + s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Leftovers are 1.0 up to rounding errors
+        for (int32_t vp : large) {
+            m_prob[base + vp] = 1.0;
+            m_alias[base + vp] = vp;
+        }
+        for (int32_t vp : small) {
+            m_prob[base + vp] = 1.0;
+            m_alias[base + vp] = vp;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VIEWPOINT_ALIAS_TABLE_H
+#define VIEWPOINT_ALIAS_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Walker alias tables for drawing the next viewpoint in O(1).
+ *
+ * One table per source viewpoint (row) is built from a row of transition
+ * probabilities.  All rows are stored in two flat row-major arrays, so a draw
+ * reads one probability and one alias of a single row.
+ */
+class Viewpoint_Alias_Table
+{
+public:
+  Viewpoint_Alias_Table () : m_nRows (0), m_nViews (0) {}
+
+  /**
+   * \param probMatrix nRows x nViews transition probabilities (not cumulative);
+   *        each row is normalized to sum to one
+   */
+  void Build (const std::vector < std::vector<double> > &probMatrix);
+
+  /**
+   * \param row the source viewpoint
+   * \param u uniform random value in [0, 1)
+   * \returns the destination viewpoint
+   */
+  int32_t Sample (int32_t row, double u) const
+  {
+    double x = u * m_nViews;
+    int32_t col = (int32_t) x;
+    if (col >= m_nViews)
+      col = m_nViews - 1;
+    int32_t i = row * m_nViews + col;
+    return (x - col < m_prob[i]) ? col : m_alias[i];
+  }
+
+  int32_t GetNRows (void) const { return m_nRows; }
+  int32_t GetNViews (void) const { return m_nViews; }
+
+private:
+  int32_t m_nRows;
+  int32_t m_nViews;
+  std::vector <double> m_prob;      //!< probability of keeping the column, row-major
+  std::vector <int32_t> m_alias;    //!< column chosen otherwise, row-major
+};
+} // namespace ns3
+
+#endif /* VIEWPOINT_ALIAS_TABLE_H */
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "viewport_model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Viewport_Model");
+
+NS_OBJECT_ENSURE_REGISTERED (Viewport_Model);
+
+TypeId Viewport_Model::GetTypeId(void)
+{
+    static TypeId tid = TypeId ("ns3::Viewport_Model")
+      .SetParent<Object> ()
+      .SetGroupName("Applications")
+      .AddConstructor<Viewport_Model> ()
+      .AddAttribute ("FovWidth",
+                     "Horizontal field of view of the viewer, in degrees",
+                     DoubleValue (100.0),
+                     MakeDoubleAccessor (&Viewport_Model::m_fovWidth),
+                     MakeDoubleChecker<double> (0.0, 360.0))
+      .AddAttribute ("FovHeight",
+                     "Vertical field of view of the viewer, in degrees",
+                     DoubleValue (90.0),
+                     MakeDoubleAccessor (&Viewport_Model::m_fovHeight),
+                     MakeDoubleChecker<double> (0.0, 180.0))
+      .AddAttribute ("YawSpeed",
+                     "Standard deviation of the yaw change over one second, in degrees",
+                     DoubleValue (30.0),
+                     MakeDoubleAccessor (&Viewport_Model::m_yawSpeed),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("PitchSpeed",
+                     "Standard deviation of the pitch change over one second, in degrees",
+                     DoubleValue (10.0),
+                     MakeDoubleAccessor (&Viewport_Model::m_pitchSpeed),
+                     MakeDoubleChecker<double> (0.0))
+    ;
+    return tid;
+}
+
+Viewport_Model::Viewport_Model()
+    : m_fovWidth(100.0),
+      m_fovHeight(90.0),
+      m_yawSpeed(30.0),
+      m_pitchSpeed(10.0),
+      m_yaw(0.0),
+      m_pitch(0.0),
+      m_tIndex(0)
+{
+    m_pYawRNG = CreateObject<NormalRandomVariable>();
+    m_pYawRNG->SetAttribute ("Mean", DoubleValue(0.0));
+    m_pYawRNG->SetAttribute ("Variance", DoubleValue(1.0));
+    m_pPitchRNG = CreateObject<NormalRandomVariable>();
+    m_pPitchRNG->SetAttribute ("Mean", DoubleValue(0.0));
+    m_pPitchRNG->SetAttribute ("Variance", DoubleValue(1.0));
+}
+
+int64_t Viewport_Model::AssignStreams(int64_t stream)
+{
+    m_pYawRNG->SetStream(stream);
+    m_pPitchRNG->SetStream(stream + 1);
+    return 2;
+}
+
+void Viewport_Model::UpdateViewport(const int64_t t_index, const int64_t segmentDuration)
+{
+    // The steps of a random walk add up in variance
+    double scale = std::sqrt(segmentDuration / 1e6);
+    for (; m_tIndex < t_index; m_tIndex++) {
+        m_yaw = std::remainder(m_yaw + m_yawSpeed * scale * m_pYawRNG->GetValue(), 360.0);
+        m_pitch = std::max(-90.0, std::min(90.0, m_pitch + m_pitchSpeed * scale * m_pPitchRNG->GetValue()));
+    }
+}
+
+std::vector <bool> Viewport_Model::GetVisibleTiles(int32_t columns, int32_t rows, double margin) const
+{
+    std::vector <bool> visible(columns * rows, false);
+    double tileWidth = 360.0 / columns;
+    double tileHeight = 180.0 / rows;
+    double top = std::min(m_pitch + m_fovHeight / 2 + margin, 90.0);
+    double bottom = std::max(m_pitch - m_fovHeight / 2 - margin, -90.0);
+
+    for (int32_t row = 0; row < rows; row++) {
+        double rowTop = std::min(90.0 - row * tileHeight, top);
+        double rowBottom = std::max(90.0 - (row + 1) * tileHeight, bottom);
+        if (rowBottom >= rowTop)
+            continue;
+        // The viewport is wider on the picture towards the poles; take the
+        // latitude of the row nearest to a pole
+        double latitude = std::min(std::max(std::fabs(rowTop), std::fabs(rowBottom)), 89.0);
+        double halfWidth = (m_fovWidth / 2 + margin) / std::cos(latitude * M_PI / 180.0);
+        for (int32_t col = 0; col < columns; col++) {
+            double centre = -180.0 + (col + 0.5) * tileWidth;
+            double distance = std::fabs(std::remainder(centre - m_yaw, 360.0));
+            if (halfWidth >= 180.0 || distance < halfWidth + tileWidth / 2)
+                visible[row * columns + col] = true;
+        }
+    }
+    return visible;
+}
+
+} // namespace ns3
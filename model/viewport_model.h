@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VIEWPORT_MODEL_H
+#define VIEWPORT_MODEL_H
+
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * \brief Head orientation of the viewer inside a 360 degree viewpoint.
+ *
+ * The centre of the viewport takes one Gaussian random walk step per time
+ * index, in yaw (wrapping around) and in pitch (held within +-90 degrees).
+ * Tiles cover the equirectangular picture of a viewpoint, column 0 starting
+ * at yaw -180 and row 0 at pitch +90.  All viewpoints share the orientation.
+ */
+class Viewport_Model : public Object
+{
+public:
+    static TypeId GetTypeId(void);
+    Viewport_Model();
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * \brief Move the viewport to t_index, one step per time index passed
+     * \param segmentDuration microseconds of a time index
+     */
+    void UpdateViewport(const int64_t t_index, const int64_t segmentDuration);
+    double GetYaw() const { return m_yaw; }
+    double GetPitch() const { return m_pitch; }
+
+    /**
+     * \param margin degrees added on every side of the viewport, to cover
+     *        the head motion until the tiles are played
+     * \returns one flag per tile, row-major, true if the tile overlaps the viewport
+     */
+    std::vector <bool> GetVisibleTiles(int32_t columns, int32_t rows, double margin) const;
+
+private:
+    Ptr<NormalRandomVariable> m_pYawRNG;
+    Ptr<NormalRandomVariable> m_pPitchRNG;
+    double m_fovWidth;          //!< degrees
+    double m_fovHeight;
+    double m_yawSpeed;          //!< standard deviation of the yaw change over one second, degrees
+    double m_pitchSpeed;
+    double m_yaw;
+    double m_pitch;
+    int64_t m_tIndex;
+};
+} // namespace ns3
+
+#endif /* VIEWPORT_MODEL_H */
@@ -1,49 +1,2541 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
-// Include a header file from your module to test.
-#include "ns3/etri_mvdash.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mvdash-helper.h"
+#include "ns3/mvdash-campaign-helper.h"
+#include "ns3/mvdash-qoe-monitor.h"
+#include "ns3/mvdash-event-recorder.h"
+#include "ns3/mvdash-bandwidth-trace.h"
+#include "ns3/mvdash-topology-helper.h"
+#include "ns3/mvdash_client.h"
+#include "ns3/viewpoint_alias_table.h"
+#include "ns3/mvdash_segment_cache.h"
+#include "ns3/mvdash_cache_server.h"
+#include "ns3/mvdash_udp_transport.h"
+#include "ns3/mvdash_fluid_network.h"
+#include "ns3/mvdash_manifest.h"
+#include "ns3/trace_viewpoint_model.h"
+#include "ns3/mvdash-trace-player.h"
+#include "ns3/mvdash-session.h"
+#include "ns3/viewport_model.h"
+#include "ns3/mvdash_tile_allocator.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <set>
+#include <sstream>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class Etri_mvdashTestCase1 : public TestCase
+/*
+ * Heap allocation counter of the cost tests.  The replacement operator new
+ * passes every allocation of the test runner to malloc, and counts only
+ * inside an mvdashAllocationScope.  The cost tests open one around
+ * Simulator::Run, so neither the setup of their scenario nor the other
+ * tests are counted.
+ */
+static bool     g_countAllocations = false;
+static uint64_t g_allocations = 0;
+
+void *
+operator new (std::size_t size)
+{
+  if (g_countAllocations)
+    {
+      g_allocations++;
+    }
+  void *p = std::malloc (size ? size : 1);
+  if (!p)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete (void *p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * \brief Counts the heap allocations made while it is alive.
+ */
+class mvdashAllocationScope
+{
+public:
+  mvdashAllocationScope ()
+  {
+    g_allocations = 0;
+    g_countAllocations = true;
+  }
+  ~mvdashAllocationScope ()
+  {
+    g_countAllocations = false;
+  }
+  uint64_t GetCount (void) const
+  {
+    return g_allocations;
+  }
+};
+
+/**
+ * \brief Cost budgets of a canonical scenario.
+ *
+ * The counters are deterministic for a given scenario, so exceeding a budget
+ * means a change made the data path more expensive.  Events and packets are
+ * the heap objects made for every byte delivered, and the allocations every
+ * heap call of the run; the state bytes are those kept for every segment.
+ * Lower a budget when a change makes a path cheaper.
+ */
+struct st_costBudget
+{
+  double eventsPerMegabyte;       //!< executed simulator events per delivered MB
+  double packetsPerMegabyte;      //!< packets created at any layer, copies aside, per delivered MB
+  double allocationsPerSegment;   //!< heap allocations of the run per delivered segment
+  double stateBytesPerSegment;    //!< bytes of client session records per delivered segment
+};
+
+/**
+ * \brief Runs the mvdash-v2 dumbbell with a short synthetic manifest until
+ *        every client has played the whole session, and checks the cost
+ *        counters against a budget.
+ */
+class mvdashCostTestCase : public TestCase
+{
+public:
+  /**
+   * \param nConnections TCP connections per client, spread least-loaded when more than one
+   */
+  mvdashCostTestCase (std::string name, int nClients, st_costBudget budget, uint32_t nConnections = 1);
+  virtual ~mvdashCostTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void WriteContent (void);
+
+  void Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
+
+  int           m_nClients;
+  uint32_t      m_nConnections;
+  st_costBudget m_budget;
+  std::string   m_mvInfo;
+  std::string   m_vpInfo;
+
+  uint64_t      m_bytesDelivered;
+  uint64_t      m_segments;
+};
+
+// Manifest of the canonical scenarios
+static const int     g_nViewpoints = 5;
+static const int     g_nSegments = 10;
+static const int64_t g_segmentSizes[] = {100000, 400000};
+
+mvdashCostTestCase::mvdashCostTestCase (std::string name, int nClients, st_costBudget budget, uint32_t nConnections)
+  : TestCase (name),
+    m_nClients (nClients),
+    m_nConnections (nConnections),
+    m_budget (budget),
+    m_bytesDelivered (0),
+    m_segments (0)
+{
+}
+
+mvdashCostTestCase::~mvdashCostTestCase ()
+{
+}
+
+void
+mvdashCostTestCase::WriteContent (void)
+{
+  m_mvInfo = CreateTempDirFilename ("cost_mv.csv");
+  m_vpInfo = CreateTempDirFilename ("cost_vp.csv");
+
+  std::ofstream mv (m_mvInfo.c_str ());
+  mv << g_nViewpoints << " " << g_nSegments << " 2000000";
+  for (int vp = 0; vp < g_nViewpoints; vp++)
+    {
+      mv << " 2";
+    }
+  mv << "\n";
+  for (int t = 0; t < g_nSegments; t++)
+    {
+      for (int vp = 0; vp < g_nViewpoints; vp++)
+        {
+          mv << (vp ? "\t" : "") << g_segmentSizes[0] << "\t" << g_segmentSizes[1];
+        }
+      mv << "\n";
+    }
+  mv.close ();
+
+  std::ofstream vp (m_vpInfo.c_str ());
+  vp << "0 " << g_nViewpoints << " 2 10 2\n";
+  for (int i = 0; i < 2 * g_nViewpoints; i++)
+    {
+      for (int j = 0; j < g_nViewpoints; j++)
+        {
+          vp << (j ? " " : "") << (i < g_nViewpoints ? 1.0 / g_nViewpoints : 2.0);
+        }
+      vp << "\n";
+    }
+  vp.close ();
+}
+
+void
+mvdashCostTestCase::Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo)
+{
+  if (ev == segev_endReceiving)
+    {
+      m_segments++;
+      m_bytesDelivered += sinfo.segmentSize;
+    }
+}
+
+void
+mvdashCostTestCase::DoRun (void)
+{
+  WriteContent ();
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (600000));
+
+  mvdashTopologyHelper topology;
+  topology.SetBottleneck ("5Mbps", "40ms");
+  topology.Build (m_nClients);
+  NodeContainer serverNodes (topology.GetServer ());
+  NodeContainer clientNodes = topology.GetClients ();
+
+  uint16_t serverPort = 9;
+  mvdashServerHelper serverHelper (InetSocketAddress (Ipv4Address::GetAny (), serverPort), 0);
+  ApplicationContainer serverApp = serverHelper.Install (serverNodes);
+  serverApp.Start (Seconds (0.0));
+
+  mvdashClientHelper clientHelper (InetSocketAddress (topology.GetServerAddress (), serverPort), 0);
+  clientHelper.SetAttribute ("VPInfo", StringValue (m_vpInfo));
+  clientHelper.SetAttribute ("MVInfo", StringValue (m_mvInfo));
+  clientHelper.SetAttribute ("EnableLogs", BooleanValue (false));
+  clientHelper.SetAttribute ("Connections", UintegerValue (m_nConnections));
+  clientHelper.SetAttribute ("ConnectionPolicy", StringValue (m_nConnections > 1 ? "least-loaded" : "viewpoint"));
+  ApplicationContainer clientApps = clientHelper.Install (clientNodes);
+  for (int i = 0; i < m_nClients; i++)
+    {
+      clientApps.Get (i)->SetStartTime (Seconds (0.1 + i * 0.45));
+      clientApps.Get (i)->TraceConnectWithoutContext ("SegmentTrace", MakeCallback (&mvdashCostTestCase::Segment, this));
+    }
+  clientApps.Stop (Seconds (300.0));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Stop (Seconds (300.0));
+
+  // Every new packet takes the next uid, a copy keeps it: the uids taken
+  // by the run count the packets it created
+  uint64_t firstUid = Create<Packet> ()->GetUid ();
+  uint64_t allocations;
+  {
+    mvdashAllocationScope scope;
+    Simulator::Run ();
+    allocations = scope.GetCount ();
+  }
+  uint64_t packets = Create<Packet> ()->GetUid () - firstUid - 1;
+
+  uint64_t events = Simulator::GetEventCount ();
+  uint64_t stateBytes = 0;
+  for (int i = 0; i < m_nClients; i++)
+    {
+      Ptr<mvdashClient> client = DynamicCast<mvdashClient> (clientApps.Get (i));
+      stateBytes += client->GetStateBytes ();
+    }
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_segments, (uint64_t) (m_nClients * g_nViewpoints * g_nSegments),
+                         "Not every segment of the session was delivered");
+  NS_TEST_ASSERT_MSG_GT (packets, m_bytesDelivered / 1446, "Fewer packets created than the data needs");
+  NS_TEST_ASSERT_MSG_GT (allocations, packets, "The replacement operator new did not count the run");
+
+  double megabytes = m_bytesDelivered / 1e6;
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (events / megabytes, m_budget.eventsPerMegabyte,
+                               "Scheduled events per delivered MB exceed the budget");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (packets / megabytes, m_budget.packetsPerMegabyte,
+                               "Packets created per delivered MB exceed the budget");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ ((double) allocations / m_segments, m_budget.allocationsPerSegment,
+                               "Heap allocations per segment exceed the budget");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ ((double) stateBytes / m_segments, m_budget.stateBytesPerSegment,
+                               "Client state bytes per segment exceed the budget");
+}
+
+/**
+ * \brief Checks the online statistics used by the campaign helper.
+ */
+class mvdashRunningStatTestCase : public TestCase
+{
+public:
+  mvdashRunningStatTestCase ();
+  virtual ~mvdashRunningStatTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashRunningStatTestCase::mvdashRunningStatTestCase ()
+  : TestCase ("Welford mean/variance and Student-t confidence interval")
+{
+}
+
+mvdashRunningStatTestCase::~mvdashRunningStatTestCase ()
+{
+}
+
+void
+mvdashRunningStatTestCase::DoRun (void)
+{
+  mvdashRunningStat stat;
+  const double values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+  for (double v : values)
+    {
+      stat.Add (v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (stat.GetCount (), 8u, "Wrong sample count");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stat.GetMean (), 5.0, 1e-12, "Wrong mean");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stat.GetVariance (), 32.0 / 7, 1e-12, "Wrong sample variance");
+  // t(0.975, 7) = 2.364624
+  NS_TEST_ASSERT_MSG_EQ_TOL (stat.GetHalfWidth (0.95), 2.364624 * std::sqrt (32.0 / 7 / 8), 1e-3,
+                            "Wrong confidence interval half width");
+}
+
+// Sweeping u over [0, 1) in even steps must reproduce every row of the
+// transition matrix, including the zero entries.
+//
+class mvdashAliasTableTestCase : public TestCase
+{
+public:
+  mvdashAliasTableTestCase ();
+  virtual ~mvdashAliasTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashAliasTableTestCase::mvdashAliasTableTestCase ()
+  : TestCase ("Alias table reproduces the transition probabilities")
+{
+}
+
+mvdashAliasTableTestCase::~mvdashAliasTableTestCase ()
+{
+}
+
+void
+mvdashAliasTableTestCase::DoRun (void)
+{
+  std::vector < std::vector<double> > matrix = {{0.4, 0.2, 0.2, 0.1, 0.1},
+                                                {0.0, 0.5, 0.0, 0.5, 0.0},
+                                                {0.0, 0.0, 0.0, 0.0, 1.0},
+                                                {2.0, 1.0, 1.0, 0.0, 0.0}};
+  Viewpoint_Alias_Table table;
+  table.Build (matrix);
+  NS_TEST_ASSERT_MSG_EQ (table.GetNRows (), 4, "Wrong number of rows");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNViews (), 5, "Wrong number of viewpoints");
+
+  const int nSteps = 100000;
+  for (int32_t row = 0; row < table.GetNRows (); row++)
+    {
+      double sum = 0.0;
+      for (double p : matrix[row])
+        {
+          sum += p;
+        }
+      std::vector<int> hits (table.GetNViews (), 0);
+      for (int step = 0; step < nSteps; step++)
+        {
+          hits[table.Sample (row, (step + 0.5) / nSteps)]++;
+        }
+      for (int32_t vp = 0; vp < table.GetNViews (); vp++)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL ((double) hits[vp] / nSteps, matrix[row][vp] / sum, 1e-4,
+                                     "Wrong probability of " << row << " -> " << vp);
+        }
+    }
+}
+
+// LRU evicts the least recently used segment, LFU the least used one, and
+// neither keeps more bytes than its capacity.
+//
+class mvdashSegmentCacheTestCase : public TestCase
+{
+public:
+  mvdashSegmentCacheTestCase ();
+  virtual ~mvdashSegmentCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashSegmentCacheTestCase::mvdashSegmentCacheTestCase ()
+  : TestCase ("Segment cache LRU and LFU replacement")
+{
+}
+
+mvdashSegmentCacheTestCase::~mvdashSegmentCacheTestCase ()
+{
+}
+
+void
+mvdashSegmentCacheTestCase::DoRun (void)
+{
+  uint64_t a = mvdashSegmentCache::MakeKey (0, 1, 0);
+  uint64_t b = mvdashSegmentCache::MakeKey (1, 1, 0);
+  uint64_t c = mvdashSegmentCache::MakeKey (0, 1, 1);
+  NS_TEST_ASSERT_MSG_NE (a, b, "Keys of different viewpoints collide");
+  NS_TEST_ASSERT_MSG_NE (a, c, "Keys of different qualities collide");
+
+  // a is used three times, b once more recently than a
+  mvdashSegmentCache lru, lfu;
+  lfu.SetPolicy (mvdashSegmentCache::LFU);
+  mvdashSegmentCache *caches[] = {&lru, &lfu};
+  for (mvdashSegmentCache *cache : caches)
+    {
+      cache->SetCapacity (250);
+      cache->Insert (a, 100);
+      cache->Insert (b, 100);
+      cache->Lookup (a);
+      cache->Lookup (a);
+      cache->Lookup (b);
+      cache->Insert (c, 100);
+      NS_TEST_ASSERT_MSG_EQ (cache->GetNEntries (), 2u, "Wrong number of entries");
+      NS_TEST_ASSERT_MSG_EQ (cache->GetUsedBytes (), 200u, "Wrong number of cached bytes");
+      NS_TEST_ASSERT_MSG_EQ (cache->GetNEvictions (), 1u, "Wrong number of evictions");
+      cache->Insert (mvdashSegmentCache::MakeKey (2, 2, 2), 300);
+      NS_TEST_ASSERT_MSG_EQ (cache->GetNEntries (), 2u, "A segment larger than the cache was inserted");
+    }
+  NS_TEST_ASSERT_MSG_EQ (lru.Lookup (a), false, "LRU kept the least recently used segment");
+  NS_TEST_ASSERT_MSG_EQ (lru.Lookup (b), true, "LRU evicted a recently used segment");
+  NS_TEST_ASSERT_MSG_EQ (lfu.Lookup (a), true, "LFU evicted the most used segment");
+  NS_TEST_ASSERT_MSG_EQ (lfu.Lookup (b), false, "LFU kept the less used segment");
+}
+
+// Two clients fetch the same session through an mvdashCacheServer, the
+// second one after the first has closed its connection: the first one misses
+// every segment, the second one hits every segment.
+//
+class mvdashCacheServerTestCase : public TestCase
+{
+public:
+  mvdashCacheServerTestCase ();
+  virtual ~mvdashCacheServerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashCacheServerTestCase::mvdashCacheServerTestCase ()
+  : TestCase ("Cache server hits, misses and a late client")
+{
+}
+
+mvdashCacheServerTestCase::~mvdashCacheServerTestCase ()
+{
+}
+
+void
+mvdashCacheServerTestCase::DoRun (void)
+{
+  // One rate per viewpoint, so both clients ask for the same segments
+  std::string mvFile = CreateTempDirFilename ("cache_mv.csv");
+  std::string vpFile = CreateTempDirFilename ("cache_vp.csv");
+  std::ofstream mv (mvFile.c_str ());
+  mv << "2 4 1000000 1 1\n";
+  for (int t = 0; t < 4; t++)
+    {
+      mv << "50000\t50000\n";
+    }
+  mv.close ();
+  std::ofstream vp (vpFile.c_str ());
+  vp << "tIndex\tvpoint\n0\t0\n";
+  vp.close ();
+
+  // origin -- cache -- client0, client1
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  NodeContainer nodes;
+  nodes.Create (4);
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("20Mbps"));
+  link.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer originInterfaces = address.Assign (link.Install (nodes.Get (0), nodes.Get (1)));
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer cacheInterfaces = address.Assign (link.Install (nodes.Get (1), nodes.Get (2)));
+  address.SetBase ("10.1.3.0", "255.255.255.0");
+  address.Assign (link.Install (nodes.Get (1), nodes.Get (3)));
+
+  mvdashServerHelper serverHelper (InetSocketAddress (Ipv4Address::GetAny (), 9), 0);
+  ApplicationContainer serverApp = serverHelper.Install (nodes.Get (0));
+  serverApp.Start (Seconds (0.0));
+
+  mvdashCacheServerHelper cacheHelper (InetSocketAddress (Ipv4Address::GetAny (), 9),
+                                       InetSocketAddress (originInterfaces.GetAddress (0), 9));
+  ApplicationContainer cacheApp = cacheHelper.Install (nodes.Get (1));
+  cacheApp.Start (Seconds (0.0));
+
+  mvdashClientHelper clientHelper (InetSocketAddress (cacheInterfaces.GetAddress (0), 9), 0);
+  clientHelper.SetAttribute ("MVInfo", StringValue (mvFile));
+  clientHelper.SetAttribute ("VPInfo", StringValue (vpFile));
+  clientHelper.SetAttribute ("VPModel", StringValue ("trace"));
+  clientHelper.SetAttribute ("EnableLogs", BooleanValue (false));
+  ApplicationContainer first = clientHelper.Install (nodes.Get (2));
+  first.Start (Seconds (0.1));
+  first.Stop (Seconds (10));
+  ApplicationContainer second = clientHelper.Install (nodes.Get (3));
+  second.Start (Seconds (12));
+  second.Stop (Seconds (22));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Stop (Seconds (23));
+  Simulator::Run ();
+
+  Ptr<mvdashCacheServer> cache = DynamicCast<mvdashCacheServer> (cacheApp.Get (0));
+  Ptr<mvdashClient> late = DynamicCast<mvdashClient> (second.Get (0));
+  NS_TEST_EXPECT_MSG_EQ (DynamicCast<mvdashClient> (first.Get (0))->GetPlaybackData ().playbackIndex.size (), 4u,
+                         "The first client did not play the session");
+  NS_TEST_EXPECT_MSG_EQ (late->GetPlaybackData ().playbackIndex.size (), 4u,
+                         "The client that connected after the first one left was not served");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetNMisses (), 8u, "The first client did not miss every segment");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetNHits (), 8u, "The second client did not hit every segment");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Checks that the UDP transport delivers every message of several
+ * streams across a lossy link.
+ */
+class mvdashUdpTransportTestCase : public TestCase
+{
+public:
+  mvdashUdpTransportTestCase ();
+  virtual ~mvdashUdpTransportTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Receive (Ptr<Socket> socket);
+  void Message (Ptr<mvdashUdpConnection> connection, uint16_t streamId, uint32_t msgId,
+                uint32_t msgSize, Ptr<Packet> payload);
+
+  Ptr<Socket> m_sockets[2];
+  Ptr<mvdashUdpConnection> m_sender;
+  Ptr<mvdashUdpConnection> m_receiver;
+  uint32_t m_nMessages;
+  uint64_t m_bytes;
+};
+
+mvdashUdpTransportTestCase::mvdashUdpTransportTestCase ()
+  : TestCase ("UDP transport delivers every stream under loss"),
+    m_nMessages (0),
+    m_bytes (0)
+{
+}
+
+mvdashUdpTransportTestCase::~mvdashUdpTransportTestCase ()
+{
+}
+
+void
+mvdashUdpTransportTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      (socket == m_sockets[0] ? m_sender : m_receiver)->Receive (packet);
+    }
+}
+
+void
+mvdashUdpTransportTestCase::Message (Ptr<mvdashUdpConnection> connection, uint16_t streamId, uint32_t msgId,
+                                     uint32_t msgSize, Ptr<Packet> payload)
+{
+  m_nMessages++;
+  m_bytes += msgSize;
+}
+
+void
+mvdashUdpTransportTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  link.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  NetDeviceContainer devices = link.Install (nodes);
+  Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+  em->SetAttribute ("ErrorRate", DoubleValue (0.05));
+  em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+  devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  for (int i = 0; i < 2; i++)
+    {
+      m_sockets[i] = Socket::CreateSocket (nodes.Get (i), UdpSocketFactory::GetTypeId ());
+      m_sockets[i]->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+      m_sockets[i]->SetRecvCallback (MakeCallback (&mvdashUdpTransportTestCase::Receive, this));
+    }
+  m_sender = CreateObject<mvdashUdpConnection> ();
+  m_sender->Setup (m_sockets[0], InetSocketAddress (interfaces.GetAddress (1), 9));
+  m_receiver = CreateObject<mvdashUdpConnection> ();
+  m_receiver->Setup (m_sockets[1], InetSocketAddress (interfaces.GetAddress (0), 9));
+  m_receiver->SetMessageCallback (MakeCallback (&mvdashUdpTransportTestCase::Message, this));
+
+  for (uint16_t stream = 0; stream < 3; stream++)
+    {
+      m_sender->SendMessage (stream, 0, 200000, 0);
+    }
+  Simulator::Stop (Seconds (30.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nMessages, 3, "A message was not delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_bytes, 600000, "Messages were delivered with a wrong size");
+  NS_TEST_ASSERT_MSG_GT (m_sender->GetNRetransmissions (), 0, "Nothing was retransmitted on a lossy link");
+
+  m_sender->Dispose ();
+  m_receiver->Dispose ();
+  m_sockets[0] = m_sockets[1] = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Checks that a looped, time-scaled rate trace and a mahimahi trace
+ * produce the expected rate changes.
+ */
+class mvdashBandwidthTraceTestCase : public TestCase
+{
+public:
+  mvdashBandwidthTraceTestCase ();
+  virtual ~mvdashBandwidthTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashBandwidthTraceTestCase::mvdashBandwidthTraceTestCase ()
+  : TestCase ("Bandwidth trace replay, looped and mahimahi")
+{
+}
+
+mvdashBandwidthTraceTestCase::~mvdashBandwidthTraceTestCase ()
+{
+}
+
+void
+mvdashBandwidthTraceTestCase::DoRun (void)
+{
+  std::string rateFile = CreateTempDirFilename ("bw_rate.csv");
+  std::ofstream rate (rateFile.c_str ());
+  rate << "0 1000000\n100000 2000000\n200000 3000000\n";
+  rate.close ();
+  std::string mahimahiFile = CreateTempDirFilename ("bw_mahimahi.csv");
+  std::ofstream mahimahi (mahimahiFile.c_str ());
+  mahimahi << "1\n2\n3\n250\n";
+  mahimahi.close ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper link;
+  NetDeviceContainer devices = link.Install (nodes);
+
+  // A 300 ms trace, the last rate held 100 ms as the others, played at
+  // double speed restarts every 150 ms: changes every 50 ms up to 950 ms
+  Ptr<mvdashBandwidthTrace> looped = CreateObject<mvdashBandwidthTrace> ();
+  looped->SetAttribute ("Loop", BooleanValue (true));
+  looped->SetAttribute ("TimeScale", DoubleValue (0.5));
+  looped->SetAttribute ("StopTime", TimeValue (MilliSeconds (990)));
+  NS_TEST_ASSERT_MSG_EQ (looped->Install (rateFile, devices.Get (0)), true, "Rate trace not read");
+
+  // 100 ms windows of 3, 0 and 1 opportunities
+  Ptr<mvdashBandwidthTrace> windows = CreateObject<mvdashBandwidthTrace> ();
+  windows->SetAttribute ("Format", StringValue ("mahimahi"));
+  NS_TEST_ASSERT_MSG_EQ (windows->Install (mahimahiFile, devices.Get (1)), true, "Mahimahi trace not read");
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (looped->GetNChanges (), 20u, "Wrong number of looped rate changes");
+  DataRateValue last;
+  devices.Get (0)->GetAttribute ("DataRate", last);
+  NS_TEST_ASSERT_MSG_EQ (last.Get ().GetBitRate (), 2000000u, "Wrong rate at the end of the looped trace");
+  NS_TEST_ASSERT_MSG_EQ (windows->GetNChanges (), 3u, "Wrong number of mahimahi windows");
+  devices.Get (1)->GetAttribute ("DataRate", last);
+  NS_TEST_ASSERT_MSG_EQ (last.Get ().GetBitRate (), 120000u, "An empty mahimahi window did not keep one opportunity");
+
+  looped->Dispose ();
+  windows->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Checks that every client of the topology helper draws its own
+ * access link and replays its trace.
+ */
+class mvdashAccessLinkTestCase : public TestCase
+{
+public:
+  mvdashAccessLinkTestCase ();
+  virtual ~mvdashAccessLinkTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashAccessLinkTestCase::mvdashAccessLinkTestCase ()
+  : TestCase ("Heterogeneous access links")
+{
+}
+
+mvdashAccessLinkTestCase::~mvdashAccessLinkTestCase ()
+{
+}
+
+void
+mvdashAccessLinkTestCase::DoRun (void)
+{
+  std::string traceFile = CreateTempDirFilename ("bw_access.csv");
+  std::ofstream trace (traceFile.c_str ());
+  trace << "0 1000000\n500000 500000\n";
+  trace.close ();
+
+  mvdashTopologyHelper topology;
+  topology.AddAccessTrace (traceFile);
+  Ptr<UniformRandomVariable> delay = CreateObject<UniformRandomVariable> ();
+  delay->SetAttribute ("Min", DoubleValue (5));
+  delay->SetAttribute ("Max", DoubleValue (200));
+  topology.SetAccessDelay (delay);
+  topology.AssignStreams (1);
+  topology.Build (20);
+
+  NS_TEST_ASSERT_MSG_EQ (topology.GetClients ().GetN (), 20u, "Wrong number of clients");
+  Time minDelay = topology.GetAccessLink (0).delay;
+  Time maxDelay = minDelay;
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      const st_mvdashAccessLink &link = topology.GetAccessLink (i);
+      NS_TEST_ASSERT_MSG_EQ ((link.replay != 0), true, "Access link without its trace");
+      NS_TEST_ASSERT_MSG_EQ ((link.delay >= MilliSeconds (5) && link.delay <= MilliSeconds (200)), true,
+                             "Access delay out of its distribution");
+      minDelay = std::min (minDelay, link.delay);
+      maxDelay = std::max (maxDelay, link.delay);
+    }
+  NS_TEST_ASSERT_MSG_EQ ((minDelay < maxDelay), true, "Every client drew the same delay");
+
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (topology.GetAccessLink (19).replay->GetNChanges (), 2u, "Access trace not replayed");
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Checks that CSMA access puts the clients on shared LANs with one
+ * gateway each and distinct addresses, and that a session runs across them
+ * on the static routes, starting at its jittered time.
+ */
+class mvdashCsmaAccessTestCase : public TestCase
+{
+public:
+  mvdashCsmaAccessTestCase ();
+  virtual ~mvdashCsmaAccessTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashCsmaAccessTestCase::mvdashCsmaAccessTestCase ()
+  : TestCase ("Bulk CSMA access with static routes")
+{
+}
+
+mvdashCsmaAccessTestCase::~mvdashCsmaAccessTestCase ()
+{
+}
+
+void
+mvdashCsmaAccessTestCase::DoRun (void)
+{
+  mvdashTopologyHelper topology;
+  topology.SetAccessType ("csma", 4);
+  topology.SetStaticRouting (true);
+  topology.Build (10);
+
+  NS_TEST_ASSERT_MSG_EQ (topology.GetClients ().GetN (), 10u, "Wrong number of clients");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      const st_mvdashAccessLink &link = topology.GetAccessLink (i);
+      const st_mvdashAccessLink &first = topology.GetAccessLink (i - i % 4);
+      NS_TEST_ASSERT_MSG_EQ (link.gateway, first.gateway, "Clients of a LAN have different gateways");
+      NS_TEST_ASSERT_MSG_EQ (link.devices.Get (0), first.devices.Get (0), "Clients of a LAN on different router devices");
+      if (i >= 4)
+        {
+          NS_TEST_ASSERT_MSG_NE (link.gateway, topology.GetAccessLink (i - 4).gateway, "Two LANs share a gateway");
+        }
+      for (uint32_t j = 0; j < i; j++)
+        {
+          NS_TEST_ASSERT_MSG_NE (link.address, topology.GetAccessLink (j).address, "Two clients share an address");
+        }
+    }
+
+  // Two viewpoints of four half-second segments, to the last client of the
+  // last LAN
+  std::string mvFile = CreateTempDirFilename ("csma_mv.csv");
+  std::string vpFile = CreateTempDirFilename ("csma_vp.csv");
+  std::ofstream mv (mvFile.c_str ());
+  mv << "2 4 500000 2 2\n";
+  for (int32_t t = 0; t < 4; t++)
+    {
+      mv << "20000\t40000\t20000\t40000\n";
+    }
+  mv.close ();
+  std::ofstream vp (vpFile.c_str ());
+  vp << "tIndex\tvpoint\n0\t0\n";
+  vp.close ();
+
+  mvdashServerHelper serverHelper (InetSocketAddress (Ipv4Address::GetAny (), 9), 0);
+  serverHelper.SetAttribute ("MVInfo", StringValue (mvFile));
+  serverHelper.Install (topology.GetServer ()).Start (Seconds (0.0));
+  mvdashClientHelper clientHelper (InetSocketAddress (topology.GetServerAddress (), 9), 0);
+  clientHelper.SetAttribute ("MVInfo", StringValue (mvFile));
+  clientHelper.SetAttribute ("VPInfo", StringValue (vpFile));
+  clientHelper.SetAttribute ("VPModel", StringValue ("trace"));
+  clientHelper.SetAttribute ("EnableLogs", BooleanValue (false));
+  Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable> ();
+  jitter->SetAttribute ("Max", DoubleValue (0.5));
+  clientHelper.SetStartTimes (Seconds (0.1), Seconds (0), jitter);
+  // The jitter and two streams of the viewpoint model of each of ten clients
+  NS_TEST_EXPECT_MSG_EQ (clientHelper.AssignStreams (7, 10), 21, "Wrong number of streams taken");
+  ApplicationContainer apps = clientHelper.Install (topology.GetClients ().Get (9));
+  apps.Stop (Seconds (20));
+  Ptr<mvdashClient> client = DynamicCast<mvdashClient> (apps.Get (0));
+
+  // The start time is the first draw of stream 7
+  Ptr<UniformRandomVariable> same = CreateObject<UniformRandomVariable> ();
+  same->SetAttribute ("Max", DoubleValue (0.5));
+  same->SetStream (7);
+  TimeValue start;
+  client->GetAttribute ("StartTime", start);
+  NS_TEST_EXPECT_MSG_EQ (start.Get (), Seconds (0.1) + Seconds (same->GetValue ()), "The start time is not drawn from its stream");
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 4u, "The session did not run across the LAN");
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Checks that the server multicast crosses the bottleneck once for
+ * all the viewers of the dumbbell, and that the clients repair over unicast
+ * what the group misses.
+ */
+class mvdashMulticastTestCase : public TestCase
+{
+public:
+  mvdashMulticastTestCase ();
+  virtual ~mvdashMulticastTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Plays the session on nClients clients, all members of the group
+   * \param viewpoints the viewpoints taken from the group
+   * \param silent the server does not multicast
+   * \param lossyClient the client whose access link drops packets, -1 for none
+   */
+  void RunSession (uint32_t nClients, std::string viewpoints, bool silent, int32_t lossyClient);
+  void BottleneckTx (Ptr<const Packet> packet);
+
+  std::string m_mvFile;
+  std::string m_vpFile;
+  uint64_t    m_multicastBytes;         //!< sent into the bottleneck to the group
+  uint64_t    m_unicastBytes;           //!< sent into the bottleneck to the clients
+  std::vector<uint64_t> m_repairs;      //!< segments each client repaired over unicast
+  std::vector<size_t>   m_played;       //!< segments each client played
+};
+
+mvdashMulticastTestCase::mvdashMulticastTestCase ()
+  : TestCase ("Multicast session on a shared bottleneck"),
+    m_multicastBytes (0),
+    m_unicastBytes (0)
+{
+}
+
+mvdashMulticastTestCase::~mvdashMulticastTestCase ()
+{
+}
+
+void
+mvdashMulticastTestCase::BottleneckTx (Ptr<const Packet> packet)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  PppHeader ppp;
+  copy->RemoveHeader (ppp);
+  Ipv4Header ip;
+  copy->RemoveHeader (ip);
+  if (ip.GetDestination ().IsMulticast ())
+    {
+      m_multicastBytes += packet->GetSize ();
+    }
+  else
+    {
+      m_unicastBytes += packet->GetSize ();
+    }
+}
+
+void
+mvdashMulticastTestCase::RunSession (uint32_t nClients, std::string viewpoints, bool silent, int32_t lossyClient)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  m_multicastBytes = 0;
+  m_unicastBytes = 0;
+
+  mvdashTopologyHelper topology;
+  topology.SetBottleneck ("20Mbps", "10ms");
+  topology.Build (nClients);
+  if (lossyClient >= 0)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (0.01));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      em->AssignStreams (1);
+      topology.GetAccessLink (lossyClient).devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+
+  // The group from the server through both routers to every client link
+  Ipv4Address group ("225.1.2.4");
+  const NetDeviceContainer &serverDevices = topology.GetServerDevices ();
+  const NetDeviceContainer &bottleneckDevices = topology.GetBottleneckDevices ();
+  Ipv4StaticRoutingHelper multicast;
+  multicast.SetDefaultMulticastRoute (topology.GetServer (), serverDevices.Get (0));
+  multicast.AddMulticastRoute (topology.GetRouters ().Get (0), topology.GetServerAddress (), group,
+                               serverDevices.Get (1), NetDeviceContainer (bottleneckDevices.Get (0)));
+  NetDeviceContainer clientSide;
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      clientSide.Add (topology.GetAccessLink (i).devices.Get (0));
+    }
+  multicast.AddMulticastRoute (topology.GetRouters ().Get (1), topology.GetServerAddress (), group,
+                               bottleneckDevices.Get (1), clientSide);
+  bottleneckDevices.Get (0)->TraceConnectWithoutContext ("PhyTxEnd",
+                                                         MakeCallback (&mvdashMulticastTestCase::BottleneckTx, this));
+
+  mvdashServerHelper serverHelper (InetSocketAddress (Ipv4Address::GetAny (), 9), 0);
+  serverHelper.SetAttribute ("MVInfo", StringValue (m_mvFile));
+  if (!silent)
+    {
+      serverHelper.SetAttribute ("MulticastGroup", AddressValue (InetSocketAddress (group, 5000)));
+      serverHelper.SetAttribute ("MulticastViewpoints", StringValue (viewpoints));
+      serverHelper.SetAttribute ("MulticastQuality", UintegerValue (1));
+      // Every client has joined when the first segment goes out
+      serverHelper.SetAttribute ("MulticastStart", TimeValue (Seconds (1)));
+    }
+  serverHelper.Install (topology.GetServer ()).Start (Seconds (0.0));
+
+  mvdashClientHelper clientHelper (InetSocketAddress (topology.GetServerAddress (), 9), 0);
+  clientHelper.SetAttribute ("MVInfo", StringValue (m_mvFile));
+  clientHelper.SetAttribute ("VPInfo", StringValue (m_vpFile));
+  clientHelper.SetAttribute ("VPModel", StringValue ("trace"));
+  clientHelper.SetAttribute ("EnableLogs", BooleanValue (false));
+  clientHelper.SetAttribute ("MulticastGroup", AddressValue (InetSocketAddress (group, 5000)));
+  clientHelper.SetAttribute ("MulticastViewpoints", StringValue (viewpoints));
+  clientHelper.SetAttribute ("MulticastQuality", UintegerValue (1));
+  clientHelper.SetStartTimes (Seconds (0.1), Seconds (0.1));
+  ApplicationContainer apps = clientHelper.Install (topology.GetClients ());
+  apps.Stop (Seconds (30));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+  m_repairs.clear ();
+  m_played.clear ();
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      Ptr<mvdashClient> client = DynamicCast<mvdashClient> (apps.Get (i));
+      m_repairs.push_back (client->GetMulticastRepairs ());
+      m_played.push_back (client->GetPlaybackData ().playbackIndex.size ());
+    }
+  Simulator::Destroy ();
+}
+
+void
+mvdashMulticastTestCase::DoRun (void)
+{
+  // Three viewpoints of eight one-second segments; the group carries the
+  // highest quality, so a client takes from it every viewpoint it carries
+  m_mvFile = CreateTempDirFilename ("multicast_mv.csv");
+  m_vpFile = CreateTempDirFilename ("multicast_vp.csv");
+  std::ofstream mv (m_mvFile.c_str ());
+  mv << "3 8 1000000 2 2 2\n";
+  for (int32_t t = 0; t < 8; t++)
+    {
+      mv << "50000\t100000\t50000\t100000\t50000\t100000\n";
+    }
+  mv.close ();
+  std::ofstream vp (m_vpFile.c_str ());
+  vp << "tIndex\tvpoint\n0\t0\n";
+  vp.close ();
+
+  // Every viewpoint multicast, to one viewer and then to four
+  RunSession (1, "0,1,2", false, -1);
+  NS_TEST_ASSERT_MSG_EQ (m_played[0], 8u, "The single viewer did not complete every group");
+  NS_TEST_ASSERT_MSG_GT (m_multicastBytes, 3u * 8 * 100000, "The multicast did not cross the bottleneck");
+  uint64_t allViewpoints = m_multicastBytes;
+  uint64_t oneViewer = m_multicastBytes + m_unicastBytes;
+
+  RunSession (4, "0,1,2", false, -1);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_played[i], 8u, "A viewer did not complete every group");
+      NS_TEST_EXPECT_MSG_EQ (m_repairs[i], 0u, "A viewer repaired a lossless multicast");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_multicastBytes, allViewpoints, "The multicast crossed the bottleneck once per viewer");
+  // Only the requests grow with the viewers; unicast would carry every segment four times
+  NS_TEST_EXPECT_MSG_LT (m_multicastBytes + m_unicastBytes, oneViewer * 5 / 4, "The bottleneck bytes grew with the viewers");
+
+  // One viewpoint of the three multicast: a third of the bytes to the group
+  RunSession (4, "0", false, -1);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_played[i], 8u, "A viewer did not complete every group");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_multicastBytes * 3, allViewpoints, "The multicast bytes do not follow the multicast viewpoints");
+
+  // The first viewer loses one packet in a hundred: each multicast segment
+  // it misses a chunk of is fetched again over unicast
+  RunSession (4, "0,1,2", false, 0);
+  NS_TEST_EXPECT_MSG_GT (m_repairs[0], 0u, "No missed chunk was repaired");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_played[i], 8u, "A viewer did not complete every group");
+      if (i > 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_repairs[i], 0u, "A viewer on a lossless link repaired a segment");
+        }
+    }
+
+  // A silent group: every multicast segment is repaired after MulticastTimeout
+  RunSession (2, "0,1,2", true, -1);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_repairs[i], 3u * 8, "A viewer did not repair the segments of a silent group");
+      NS_TEST_EXPECT_MSG_EQ (m_played[i], 8u, "A viewer did not complete every group");
+    }
+}
+
+/**
+ * \brief Checks the max-min fair shares and completion times of the fluid
+ * network on a bottleneck shared with a slower access link.
+ */
+class mvdashFluidNetworkTestCase : public TestCase
+{
+public:
+  mvdashFluidNetworkTestCase ();
+  virtual ~mvdashFluidNetworkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Delivered (uint32_t flow);
+
+  std::vector <std::pair<uint32_t, Time> > m_delivered;
+};
+
+mvdashFluidNetworkTestCase::mvdashFluidNetworkTestCase ()
+  : TestCase ("Fluid network max-min fair completions")
+{
+}
+
+mvdashFluidNetworkTestCase::~mvdashFluidNetworkTestCase ()
+{
+}
+
+void
+mvdashFluidNetworkTestCase::Delivered (uint32_t flow)
+{
+  m_delivered.push_back (std::make_pair (flow, Simulator::Now ()));
+}
+
+void
+mvdashFluidNetworkTestCase::DoRun (void)
+{
+  Ptr<mvdashFluidNetwork> network = CreateObject<mvdashFluidNetwork> ();
+  network->SetAttribute ("Efficiency", DoubleValue (1.0));
+  // 1 MB/s bottleneck, a fast access link and a 250 kB/s one
+  std::vector <uint32_t> fast (2), slow (2);
+  fast[0] = slow[0] = network->AddLink (8000000);
+  fast[1] = network->AddLink (100000000);
+  slow[1] = network->AddLink (2000000);
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  network->SetPath (a, fast, Seconds (0));
+  network->SetPath (b, slow, Seconds (0));
+  mvdashFluidNetwork::FlowCallback delivered = MakeCallback (&mvdashFluidNetworkTestCase::Delivered, this);
+  uint32_t fa = network->AddFlow (a, false, MakeNullCallback<void, uint32_t> (), delivered);
+  uint32_t fb = network->AddFlow (b, false, MakeNullCallback<void, uint32_t> (), delivered);
+
+  // b is held to 250 kB/s, a gets the other 750 kB/s, then all of it
+  network->Send (fa, 500000);
+  network->Send (fa, 500000);
+  network->Send (fb, 250000);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_delivered.size (), 3u, "A message was not delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_delivered[0].first, fa, "Wrong first completion");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_delivered[0].second.GetSeconds (), 0.5 / 0.75, 1e-6, "Wrong fair share of the fast flow");
+  NS_TEST_ASSERT_MSG_EQ (m_delivered[1].first, fb, "Wrong second completion");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_delivered[1].second.GetSeconds (), 1.0, 1e-6, "Slow flow not held by its access link");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_delivered[2].second.GetSeconds (), 1.25, 1e-6, "Freed bandwidth not reallocated");
+
+  network->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Base of the tests of a multi-view session: writes a manifest with
+ * the same segment sizes throughout and a viewpoint trace, and plays them
+ * over the fluid network or across a point-to-point link from an
+ * mvdashServer.  A test sets its features in ConfigureFeatures.
+ */
+class mvdashSessionTestCase : public TestCase
+{
+public:
+  mvdashSessionTestCase (std::string name);
+  virtual ~mvdashSessionTestCase ();
+
+protected:
+  /**
+   * \param prefix prefix of the temporary file names
+   * \param sizes bytes of a segment of each quality, for every viewpoint and time index
+   * \param switches the rows of the viewpoint trace, "tIndex\tvpoint\n" each
+   */
+  void WriteContent (std::string prefix, int32_t nViewpoints, int32_t nSegments, int64_t segmentDuration,
+                     const std::vector<int64_t> &sizes, std::string switches);
+  /**
+   * \brief Serves the session from the fluid network over one link
+   * \param rate bits per second
+   */
+  void SetFluidLink (uint64_t rate, Time delay);
+  /**
+   * \brief Serves the session from an mvdashServer across a point-to-point link
+   */
+  void SetPointToPointLink (std::string rate, std::string delay);
+  /**
+   * \brief Buffers every viewpoint of its own; without it the viewpoints
+   * of a time index are downloaded as one group
+   */
+  void SetBufferTargets (Time mainTarget, Time sideTarget);
+  /**
+   * \returns the client, after the simulation ran until \p stop
+   */
+  Ptr<mvdashClient> RunSession (Time stop);
+  /**
+   * \brief Releases the network and the simulator, for the next session
+   */
+  void EndSession (void);
+  /**
+   * \brief The hook for the attributes of the feature under test
+   */
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+  /**
+   * \brief The hook for the trace sinks of a test, before the session starts
+   */
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+
+  std::string m_mvFile;
+  std::string m_vpFile;
+
+private:
+  virtual void DoTeardown (void);
+
+  bool          m_fluid;
+  uint64_t      m_fluidRate;
+  Time          m_fluidDelay;
+  std::string   m_linkRate;
+  std::string   m_linkDelay;
+  Time          m_mainTarget;
+  Time          m_sideTarget;
+  Ptr<mvdashFluidNetwork> m_network;
+};
+
+mvdashSessionTestCase::mvdashSessionTestCase (std::string name)
+  : TestCase (name),
+    m_fluid (true),
+    m_fluidRate (8000000),
+    m_fluidDelay (MilliSeconds (10)),
+    m_mainTarget (Seconds (0)),
+    m_sideTarget (Seconds (0))
+{
+}
+
+mvdashSessionTestCase::~mvdashSessionTestCase ()
+{
+}
+
+void
+mvdashSessionTestCase::WriteContent (std::string prefix, int32_t nViewpoints, int32_t nSegments,
+                                     int64_t segmentDuration, const std::vector<int64_t> &sizes,
+                                     std::string switches)
+{
+  m_mvFile = CreateTempDirFilename (prefix + "_mv.csv");
+  m_vpFile = CreateTempDirFilename (prefix + "_vp.csv");
+  std::ofstream mv (m_mvFile.c_str ());
+  mv << nViewpoints << " " << nSegments << " " << segmentDuration;
+  for (int32_t vp = 0; vp < nViewpoints; vp++)
+    {
+      mv << " " << sizes.size ();
+    }
+  mv << "\n";
+  for (int32_t t = 0; t < nSegments; t++)
+    {
+      for (int32_t vp = 0; vp < nViewpoints; vp++)
+        {
+          for (size_t q = 0; q < sizes.size (); q++)
+            {
+              mv << ((vp || q) ? "\t" : "") << sizes[q];
+            }
+        }
+      mv << "\n";
+    }
+  mv.close ();
+  std::ofstream vp (m_vpFile.c_str ());
+  vp << "tIndex\tvpoint\n" << switches;
+  vp.close ();
+}
+
+void
+mvdashSessionTestCase::SetFluidLink (uint64_t rate, Time delay)
+{
+  m_fluid = true;
+  m_fluidRate = rate;
+  m_fluidDelay = delay;
+}
+
+void
+mvdashSessionTestCase::SetPointToPointLink (std::string rate, std::string delay)
+{
+  m_fluid = false;
+  m_linkRate = rate;
+  m_linkDelay = delay;
+}
+
+void
+mvdashSessionTestCase::SetBufferTargets (Time mainTarget, Time sideTarget)
+{
+  m_mainTarget = mainTarget;
+  m_sideTarget = sideTarget;
+}
+
+void
+mvdashSessionTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+}
+
+void
+mvdashSessionTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+}
+
+Ptr<mvdashClient>
+mvdashSessionTestCase::RunSession (Time stop)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Address serverAddress = InetSocketAddress (Ipv4Address ("10.1.2.1"), 9);
+  NodeContainer nodes;
+  mvdashServerHelper serverHelper (InetSocketAddress (Ipv4Address::GetAny (), 9), 0);
+  serverHelper.SetAttribute ("MVInfo", StringValue (m_mvFile));
+  if (m_fluid)
+    {
+      // The fluid network serves the requests itself
+      m_network = CreateObject<mvdashFluidNetwork> ();
+      m_network->SetAttribute ("Efficiency", DoubleValue (1.0));
+      nodes.Create (1);
+      m_network->SetPath (nodes.Get (0), std::vector<uint32_t> (1, m_network->AddLink (m_fluidRate)), m_fluidDelay);
+    }
+  else
+    {
+      Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+      nodes.Create (2);
+      PointToPointHelper link;
+      link.SetDeviceAttribute ("DataRate", StringValue (m_linkRate));
+      link.SetChannelAttribute ("Delay", StringValue (m_linkDelay));
+      NetDeviceContainer devices = link.Install (nodes);
+      InternetStackHelper stack;
+      stack.Install (nodes);
+      Ipv4AddressHelper address;
+      address.SetBase ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      serverAddress = InetSocketAddress (interfaces.GetAddress (1), 9);
+    }
+
+  mvdashClientHelper clientHelper (serverAddress, 0);
+  clientHelper.SetAttribute ("MVInfo", StringValue (m_mvFile));
+  clientHelper.SetAttribute ("VPInfo", StringValue (m_vpFile));
+  clientHelper.SetAttribute ("VPModel", StringValue ("trace"));
+  clientHelper.SetAttribute ("EnableLogs", BooleanValue (false));
+  if (m_fluid)
+    {
+      clientHelper.SetAttribute ("FluidNetwork", PointerValue (m_network));
+    }
+  if (!m_mainTarget.IsZero ())
+    {
+      clientHelper.SetAttribute ("BufferMode", StringValue ("viewpoint"));
+      clientHelper.SetAttribute ("MainBufferTarget", TimeValue (m_mainTarget));
+      clientHelper.SetAttribute ("SideBufferTarget", TimeValue (m_sideTarget));
+    }
+  ConfigureFeatures (clientHelper, serverHelper);
+
+  // The client on the first node, the server on the second
+  if (!m_fluid)
+    {
+      ApplicationContainer serverApp = serverHelper.Install (nodes.Get (1));
+      serverApp.Start (Seconds (0.0));
+    }
+  ApplicationContainer apps = clientHelper.Install (nodes.Get (0));
+  if (!m_fluid)
+    {
+      apps.Start (Seconds (0.1));
+    }
+  apps.Stop (stop);
+  Ptr<mvdashClient> client = DynamicCast<mvdashClient> (apps.Get (0));
+  ConnectTraces (client);
+  Simulator::Stop (stop);
+  Simulator::Run ();
+  return client;
+}
+
+void
+mvdashSessionTestCase::EndSession (void)
+{
+  if (m_network)
+    {
+      m_network->Dispose ();
+      m_network = 0;
+    }
+  Simulator::Destroy ();
+}
+
+void
+mvdashSessionTestCase::DoTeardown (void)
+{
+  EndSession ();
+}
+
+/**
+ * \brief Checks that in the viewpoint buffer mode the main view runs further
+ * ahead than the side views, and that a side view covers a viewpoint switch.
+ */
+class mvdashViewpointBufferTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashViewpointBufferTestCase ();
+  virtual ~mvdashViewpointBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashViewpointBufferTestCase::mvdashViewpointBufferTestCase ()
+  : mvdashSessionTestCase ("Per-viewpoint buffers and download pipelines")
+{
+}
+
+mvdashViewpointBufferTestCase::~mvdashViewpointBufferTestCase ()
+{
+}
+
+void
+mvdashViewpointBufferTestCase::DoRun (void)
+{
+  // Three viewpoints of 12 one-second segments in three qualities; the
+  // viewer switches from viewpoint 0 to 2 at time index 6
+  WriteContent ("vpbuffer", 3, 12, 1000000, {50000, 100000, 200000}, "0\t0\n6\t2\n");
+  // A 1 MB/s link: far more than the session needs
+  SetFluidLink (8000000, MilliSeconds (10));
+  SetBufferTargets (Seconds (6), Seconds (2));
+  Ptr<mvdashClient> client = RunSession (Seconds (30));
+
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 12u, "The session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (play.playbackStart[11] - play.playbackStart[0], 11000000, "Playback stalled");
+  NS_TEST_EXPECT_MSG_EQ (play.mainViewpoint[6], 2, "The viewpoint switch was not played");
+  NS_TEST_EXPECT_MSG_EQ (play.qualityIndex[6][2], 0, "The switch was not covered by the side view buffer");
+  NS_TEST_EXPECT_MSG_EQ (play.qualityIndex[11][2], 2, "The new main view did not get the top quality");
+
+  // Lead of a request: time indexes ahead of the next segment to play
+  const struct downloadDataGroup &down = client->GetDownloadData ();
+  int32_t mainLead = -1, sideLead = -1;
+  for (size_t i = 0; i < down.id.size (); i++)
+    {
+      int64_t sent = down.time[i].requestSent;
+      if (sent >= play.playbackStart[6])
+        {
+          continue;
+        }
+      int32_t nStarted = std::upper_bound (play.playbackStart.begin (), play.playbackStart.end (), sent)
+        - play.playbackStart.begin ();
+      int32_t lead = down.playbackIndex[i] - nStarted;
+      int32_t &maxLead = (down.qualityIndex[i][0] >= 0) ? mainLead : sideLead;
+      maxLead = std::max (maxLead, lead);
+    }
+  NS_TEST_EXPECT_MSG_GT (mainLead, 3, "The main view did not run ahead");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (sideLead, 1, "A side view was filled past its target");
+}
+
+/**
+ * \brief Checks that with SideViewCongestionControl the side views go over
+ * a connection of their own, and that the main view keeps its quality
+ * against them on a bottleneck.
+ */
+class mvdashSideViewConnectionTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashSideViewConnectionTestCase ();
+  virtual ~mvdashSideViewConnectionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+  void ServerRx (Ptr<const Packet> packet, const Address &from);
+  /**
+   * \returns the mean quality the main view played at
+   */
+  static double MainQuality (const struct playbackDataGroup &play);
+
+  std::string m_sideViewCc;
+  std::map<Address, std::set<int32_t> > m_mainView;  //!< the mainView marks of the requests of each connection
+};
+
+mvdashSideViewConnectionTestCase::mvdashSideViewConnectionTestCase ()
+  : mvdashSessionTestCase ("Side views on a low-priority connection")
+{
+}
+
+mvdashSideViewConnectionTestCase::~mvdashSideViewConnectionTestCase ()
+{
+}
+
+void
+mvdashSideViewConnectionTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+  clientHelper.SetAttribute ("SideViewCongestionControl", StringValue (m_sideViewCc));
+}
+
+void
+mvdashSideViewConnectionTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  Config::ConnectWithoutContext ("/NodeList/1/ApplicationList/*/$ns3::mvdashServer/Rx",
+                                 MakeCallback (&mvdashSideViewConnectionTestCase::ServerRx, this));
+}
+
+void
+mvdashSideViewConnectionTestCase::ServerRx (Ptr<const Packet> packet, const Address &from)
+{
+  // The requests are sent one packet each, well under a TCP segment
+  if (packet->GetSize () % sizeof (st_mvdashRequest) != 0)
+    {
+      return;
+    }
+  std::vector<st_mvdashRequest> requests (packet->GetSize () / sizeof (st_mvdashRequest));
+  packet->CopyData ((uint8_t *) requests.data (), requests.size () * sizeof (st_mvdashRequest));
+  for (const st_mvdashRequest &req : requests)
+    {
+      m_mainView[from].insert (req.mainView);
+    }
+}
+
+double
+mvdashSideViewConnectionTestCase::MainQuality (const struct playbackDataGroup &play)
+{
+  double sum = 0;
+  for (size_t i = 0; i < play.playbackIndex.size (); i++)
+    {
+      sum += play.qualityIndex[i][play.mainViewpoint[i]];
+    }
+  return play.playbackIndex.empty () ? 0 : sum / play.playbackIndex.size ();
+}
+
+void
+mvdashSideViewConnectionTestCase::DoRun (void)
+{
+  // Three viewpoints of 20 one-second segments; the main view at the middle
+  // quality and the side views at the lowest take more than the 3 Mbps link
+  WriteContent ("sideview", 3, 20, 1000000, {100000, 200000, 400000}, "0\t0\n10\t1\n");
+  SetPointToPointLink ("3Mbps", "20ms");
+  SetBufferTargets (Seconds (6), Seconds (3));
+
+  // Every viewpoint on the one connection
+  m_sideViewCc = "";
+  Ptr<mvdashClient> client = RunSession (Seconds (60));
+  const struct playbackDataGroup &shared = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (shared.playbackIndex.size (), 20u, "The shared session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (m_mainView.size (), 1u, "The requests did not share one connection");
+  NS_TEST_EXPECT_MSG_EQ (m_mainView.begin ()->second.size (), 2u, "The connection did not carry both kinds of view");
+  double sharedQuality = MainQuality (shared);
+  int64_t sharedSpan = shared.playbackStart[19] - shared.playbackStart[0];
+  EndSession ();
+
+  m_sideViewCc = "ns3::TcpLedbat";
+  m_mainView.clear ();
+  client = RunSession (Seconds (60));
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 20u, "The session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (play.mainViewpoint[10], 1, "The viewpoint switch was not played");
+
+  // One connection of main view requests and one of side view requests
+  NS_TEST_ASSERT_MSG_EQ (m_mainView.size (), 2u, "The side views did not get a connection of their own");
+  std::set<int32_t> kinds;
+  for (const std::pair<const Address, std::set<int32_t> > &conn : m_mainView)
+    {
+      NS_TEST_EXPECT_MSG_EQ (conn.second.size (), 1u, "A connection carried both main and side views");
+      kinds.insert (conn.second.begin (), conn.second.end ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (kinds.size (), 2u, "One connection carried no requests of its kind");
+
+  // The side views yield: the main view plays as well and stalls no longer
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (sharedQuality, MainQuality (play), "The main view lost quality to the side views");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (play.playbackStart[19] - play.playbackStart[0], sharedSpan,
+                               "The main view stalled longer with the side views apart");
+}
+
+/**
+ * \brief Checks how the requests of a group are spread over a pool of
+ * connections: by viewpoint, or to the least loaded one.
+ */
+class mvdashConnectionPoolTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashConnectionPoolTestCase ();
+  virtual ~mvdashConnectionPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+  void ServerRx (Ptr<const Packet> packet, const Address &from);
+
+  std::string m_policy;
+  std::map<Address, uint32_t> m_nRequests;                 //!< requests the server got on each connection
+  std::map<Address, std::set<int32_t> > m_viewpoints;     //!< viewpoints requested on each connection
+};
+
+mvdashConnectionPoolTestCase::mvdashConnectionPoolTestCase ()
+  : mvdashSessionTestCase ("Requests spread over a connection pool")
+{
+}
+
+mvdashConnectionPoolTestCase::~mvdashConnectionPoolTestCase ()
+{
+}
+
+void
+mvdashConnectionPoolTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+  clientHelper.SetAttribute ("Connections", UintegerValue (3));
+  clientHelper.SetAttribute ("ConnectionPolicy", StringValue (m_policy));
+}
+
+void
+mvdashConnectionPoolTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  Config::ConnectWithoutContext ("/NodeList/1/ApplicationList/*/$ns3::mvdashServer/Rx",
+                                 MakeCallback (&mvdashConnectionPoolTestCase::ServerRx, this));
+}
+
+void
+mvdashConnectionPoolTestCase::ServerRx (Ptr<const Packet> packet, const Address &from)
+{
+  // The requests of a connection are sent one packet per group, well under a TCP segment
+  if (packet->GetSize () % sizeof (st_mvdashRequest) != 0)
+    {
+      return;
+    }
+  std::vector<st_mvdashRequest> requests (packet->GetSize () / sizeof (st_mvdashRequest));
+  packet->CopyData ((uint8_t *) requests.data (), requests.size () * sizeof (st_mvdashRequest));
+  for (const st_mvdashRequest &req : requests)
+    {
+      m_nRequests[from]++;
+      m_viewpoints[from].insert (req.viewpoint);
+    }
+}
+
+void
+mvdashConnectionPoolTestCase::DoRun (void)
+{
+  // Four viewpoints of eight one-second segments on three connections
+  WriteContent ("pool", 4, 8, 1000000, {50000, 100000}, "0\t0\n");
+  SetPointToPointLink ("10Mbps", "10ms");
+
+  // Viewpoint modulo Connections: 0 and 3 share a connection
+  m_policy = "viewpoint";
+  Ptr<mvdashClient> client = RunSession (Seconds (30));
+  NS_TEST_ASSERT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 8u, "The session was not played through");
+  NS_TEST_ASSERT_MSG_EQ (m_nRequests.size (), 3u, "The requests did not use every connection");
+  std::set<int32_t> placed;
+  for (const std::pair<const Address, std::set<int32_t> > &conn : m_viewpoints)
+    {
+      const std::set<int32_t> &vps = conn.second;
+      int32_t residue = *vps.begin () % 3;
+      for (int32_t vp : vps)
+        {
+          NS_TEST_EXPECT_MSG_EQ (vp % 3, residue, "A viewpoint was sent on the connection of another");
+        }
+      placed.insert (residue);
+      NS_TEST_EXPECT_MSG_EQ (m_nRequests[conn.first], (uint32_t) (8 * vps.size ()),
+                             "A connection did not get one request per segment of each of its viewpoints");
+      NS_TEST_EXPECT_MSG_EQ (vps.size (), (size_t) (residue == 0 ? 2 : 1), "Wrong viewpoints on a connection");
+    }
+  NS_TEST_EXPECT_MSG_EQ (placed.size (), 3u, "Two connections carried the same viewpoints");
+  EndSession ();
+
+  // Least loaded: a group is sent on idle connections, one request each
+  // in turn, so every connection gets at least one request of each group
+  m_policy = "least-loaded";
+  m_nRequests.clear ();
+  m_viewpoints.clear ();
+  client = RunSession (Seconds (30));
+  NS_TEST_ASSERT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 8u, "The least-loaded session was not played through");
+  NS_TEST_ASSERT_MSG_EQ (m_nRequests.size (), 3u, "The least-loaded requests did not use every connection");
+  uint32_t total = 0;
+  for (const std::pair<const Address, uint32_t> &conn : m_nRequests)
+    {
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (8u, conn.second, "A connection was left idle during a group");
+      total += conn.second;
+    }
+  NS_TEST_EXPECT_MSG_EQ (total, 32u, "Requests were lost or repeated");
+}
+
+/**
+ * \brief Checks that the online QoE monitor agrees with the playback record
+ * of a session with a viewpoint switch.
+ */
+class mvdashQoeMonitorTestCase : public mvdashSessionTestCase
 {
 public:
-  Etri_mvdashTestCase1 ();
-  virtual ~Etri_mvdashTestCase1 ();
+  mvdashQoeMonitorTestCase ();
+  virtual ~mvdashQoeMonitorTestCase ();
 
 private:
   virtual void DoRun (void);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+
+  mvdashQoeMonitor m_qoeMonitor;
 };
 
-// Add some help text to this case to describe what it is intended to test
-Etri_mvdashTestCase1::Etri_mvdashTestCase1 ()
-  : TestCase ("Etri_mvdash test case (does nothing)")
+mvdashQoeMonitorTestCase::mvdashQoeMonitorTestCase ()
+  : mvdashSessionTestCase ("Online QoE monitor")
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-Etri_mvdashTestCase1::~Etri_mvdashTestCase1 ()
+mvdashQoeMonitorTestCase::~mvdashQoeMonitorTestCase ()
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-Etri_mvdashTestCase1::DoRun (void)
+mvdashQoeMonitorTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  m_qoeMonitor.Install (ApplicationContainer (client));
+}
+
+void
+mvdashQoeMonitorTestCase::DoRun (void)
+{
+  // Three viewpoints, the viewer switching once, on a link that holds
+  // the group at the lowest quality only
+  WriteContent ("qoe", 3, 12, 1000000, {100000, 400000}, "0\t0\n6\t1\n");
+  SetPointToPointLink ("3Mbps", "20ms");
+  Ptr<mvdashClient> client = RunSession (Seconds (60));
+  NS_TEST_ASSERT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 12u, "The session was not played through");
+
+  st_mvdashQoeSummary online = m_qoeMonitor.GetSummary (client);
+  st_mvdashClientQoe offline = mvdashCampaignHelper::GetClientQoe (client);
+  NS_TEST_EXPECT_MSG_EQ (online.nPlayed, 12u, "The QoE monitor missed a played segment");
+  NS_TEST_EXPECT_MSG_EQ_TOL (online.meanBitrate, offline.meanBitrate, 1e-6 * offline.meanBitrate,
+                             "Online and offline mean bitrates differ");
+  NS_TEST_EXPECT_MSG_EQ (online.startupDelay, offline.startupDelay, "Online and offline startup delays differ");
+  NS_TEST_EXPECT_MSG_EQ (online.nViewpointSwitches, 1u, "The viewpoint switch was not counted");
+  NS_TEST_EXPECT_MSG_GT (online.bytesReceived, 0u, "No segment bytes were counted");
+
+  // A header and one row
+  std::ostringstream report;
+  m_qoeMonitor.Write (report);
+  std::string text = report.str ();
+  NS_TEST_EXPECT_MSG_EQ (std::count (text.begin (), text.end (), '\n'), 2, "Wrong QoE report");
+}
+
+/**
+ * \brief Checks that the event recorder writes every record of a session
+ * through a small ring and that the decoder reads them all back.
+ */
+class mvdashEventRecorderTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashEventRecorderTestCase ();
+  virtual ~mvdashEventRecorderTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+
+  mvdashEventRecorder *m_recorder;
+};
+
+mvdashEventRecorderTestCase::mvdashEventRecorderTestCase ()
+  : mvdashSessionTestCase ("Binary event recorder"),
+    m_recorder (0)
+{
+}
+
+mvdashEventRecorderTestCase::~mvdashEventRecorderTestCase ()
+{
+}
+
+void
+mvdashEventRecorderTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  m_recorder->Install (ApplicationContainer (client));
+}
+
+void
+mvdashEventRecorderTestCase::DoRun (void)
+{
+  WriteContent ("recorder", 3, 10, 1000000, {50000, 100000}, "0\t0\n");
+  SetPointToPointLink ("10Mbps", "10ms");
+  // A small ring, so that records are dumped many times during the run
+  std::string recordFile = CreateTempDirFilename ("recorder_events.bin");
+  mvdashEventRecorder recorder (recordFile, 64);
+  m_recorder = &recorder;
+  Ptr<mvdashClient> client = RunSession (Seconds (30));
+  NS_TEST_ASSERT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 10u, "The session was not played through");
+  EndSession ();
+  m_recorder = 0;
+
+  recorder.Flush ();
+  NS_TEST_EXPECT_MSG_GT (recorder.GetNRecords (), 64u, "The ring was not dumped");
+  // A start and an end of each of the 30 segments at least
+  NS_TEST_EXPECT_MSG_GT (recorder.GetNRecords (), 60u, "Segment events were not recorded");
+  std::ostringstream decoded;
+  NS_TEST_EXPECT_MSG_EQ (mvdashEventRecorder::Decode (recordFile, decoded), (int64_t) recorder.GetNRecords (),
+                         "The decoder did not read back every recorded event");
+}
+
+/**
+ * \brief An mvdashSession that records the request groups it is given, for
+ * a driver that replays the download times of a client.
+ */
+class mvdashReplaySession : public mvdashSession
+{
+public:
+  mvdashReplaySession (const t_videoDataGroup &videoData, MultiView_Model *viewModel)
+    : mvdashSession (videoData, viewModel, "maximize_current")
+  {
+  }
+
+  std::vector < std::vector<st_mvdashRequest> > m_groups;
+
+private:
+  virtual void SendRequests (const std::vector <st_mvdashRequest> &requests)
+  {
+    m_groups.push_back (requests);
+  }
+};
+
+/**
+ * \brief Checks that mvdashSession, carried by a fake transport that
+ * replays the download times of an mvdashClient, requests and plays what
+ * the client did: both run one mvdashGroupController.
+ */
+class mvdashGroupControllerTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashGroupControllerTestCase ();
+  virtual ~mvdashGroupControllerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashGroupControllerTestCase::mvdashGroupControllerTestCase ()
+  : mvdashSessionTestCase ("Session and client share the group controller")
+{
+}
+
+mvdashGroupControllerTestCase::~mvdashGroupControllerTestCase ()
+{
+}
+
+void
+mvdashGroupControllerTestCase::DoRun (void)
+{
+  // Three viewpoints of 16 one-second segments; a top quality group of
+  // 5.6 Mbit on a 4 Mbps link, so that the algorithm adapts and playback stalls
+  WriteContent ("controller", 3, 16, 1000000, {100000, 250000, 500000}, "0\t0\n5\t1\n11\t2\n");
+  SetFluidLink (4000000, MilliSeconds (20));
+  Ptr<mvdashClient> client = RunSession (Seconds (60));
+  struct downloadDataGroup down = client->GetDownloadData ();
+  struct playbackDataGroup play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 16u, "The client did not play through");
+
+  t_videoDataGroup video;
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadManifest (m_mvFile, video), 16, "Manifest not read");
+  mvdashReplaySession session (video, mvdashCreateViewpointModel ("trace", m_vpFile, 3));
+  NS_TEST_ASSERT_MSG_EQ (session.Start (down.time[0].requestSent), true, "Session did not start");
+
+  // Every group is in when it was in at the client, and each segment ends a
+  // segment duration after it started
+  size_t nFinished = 0;
+  while (!session.IsFinished ())
+    {
+      size_t g = session.GetDownloadData ().id.size () - 1;
+      bool pending = nFinished <= g && g < down.id.size ();
+      int64_t playbackEnd = session.GetPlaybackEnd ();
+      if (playbackEnd >= 0 && (!pending || playbackEnd <= down.time[g].downloadEnd))
+        {
+          session.PlaybackFinished (playbackEnd);
+        }
+      else if (pending)
+        {
+          session.DownloadStarted (down.time[g].downloadStart);
+          session.DownloadFinished (down.time[g].downloadEnd);
+          nFinished++;
+        }
+      else
+        {
+          break;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (session.IsFinished (), true, "The session did not play through");
+
+  const struct downloadDataGroup &sessionDown = session.GetDownloadData ();
+  NS_TEST_ASSERT_MSG_EQ (sessionDown.id.size (), down.id.size (), "Different number of groups");
+  NS_TEST_ASSERT_MSG_EQ (session.m_groups.size (), down.id.size (), "Groups not carried");
+  bool adapted = false;
+  for (size_t g = 0; g < down.id.size (); g++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sessionDown.time[g].requestSent, down.time[g].requestSent, "Group " << g << " requested at another time");
+      NS_TEST_EXPECT_MSG_EQ (sessionDown.playbackIndex[g], down.playbackIndex[g], "Group " << g << " of another time index");
+      NS_TEST_EXPECT_MSG_EQ (session.m_groups[g].size (), 3u, "Group " << g << " is not one request per viewpoint");
+      for (int32_t vp = 0; vp < 3; vp++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (sessionDown.qualityIndex[g][vp], down.qualityIndex[g][vp],
+                                 "Group " << g << " requested viewpoint " << vp << " at another quality");
+          adapted = adapted || down.qualityIndex[g][vp] != down.qualityIndex[0][vp];
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (adapted, true, "The qualities never changed, nothing was compared");
+
+  const struct playbackDataGroup &sessionPlay = session.GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (sessionPlay.playbackIndex.size (), play.playbackIndex.size (), "Different number of segments played");
+  bool stalled = false;
+  for (size_t i = 0; i < play.playbackIndex.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sessionPlay.playbackStart[i], play.playbackStart[i], "Segment " << i << " played at another time");
+      NS_TEST_EXPECT_MSG_EQ (sessionPlay.mainViewpoint[i], play.mainViewpoint[i], "Segment " << i << " played another viewpoint");
+      stalled = stalled || (i > 0 && play.playbackStart[i] - play.playbackStart[i - 1] > 1000000);
+    }
+  NS_TEST_EXPECT_MSG_EQ (stalled, true, "Playback never stalled, nothing was compared");
+  NS_TEST_EXPECT_MSG_GT (session.GetSummary (sessionPlay.playbackStart.back ()).nStalls, 0u, "Stall not accounted");
+}
+
+/**
+ * \brief Checks the session timeline of the trace-driven player, and that the
+ * evaluator thread pool gives the same QoE as players run one by one.
+ */
+class mvdashTracePlayerTestCase : public TestCase
+{
+public:
+  mvdashTracePlayerTestCase ();
+  virtual ~mvdashTracePlayerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+mvdashTracePlayerTestCase::mvdashTracePlayerTestCase ()
+  : TestCase ("Trace-driven player and evaluator")
+{
+}
+
+mvdashTracePlayerTestCase::~mvdashTracePlayerTestCase ()
+{
+}
+
+void
+mvdashTracePlayerTestCase::DoRun (void)
+{
+  // Two viewpoints, four 1 s segments of one rate, 2 Mbit per group
+  std::string mvFile = CreateTempDirFilename ("player_mv.csv");
+  std::ofstream mv (mvFile.c_str ());
+  mv << "2 4 1000000 1 1\n";
+  for (int t = 0; t < 4; t++)
+    {
+      mv << "125000\t125000\n";
+    }
+  mv.close ();
+  // The viewer moves to viewpoint 1 at the third segment
+  std::string vpFile = CreateTempDirFilename ("player_vp.csv");
+  std::ofstream vp (vpFile.c_str ());
+  vp << "tIndex\tvpoint\n0\t0\n2\t1\n";
+  vp.close ();
+  // The 2 Mbps bottleneck halves at 1.5 s
+  std::string bwFile = CreateTempDirFilename ("player_bw.csv");
+  std::ofstream bw (bwFile.c_str ());
+  bw << "1500000 1000000\n";
+  bw.close ();
+
+  t_videoDataGroup video;
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadManifest (mvFile, video), 4, "Manifest not read");
+
+  // A group downloads in 1 s: every segment is in before it is due
+  t_mvdashRateChanges constant;
+  MultiView_Model *viewModel = mvdashCreateViewpointModel ("trace", vpFile, 2);
+  mvdashTracePlayer steady (video, constant, viewModel, "maximize_current");
+  steady.Configure (2000000, 0, 1.0, 0);
+  NS_TEST_ASSERT_MSG_EQ (steady.Run (), true, "Player did not run");
+  st_mvdashQoeSummary s = steady.GetSummary ();
+  NS_TEST_EXPECT_MSG_EQ (s.startupDelay, 1000000, "Wrong startup delay");
+  NS_TEST_EXPECT_MSG_EQ (s.nPlayed, 4u, "Session not played through");
+  NS_TEST_EXPECT_MSG_EQ (s.nStalls, 0u, "Unexpected stall");
+  NS_TEST_EXPECT_MSG_EQ (s.nViewpointSwitches, 1u, "Viewpoint trace not replayed");
+  NS_TEST_EXPECT_MSG_EQ (s.bytesReceived, 1000000u, "Wrong bytes");
+  NS_TEST_EXPECT_MSG_EQ (steady.GetPlaybackData ().mainViewpoint[2], 1, "Wrong viewpoint of the third segment");
+
+  // The second group takes 0.5 s at 2 Mbps and 1 s at 1 Mbps, a 0.5 s stall;
+  // later groups take 2 s, each a 1 s stall
+  t_mvdashRateChanges halved;
+  halved.push_back (std::make_pair ((int64_t) 1500000, (uint64_t) 1000000));
+  viewModel = mvdashCreateViewpointModel ("trace", vpFile, 2);
+  mvdashTracePlayer slowed (video, halved, viewModel, "maximize_current");
+  slowed.Configure (2000000, 0, 1.0, 0);
+  slowed.Run ();
+  NS_TEST_EXPECT_MSG_EQ (slowed.GetDownloadData ().time[1].downloadEnd, 2500000, "Wrong download time across a rate change");
+  NS_TEST_EXPECT_MSG_EQ (slowed.GetSummary ().nStalls, 3u, "Stall missed");
+  NS_TEST_EXPECT_MSG_EQ (slowed.GetSummary ().stallTime, 2500000, "Wrong stall time");
+
+  Ptr<mvdashPlayerEvaluator> evaluator = CreateObject<mvdashPlayerEvaluator> ();
+  evaluator->SetAttribute ("MVInfo", StringValue (mvFile));
+  evaluator->SetAttribute ("VPInfo", StringValue (vpFile));
+  evaluator->SetAttribute ("VPModel", StringValue ("trace"));
+  evaluator->SetAttribute ("DataRate", DataRateValue (DataRate (2000000)));
+  evaluator->SetAttribute ("Rtt", TimeValue (Seconds (0)));
+  evaluator->SetAttribute ("Efficiency", DoubleValue (1.0));
+  evaluator->SetAttribute ("Threads", UintegerValue (2));
+  for (int i = 0; i < 4; i++)
+    {
+      evaluator->AddJob (i % 2 ? bwFile : "", i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (evaluator->Run (), true, "Evaluator did not run");
+  for (uint32_t j = 0; j < evaluator->GetNJobs (); j++)
+    {
+      st_mvdashQoeSummary expected = j % 2 ? slowed.GetSummary () : s;
+      NS_TEST_EXPECT_MSG_EQ (evaluator->GetSummary (j).stallTime, expected.stallTime, "Job " << j << " differs from a single player");
+      NS_TEST_EXPECT_MSG_EQ (evaluator->GetSummary (j).nPlayed, expected.nPlayed, "Job " << j << " differs from a single player");
+    }
+}
+
+/**
+ * \brief Checks the tile sizes of a video, the tiles in a viewport, and a
+ * tiled session over the fluid network.
+ */
+class mvdashTileTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashTileTestCase ();
+  virtual ~mvdashTileTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+  void Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
+
+  bool          m_tiled;
+  int64_t       m_bytes;                                //!< bytes of the segments received
+  std::map <int32_t, std::vector<int32_t> > m_tiles;    //!< qualities of the tiles received, by time index
+};
+
+mvdashTileTestCase::mvdashTileTestCase ()
+  : mvdashSessionTestCase ("Tiled viewpoints"),
+    m_tiled (false),
+    m_bytes (0)
+{
+}
+
+mvdashTileTestCase::~mvdashTileTestCase ()
+{
+}
+
+void
+mvdashTileTestCase::DoRun (void)
+{
+  // Two viewpoints, two segments of two rates, cut into 2x1 tiles
+  std::string mvFile = CreateTempDirFilename ("tile_mv.csv");
+  std::string tileFile = CreateTempDirFilename ("tile_ti.csv");
+  std::ofstream mv (mvFile.c_str ());
+  mv << "2 2 1000000 2 2\n100\t200\t100\t200\n100\t200\t100\t200\n";
+  mv.close ();
+  std::ofstream ti (tileFile.c_str ());
+  ti << "2 2 2 1\n10 20 30 40 11 21 31 41\n1 2 3 4 5 6 7 8\n";
+  ti.close ();
+
+  t_videoDataGroup video;
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadManifest (mvFile, video), 2, "Manifest not read");
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadTileManifest (tileFile, video), 2, "Tile sizes not read");
+  NS_TEST_EXPECT_MSG_EQ (video[0].segmentSize[1][0], 70, "A segment is not the sum of its tiles");
+  NS_TEST_EXPECT_MSG_EQ (video[1].tileSize[1][1 * 2 + 1], 8, "Wrong tile size");
+
+  t_videoDataGroup split;
+  mvdashReadManifest (mvFile, split);
+  mvdashSplitTiles (split, 3, 1);
+  NS_TEST_EXPECT_MSG_EQ (split[0].tileSize[1][0], 67, "The first tile does not take the remainder");
+  NS_TEST_EXPECT_MSG_EQ (split[0].tileSize[1][2], 66, "Wrong even tile size");
+
+  // Looking straight ahead, a 100x90 degree field of view on an 8x4 grid
+  // covers the middle four columns of the two middle rows
+  Ptr<Viewport_Model> viewport = CreateObject<Viewport_Model> ();
+  std::vector<bool> visible = viewport->GetVisibleTiles (8, 4, 0);
+  NS_TEST_EXPECT_MSG_EQ (std::count (visible.begin (), visible.end (), true), 8, "Wrong tiles in the viewport");
+  NS_TEST_EXPECT_MSG_EQ (visible[8 + 2], true, "A tile in front of the viewer is not visible");
+  NS_TEST_EXPECT_MSG_EQ (visible[0], false, "A tile behind the viewer is visible");
+
+  mvdashTileAllocator allocator;
+  allocator.SetOutOfViewportQuality (0);
+  std::vector<int32_t> qualities;
+  std::vector<bool> left (2, false);
+  left[0] = true;
+  NS_TEST_EXPECT_MSG_EQ (allocator.Allocate (video[0], 0, 1, left, qualities), 50, "Wrong bytes of the tiles");
+  NS_TEST_EXPECT_MSG_EQ (qualities[1], 0, "A tile out of the viewport was not lowered");
+  NS_TEST_EXPECT_MSG_EQ (mvdashTileAllocator::GetCoverage (qualities, 1, std::vector<bool> (2, true)), 0.5,
+                         "Wrong viewport coverage");
+
+  // One viewpoint of 12 segments, on a link that carries the top quality:
+  // untiled first, then in 6x4 tiles
+  WriteContent ("tile_session", 1, 12, 1000000, {48000, 96000}, "0\t0\n");
+  SetFluidLink (8000000, MilliSeconds (10));
+  Ptr<mvdashClient> client = RunSession (Seconds (30));
+  NS_TEST_ASSERT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 12u, "The untiled session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (client->GetPlaybackData ().qualityIndex[11][0], 1, "The untiled session did not reach the top quality");
+  int64_t untiledBytes = m_bytes;
+  EndSession ();
+
+  m_tiled = true;
+  m_bytes = 0;
+  client = RunSession (Seconds (30));
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 12u, "The session was not played through");
+  NS_TEST_ASSERT_MSG_EQ (play.viewportCoverage.size (), 12u, "Viewport coverage not recorded");
+  for (double coverage : play.viewportCoverage)
+    {
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (coverage, 1.0, "Coverage above one");
+    }
+
+  // A tile is at the quality of its viewpoint inside the predicted
+  // viewport, at OutOfViewportQuality outside it
+  NS_TEST_ASSERT_MSG_EQ (m_tiles.size (), 12u, "Not every segment came as tiles");
+  int32_t nOutside = 0, nInside = 0;
+  for (const std::pair<const int32_t, std::vector<int32_t> > &segment : m_tiles)
+    {
+      NS_TEST_EXPECT_MSG_EQ (segment.second.size (), 24u, "Segment " << segment.first << " did not come as 24 tiles");
+      int32_t outside = std::count (segment.second.begin (), segment.second.end (), 0);
+      int32_t inside = std::count (segment.second.begin (), segment.second.end (), 1);
+      NS_TEST_EXPECT_MSG_EQ (outside + inside, 24, "A tile of segment " << segment.first << " at neither quality");
+      nOutside += outside;
+      nInside += inside;
+    }
+  NS_TEST_EXPECT_MSG_GT (nOutside, 0, "No tile fetched at OutOfViewportQuality");
+  NS_TEST_EXPECT_MSG_GT (nInside, 0, "No tile fetched at the quality of its viewpoint");
+  NS_TEST_EXPECT_MSG_LT (m_bytes, untiledBytes, "Tiles took no fewer bytes than whole segments");
+}
+
+void
+mvdashTileTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+  if (m_tiled)
+    {
+      clientHelper.SetAttribute ("TileColumns", UintegerValue (6));
+      clientHelper.SetAttribute ("TileRows", UintegerValue (4));
+      clientHelper.SetAttribute ("OutOfViewportQuality", UintegerValue (0));
+    }
+}
+
+void
+mvdashTileTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  client->TraceConnectWithoutContext ("SegmentTrace", MakeCallback (&mvdashTileTestCase::Segment, this));
+}
+
+void
+mvdashTileTestCase::Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo)
+{
+  if (ev != segev_endReceiving)
+    {
+      return;
+    }
+  m_bytes += sinfo.segmentSize;
+  if (m_tiled)
+    {
+      m_tiles[sinfo.timeIndex].push_back (sinfo.qualityIndex);
+    }
+}
+
+/**
+ * \brief Checks that the server packs the segments of untiled TCP
+ * responses into full packets across segment boundaries, and that the
+ * client still gets every segment whole.
+ */
+class mvdashResponsePackingTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashResponsePackingTestCase ();
+  virtual ~mvdashResponsePackingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+  void ServerTx (Ptr<const Packet> packet, const Address &to);
+  void Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
+
+  uint32_t      m_nPackets;
+  uint32_t      m_nShortPackets;    //!< packets of less than 1446 bytes
+  int64_t       m_bytesSent;
+  int64_t       m_bytesReceived;    //!< bytes of the segments received whole
+};
+
+mvdashResponsePackingTestCase::mvdashResponsePackingTestCase ()
+  : mvdashSessionTestCase ("Responses packed across segments over TCP"),
+    m_nPackets (0),
+    m_nShortPackets (0),
+    m_bytesSent (0),
+    m_bytesReceived (0)
+{
+}
+
+mvdashResponsePackingTestCase::~mvdashResponsePackingTestCase ()
+{
+}
+
+void
+mvdashResponsePackingTestCase::DoRun (void)
+{
+  // Two viewpoints of 8 one-second segments, no size a multiple of 1446
+  WriteContent ("packing", 2, 8, 1000000, {10000, 25000}, "0\t0\n");
+  SetPointToPointLink ("10Mbps", "5ms");
+  Ptr<mvdashClient> client = RunSession (Seconds (20));
+
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 8u, "The session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (m_bytesSent, m_bytesReceived, "The server sent other bytes than the segments received");
+  // Only the packet that empties the queue of a group is short: one per
+  // group, where one per segment were without packing
+  size_t nGroups = client->GetDownloadData ().id.size ();
+  NS_TEST_ASSERT_MSG_GT (m_nPackets, 0u, "No packet traced at the server");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_nShortPackets, nGroups, "A segment ended in a short packet of its own");
+}
+
+void
+mvdashResponsePackingTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  Config::ConnectWithoutContext ("/NodeList/1/ApplicationList/*/$ns3::mvdashServer/Tx",
+                                 MakeCallback (&mvdashResponsePackingTestCase::ServerTx, this));
+  client->TraceConnectWithoutContext ("SegmentTrace", MakeCallback (&mvdashResponsePackingTestCase::Segment, this));
+}
+
+void
+mvdashResponsePackingTestCase::ServerTx (Ptr<const Packet> packet, const Address &to)
+{
+  m_nPackets++;
+  m_bytesSent += packet->GetSize ();
+  if (packet->GetSize () < 1446)
+    {
+      m_nShortPackets++;
+    }
+}
+
+void
+mvdashResponsePackingTestCase::Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo)
+{
+  if (ev == segev_endReceiving)
+    {
+      m_bytesReceived += sinfo.segmentSize;
+    }
+}
+
+/**
+ * \brief Checks the layer sizes of a scalable video, and that the main view
+ * fetches enhancement layers for the base layers it buffered as a side view.
+ */
+class mvdashLayerTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashLayerTestCase ();
+  virtual ~mvdashLayerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+};
+
+mvdashLayerTestCase::mvdashLayerTestCase ()
+  : mvdashSessionTestCase ("Layered coding")
+{
+}
+
+mvdashLayerTestCase::~mvdashLayerTestCase ()
+{
+}
+
+void
+mvdashLayerTestCase::DoRun (void)
+{
+  // Two viewpoints, two segments of two rates
+  std::string mvFile = CreateTempDirFilename ("layer_mv.csv");
+  std::string layerFile = CreateTempDirFilename ("layer_li.csv");
+  std::ofstream mv (mvFile.c_str ());
+  mv << "2 2 1000000 2 2\n100\t200\t100\t200\n100\t200\t100\t200\n";
+  mv.close ();
+  std::ofstream li (layerFile.c_str ());
+  li << "2 2\n100 120 100 130\n90 140 100 110\n";
+  li.close ();
+
+  t_videoDataGroup video;
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadManifest (mvFile, video), 2, "Manifest not read");
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadLayerManifest (layerFile, video), 2, "Layer sizes not read");
+  NS_TEST_EXPECT_MSG_EQ (video[0].layerSize[1][1], 140, "Wrong layer size");
+  NS_TEST_EXPECT_MSG_EQ (video[0].segmentSize[1][1], 230, "A level is not the sum of its layers");
+  NS_TEST_EXPECT_MSG_EQ (video[1].segmentSize[1][0], 230, "A level is not the sum of its layers");
+
+  // A 10% overhead on the higher level: 100 + 120 bytes for 200 single-layer
+  t_videoDataGroup split;
+  mvdashReadManifest (mvFile, split);
+  mvdashSplitLayers (split, 0.1);
+  NS_TEST_EXPECT_MSG_EQ (split[0].layerSize[0][0], 100, "The base layer is not the lowest rate");
+  NS_TEST_EXPECT_MSG_EQ (split[0].layerSize[1][0], 120, "Wrong enhancement layer size");
+  NS_TEST_EXPECT_MSG_EQ (split[0].segmentSize[1][0], 220, "A level is not the sum of its layers");
+
+  // The session of the viewpoint buffer test: the viewer switches from
+  // viewpoint 0 to 2 at time index 6, which had base layers only
+  WriteContent ("layer_session", 3, 12, 1000000, {50000, 100000, 200000}, "0\t0\n6\t2\n");
+  SetFluidLink (8000000, MilliSeconds (10));
+  SetBufferTargets (Seconds (6), Seconds (2));
+  Ptr<mvdashClient> client = RunSession (Seconds (30));
+
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 12u, "The session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (play.playbackStart[11] - play.playbackStart[0], 11000000, "Playback stalled");
+
+  // A second request for a time index of viewpoint 2 is an upgrade
+  const struct downloadDataGroup &down = client->GetDownloadData ();
+  std::vector <int32_t> nRequests (12, 0);
+  int32_t upgraded = -1;
+  for (size_t i = 0; i < down.id.size (); i++)
+    {
+      if (down.qualityIndex[i][2] >= 0 && ++nRequests[down.playbackIndex[i]] == 2 && upgraded < 0)
+        {
+          upgraded = down.playbackIndex[i];
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (upgraded, 6, "No enhancement layers were fetched after the switch");
+  NS_TEST_EXPECT_MSG_GT (play.qualityIndex[upgraded][2], 0, "The enhancement layers did not arrive in time");
+}
+
+void
+mvdashLayerTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+  clientHelper.SetAttribute ("Layered", BooleanValue (true));
+}
+
+/**
+ * \brief Checks that the server pushes the main view, that the client cancels
+ * the pushes of a viewpoint it leaves, and that push saves requests over a
+ * long round trip.
+ */
+class mvdashPushTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashPushTestCase ();
+  virtual ~mvdashPushTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+
+  void ClientTx (Ptr<const mvdashClient> client, Ptr<const Packet> packet);
+  void Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo);
+
+  /// Pushed time indexes a cancel took back
+  struct st_cancel
+  {
+    int32_t viewpoint;
+    int32_t first;
+    int32_t last;
+    int32_t quality;    //!< the quality they were promised at
+  };
+
+  uint32_t m_pushDepth;
+  std::map<int32_t, st_mvdashRequest> m_promises;    //!< the last promise of each viewpoint
+  std::vector<st_cancel> m_cancels;
+  std::set<std::vector<int32_t> > m_received;        //!< {viewpoint, time index, quality}
+};
+
+mvdashPushTestCase::mvdashPushTestCase ()
+  : mvdashSessionTestCase ("Server push of the main view"),
+    m_pushDepth (0)
+{
+}
+
+mvdashPushTestCase::~mvdashPushTestCase ()
+{
+}
+
+void
+mvdashPushTestCase::ClientTx (Ptr<const mvdashClient> client, Ptr<const Packet> packet)
+{
+  std::vector<st_mvdashRequest> requests (packet->GetSize () / sizeof (st_mvdashRequest));
+  packet->CopyData ((uint8_t *) requests.data (), requests.size () * sizeof (st_mvdashRequest));
+  for (const st_mvdashRequest &req : requests)
+    {
+      if (req.id != pushid_cancel || m_promises.count (req.viewpoint) == 0)
+        {
+          continue;
+        }
+      const st_mvdashRequest &promise = m_promises[req.viewpoint];
+      st_cancel cancel = {req.viewpoint, req.timeIndex, promise.timeIndex + promise.push, promise.qualityIndex};
+      m_cancels.push_back (cancel);
+    }
+}
+
+void
+mvdashPushTestCase::Segment (Ptr<const mvdashClient> client, segmentEvent ev, st_mvdashRequest sinfo)
+{
+  if (ev == segev_startReceiving && sinfo.push > 0)
+    {
+      m_promises[sinfo.viewpoint] = sinfo;
+    }
+  else if (ev == segev_endReceiving)
+    {
+      m_received.insert (std::vector<int32_t> {sinfo.viewpoint, sinfo.timeIndex, sinfo.qualityIndex});
+    }
+}
+
+void
+mvdashPushTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  client->TraceConnectWithoutContext ("Tx", MakeCallback (&mvdashPushTestCase::ClientTx, this));
+  client->TraceConnectWithoutContext ("SegmentTrace", MakeCallback (&mvdashPushTestCase::Segment, this));
+}
+
+void
+mvdashPushTestCase::DoRun (void)
+{
+  // The viewpoint buffer test session, made longer, on a 300 ms round trip.
+  // The link keeps the main view downloading through the switch at time
+  // index 6, so the pushes of viewpoint 0 are cut short.
+  WriteContent ("push", 3, 24, 1000000, {50000, 100000, 200000}, "0\t0\n6\t2\n");
+  SetPointToPointLink ("3Mbps", "150ms");
+  SetBufferTargets (Seconds (30), Seconds (2));
+
+  // Pulled only
+  m_pushDepth = 0;
+  Ptr<mvdashClient> client = RunSession (Seconds (60));
+  NS_TEST_ASSERT_MSG_EQ (client->GetPlaybackData ().playbackIndex.size (), 24u, "The pulled session was not played through");
+  size_t nPulledOnly = client->GetDownloadData ().id.size ();
+  int64_t startPulledOnly = client->GetPlaybackData ().playbackStart[0];
+  EndSession ();
+
+  m_pushDepth = 2;
+  m_promises.clear ();
+  m_cancels.clear ();
+  m_received.clear ();
+  client = RunSession (Seconds (60));
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 24u, "The session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (play.playbackStart[23] - play.playbackStart[0], 23000000, "Playback stalled");
+  NS_TEST_EXPECT_MSG_EQ (play.mainViewpoint[6], 2, "The viewpoint switch was not played");
+  NS_TEST_EXPECT_MSG_GT (client->GetPushedSegments (), 0u, "No segment was pushed");
+  NS_TEST_EXPECT_MSG_GT (client->GetCancelledPushes (), 0u, "The pushes of the viewpoint left were not cancelled");
+  NS_TEST_EXPECT_MSG_EQ (m_cancels.empty (), false, "No cancel was sent");
+
+  // What the server dropped is not played at the quality it was promised at
+  for (const st_cancel &cancel : m_cancels)
+    {
+      for (int32_t t = cancel.first; t <= cancel.last && t < 24; t++)
+        {
+          if (m_received.count (std::vector<int32_t> {cancel.viewpoint, t, cancel.quality}) == 0)
+            {
+              NS_TEST_EXPECT_MSG_NE (play.qualityIndex[t][cancel.viewpoint], cancel.quality,
+                                     "A cancelled segment was played at the quality it was pushed at");
+            }
+        }
+    }
+
+  // Each request brings up to three segments of the main view
+  size_t nPulled = client->GetDownloadData ().id.size () - client->GetPushedSegments ();
+  NS_TEST_EXPECT_MSG_LT (nPulled, nPulledOnly, "Push did not save requests");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (play.playbackStart[0], startPulledOnly, "Push delayed the start-up");
+}
+
+void
+mvdashPushTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+  serverHelper.SetAttribute ("Push", BooleanValue (true));
+  clientHelper.SetAttribute ("PushDepth", UintegerValue (m_pushDepth));
+}
+
+class mvdashSwitchTestCase : public mvdashSessionTestCase
+{
+public:
+  mvdashSwitchTestCase ();
+  virtual ~mvdashSwitchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper);
+  virtual void ConnectTraces (Ptr<mvdashClient> client);
+  void ClientTx (Ptr<const mvdashClient> client, Ptr<const Packet> packet);
+
+  uint32_t m_pushDepth;
+  std::set<std::pair<int32_t, int32_t> > m_requested;  //!< {viewpoint, time index} of the regular requests
+  uint32_t m_nRefetches;
+  uint32_t m_nRefetchPushes;                          //!< refetches that asked for a push
+};
+
+mvdashSwitchTestCase::mvdashSwitchTestCase ()
+  : mvdashSessionTestCase ("Switch segments"),
+    m_pushDepth (0),
+    m_nRefetches (0),
+    m_nRefetchPushes (0)
+{
+}
+
+mvdashSwitchTestCase::~mvdashSwitchTestCase ()
+{
+}
+
+void
+mvdashSwitchTestCase::DoRun (void)
+{
+  // Two viewpoints, two one-second segments of two rates, in half-second
+  // switch segments
+  std::string mvFile = CreateTempDirFilename ("switch_mv.csv");
+  std::string switchFile = CreateTempDirFilename ("switch_si.csv");
+  std::ofstream mv (mvFile.c_str ());
+  mv << "2 2 1000000 2 2\n100\t200\t100\t200\n100\t200\t100\t200\n";
+  mv.close ();
+  std::ofstream si (switchFile.c_str ());
+  si << "2 2 500000\n60 60 110 120 60 60 110 110\n60 70 110 130 60 60 110 110\n";
+  si.close ();
+
+  t_videoDataGroup video;
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadManifest (mvFile, video), 2, "Manifest not read");
+  NS_TEST_ASSERT_MSG_EQ (mvdashReadSwitchManifest (switchFile, video), 2, "Switch segment sizes not read");
+  NS_TEST_EXPECT_MSG_EQ (video[0].switchDuration, 500000, "Wrong switch segment duration");
+  NS_TEST_EXPECT_MSG_EQ (video[0].switchSize[1][3], 130, "Wrong switch segment size");
+  NS_TEST_EXPECT_MSG_EQ (video[0].segmentSize[1][1], 200, "The regular segments changed");
+
+  t_videoDataGroup made;
+  mvdashReadManifest (mvFile, made);
+  mvdashMakeSwitchSegments (made, 500000, 0.5);
+  NS_TEST_EXPECT_MSG_EQ (made[1].switchSize[1][1], 150, "Wrong switch segment overhead");
+
+  // The viewer switches from viewpoint 0 to 2 as time index 6 of 2 s
+  // segments starts, with its side view copy at the lowest quality
+  WriteContent ("switch_session", 3, 12, 2000000, {100000, 200000, 400000}, "0\t0\n6\t2\n");
+  SetFluidLink (16000000, MilliSeconds (10));
+  SetBufferTargets (Seconds (12), Seconds (4));
+  Ptr<mvdashClient> client = RunSession (Seconds (60));
+
+  const struct playbackDataGroup &play = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (play.playbackIndex.size (), 12u, "The session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (play.playbackStart[11] - play.playbackStart[0], 22000000, "Playback stalled");
+  NS_TEST_ASSERT_MSG_EQ (play.mainViewpoint[6], 2, "The viewpoint switch was not played");
+  NS_TEST_EXPECT_MSG_EQ (play.qualityIndex[6][2], 0, "The switch was not played from the side view copy");
+  // Half a second after the switch, the new main view plays at the top quality
+  NS_TEST_EXPECT_MSG_EQ (play.switchPart[6], 1, "The switch segments did not bridge from the first one due");
+  NS_TEST_EXPECT_MSG_EQ (play.switchQuality[6], 2, "The switch segments are not at the main view quality");
+  NS_TEST_EXPECT_MSG_EQ (play.qualityIndex[7][2], 2, "The bridge did not lead to a regular segment at that quality");
+  NS_TEST_EXPECT_MSG_EQ (play.switchPart[5], 0, "Switch segments were played without a switch");
+  NS_TEST_EXPECT_MSG_GT (m_nRefetches, 0u, "The bridge did not fetch a buffered segment again");
+  EndSession ();
+
+  // With push, the segment the bridge fetches again asks for no push, and
+  // the main view request in flight is still awaited
+  m_pushDepth = 2;
+  m_requested.clear ();
+  m_nRefetches = 0;
+  SetPointToPointLink ("16Mbps", "10ms");
+  client = RunSession (Seconds (60));
+  const struct playbackDataGroup &pushed = client->GetPlaybackData ();
+  NS_TEST_ASSERT_MSG_EQ (pushed.playbackIndex.size (), 12u, "The pushed session was not played through");
+  NS_TEST_EXPECT_MSG_EQ (pushed.playbackStart[11] - pushed.playbackStart[0], 22000000, "The pushed session stalled");
+  NS_TEST_EXPECT_MSG_EQ (pushed.mainViewpoint[6], 2, "The viewpoint switch was not played with push");
+  NS_TEST_EXPECT_MSG_GT (client->GetPushedSegments (), 0u, "No segment was pushed");
+  NS_TEST_EXPECT_MSG_GT (m_nRefetches, 0u, "The bridge did not fetch a buffered segment again with push");
+  NS_TEST_EXPECT_MSG_EQ (m_nRefetchPushes, 0u, "A segment fetched again asked for a push");
+}
+
+void
+mvdashSwitchTestCase::ConfigureFeatures (mvdashClientHelper &clientHelper, mvdashServerHelper &serverHelper)
+{
+  clientHelper.SetAttribute ("SwitchDuration", TimeValue (MilliSeconds (500)));
+  clientHelper.SetAttribute ("PushDepth", UintegerValue (m_pushDepth));
+  serverHelper.SetAttribute ("Push", BooleanValue (m_pushDepth > 0));
+}
+
+void
+mvdashSwitchTestCase::ConnectTraces (Ptr<mvdashClient> client)
+{
+  client->TraceConnectWithoutContext ("Tx", MakeCallback (&mvdashSwitchTestCase::ClientTx, this));
+}
+
+void
+mvdashSwitchTestCase::ClientTx (Ptr<const mvdashClient> client, Ptr<const Packet> packet)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  std::vector<st_mvdashRequest> requests (packet->GetSize () / sizeof (st_mvdashRequest));
+  packet->CopyData ((uint8_t *) requests.data (), requests.size () * sizeof (st_mvdashRequest));
+  for (const st_mvdashRequest &req : requests)
+    {
+      if (req.id < 0 || req.part > 0)
+        {
+          continue;
+        }
+      if (!m_requested.insert (std::make_pair (req.viewpoint, req.timeIndex)).second)
+        {
+          m_nRefetches++;
+          m_nRefetchPushes += req.push > 0;
+        }
+    }
 }
 
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
@@ -59,10 +2551,52 @@ public:
 Etri_mvdashTestSuite::Etri_mvdashTestSuite ()
   : TestSuite ("etri_mvdash", UNIT)
 {
-  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new Etri_mvdashTestCase1, TestCase::QUICK);
+  // A delivered MB is 692 segments of 1446 bytes and 346 delayed ACKs, each
+  // across three links at two events a link: 6228 events.  It creates 1730
+  // packets: the responses, the ACKs and one per Recv of the client.  A TCP
+  // segment takes about 24 heap allocations (per link a queue disc item,
+  // two queue entries, a packet tag and two events, plus a packet copy at
+  // each router and the buffers at both ends) and its half ACK 12 more:
+  // 24900 a MB, at most 9960 for a video segment of 400 kB.  The records
+  // of a session are 2320 bytes for 50 segments, 46.4 a segment.  The
+  // budgets add 30% to the events, packets and allocations of one flow, 60%
+  // where flows share the bottleneck and lose packets, and 20% to the state.
+  //
+  // These budgets are derived, not measured: no ns-3 build was at hand when
+  // they were set.  To measure them, set a budget to 0 and run
+  // ./test.py -s etri_mvdash -v; the failed check prints the measured value.
+  // Then replace the derivation above with those values and their margins.
+  st_costBudget singleClient = {8100.0, 2250.0, 13000.0, 56.0};
+  st_costBudget sharedBottleneck = {10000.0, 2800.0, 16000.0, 56.0};
+
+  AddTestCase (new mvdashRunningStatTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashAliasTableTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashSegmentCacheTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashCacheServerTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashUdpTransportTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashBandwidthTraceTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashAccessLinkTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashCsmaAccessTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashMulticastTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashFluidNetworkTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashViewpointBufferTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashSideViewConnectionTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashConnectionPoolTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashQoeMonitorTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashEventRecorderTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashTracePlayerTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashGroupControllerTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashTileTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashResponsePackingTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashLayerTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashPushTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashSwitchTestCase, TestCase::QUICK);
+  AddTestCase (new mvdashCostTestCase ("Cost budget, one client", 1, singleClient), TestCase::QUICK);
+  AddTestCase (new mvdashCostTestCase ("Cost budget, four clients on one bottleneck", 4, sharedBottleneck),
+               TestCase::QUICK);
+  AddTestCase (new mvdashCostTestCase ("Cost budget, one client on three connections", 1, sharedBottleneck, 3),
+               TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static Etri_mvdashTestSuite setri_mvdashTestSuite;
-
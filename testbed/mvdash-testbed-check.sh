@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+# Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# Localhost check of the testbed: mvdash-testbed-server serves 8 concurrent
+# sessions of mvdash-testbed-client, 30 request groups each, and every
+# session must receive every byte it requested.
+#
+# Run from the top of the ns-3 tree, after ./waf build:
+#   sh contrib/etri_mvdash/testbed/mvdash-testbed-check.sh [sessions] [port]
+
+SESSIONS=${1:-8}
+PORT=${2:-9000}
+SEGMENTS=30
+DIR=$(mktemp -d /tmp/mvdash-testbed.XXXXXX)
+trap 'kill $SERVER 2>/dev/null; rm -rf "$DIR"' EXIT
+
+# Three viewpoints of 30 segments of 0.2 s, qualities of 25, 50 and 100 kB
+MV=$DIR/mv.csv
+echo "3 $SEGMENTS 200000 3 3 3" > "$MV"
+for t in $(seq $SEGMENTS); do
+  printf '25000\t50000\t100000\t25000\t50000\t100000\t25000\t50000\t100000\n' >> "$MV"
+done
+
+./waf --run "mvdash-testbed-server --address=127.0.0.1:$PORT --mvInfo=$MV --content=$DIR --generate=1 --duration=30" \
+  > "$DIR/server.log" 2>&1 &
+SERVER=$!
+sleep 5
+
+./waf --run "mvdash-testbed-client --address=127.0.0.1:$PORT --mvInfo=$MV --vpModel=free --sessions=$SESSIONS --rampUp=0" \
+  > "$DIR/client.log" 2>&1
+STATUS=$?
+# The server reports when its 30 s are up
+wait $SERVER
+cat "$DIR/client.log" "$DIR/server.log"
+
+# The last line of the client report: sessions, finished, failed, groups, bytes
+set -- $(tail -n 1 "$DIR/client.log")
+if [ $STATUS -ne 0 ] || [ "$2" != "$SESSIONS" ] || [ "$3" != 0 ] || [ "$4" != $((SESSIONS * SEGMENTS)) ]; then
+  echo "FAIL: $2 of $SESSIONS sessions finished, $3 failed, $4 groups"
+  exit 1
+fi
+# The last line of the server report: its protocol errors last
+ERRORS=$(tail -n 1 "$DIR/server.log" | awk '{print $NF}')
+if [ "$ERRORS" != 0 ]; then
+  echo "FAIL: $ERRORS protocol errors at the server"
+  exit 1
+fi
+echo "PASS: $SESSIONS sessions received every byte of $SEGMENTS groups"
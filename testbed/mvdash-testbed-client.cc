@@ -0,0 +1,662 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/mvdash_manifest.h"
+#include "ns3/mvdash-session.h"
+#include "mvdash-testbed.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <thread>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/*
+ * Load generator of the mvdash request protocol over real Linux sockets.
+ *
+ * Each session is the controller of mvdashClient (mvdashSession) with its
+ * viewpoint model and adaptation algorithm, on the wall clock, over one TCP
+ * connection to a testbed server.  The sessions are spread over a few
+ * threads, each a non-blocking edge-triggered epoll loop with a timer heap
+ * for the session starts and the ends of playback, so thousands of them
+ * share a handful of cores.  Session s draws the viewpoints of the
+ * simulated client of ClientId s.  With a tiled video (--tileInfo or
+ * --tileColumns, as given to the server), sessions request tiles, those
+ * expected in their viewport at the quality of the viewpoint; with a
+ * layered video (--layerInfo or --layered), the layers up to the quality.
+ *
+ * The report gives the throughput, the request latency (request sent to
+ * first byte), the group download time and the mean QoE of the sessions.
+ *
+ * On localhost, with mvdash-testbed-server listening on 127.0.0.1:9000:
+ *   ./waf --run "mvdash-testbed-client --sessions=1000 --threads=4 --rampUp=10"
+ */
+
+/// Random streams per viewpoint and viewport model, as in mvdashClient
+static const int64_t VIEW_MODEL_STREAMS = 2;
+static const int64_t VIEWPORT_MODEL_STREAMS = 2;
+static const int64_t VIEWPORT_STREAM_BASE = (int64_t) 1 << 32;
+
+/// Load generator counters, shared by the threads
+struct st_loadStats
+{
+  std::atomic<uint64_t> connected;
+  std::atomic<uint64_t> failed;           //!< sessions lost to a connection or protocol error
+  std::atomic<uint64_t> finished;
+  std::atomic<uint64_t> groups;           //!< request groups downloaded
+  std::atomic<uint64_t> bytes;
+};
+
+class mvdashTestbedClient;
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief One client session over a TCP connection of the load generator.
+ */
+class mvdashTestbedSession : public mvdashSession
+{
+public:
+  mvdashTestbedSession (const t_videoDataGroup &videoData, MultiView_Model *viewModel, std::string algorithm)
+    : mvdashSession (videoData, viewModel, algorithm),
+      fd (-1),
+      loop (0),
+      connected (false),
+      closed (false),
+      startTime (0),
+      timerEnd (-1),
+      outSent (0),
+      received (0)
+  {
+  }
+
+  int       fd;
+  mvdashTestbedClient *loop;
+  bool      connected;
+  bool      closed;             //!< finished or failed, the connection is gone
+  int64_t   startTime;          //!< microseconds of the monotonic clock
+  int64_t   timerEnd;           //!< end of playback in the timer heap, -1 if none
+  std::vector <uint8_t> out;    //!< requests not written yet
+  size_t    outSent;
+  int64_t   received;           //!< bytes of the pending group received
+
+protected:
+  virtual void SendRequests (const std::vector <st_mvdashRequest> &requests);
+};
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief One event loop of the load generator, with the sessions it drives.
+ */
+class mvdashTestbedClient
+{
+public:
+  mvdashTestbedClient (const struct sockaddr_in &server, st_loadStats &stats);
+  ~mvdashTestbedClient ();
+
+  /**
+   * \brief Drive session, connecting at startTime; the loop does not own it
+   */
+  void AddSession (mvdashTestbedSession *session, int64_t startTime);
+  /**
+   * \brief Run until every session is closed, or stop is set
+   */
+  void Run (const std::atomic<bool> &stop);
+  /**
+   * \brief Write the pending requests of a session
+   */
+  void Flush (mvdashTestbedSession *session);
+
+  /// Microseconds from the request to the first byte, one per group
+  const std::vector <int64_t> & GetFirstByteLatencies (void) const { return m_firstByte; }
+  /// Microseconds from the request to the last byte, one per group
+  const std::vector <int64_t> & GetDownloadTimes (void) const { return m_downloadTime; }
+
+private:
+  /// A session start or end of playback; which one the session state tells
+  typedef std::pair<int64_t, uint32_t> t_timer;
+
+  void Connect (uint32_t index);
+  void HandleConnected (uint32_t index);
+  void HandleRead (uint32_t index);
+  void HandleTimer (uint32_t index, int64_t time);
+  /**
+   * \brief Put the end of playback of a session in the timer heap once
+   */
+  void ArmPlaybackTimer (uint32_t index);
+  void CloseSession (uint32_t index, bool failed);
+
+  struct sockaddr_in m_server;
+  int       m_epollFd;
+  st_loadStats &m_stats;
+  std::vector <mvdashTestbedSession *> m_sessions;
+  std::priority_queue < t_timer, std::vector<t_timer>, std::greater<t_timer> > m_timers;
+  uint32_t  m_nOpen;            //!< sessions not closed yet
+  std::vector <int64_t> m_firstByte;
+  std::vector <int64_t> m_downloadTime;
+};
+
+void
+mvdashTestbedSession::SendRequests (const std::vector <st_mvdashRequest> &requests)
+{
+  const uint8_t *data = (const uint8_t *) requests.data ();
+  out.insert (out.end (), data, data + requests.size () * sizeof (st_mvdashRequest));
+  received = 0;
+  loop->Flush (this);
+}
+
+mvdashTestbedClient::mvdashTestbedClient (const struct sockaddr_in &server, st_loadStats &stats)
+  : m_server (server),
+    m_epollFd (epoll_create1 (EPOLL_CLOEXEC)),
+    m_stats (stats),
+    m_nOpen (0)
+{
+}
+
+mvdashTestbedClient::~mvdashTestbedClient ()
+{
+  for (mvdashTestbedSession *session : m_sessions)
+    {
+      if (session->fd >= 0)
+        {
+          close (session->fd);
+        }
+    }
+  close (m_epollFd);
+}
+
+void
+mvdashTestbedClient::AddSession (mvdashTestbedSession *session, int64_t startTime)
+{
+  session->loop = this;
+  session->startTime = startTime;
+  m_timers.push (t_timer (startTime, m_sessions.size ()));
+  m_sessions.push_back (session);
+  m_nOpen++;
+}
+
+void
+mvdashTestbedClient::Run (const std::atomic<bool> &stop)
+{
+  const int maxEvents = 256;
+  struct epoll_event events[maxEvents];
+
+  while (m_nOpen > 0 && !stop.load (std::memory_order_relaxed))
+    {
+      // Sleep until the next timer, rounded up to the millisecond, or 100 ms
+      int timeout = 100;
+      if (!m_timers.empty ())
+        {
+          int64_t wait = m_timers.top ().first - mvdashTestbedNow ();
+          timeout = wait <= 0 ? 0 : (int) std::min ((wait + 999) / 1000, (int64_t) timeout);
+        }
+      int n = epoll_wait (m_epollFd, events, maxEvents, timeout);
+      if (n < 0 && errno != EINTR)
+        {
+          std::cerr << "epoll_wait: " << strerror (errno) << std::endl;
+          return;
+        }
+      for (int i = 0; i < n; i++)
+        {
+          uint32_t index = events[i].data.u32;
+          mvdashTestbedSession *session = m_sessions[index];
+          if (session->closed)
+            {
+              continue;
+            }
+          if (events[i].events & EPOLLERR)
+            {
+              CloseSession (index, true);
+              continue;
+            }
+          if (!session->connected)
+            {
+              if (events[i].events & (EPOLLOUT | EPOLLHUP))
+                {
+                  HandleConnected (index);
+                }
+              continue;
+            }
+          if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+            {
+              HandleRead (index);
+            }
+          if ((events[i].events & EPOLLOUT) && !session->closed)
+            {
+              Flush (session);
+            }
+        }
+
+      int64_t now = mvdashTestbedNow ();
+      while (!m_timers.empty () && m_timers.top ().first <= now)
+        {
+          t_timer timer = m_timers.top ();
+          m_timers.pop ();
+          HandleTimer (timer.second, timer.first);
+        }
+    }
+}
+
+void
+mvdashTestbedClient::Connect (uint32_t index)
+{
+  mvdashTestbedSession *session = m_sessions[index];
+  int fd = socket (AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    {
+      std::cerr << "socket: " << strerror (errno) << std::endl;
+      CloseSession (index, true);
+      return;
+    }
+  // A request group is a few hundred bytes: do not wait for more
+  int one = 1;
+  setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof (one));
+  session->fd = fd;
+  if (connect (fd, (const struct sockaddr *) &m_server, sizeof (m_server)) < 0 && errno != EINPROGRESS)
+    {
+      CloseSession (index, true);
+      return;
+    }
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  ev.data.u32 = index;
+  epoll_ctl (m_epollFd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+void
+mvdashTestbedClient::HandleConnected (uint32_t index)
+{
+  mvdashTestbedSession *session = m_sessions[index];
+  int error = 0;
+  socklen_t len = sizeof (error);
+  if (getsockopt (session->fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0)
+    {
+      CloseSession (index, true);
+      return;
+    }
+  session->connected = true;
+  m_stats.connected++;
+  if (!session->Start (mvdashTestbedNow ()))
+    {
+      CloseSession (index, true);
+    }
+}
+
+void
+mvdashTestbedClient::Flush (mvdashTestbedSession *session)
+{
+  while (session->outSent < session->out.size ())
+    {
+      ssize_t n = send (session->fd, session->out.data () + session->outSent,
+                        session->out.size () - session->outSent, MSG_NOSIGNAL);
+      if (n < 0)
+        {
+          // EPOLLOUT, or EPOLLERR on a broken connection, comes back to it
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          return;
+        }
+      session->outSent += n;
+    }
+  session->out.clear ();
+  session->outSent = 0;
+}
+
+void
+mvdashTestbedClient::HandleRead (uint32_t index)
+{
+  mvdashTestbedSession *session = m_sessions[index];
+  static thread_local uint8_t buffer[262144];
+  bool peerClosed = false;
+
+  while (!session->closed)
+    {
+      ssize_t n = recv (session->fd, buffer, sizeof (buffer), 0);
+      if (n == 0)
+        {
+          peerClosed = true;
+          break;
+        }
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+              peerClosed = true;
+            }
+          break;
+        }
+      int64_t now = mvdashTestbedNow ();
+      const struct downloadDataGroup &downData = session->GetDownloadData ();
+      int64_t requestSent = downData.time.empty () ? now : downData.time.back ().requestSent;
+      // The server sends nothing unrequested: bytes are of the pending group only
+      if (session->received == 0)
+        {
+          session->DownloadStarted (now);
+          m_firstByte.push_back (now - requestSent);
+        }
+      session->received += n;
+      m_stats.bytes += n;
+      if (session->received > session->GetGroupBytes ())
+        {
+          std::cerr << "Session " << index << " received more than it requested" << std::endl;
+          CloseSession (index, true);
+          return;
+        }
+      if (session->received == session->GetGroupBytes ())
+        {
+          m_downloadTime.push_back (now - requestSent);
+          m_stats.groups++;
+          session->DownloadFinished (now);
+          ArmPlaybackTimer (index);
+        }
+    }
+  if (peerClosed && !session->closed)
+    {
+      CloseSession (index, true);
+    }
+}
+
+void
+mvdashTestbedClient::HandleTimer (uint32_t index, int64_t time)
+{
+  mvdashTestbedSession *session = m_sessions[index];
+  if (session->closed)
+    {
+      return;
+    }
+  if (session->fd < 0)
+    {
+      Connect (index);
+      return;
+    }
+  if (session->timerEnd != time)
+    {
+      return;
+    }
+  session->timerEnd = -1;
+  session->PlaybackFinished (mvdashTestbedNow ());
+  if (session->IsFinished ())
+    {
+      CloseSession (index, false);
+      return;
+    }
+  ArmPlaybackTimer (index);
+}
+
+void
+mvdashTestbedClient::ArmPlaybackTimer (uint32_t index)
+{
+  mvdashTestbedSession *session = m_sessions[index];
+  int64_t end = session->GetPlaybackEnd ();
+  if (end >= 0 && end != session->timerEnd)
+    {
+      session->timerEnd = end;
+      m_timers.push (t_timer (end, index));
+    }
+}
+
+void
+mvdashTestbedClient::CloseSession (uint32_t index, bool failed)
+{
+  mvdashTestbedSession *session = m_sessions[index];
+  if (session->closed)
+    {
+      return;
+    }
+  if (session->fd >= 0)
+    {
+      epoll_ctl (m_epollFd, EPOLL_CTL_DEL, session->fd, 0);
+      close (session->fd);
+      session->fd = -1;
+    }
+  session->closed = true;
+  m_nOpen--;
+  if (failed)
+    {
+      m_stats.failed++;
+    }
+  else
+    {
+      m_stats.finished++;
+    }
+}
+
+/// Value at quantile q of sorted values
+static double
+Percentile (const std::vector<int64_t> &sorted, double q)
+{
+  if (sorted.empty ())
+    return 0;
+  return sorted[std::min ((size_t) (q * sorted.size ()), sorted.size () - 1)];
+}
+
+static std::atomic<bool> g_stop (false);
+
+int main(int argc, char *argv[]) {
+    std::string address = "127.0.0.1:9000";
+    std::string mvInfo = "./contrib/etri_mvdash/multiviewvideo.csv";
+    std::string vpInfo = "./contrib/etri_mvdash/viewpoint_transition.csv";
+    std::string vpModel = "markovian";
+    std::string mvAlgo = "maximize_current";
+    uint32_t nSessions = 100;
+    uint32_t firstClientId = 0;
+    uint32_t nThreads = 1;
+    double   rampUp = 1;
+    double   duration = 0;
+    double   report = 0;
+    std::string qoeFile = "";
+    std::string tileInfo = "";
+    uint32_t tileColumns = 0;
+    uint32_t tileRows = 1;
+    std::string layerInfo = "";
+    bool     layered = false;
+    double   layerOverhead = 0.1;
+    uint32_t outQuality = 0;
+    double   viewportMargin = 15;
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH: load generator of the mvdash request protocol.\n");
+    cmd.AddValue ("address", "The address and port of the testbed server", address);
+    cmd.AddValue ("mvInfo", "The file containing Multi-View video source info", mvInfo);
+    cmd.AddValue ("vpInfo", "The viewpoint model parameters, or the viewpoint trace", vpInfo);
+    cmd.AddValue ("vpModel", "The View-point Switching Model: markovian, free or trace", vpModel);
+    cmd.AddValue ("mvAlgo", "The Multi-View Video Streaming Adaptation Algorithm", mvAlgo);
+    cmd.AddValue ("sessions", "Number of client sessions", nSessions);
+    cmd.AddValue ("firstClientId", "ClientId, and so viewpoint streams, of the first session", firstClientId);
+    cmd.AddValue ("threads", "Event loop threads", nThreads);
+    cmd.AddValue ("rampUp", "Seconds over which the session starts are spread", rampUp);
+    cmd.AddValue ("duration", "Stop after this many seconds, 0 to run until the sessions end or SIGINT", duration);
+    cmd.AddValue ("report", "Print the counters every this many seconds, 0 only at the end", report);
+    cmd.AddValue ("qoe", "Write the QoE of every session to this file", qoeFile);
+    cmd.AddValue ("tileInfo", "The tile sizes of the video, to request tiles", tileInfo);
+    cmd.AddValue ("tileColumns", "Without tileInfo, request tiles of equal size, this many columns of them", tileColumns);
+    cmd.AddValue ("tileRows", "Without tileInfo, the rows of tiles of equal size", tileRows);
+    cmd.AddValue ("layerInfo", "The layer sizes of a scalable video, to request layers", layerInfo);
+    cmd.AddValue ("layered", "Without layerInfo, request layers made of the rates of mvInfo", layered);
+    cmd.AddValue ("layerOverhead", "Without layerInfo, the share by which a layered level outgrows its rate", layerOverhead);
+    cmd.AddValue ("outQuality", "The quality index of the tiles outside the expected viewport", outQuality);
+    cmd.AddValue ("viewportMargin", "Degrees added around the viewport to predict the viewport of a request", viewportMargin);
+    cmd.Parse (argc, argv);
+
+    t_videoDataGroup videoData;
+    if (mvdashReadManifest (mvInfo, videoData) <= 0) {
+        std::cerr << "Cannot read " << mvInfo << std::endl;
+        return 1;
+    }
+    if (!mvdashTestbedReadTiles (tileInfo, tileColumns, tileRows, videoData)) {
+        std::cerr << "Cannot read " << tileInfo << std::endl;
+        return 1;
+    }
+    if (!mvdashTestbedReadLayers (layerInfo, layered, layerOverhead, videoData)) {
+        std::cerr << "Cannot read " << layerInfo << std::endl;
+        return 1;
+    }
+    if (!videoData[0].tileSize.empty () && !videoData[0].layerSize.empty ()) {
+        std::cerr << "A video is tiled or layered, not both" << std::endl;
+        return 1;
+    }
+    struct sockaddr_in sa;
+    if (!mvdashTestbedParseAddress (address, sa)) {
+        std::cerr << "Invalid address " << address << std::endl;
+        return 1;
+    }
+    nThreads = std::max (std::min (nThreads, nSessions), 1u);
+
+    // One descriptor per session, plus the epoll ones
+    struct rlimit files;
+    if (getrlimit (RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < nSessions + 64) {
+        files.rlim_cur = std::min ((rlim_t) nSessions + 64, files.rlim_max);
+        setrlimit (RLIMIT_NOFILE, &files);
+        if (files.rlim_cur < nSessions + 64)
+            std::cerr << "Open files limited to " << files.rlim_cur << ": some sessions will fail" << std::endl;
+    }
+
+    // The models draw from ns-3 random streams: build them all here, the
+    // threads only drive the sessions
+    std::vector <mvdashTestbedSession *> sessions;
+    for (uint32_t s = 0; s < nSessions; s++) {
+        MultiView_Model *viewModel = mvdashCreateViewpointModel (vpModel, vpInfo, videoData.size ());
+        if (!viewModel) {
+            std::cerr << "Unknown viewpoint model " << vpModel << std::endl;
+            return 1;
+        }
+        viewModel->AssignStreams (VIEW_MODEL_STREAMS * (int64_t) (firstClientId + s));
+        sessions.push_back (new mvdashTestbedSession (videoData, viewModel, mvAlgo));
+        if (!videoData[0].tileSize.empty ()) {
+            Ptr<Viewport_Model> viewport = CreateObject<Viewport_Model> ();
+            viewport->AssignStreams (VIEWPORT_STREAM_BASE + VIEWPORT_MODEL_STREAMS * (int64_t) (firstClientId + s));
+            sessions.back ()->SetTiling (viewport, viewportMargin, outQuality);
+        }
+    }
+
+    signal (SIGPIPE, SIG_IGN);
+    sigset_t signals;
+    sigemptyset (&signals);
+    sigaddset (&signals, SIGINT);
+    sigaddset (&signals, SIGTERM);
+    pthread_sigmask (SIG_BLOCK, &signals, 0);
+
+    st_loadStats stats = {};
+    int64_t start = mvdashTestbedNow ();
+    std::vector <mvdashTestbedClient *> loops;
+    for (uint32_t t = 0; t < nThreads; t++)
+        loops.push_back (new mvdashTestbedClient (sa, stats));
+    for (uint32_t s = 0; s < nSessions; s++)
+        loops[s % nThreads]->AddSession (sessions[s], start + (int64_t) (rampUp * 1e6 * s / nSessions));
+
+    std::atomic<uint32_t> running (nThreads);
+    std::vector <std::thread> workers;
+    for (mvdashTestbedClient *loop : loops) {
+        workers.push_back (std::thread ([loop, &running] () {
+            loop->Run (g_stop);
+            running--;
+        }));
+    }
+    std::cout << nSessions << " sessions of " << videoData.size () << " viewpoints to " << address
+              << " on " << nThreads << " threads" << std::endl;
+
+    int64_t lastReport = start;
+    uint64_t lastBytes = 0;
+    while (running > 0) {
+        struct timespec tick = {0, 200000000};
+        if (sigtimedwait (&signals, 0, &tick) > 0)
+            break;
+        int64_t now = mvdashTestbedNow ();
+        if (duration > 0 && now - start >= duration * 1e6)
+            break;
+        if (report > 0 && now - lastReport >= report * 1e6) {
+            uint64_t bytes = stats.bytes;
+            std::cout << (now - start) / 1e6 << " s: " << stats.connected << " connected, "
+                      << stats.finished << " finished, " << stats.failed << " failed, "
+                      << (bytes - lastBytes) * 8.0 / (now - lastReport) << " Mbps" << std::endl;
+            lastReport = now;
+            lastBytes = bytes;
+        }
+    }
+    g_stop = true;
+    for (std::thread &worker : workers)
+        worker.join ();
+    int64_t end = mvdashTestbedNow ();
+
+    std::vector <int64_t> firstByte, downloadTime;
+    for (mvdashTestbedClient *loop : loops) {
+        firstByte.insert (firstByte.end (), loop->GetFirstByteLatencies ().begin (), loop->GetFirstByteLatencies ().end ());
+        downloadTime.insert (downloadTime.end (), loop->GetDownloadTimes ().begin (), loop->GetDownloadTimes ().end ());
+        delete loop;
+    }
+    std::sort (firstByte.begin (), firstByte.end ());
+    std::sort (downloadTime.begin (), downloadTime.end ());
+
+    // Sessions cut by the end of the run are summarized at that time
+    std::ofstream qoe;
+    if (!qoeFile.empty ()) {
+        qoe.open (qoeFile.c_str ());
+        mvdashQoeMonitor::WriteHeader (qoe, "session");
+    }
+    double startup = 0, stallTime = 0, bitrate = 0;
+    uint64_t stalls = 0, started = 0;
+    for (uint32_t s = 0; s < nSessions; s++) {
+        st_mvdashQoeSummary summary = sessions[s]->GetSummary (end);
+        if (qoe.is_open ())
+            mvdashQoeMonitor::WriteRow (qoe, std::to_string (firstClientId + s), summary);
+        if (summary.startupDelay >= 0) {
+            started++;
+            startup += summary.startupDelay;
+            stallTime += summary.stallTime;
+            stalls += summary.nStalls;
+            bitrate += summary.meanBitrate;
+        }
+        delete sessions[s];
+    }
+
+    double seconds = (end - start) / 1e6;
+    std::cout << "sessions\tfinished\tfailed\tgroups\tbytes\tMbps"
+              << "\tfirst_byte_ms\tp50\tp99\tdownload_ms\tp50\tp99"
+              << "\tstartup_ms\tstalls\tstall_ms\tbitrate_kbps\n"
+              << nSessions << "\t" << stats.finished << "\t" << stats.failed << "\t" << stats.groups << "\t"
+              << stats.bytes << "\t" << stats.bytes * 8.0 / seconds / 1e6;
+    for (const std::vector<int64_t> *values : {&firstByte, &downloadTime}) {
+        double sum = 0;
+        for (int64_t v : *values)
+            sum += v;
+        std::cout << "\t" << (values->empty () ? 0.0 : sum / values->size () / 1000.0)
+                  << "\t" << Percentile (*values, 0.5) / 1000.0 << "\t" << Percentile (*values, 0.99) / 1000.0;
+    }
+    if (started)
+        std::cout << "\t" << startup / started / 1000.0 << "\t" << (double) stalls / started
+                  << "\t" << stallTime / started / 1000.0 << "\t" << bitrate / started / 1000.0;
+    else
+        std::cout << "\t0\t0\t0\t0";
+    std::cout << std::endl;
+    return stats.failed ? 1 : 0;
+}
@@ -0,0 +1,605 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-module.h"
+#include "ns3/mvdash_manifest.h"
+#include "mvdash-testbed.h"
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/*
+ * The mvdashServer request protocol over real Linux sockets.
+ *
+ * Clients send st_mvdashRequest records on a TCP connection and receive
+ * the segments back to back, in request order, with no framing, exactly as
+ * from mvdashServer.  The payload comes from the content files of
+ * mvdashTestbedContent (--generate makes sparse ones from the manifest).
+ *
+ * Each thread runs a non-blocking edge-triggered epoll loop on its own
+ * SO_REUSEPORT listening socket.  The client marks the requests of its main
+ * view (mainView); a connection whose next segment is a main view is
+ * always written before one whose next segment is a side view, so side views only get what main views leave, as with the
+ * low priority connection of mvdashClient.  TCP_NOTSENT_LOWAT keeps the
+ * kernel send buffers short so that this order holds on the wire.
+ *
+ * Large segments go out by sendfile; runs of small ones, such as the tiles
+ * of a tiled video, by one gathered write from the mapping per quantum, so
+ * the system calls do not grow with the number of tiles.
+ *
+ * On localhost:
+ *   ./waf --run "mvdash-testbed-server --content=/tmp/mvdash --generate=1 --duration=60"
+ * and point a client of the protocol at 127.0.0.1:9000.  mvdash-testbed-check.sh
+ * runs 8 sessions of mvdash-testbed-client against it and checks that each
+ * received every byte.
+ */
+
+/// Server counters, shared by the threads
+struct st_serverStats
+{
+  std::atomic<uint64_t> connections;
+  std::atomic<uint64_t> requests;
+  std::atomic<uint64_t> segments;         //!< segments sent completely
+  std::atomic<uint64_t> bytes;
+  std::atomic<uint64_t> serviceTime;      //!< microseconds from request arrival to the last byte, summed over segments
+  std::atomic<uint64_t> protocolErrors;
+};
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief One event loop of the testbed server, with the state machines of its connections.
+ */
+class mvdashTestbedServer
+{
+public:
+  mvdashTestbedServer (const mvdashTestbedContent &content, int listenFd, st_serverStats &stats);
+  ~mvdashTestbedServer ();
+
+  void SetZeroCopy (bool zeroCopy) { m_zeroCopy = zeroCopy; }
+  /// Bytes written to a connection before the next one gets its turn
+  void SetQuantum (uint32_t quantum) { m_quantum = quantum; }
+  void SetNotSentLowat (uint32_t lowat) { m_notSentLowat = lowat; }
+  /**
+   * \brief Serve until stop is set
+   */
+  void Run (const std::atomic<bool> &stop);
+
+private:
+  /// States of a connection
+  enum connState
+  {
+    connIdle,           //!< nothing to send
+    connSending,        //!< segments pending and the socket writable: waits in a ready queue
+    connBlocked,        //!< segments pending, socket buffer full: waits for EPOLLOUT
+    connClosed
+  };
+
+  struct st_queuedSegment
+  {
+    st_mvdashRequest req;
+    uint8_t  priority;          //!< 0 for a main view, 1 for a side view
+    int64_t  arrival;           //!< microseconds
+  };
+
+  struct st_connection
+  {
+    connState state;
+    bool     queued;            //!< in a ready queue
+    uint8_t  partial[sizeof (st_mvdashRequest)];   //!< leading bytes of a request split by TCP
+    uint32_t nPartial;
+    std::deque <st_queuedSegment> segments;
+    int64_t  sent;              //!< bytes of the head segment sent
+  };
+
+  void Accept (void);
+  void HandleRead (int fd);
+  /**
+   * \brief Write up to one quantum of the pending segments of fd
+   */
+  void Send (int fd);
+  /**
+   * \brief Gather the rest of the head segment and the small segments after it
+   * \returns the bytes written, or -1 with errno set
+   */
+  ssize_t SendGathered (int fd, st_connection &conn, int64_t budget);
+  void MakeReady (int fd);
+  void CloseConnection (int fd);
+
+  const mvdashTestbedContent &m_content;
+  int       m_listenFd;
+  int       m_epollFd;
+  st_serverStats &m_stats;
+  bool      m_zeroCopy;
+  uint32_t  m_quantum;
+  uint32_t  m_notSentLowat;
+  std::vector <st_connection> m_connections;   //!< by descriptor
+  std::deque <int> m_ready[2];                  //!< writable connections, by priority of their head segment
+};
+
+mvdashTestbedServer::mvdashTestbedServer (const mvdashTestbedContent &content, int listenFd, st_serverStats &stats)
+  : m_content (content),
+    m_listenFd (listenFd),
+    m_epollFd (epoll_create1 (EPOLL_CLOEXEC)),
+    m_stats (stats),
+    m_zeroCopy (true),
+    m_quantum (65536),
+    m_notSentLowat (131072)
+{
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.fd = m_listenFd;
+  epoll_ctl (m_epollFd, EPOLL_CTL_ADD, m_listenFd, &ev);
+}
+
+mvdashTestbedServer::~mvdashTestbedServer ()
+{
+  for (size_t fd = 0; fd < m_connections.size (); fd++)
+    {
+      if (m_connections[fd].state != connClosed)
+        {
+          close (fd);
+        }
+    }
+  close (m_epollFd);
+  close (m_listenFd);
+}
+
+void
+mvdashTestbedServer::Run (const std::atomic<bool> &stop)
+{
+  const int maxEvents = 256;
+  struct epoll_event events[maxEvents];
+
+  while (!stop.load (std::memory_order_relaxed))
+    {
+      // Do not sleep while some connection can be written
+      bool ready = !m_ready[0].empty () || !m_ready[1].empty ();
+      int n = epoll_wait (m_epollFd, events, maxEvents, ready ? 0 : 100);
+      if (n < 0 && errno != EINTR)
+        {
+          std::cerr << "epoll_wait: " << strerror (errno) << std::endl;
+          return;
+        }
+      for (int i = 0; i < n; i++)
+        {
+          int fd = events[i].data.fd;
+          if (fd == m_listenFd)
+            {
+              Accept ();
+              continue;
+            }
+          if (m_connections[fd].state == connClosed)
+            {
+              continue;
+            }
+          if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+              CloseConnection (fd);
+              continue;
+            }
+          if (events[i].events & (EPOLLIN | EPOLLRDHUP))
+            {
+              HandleRead (fd);
+            }
+          if ((events[i].events & EPOLLOUT) && m_connections[fd].state == connBlocked)
+            {
+              m_connections[fd].state = connSending;
+              MakeReady (fd);
+            }
+        }
+
+      // Strict priority between the queues, round robin within one; a bounded
+      // number of turns keeps the loop responsive to new requests
+      for (int turn = 0; turn < maxEvents; turn++)
+        {
+          std::deque<int> &queue = m_ready[0].empty () ? m_ready[1] : m_ready[0];
+          if (queue.empty ())
+            {
+              break;
+            }
+          int fd = queue.front ();
+          queue.pop_front ();
+          m_connections[fd].queued = false;
+          if (m_connections[fd].state == connSending)
+            {
+              Send (fd);
+            }
+          if (m_connections[fd].state == connSending)
+            {
+              MakeReady (fd);
+            }
+        }
+    }
+}
+
+void
+mvdashTestbedServer::Accept (void)
+{
+  while (true)
+    {
+      int fd = accept4 (m_listenFd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0)
+        {
+          if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+              std::cerr << "accept: " << strerror (errno) << std::endl;
+            }
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          return;
+        }
+      if (m_notSentLowat)
+        {
+          setsockopt (fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &m_notSentLowat, sizeof (m_notSentLowat));
+        }
+      if ((size_t) fd >= m_connections.size ())
+        {
+          st_connection closed;
+          closed.state = connClosed;
+          closed.queued = false;
+          closed.nPartial = 0;
+          closed.sent = 0;
+          m_connections.resize (fd + 1, closed);
+        }
+      st_connection &conn = m_connections[fd];
+      conn.state = connIdle;
+      conn.nPartial = 0;
+      conn.sent = 0;
+      conn.segments.clear ();
+
+      struct epoll_event ev = {};
+      ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+      ev.data.fd = fd;
+      epoll_ctl (m_epollFd, EPOLL_CTL_ADD, fd, &ev);
+      m_stats.connections++;
+    }
+}
+
+void
+mvdashTestbedServer::HandleRead (int fd)
+{
+  st_connection &conn = m_connections[fd];
+  std::vector <st_mvdashRequest> batch;
+  uint8_t buffer[16384];
+  bool peerClosed = false;
+
+  while (true)
+    {
+      ssize_t n = recv (fd, buffer, sizeof (buffer), 0);
+      if (n == 0)
+        {
+          peerClosed = true;
+          break;
+        }
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+              peerClosed = true;
+            }
+          break;
+        }
+      // Requests may be split across reads; keep the tail for the next one
+      ssize_t i = 0;
+      while (i < n)
+        {
+          uint32_t take = std::min ((uint32_t) (n - i), (uint32_t) sizeof (st_mvdashRequest) - conn.nPartial);
+          memcpy (conn.partial + conn.nPartial, buffer + i, take);
+          conn.nPartial += take;
+          i += take;
+          if (conn.nPartial == sizeof (st_mvdashRequest))
+            {
+              st_mvdashRequest req;
+              memcpy (&req, conn.partial, sizeof (req));
+              batch.push_back (req);
+              conn.nPartial = 0;
+            }
+        }
+    }
+
+  if (!batch.empty ())
+    {
+      for (const st_mvdashRequest &req : batch)
+        {
+          if (!m_content.IsValid (req))
+            {
+              std::cerr << "Invalid request <" << req.viewpoint << "," << req.timeIndex << ","
+                        << req.qualityIndex << "," << req.segmentSize << "," << req.tile << ">, closing" << std::endl;
+              m_stats.protocolErrors++;
+              CloseConnection (fd);
+              return;
+            }
+        }
+      int64_t now = mvdashTestbedNow ();
+      for (const st_mvdashRequest &req : batch)
+        {
+          st_queuedSegment seg = {req, (uint8_t) (req.mainView ? 0 : 1), now};
+          conn.segments.push_back (seg);
+          m_content.Prefetch (req);
+        }
+      m_stats.requests += batch.size ();
+      if (conn.state == connIdle)
+        {
+          conn.state = connSending;
+          MakeReady (fd);
+        }
+    }
+  if (peerClosed)
+    {
+      CloseConnection (fd);
+    }
+}
+
+// Segments below this size are gathered into one write rather than sent one
+// sendfile each; up to GATHER_SEGMENTS of them per write
+static const int64_t GATHER_LIMIT = 16384;
+static const int GATHER_SEGMENTS = 64;
+
+void
+mvdashTestbedServer::Send (int fd)
+{
+  st_connection &conn = m_connections[fd];
+  int64_t budget = m_quantum;
+
+  while (budget > 0 && !conn.segments.empty ())
+    {
+      const st_queuedSegment &head = conn.segments.front ();
+      ssize_t n;
+      if (m_zeroCopy && head.req.segmentSize - conn.sent >= GATHER_LIMIT)
+        {
+          size_t len = std::min (head.req.segmentSize - conn.sent, budget);
+          off_t offset = m_content.GetOffset (head.req) + conn.sent;
+          n = sendfile (fd, m_content.GetFd (head.req), &offset, len);
+        }
+      else
+        {
+          n = SendGathered (fd, conn, budget);
+        }
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+              conn.state = connBlocked;
+              return;
+            }
+          CloseConnection (fd);
+          return;
+        }
+      conn.sent += n;
+      budget -= n;
+      m_stats.bytes += n;
+      // A write may end several segments
+      int64_t now = mvdashTestbedNow ();
+      while (!conn.segments.empty () && conn.sent >= conn.segments.front ().req.segmentSize)
+        {
+          conn.sent -= conn.segments.front ().req.segmentSize;
+          m_stats.segments++;
+          m_stats.serviceTime += now - conn.segments.front ().arrival;
+          conn.segments.pop_front ();
+        }
+    }
+  if (conn.segments.empty ())
+    {
+      conn.state = connIdle;
+    }
+}
+
+ssize_t
+mvdashTestbedServer::SendGathered (int fd, st_connection &conn, int64_t budget)
+{
+  struct iovec iov[GATHER_SEGMENTS];
+  int nIov = 0;
+  int64_t len = 0;
+  int64_t skip = conn.sent;
+  for (std::deque<st_queuedSegment>::const_iterator it = conn.segments.begin ();
+       it != conn.segments.end () && nIov < GATHER_SEGMENTS && len < budget; ++it)
+    {
+      // Large segments are left to sendfile
+      if (nIov > 0 && m_zeroCopy && it->req.segmentSize >= GATHER_LIMIT)
+        {
+          break;
+        }
+      int64_t take = std::min (it->req.segmentSize - skip, budget - len);
+      iov[nIov].iov_base = (void *) (m_content.GetData (it->req) + skip);
+      iov[nIov].iov_len = take;
+      nIov++;
+      len += take;
+      skip = 0;
+    }
+  struct msghdr msg = {};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = nIov;
+  return sendmsg (fd, &msg, MSG_NOSIGNAL);
+}
+
+void
+mvdashTestbedServer::MakeReady (int fd)
+{
+  st_connection &conn = m_connections[fd];
+  if (conn.queued || conn.segments.empty ())
+    {
+      return;
+    }
+  conn.queued = true;
+  m_ready[conn.segments.front ().priority].push_back (fd);
+}
+
+void
+mvdashTestbedServer::CloseConnection (int fd)
+{
+  st_connection &conn = m_connections[fd];
+  if (conn.state == connClosed)
+    {
+      return;
+    }
+  epoll_ctl (m_epollFd, EPOLL_CTL_DEL, fd, 0);
+  close (fd);
+  conn.state = connClosed;
+  conn.segments.clear ();
+  // A ready queue may still hold fd: queued stays set until it is popped, so
+  // a new connection reusing the descriptor is queued at most once
+}
+
+static std::atomic<bool> g_stop (false);
+
+int main(int argc, char *argv[]) {
+    std::string address = "0.0.0.0:9000";
+    std::string mvInfo = "./contrib/etri_mvdash/multiviewvideo.csv";
+    std::string contentDir = "";
+    std::string tileInfo = "";
+    uint32_t tileColumns = 0;
+    uint32_t tileRows = 1;
+    std::string layerInfo = "";
+    bool     layered = false;
+    double   layerOverhead = 0.1;
+    bool     generate = false;
+    bool     zeroCopy = true;
+    uint32_t nThreads = 1;
+    uint32_t quantum = 65536;
+    uint32_t notSentLowat = 131072;
+    double   duration = 0;
+    double   report = 0;
+
+    CommandLine cmd;
+    cmd.Usage ("ETRI Multi-View Video DASH: testbed server of the mvdash request protocol.\n");
+    cmd.AddValue ("address", "The address and port to listen on", address);
+    cmd.AddValue ("mvInfo", "The file containing Multi-View video source info", mvInfo);
+    cmd.AddValue ("content", "The directory of the content files, vp<v>_q<q>.bin", contentDir);
+    cmd.AddValue ("tileInfo", "The tile sizes of the video, to serve tiles", tileInfo);
+    cmd.AddValue ("tileColumns", "Without tileInfo, serve tiles of equal size, this many columns of them", tileColumns);
+    cmd.AddValue ("tileRows", "Without tileInfo, the rows of tiles of equal size", tileRows);
+    cmd.AddValue ("layerInfo", "The layer sizes of a scalable video, to serve layers", layerInfo);
+    cmd.AddValue ("layered", "Without layerInfo, serve layers made of the rates of mvInfo", layered);
+    cmd.AddValue ("layerOverhead", "Without layerInfo, the share by which a layered level outgrows its rate", layerOverhead);
+    cmd.AddValue ("generate", "Create missing content files, sparse, from mvInfo", generate);
+    cmd.AddValue ("zeroCopy", "1 - sendfile from the content files, 0 - send from their mapping", zeroCopy);
+    cmd.AddValue ("threads", "Event loop threads", nThreads);
+    cmd.AddValue ("quantum", "Bytes written to a connection before the next one gets its turn", quantum);
+    cmd.AddValue ("notSentLowat", "TCP_NOTSENT_LOWAT of the connections, 0 for the system default", notSentLowat);
+    cmd.AddValue ("duration", "Stop after this many seconds, 0 to run until SIGINT or SIGTERM", duration);
+    cmd.AddValue ("report", "Print the counters every this many seconds, 0 only at the end", report);
+    cmd.Parse (argc, argv);
+
+    t_videoDataGroup videoData;
+    if (mvdashReadManifest (mvInfo, videoData) <= 0) {
+        std::cerr << "Cannot read " << mvInfo << std::endl;
+        return 1;
+    }
+    if (!mvdashTestbedReadTiles (tileInfo, tileColumns, tileRows, videoData)) {
+        std::cerr << "Cannot read " << tileInfo << std::endl;
+        return 1;
+    }
+    if (!mvdashTestbedReadLayers (layerInfo, layered, layerOverhead, videoData)) {
+        std::cerr << "Cannot read " << layerInfo << std::endl;
+        return 1;
+    }
+    if (!videoData[0].tileSize.empty () && !videoData[0].layerSize.empty ()) {
+        std::cerr << "A video is tiled or layered, not both" << std::endl;
+        return 1;
+    }
+    mvdashTestbedContent content;
+    if (contentDir.empty () || !content.Open (contentDir, videoData, generate)) {
+        std::cerr << "No content: set --content, and --generate=1 to create it" << std::endl;
+        return 1;
+    }
+    struct sockaddr_in sa;
+    if (!mvdashTestbedParseAddress (address, sa)) {
+        std::cerr << "Invalid address " << address << std::endl;
+        return 1;
+    }
+
+    // Workers inherit the blocked signals; only this thread waits for them
+    signal (SIGPIPE, SIG_IGN);
+    sigset_t signals;
+    sigemptyset (&signals);
+    sigaddset (&signals, SIGINT);
+    sigaddset (&signals, SIGTERM);
+    pthread_sigmask (SIG_BLOCK, &signals, 0);
+
+    st_serverStats stats = {};
+    std::vector <std::thread> workers;
+    for (uint32_t t = 0; t < std::max (nThreads, 1u); t++) {
+        int listenFd = mvdashTestbedListen (sa, true, 4096);
+        if (listenFd < 0) {
+            std::cerr << "Cannot listen on " << address << ": " << strerror (errno) << std::endl;
+            g_stop = true;
+            break;
+        }
+        workers.push_back (std::thread ([&content, &stats, listenFd, zeroCopy, quantum, notSentLowat] () {
+            mvdashTestbedServer server (content, listenFd, stats);
+            server.SetZeroCopy (zeroCopy);
+            server.SetQuantum (quantum);
+            server.SetNotSentLowat (notSentLowat);
+            server.Run (g_stop);
+        }));
+    }
+    std::cout << "Serving " << videoData.size () << " viewpoints on " << address
+              << " with " << workers.size () << " threads" << std::endl;
+
+    int64_t start = mvdashTestbedNow ();
+    int64_t lastReport = start;
+    uint64_t lastBytes = 0;
+    while (!g_stop) {
+        struct timespec tick = {0, 200000000};
+        if (sigtimedwait (&signals, 0, &tick) > 0)
+            break;
+        int64_t now = mvdashTestbedNow ();
+        if (duration > 0 && now - start >= duration * 1e6)
+            break;
+        if (report > 0 && now - lastReport >= report * 1e6) {
+            uint64_t bytes = stats.bytes;
+            std::cout << (now - start) / 1e6 << " s: " << stats.connections << " connections, "
+                      << stats.segments << " segments, "
+                      << (bytes - lastBytes) * 8.0 / (now - lastReport) << " Mbps" << std::endl;
+            lastReport = now;
+            lastBytes = bytes;
+        }
+    }
+    g_stop = true;
+    for (std::thread &worker : workers)
+        worker.join ();
+
+    double seconds = (mvdashTestbedNow () - start) / 1e6;
+    std::cout << "connections\trequests\tsegments\tbytes\tMbps\tservice_ms\terrors\n"
+              << stats.connections << "\t" << stats.requests << "\t" << stats.segments << "\t"
+              << stats.bytes << "\t" << stats.bytes * 8.0 / seconds / 1e6 << "\t"
+              << (stats.segments ? stats.serviceTime / 1000.0 / stats.segments : 0.0) << "\t"
+              << stats.protocolErrors << std::endl;
+    return 0;
+}
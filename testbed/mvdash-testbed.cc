@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mvdash-testbed.h"
+#include "ns3/mvdash_manifest.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+int64_t
+mvdashTestbedNow (void)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds> (
+    std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+bool
+mvdashTestbedParseAddress (std::string address, struct sockaddr_in &sa)
+{
+  size_t colon = address.rfind (':');
+  if (colon == std::string::npos)
+    {
+      return false;
+    }
+  sa = sockaddr_in ();
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons ((uint16_t) std::atoi (address.c_str () + colon + 1));
+  std::string host = address.substr (0, colon);
+  if (host.empty ())
+    {
+      host = "0.0.0.0";
+    }
+  return inet_pton (AF_INET, host.c_str (), &sa.sin_addr) == 1;
+}
+
+bool
+mvdashTestbedSetNonBlocking (int fd)
+{
+  int flags = fcntl (fd, F_GETFL, 0);
+  return flags >= 0 && fcntl (fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+int
+mvdashTestbedListen (const struct sockaddr_in &sa, bool reusePort, int backlog)
+{
+  int fd = socket (AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    {
+      return -1;
+    }
+  int one = 1;
+  setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+  if (reusePort)
+    {
+      setsockopt (fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof (one));
+    }
+  if (bind (fd, (const struct sockaddr *) &sa, sizeof (sa)) < 0 || listen (fd, backlog) < 0)
+    {
+      close (fd);
+      return -1;
+    }
+  return fd;
+}
+
+bool
+mvdashTestbedReadTiles (std::string tileInfo, uint32_t columns, uint32_t rows, t_videoDataGroup &videoData)
+{
+  if (!tileInfo.empty ())
+    {
+      return mvdashReadTileManifest (tileInfo, videoData) > 0;
+    }
+  if (columns > 0 && rows > 0)
+    {
+      mvdashSplitTiles (videoData, columns, rows);
+    }
+  return true;
+}
+
+bool
+mvdashTestbedReadLayers (std::string layerInfo, bool layered, double overhead, t_videoDataGroup &videoData)
+{
+  if (!layerInfo.empty ())
+    {
+      return mvdashReadLayerManifest (layerInfo, videoData) > 0;
+    }
+  if (layered)
+    {
+      mvdashSplitLayers (videoData, overhead);
+    }
+  return true;
+}
+
+mvdashTestbedContent::mvdashTestbedContent ()
+  : m_videoData (0)
+{
+}
+
+mvdashTestbedContent::~mvdashTestbedContent ()
+{
+  Close ();
+}
+
+std::string
+mvdashTestbedContent::GetFileName (std::string dir, int32_t viewpoint, int32_t quality)
+{
+  std::ostringstream name;
+  name << dir << "/vp" << viewpoint << "_q" << quality << ".bin";
+  return name.str ();
+}
+
+bool
+mvdashTestbedContent::Open (std::string dir, const t_videoDataGroup &videoData, bool create)
+{
+  Close ();
+  m_videoData = &videoData;
+  m_reps.resize (videoData.size ());
+  for (size_t vp = 0; vp < videoData.size (); vp++)
+    {
+      for (size_t q = 0; q < videoData[vp].segmentSize.size (); q++)
+        {
+          bool tiled = !videoData[vp].tileSize.empty ();
+          bool layered = !videoData[vp].layerSize.empty ();
+          st_representation rep = {-1, 0, 0, tiled ? videoData[vp].tileColumns * videoData[vp].tileRows : 1,
+                                   std::vector<int64_t> (1, 0)};
+          const std::vector<int64_t> &sizes = tiled ? videoData[vp].tileSize[q]
+                                              : layered ? videoData[vp].layerSize[q] : videoData[vp].segmentSize[q];
+          for (int64_t size : sizes)
+            {
+              rep.offsets.push_back (rep.offsets.back () + size);
+            }
+          m_reps[vp].push_back (rep);
+          st_representation &r = m_reps[vp].back ();
+
+          std::string name = GetFileName (dir, vp, q);
+          r.fd = open (name.c_str (), O_RDONLY | O_CLOEXEC);
+          if (r.fd < 0 && create)
+            {
+              // Sparse: the payload is not looked at, as in the simulation
+              int wfd = open (name.c_str (), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+              if (wfd < 0 || ftruncate (wfd, rep.offsets.back ()) < 0)
+                {
+                  std::cerr << "Cannot create " << name << std::endl;
+                  if (wfd >= 0)
+                    {
+                      close (wfd);
+                    }
+                  return false;
+                }
+              close (wfd);
+              r.fd = open (name.c_str (), O_RDONLY | O_CLOEXEC);
+            }
+          struct stat st;
+          if (r.fd < 0 || fstat (r.fd, &st) < 0 || st.st_size < r.offsets.back ())
+            {
+              std::cerr << "Missing or short content file " << name << std::endl;
+              return false;
+            }
+          r.length = st.st_size;
+          if (r.length > 0)
+            {
+              void *data = mmap (0, r.length, PROT_READ, MAP_SHARED, r.fd, 0);
+              if (data == MAP_FAILED)
+                {
+                  std::cerr << "Cannot map " << name << std::endl;
+                  return false;
+                }
+              r.data = (uint8_t *) data;
+            }
+        }
+    }
+  return true;
+}
+
+void
+mvdashTestbedContent::Close (void)
+{
+  for (std::vector<st_representation> &reps : m_reps)
+    {
+      for (st_representation &r : reps)
+        {
+          if (r.data)
+            {
+              munmap (r.data, r.length);
+            }
+          if (r.fd >= 0)
+            {
+              close (r.fd);
+            }
+        }
+    }
+  m_reps.clear ();
+}
+
+bool
+mvdashTestbedContent::IsValid (const st_mvdashRequest &req) const
+{
+  if (req.viewpoint < 0 || req.viewpoint >= (int32_t) m_reps.size ())
+    {
+      return false;
+    }
+  const std::vector<st_representation> &reps = m_reps[req.viewpoint];
+  if (req.qualityIndex < 0 || req.qualityIndex >= (int32_t) reps.size ())
+    {
+      return false;
+    }
+  const st_representation &r = reps[req.qualityIndex];
+  if (req.tile < 0 || req.tile >= r.nTiles || req.timeIndex < 0)
+    {
+      return false;
+    }
+  int64_t i = (int64_t) req.timeIndex * r.nTiles + req.tile;
+  if (i + 1 >= (int64_t) r.offsets.size ())
+    {
+      return false;
+    }
+  return r.offsets[i + 1] - r.offsets[i] == req.segmentSize;
+}
+
+void
+mvdashTestbedContent::Prefetch (const st_mvdashRequest &req) const
+{
+  static const uintptr_t pageMask = ~((uintptr_t) sysconf (_SC_PAGESIZE) - 1);
+  const st_representation &r = m_reps[req.viewpoint][req.qualityIndex];
+  if (!r.data || req.segmentSize <= 0)
+    {
+      return;
+    }
+  uint8_t *start = (uint8_t *) ((uintptr_t) (r.data + GetOffset (req)) & pageMask);
+  madvise (start, r.data + GetOffset (req) + req.segmentSize - start, MADV_WILLNEED);
+}
+
+} // namespace ns3
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2021 ETRI (Electronic and Telecommunication Research Institute) KOREA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MVDASH_TESTBED_H
+#define MVDASH_TESTBED_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include "ns3/mvdash.h"
+
+namespace ns3 {
+
+/**
+ * \defgroup mvdash-testbed Testbed programs over real sockets
+ *
+ * Linux programs that speak the st_mvdashRequest protocol of mvdashServer
+ * and mvdashClient over real TCP sockets, for checking the simulated
+ * behavior against a real implementation.  They run on the wall clock and
+ * never start the simulator.
+ */
+
+/**
+ * \ingroup mvdash-testbed
+ * \returns microseconds of a monotonic clock
+ */
+int64_t mvdashTestbedNow (void);
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief Parse "a.b.c.d:port"
+ */
+bool mvdashTestbedParseAddress (std::string address, struct sockaddr_in &sa);
+
+/**
+ * \ingroup mvdash-testbed
+ * \returns false if O_NONBLOCK cannot be set
+ */
+bool mvdashTestbedSetNonBlocking (int fd);
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief Open a non-blocking listening TCP socket
+ * \param reusePort let several sockets, one per thread, listen on sa
+ * \returns the socket, -1 on error
+ */
+int mvdashTestbedListen (const struct sockaddr_in &sa, bool reusePort, int backlog);
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief Tile videoData as the TileInfo file says, or into columns x rows
+ *        tiles of equal size; neither leaves it whole
+ * \returns false if tileInfo cannot be read
+ */
+bool mvdashTestbedReadTiles (std::string tileInfo, uint32_t columns, uint32_t rows, t_videoDataGroup &videoData);
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief Layer videoData as the LayerInfo file says, or make layers of its
+ *        rates if layered is set; neither leaves it single-layer
+ * \returns false if layerInfo cannot be read
+ */
+bool mvdashTestbedReadLayers (std::string layerInfo, bool layered, double overhead, t_videoDataGroup &videoData);
+
+/**
+ * \ingroup mvdash-testbed
+ * \brief Segments of the video as served by the testbed server.
+ *
+ * Each representation (viewpoint, quality) is one file, "vp<v>_q<q>.bin" in
+ * the content directory, holding its segments back to back in time index
+ * order, with the sizes of the manifest.  The segments of a tiled video hold
+ * their tiles back to back, so a file serves the tiles and the whole segments
+ * of a video cut into tiles of equal size alike; the file of a layered video
+ * holds the layer of its quality alone.  The files are mapped read-only:
+ * the mapping gives the page-cache readahead of requested segments and the
+ * copy path, the descriptor the sendfile path.
+ */
+class mvdashTestbedContent
+{
+public:
+  mvdashTestbedContent ();
+  ~mvdashTestbedContent ();
+
+  /**
+   * \param create make missing files, sparse, of the manifest sizes
+   * \returns false if a file is missing or shorter than the manifest says
+   */
+  bool Open (std::string dir, const t_videoDataGroup &videoData, bool create);
+  void Close (void);
+
+  /**
+   * \returns true if req names a segment of the manifest with its size
+   */
+  bool IsValid (const st_mvdashRequest &req) const;
+  int GetFd (const st_mvdashRequest &req) const { return m_reps[req.viewpoint][req.qualityIndex].fd; }
+  /// Offset of the segment of req in its representation file
+  int64_t GetOffset (const st_mvdashRequest &req) const
+  {
+    const st_representation &r = m_reps[req.viewpoint][req.qualityIndex];
+    return r.offsets[req.timeIndex * r.nTiles + req.tile];
+  }
+  const uint8_t * GetData (const st_mvdashRequest &req) const
+  {
+    return m_reps[req.viewpoint][req.qualityIndex].data + GetOffset (req);
+  }
+  /**
+   * \brief Ask the kernel to read the segment of req ahead
+   */
+  void Prefetch (const st_mvdashRequest &req) const;
+
+  static std::string GetFileName (std::string dir, int32_t viewpoint, int32_t quality);
+
+private:
+  /// One representation file
+  struct st_representation
+  {
+    int       fd;
+    uint8_t  *data;             //!< read-only mapping of the whole file
+    int64_t   length;
+    int32_t   nTiles;           //!< 1 if not tiled
+    std::vector <int64_t> offsets;  //!< by time index and tile, plus the end of the last segment
+  };
+
+  const t_videoDataGroup *m_videoData;
+  std::vector < std::vector<st_representation> > m_reps;  //!< by viewpoint and quality
+};
+
+} // namespace ns3
+
+#endif /* MVDASH_TESTBED_H */